@@ -0,0 +1,470 @@
+/*-
+ * Copyright (c) 2011, 2012, 2013, Columbia University
+ * All rights reserved.
+ *
+ * This software was developed by Vasileios P. Kemerlis <vpk@cs.columbia.edu>
+ * at Columbia University, New York, NY, USA, in June 2011.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Columbia University nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+/*
+ * exec handoff
+ *
+ * execve(2) replaces the address space, and the instance of libdft that
+ * follows the new image (-follow_execv) starts with a clear tagmap; the
+ * tags of the argument and environment strings, which the kernel copies
+ * onto the new stack, are lost, and so is the state that the tool keeps
+ * for the inherited descriptors. Right before the exec, the tags of the
+ * argv/envp strings, and the descriptors of the tool that survive the
+ * exec (i.e., without FD_CLOEXEC), are written into an anonymous memory
+ * file that is inherited as EXECTAG_FD. The new instance picks it up
+ * during its initialization, and applies it when the first thread
+ * starts; the strings are found on the initial stack, in the same
+ * order, and their tags are read back into the tagmap.
+ *
+ * The handoff carries only what is there to carry; with clear strings
+ * and no descriptors, nothing is created, and a failed exec drops it.
+ * The strings are fetched with PIN_SafeCopy(), and measured once; an
+ * invalid argv/envp carries nothing (the exec fails with EFAULT). The
+ * handoff is close-on-exec unless Pin follows the new image.
+ * NOTE: nothing is carried if the application uses EXECTAG_FD
+ */
+
+#include <sys/syscall.h>
+#include <sys/types.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <set>
+#include <vector>
+
+#include "libdft_api.h"
+#include "exectag.h"
+#include "summary.h"
+#include "tagmap.h"
+#include "branch_pred.h"
+
+#ifndef __NR_memfd_create
+#define __NR_memfd_create	356	/* i386; Linux 3.17 */
+#endif
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC		0x0001U	/* see linux/memfd.h */
+#endif
+
+/* handoff header; followed by the descriptors and the tags */
+typedef struct {
+	uint32_t	magic;		/* EXECTAG_MAGIC */
+	uint32_t	argc;		/* argument strings */
+	uint32_t	envc;		/* environment strings */
+	uint32_t	len;		/* bytes of tags (0 if all clear) */
+	uint32_t	nfds;		/* descriptors */
+} exectag_hdr_t;
+
+/* a string of the exec: address and length (including the NUL) */
+typedef pair<ADDRINT, uint32_t> exectag_str_t;
+
+static int	exectag_in	= -1;	/* inherited handoff (-1 if none) */
+static int	exectag_out	= -1;	/* outgoing handoff (-1 if none) */
+static set<int>	*exectag_fdset	= NULL;	/* descriptors of the tool */
+
+
+/*
+ * measure a NULL-terminated array of strings
+ *
+ * the array and the strings are fetched with PIN_SafeCopy(), so
+ * that an invalid pointer fails the measurement instead of
+ * faulting inside the tool
+ *
+ * @strv:	the array (it may be NULL)
+ * @strs:	the strings (appended)
+ * @len:	the bytes of the strings, including the NULs (updated)
+ * @tag:	the tags of the strings (ORed; updated)
+ *
+ * returns:	the number of strings, or -1 on error
+ */
+static int
+exectag_strs(ADDRINT strv, vector<exectag_str_t> *strs, uint32_t *len,
+		uint8_t *tag)
+{
+	/* number of strings */
+	int n;
+	/* a string and its length */
+	ADDRINT str;
+	size_t slen, nul;
+
+	/* traverse the array */
+	for (n = 0; strv != 0; n++, strv += sizeof(str)) {
+		/* the next pointer; optimized branch */
+		if (unlikely(PIN_SafeCopy(&str, (const VOID *)strv,
+					sizeof(str)) != sizeof(str)))
+			return -1;
+
+		/* the end of the array */
+		if (str == 0)
+			break;
+
+		/* the string; optimized branch */
+		slen = summary_strnlen(str, EXECTAG_STRMAX, &nul) + 1;
+		if (unlikely(nul == 0))
+			return -1;
+
+		/* update */
+		*tag	|= tagmap_getn((size_t)str, slen);
+		*len	+= slen;
+		strs->push_back(make_pair(str, (uint32_t)slen));
+	}
+
+	/* done */
+	return n;
+}
+
+/*
+ * write (or read) the tags of the strings of the exec
+ *
+ * @fd:		the handoff
+ * @strs:	the strings (see exectag_strs())
+ * @off:	the offset of the tags in the handoff
+ * @load:	read the tags instead of writing them (flag)
+ *
+ * returns:	0 on success, 1 on error
+ */
+static int
+exectag_io(int fd, const vector<exectag_str_t> &strs, off64_t off,
+		size_t load)
+{
+	/* iterator */
+	size_t i;
+
+	/* traverse the strings */
+	for (i = 0; i < strs.size(); off += strs[i].second, i++)
+		/* the tags of the string; optimized branch */
+		if (unlikely((load ?
+			tagmap_pread(fd, strs[i].first, strs[i].second, off) :
+			tagmap_pwrite(fd, strs[i].first, strs[i].second,
+				off)) != 0))
+			/* failed */
+			return 1;
+
+	/* success */
+	return 0;
+}
+
+/*
+ * the new image is followed (-follow_execv)
+ *
+ * the handoff is close-on-exec, so that an image that is
+ * not followed does not inherit it; let it through
+ *
+ * @child:	the child process
+ * @v:		callback value
+ *
+ * returns:	TRUE (the image is followed)
+ */
+static BOOL
+exectag_follow(CHILD_PROCESS child, VOID *v)
+{
+	/* keep the handoff open across the exec */
+	if (exectag_out >= 0)
+		(void)fcntl(exectag_out, F_SETFD, 0);
+
+	/* follow it */
+	return TRUE;
+}
+
+/*
+ * look for an inherited handoff
+ *
+ * called by libdft_init(); the handoff is a memory
+ * file (EXECTAG_NAME) in the EXECTAG_FD slot
+ */
+void
+exectag_init(void)
+{
+	/* path of the slot and its target */
+	char path[PATH_MAX], link[PATH_MAX];
+	/* link length */
+	ssize_t n;
+
+	/* the handoff of a followed image is inherited */
+	PIN_AddFollowChildProcessFunction(exectag_follow, NULL);
+
+	/* the target of the slot; e.g., "/memfd:libdft-exec (deleted)" */
+	(void)snprintf(path, sizeof(path), "/proc/self/fd/%d", EXECTAG_FD);
+	if (likely((n = readlink(path, link, sizeof(link) - 1)) < 0))
+		/* no handoff */
+		return;
+	link[n] = '\0';
+
+	/* not a handoff; the application uses the slot */
+	if (strncmp(link, "/memfd:" EXECTAG_NAME,
+				strlen("/memfd:" EXECTAG_NAME)) != 0)
+		return;
+
+	/* applied when the first thread starts */
+	exectag_in = EXECTAG_FD;
+}
+
+/*
+ * register the descriptors of the tool
+ *
+ * the tracked descriptors that survive an exec are
+ * carried over, and inserted into the same set (and
+ * the sampling logic) by the new instance
+ *
+ * @fds:	the set of descriptors
+ */
+void
+exectag_fds(set<int> *fds)
+{
+	exectag_fdset = fds;
+}
+
+/*
+ * execve(2)/execveat(2) pre-syscall hook
+ *
+ * write the handoff (if there is anything to carry)
+ *
+ * @ctx:	syscall context
+ */
+void
+exectag_pre(syscall_ctx_t *ctx)
+{
+	/* handoff header */
+	exectag_hdr_t hdr;
+	/* tags of the strings (ORed) */
+	uint8_t tag = 0;
+	/* the strings */
+	vector<exectag_str_t> strs;
+	/* number of argv and envp strings */
+	int argc, envc;
+	/* descriptors to carry */
+	vector<int> fds;
+	/* iterator */
+	set<int>::iterator it;
+	/* descriptor flags and the handoff */
+	int flags, fd;
+	/* offset of the tags */
+	off64_t off;
+	/* argument index */
+	size_t i;
+
+	/* execveat(2) takes a directory descriptor first */
+	i = (ctx->nr == __NR_execve) ? SYSCALL_ARG1 : SYSCALL_ARG2;
+
+	/* the strings */
+	(void)memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = EXECTAG_MAGIC;
+	if (unlikely((argc = exectag_strs(ctx->arg[i], &strs, &hdr.len,
+				&tag)) < 0 ||
+			(envc = exectag_strs(ctx->arg[i + 1], &strs, &hdr.len,
+				&tag)) < 0))
+		/* invalid argv/envp; the exec fails with EFAULT */
+		return;
+	hdr.argc = argc;
+	hdr.envc = envc;
+
+	/* clear strings; no tags */
+	if (tag == 0)
+		hdr.len = 0;
+
+	/* the descriptors that survive the exec */
+	if (exectag_fdset != NULL)
+		for (it = exectag_fdset->begin();
+				it != exectag_fdset->end(); it++)
+			if ((flags = fcntl(*it, F_GETFD)) >= 0 &&
+					!(flags & FD_CLOEXEC))
+				fds.push_back(*it);
+	hdr.nfds = fds.size();
+
+	/* nothing to carry; fast path */
+	if (likely(hdr.len == 0 && hdr.nfds == 0))
+		return;
+
+	/* the slot is used by the application; optimized branch */
+	if (unlikely(fcntl(EXECTAG_FD, F_GETFD) >= 0)) {
+		/* error message */
+		LOG(string(__func__) + ": descriptor " + decstr(EXECTAG_FD) +
+				" in use; nothing is carried\n");
+
+		/* nothing else to do */
+		return;
+	}
+
+	/* create the handoff; optimized branch */
+	if (unlikely((fd = syscall(__NR_memfd_create, EXECTAG_NAME,
+					MFD_CLOEXEC)) < 0)) {
+		/* error message */
+		LOG(string(__func__) + ": memfd_create(2) failed (" +
+				string(strerror(errno)) + ")\n");
+
+		/* nothing else to do */
+		return;
+	}
+
+	/* move it to the slot (close-on-exec; see exectag_follow()) */
+	if (unlikely(dup3(fd, EXECTAG_FD, O_CLOEXEC) < 0)) {
+		/* error message */
+		LOG(string(__func__) + ": dup3(2) failed (" +
+				string(strerror(errno)) + ")\n");
+
+		/* cleanup */
+		(void)close(fd);
+		return;
+	}
+	(void)close(fd);
+	exectag_out = EXECTAG_FD;
+
+	/* the tags follow the header and the descriptors */
+	off = sizeof(hdr) + hdr.nfds * sizeof(int);
+
+	/* write the handoff; optimized branch */
+	if (unlikely(
+		pwrite64(exectag_out, &hdr, sizeof(hdr), 0) != sizeof(hdr) ||
+		(hdr.nfds > 0 && pwrite64(exectag_out, &fds[0],
+			hdr.nfds * sizeof(int), sizeof(hdr)) !=
+				(ssize_t)(hdr.nfds * sizeof(int))) ||
+		(hdr.len > 0 && exectag_io(exectag_out, strs, off, 0)))) {
+		/* error message */
+		LOG(string(__func__) + ": handoff write failed (" +
+				string(strerror(errno)) + ")\n");
+
+		/* cleanup */
+		(void)close(exectag_out);
+		exectag_out = -1;
+	}
+}
+
+/*
+ * execve(2)/execveat(2) post-syscall hook
+ *
+ * reached only if the exec failed; drop the handoff
+ *
+ * @ctx:	syscall context
+ */
+void
+exectag_post(syscall_ctx_t *ctx)
+{
+	/* no handoff */
+	if (exectag_out < 0)
+		return;
+
+	/* cleanup */
+	(void)close(exectag_out);
+	exectag_out = -1;
+}
+
+/*
+ * apply the inherited handoff
+ *
+ * called when a thread starts; the first thread of the new
+ * image starts with the stack pointer at the argument count,
+ * followed by the argv and envp arrays (NULL-terminated)
+ *
+ * @ctx:	CPU context
+ */
+void
+exectag_load(CONTEXT *ctx)
+{
+	/* handoff header */
+	exectag_hdr_t hdr;
+	/* the initial stack */
+	ADDRINT *sp;
+	/* the strings */
+	vector<exectag_str_t> strs;
+	/* number of argv and envp strings, and their length */
+	int argc, envc;
+	uint32_t len = 0;
+	/* tags of the strings (unused) */
+	uint8_t tag = 0;
+	/* iterator */
+	uint32_t i;
+	/* a descriptor */
+	int fd;
+	/* offset of the tags */
+	off64_t off;
+
+	/* no handoff; fast path */
+	if (likely(exectag_in < 0))
+		return;
+
+	/* read the header; optimized branch */
+	if (unlikely(pread64(exectag_in, &hdr, sizeof(hdr), 0) !=
+				sizeof(hdr) || hdr.magic != EXECTAG_MAGIC)) {
+		/* error message */
+		LOG(string(__func__) + ": invalid handoff\n");
+
+		/* cleanup */
+		goto done;
+	}
+
+	/* the descriptors; still open and tracked again */
+	for (i = 0; i < hdr.nfds; i++)
+		if (pread64(exectag_in, &fd, sizeof(fd),
+				sizeof(hdr) + i * sizeof(fd)) == sizeof(fd) &&
+				fd != exectag_in &&
+				fcntl(fd, F_GETFD) >= 0 &&
+				exectag_fdset != NULL &&
+				exectag_fdset->insert(fd).second)
+			(void)sample_open(fd);
+
+	/* clear strings; nothing else to do */
+	if (hdr.len == 0)
+		goto done;
+
+	/* the strings on the initial stack */
+	sp	= (ADDRINT *)PIN_GetContextReg(ctx, REG_STACK_PTR);
+	argc	= exectag_strs((ADDRINT)&sp[1], &strs, &len, &tag);
+	envc	= exectag_strs((ADDRINT)&sp[sp[0] + 2], &strs, &len, &tag);
+
+	/* not the strings of the exec; optimized branch */
+	if (unlikely(argc != (int)hdr.argc || envc != (int)hdr.envc ||
+				len != hdr.len)) {
+		/* error message */
+		LOG(string(__func__) + ": argv/envp mismatch\n");
+
+		/* cleanup */
+		goto done;
+	}
+
+	/* read the tags; optimized branch */
+	off = sizeof(hdr) + hdr.nfds * sizeof(int);
+	if (unlikely(exectag_io(exectag_in, strs, off, 1)))
+		/* error message */
+		LOG(string(__func__) + ": handoff read failed (" +
+				string(strerror(errno)) + ")\n");
+
+done:
+	/* the handoff is applied once */
+	(void)close(exectag_in);
+	exectag_in = -1;
+}
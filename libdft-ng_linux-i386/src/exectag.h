@@ -0,0 +1,56 @@
+/*-
+ * Copyright (c) 2011, 2012, 2013, Columbia University
+ * All rights reserved.
+ *
+ * This software was developed by Vasileios P. Kemerlis <vpk@cs.columbia.edu>
+ * at Columbia University, New York, NY, USA, in June 2011.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Columbia University nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+#ifndef __EXECTAG_H__
+#define __EXECTAG_H__
+
+#include <set>
+
+#include "pin.H"
+#include "libdft_api.h"
+
+#define EXECTAG_FD	1021		/* descriptor of the handoff	*/
+#define EXECTAG_NAME	"libdft-exec"	/* name of the handoff memfd	*/
+#define EXECTAG_MAGIC	0x78656466	/* magic number ("fdex")	*/
+#define EXECTAG_STRMAX	131072		/* longest string (MAX_ARG_STRLEN) */
+
+
+/* exec handoff API */
+void	exectag_init(void);
+void	exectag_fds(set<int> *);
+void	exectag_pre(syscall_ctx_t *);
+void	exectag_post(syscall_ctx_t *);
+void	exectag_load(CONTEXT *);
+
+#endif /* __EXECTAG_H__ */
@@ -0,0 +1,913 @@
+/*-
+ * Copyright (c) 2011, 2012, 2013, Columbia University
+ * All rights reserved.
+ *
+ * This software was developed by Vasileios P. Kemerlis <vpk@cs.columbia.edu>
+ * at Columbia University, New York, NY, USA, in June 2011.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Columbia University nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * file tag store
+ *
+ * pipes, sockets, and files are not shadowed; the data that are written
+ * into a file lose their tags, and the data that are read from it get
+ * the tags that the taint-sources choose. With the file tag store, the
+ * tags of the data that are written into a regular file are kept in a
+ * shadow file (one byte per file byte, as in the tagmap), and they are
+ * restored whenever the same file range is read, or mapped, later on.
+ *
+ * Every file (device, inode) has an in-memory map of the ranges that
+ * were written (start -> end), with adjacent ranges merged, and the
+ * tags themselves are stored in the shadow file; ranges with clear tags
+ * are punched out of it, and therefore the shadow files are sparse and
+ * they do not consume memory. The descriptor of a shadow file is moved
+ * above the range that applications typically use (FILETAG_FD_BASE),
+ * and it is closed when the last application descriptor of the file is
+ * closed; the shadow file is reopened by its name (it carries the pid)
+ * the next time that the file is accessed. The shadow files of a process
+ * are removed at exit, copied on fork, and the ones that are left behind
+ * by an exec (same pid) are removed when the new image starts.
+ *
+ * NOTE: the tags persist only for the lifetime of a process (image); the
+ * store is private to it, a child starts with a copy of it, and it is
+ * discarded at exit. Hence, a file that is written by one process and
+ * read by another (including a later run of the same program) does not
+ * carry its tags over; sharing the store would require shadow files that
+ * are keyed by (device, inode) and locked across processes.
+ *
+ * NOTE: the shadow files are accessed with pread(2)/pwrite(2) instead of
+ * being mapped, so that they do not compete with the application and the
+ * tagmap for the (32-bit) address space. Writes via shared file mappings,
+ * and truncate(2) on paths, are not tracked
+ */
+
+#include <sys/stat.h>
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <map>
+
+#include "libdft_api.h"
+#include "filetag.h"
+#include "tagmap.h"
+#include "branch_pred.h"
+
+#ifndef	FALLOC_FL_KEEP_SIZE
+#define	FALLOC_FL_KEEP_SIZE	0x01	/* see linux/falloc.h */
+#endif
+#ifndef	FALLOC_FL_PUNCH_HOLE
+#define	FALLOC_FL_PUNCH_HOLE	0x02	/* see linux/falloc.h */
+#endif
+
+/* the store of a file */
+typedef struct {
+	dev_t			dev;	/* device			*/
+	ino_t			ino;	/* inode			*/
+	int			fd;	/* shadow file; -1 if closed	*/
+	size_t			refs;	/* application descriptors	*/
+	string			path;	/* shadow file; empty if none	*/
+	map<off64_t, off64_t>	runs;	/* written ranges		*/
+} filetag_t;
+
+/* shadow files directory; empty if the store is disabled */
+static string filetag_dir;
+
+/* file stores (device, inode) */
+static map<pair<dev_t, ino_t>, filetag_t *> filetags;
+
+/* descriptor -> file store; NULL if it is not a regular file */
+static map<int, filetag_t *> filetag_fds;
+
+/* lock of the stores and the descriptor cache */
+static PIN_LOCK filetag_lock;
+
+/* copy buffer of the shadow files (fork) */
+static uint8_t filetag_buf[FILETAG_CHUNK];
+
+/*
+ * get the store of the file that a descriptor refers to
+ *
+ * the store is created the first time that the file is seen, and
+ * the result is cached until the descriptor is closed
+ *
+ * @fd:		the descriptor
+ *
+ * returns:	the store, or NULL if fd does not refer to a regular file
+ */
+static filetag_t *
+filetag_get(int fd)
+{
+	/* iterator */
+	map<int, filetag_t *>::iterator it;
+
+	/* file status */
+	struct stat64 st;
+
+	/* the store */
+	filetag_t *ft = NULL;
+
+	/* cached; optimized branch */
+	if (likely((it = filetag_fds.find(fd)) != filetag_fds.end()))
+		return it->second;
+
+	/* regular file */
+	if (fstat64(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+		/* first time; create it */
+		if ((ft = filetags[make_pair(st.st_dev, st.st_ino)]) == NULL) {
+			ft		= new filetag_t;
+			ft->dev		= st.st_dev;
+			ft->ino		= st.st_ino;
+			ft->fd		= -1;
+			ft->refs	= 0;
+			filetags[make_pair(st.st_dev, st.st_ino)] = ft;
+		}
+
+		/* one more descriptor refers to it */
+		ft->refs++;
+	}
+
+	/* cache */
+	filetag_fds[fd] = ft;
+
+	/* return the store */
+	return ft;
+}
+
+/*
+ * move a shadow file descriptor above the application's range
+ *
+ * the descriptor is kept as is if there is no free slot at, or
+ * above, FILETAG_FD_BASE (e.g., due to RLIMIT_NOFILE)
+ *
+ * @fd:		the descriptor
+ *
+ * returns:	the new descriptor (close-on-exec)
+ */
+static int
+filetag_high(int fd)
+{
+	/* the new descriptor */
+	int nfd;
+
+	/* duplicate it; optimized branch */
+	if (likely((nfd = fcntl(fd, F_DUPFD_CLOEXEC, FILETAG_FD_BASE)) >= 0)) {
+		(void)close(fd);
+		return nfd;
+	}
+
+	/* keep it */
+	return fd;
+}
+
+/*
+ * open the shadow file of a store; it is created the first time
+ *
+ * @ft:		the store
+ *
+ * returns:	0 on success, 1 on error
+ */
+static int
+filetag_shadow(filetag_t *ft)
+{
+	/* shadow file path */
+	char path[PATH_MAX];
+
+	/* descriptor */
+	int fd;
+
+	/* already open; optimized branch */
+	if (likely(ft->fd >= 0))
+		return 0;
+
+	/* reopen it */
+	if (!ft->path.empty())
+		fd = open(ft->path.c_str(), O_RDWR | O_LARGEFILE | O_CLOEXEC);
+	/* create it */
+	else {
+		(void)snprintf(path, PATH_MAX, "%s/%s-%d-%llx-%llx",
+				filetag_dir.c_str(), FILETAG_PREF, getpid(),
+				(unsigned long long)ft->dev,
+				(unsigned long long)ft->ino);
+		if ((fd = open(path,
+			O_RDWR | O_CREAT | O_TRUNC | O_LARGEFILE | O_CLOEXEC,
+			S_IRUSR | S_IWUSR)) >= 0)
+			ft->path = path;
+	}
+
+	/* failed */
+	if (unlikely(fd < 0))
+		return 1;
+
+	/* move it out of the way */
+	ft->fd = filetag_high(fd);
+
+	/* success */
+	return 0;
+}
+
+/*
+ * forget the cached store of a descriptor
+ *
+ * the shadow file is closed when no application descriptor refers
+ * to the file anymore; the store itself (and its tags) is kept
+ *
+ * @fd:		the descriptor
+ */
+static void
+filetag_drop(int fd)
+{
+	/* iterator */
+	map<int, filetag_t *>::iterator it;
+
+	/* the store */
+	filetag_t *ft;
+
+	/* not cached */
+	if ((it = filetag_fds.find(fd)) == filetag_fds.end())
+		return;
+
+	/* forget it */
+	ft = it->second;
+	filetag_fds.erase(it);
+
+	/* the last descriptor of the file */
+	if (ft != NULL && --ft->refs == 0 && ft->fd >= 0) {
+		(void)close(ft->fd);
+		ft->fd = -1;
+	}
+}
+
+/*
+ * check if a file range overlaps with the written ranges of a store
+ *
+ * @ft:		the store
+ * @start:	the start of the range
+ * @end:	the end of the range (exclusive)
+ *
+ * returns:	1 if the range overlaps, 0 otherwise
+ */
+static inline size_t
+filetag_overlaps(filetag_t *ft, off64_t start, off64_t end)
+{
+	/* iterators */
+	map<off64_t, off64_t>::iterator it, prev;
+
+	/* the first range that starts after start */
+	it = ft->runs.upper_bound(start);
+
+	/* the previous range covers start */
+	if (it != ft->runs.begin() && (--(prev = it))->second > start)
+		return 1;
+
+	/* the next range starts before end */
+	return (it != ft->runs.end() && it->first < end);
+}
+
+/*
+ * add a file range to the written ranges of a store;
+ * overlapping and adjacent ranges are merged
+ *
+ * @ft:		the store
+ * @start:	the start of the range
+ * @end:	the end of the range (exclusive)
+ */
+static void
+filetag_add(filetag_t *ft, off64_t start, off64_t end)
+{
+	/* iterators */
+	map<off64_t, off64_t>::iterator it, prev;
+
+	/* the first range that starts after start */
+	it = ft->runs.upper_bound(start);
+
+	/* the previous range overlaps, or it is adjacent */
+	if (it != ft->runs.begin() && (--(prev = it))->second >= start) {
+		start	= prev->first;
+		end	= max(end, prev->second);
+		ft->runs.erase(prev);
+	}
+
+	/* the next ranges overlap, or they are adjacent */
+	while (it != ft->runs.end() && it->first <= end) {
+		end	= max(end, it->second);
+		ft->runs.erase(it++);
+	}
+
+	/* update */
+	ft->runs[start] = end;
+}
+
+/*
+ * get the file offset of a transfer
+ *
+ * @fd:		the descriptor
+ * @num:	the number of bytes transferred
+ * @off:	the offset of the transfer; negative if
+ * 		the current file offset was used
+ *
+ * returns:	the offset, or a negative value on error
+ */
+static inline off64_t
+filetag_pos(int fd, size_t num, off64_t off)
+{
+	/* positional transfer */
+	if (off >= 0)
+		return off;
+
+	/* the file offset has been advanced by num bytes */
+	return ((off = lseek64(fd, 0, SEEK_CUR)) < 0) ? off :
+		off - (off64_t)num;
+}
+
+/*
+ * record the tags of written data
+ *
+ * @ft:		the store
+ * @addr:	the virtual address of the data
+ * @num:	the number of bytes
+ * @off:	the file offset
+ */
+static void
+filetag_put(filetag_t *ft, size_t addr, size_t num, off64_t off)
+{
+	/* clean data */
+	if (tagmap_getn(addr, num) == TAG_ZERO) {
+		/*
+		 * stale tags; punch them out of the shadow file,
+		 * or overwrite them if the filesystem cannot
+		 */
+		if (!ft->path.empty() && filetag_overlaps(ft, off, off + num) &&
+			(unlikely(filetag_shadow(ft) != 0) ||
+			(fallocate64(ft->fd,
+				FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+				off, num) != 0 &&
+			unlikely(tagmap_pwrite(ft->fd, addr, num, off) != 0))))
+			/* failed */
+			goto err;
+	}
+	/* tainted data */
+	else if (unlikely(filetag_shadow(ft) != 0) ||
+			unlikely(tagmap_pwrite(ft->fd, addr, num, off) != 0))
+		/* failed */
+		goto err;
+
+	/* the range is written */
+	filetag_add(ft, off, off + (off64_t)num);
+
+	/* done */
+	return;
+
+err:	/* error handling */
+
+	/* error message */
+	LOG(string(__func__) + ": failed to store the tags of " +
+		decstr(num) + " bytes at " + decstr(off) + " (" +
+		string(strerror(errno)) + ")\n");
+
+	/* die */
+	libdft_die();
+}
+
+/*
+ * restore the tags of read data
+ *
+ * the bytes that were not written get the default tag value
+ *
+ * @ft:		the store
+ * @addr:	the virtual address of the data
+ * @num:	the number of bytes
+ * @off:	the file offset
+ * @color:	the default tag value
+ */
+static void
+filetag_fetch(filetag_t *ft, size_t addr, size_t num, off64_t off,
+		uint8_t color)
+{
+	/* iterator */
+	map<off64_t, off64_t>::iterator it;
+
+	/* range end, current position, and written range (start/end) */
+	off64_t end = off + (off64_t)num, pos = off, start, stop;
+
+	/* the first range that may overlap */
+	it = ft->runs.upper_bound(off);
+	if (it != ft->runs.begin())
+		it--;
+
+	/* traverse the ranges until the end of the data */
+	while (pos < end) {
+		/* the next written part */
+		if (it != ft->runs.end() && it->first < end) {
+			start	= max(it->first, pos);
+			stop	= min(it->second, end);
+			it++;
+
+			/* the range ends before the data */
+			if (stop <= start)
+				continue;
+		}
+		/* no more written parts */
+		else
+			start = stop = end;
+
+		/* the part that was not written */
+		if (start > pos) {
+			if (color == TAG_ZERO)
+				tagmap_clrn(addr + (pos - off), start - pos);
+			else
+				tagmap_setn(addr + (pos - off), start - pos,
+						color);
+		}
+
+		/* the written part */
+		if (stop > start) {
+			/* clean; there is no shadow file */
+			if (ft->path.empty())
+				tagmap_clrn(addr + (start - off), stop - start);
+			/* the tags are in the shadow file */
+			else if (unlikely(filetag_shadow(ft) != 0) ||
+					unlikely(tagmap_pread(ft->fd,
+					addr + (start - off), stop - start,
+					start) != 0)) {
+				/* error message */
+				LOG(string(__func__) +
+					": failed to load the tags of " +
+					decstr(stop - start) + " bytes at " +
+					decstr(start) + " (" +
+					string(strerror(errno)) + ")\n");
+
+				/* die */
+				libdft_die();
+			}
+		}
+
+		/* housekeeping */
+		pos = stop;
+	}
+}
+
+/*
+ * record the tags of the data that are written into a file
+ *
+ * called after write(2)/pwrite64(2)
+ *
+ * @fd:		the descriptor
+ * @addr:	the virtual address of the data
+ * @num:	the number of bytes written
+ * @off:	the file offset; negative for the current one
+ */
+void
+filetag_store(int fd, size_t addr, size_t num, off64_t off)
+{
+	/* the store */
+	filetag_t *ft;
+
+	/* disabled; optimized branch */
+	if (likely(filetag_dir.empty()) || unlikely(num == 0))
+		return;
+
+	PIN_GetLock(&filetag_lock, PIN_ThreadId() + 1);
+
+	/* record the tags of a regular file */
+	if ((ft = filetag_get(fd)) != NULL &&
+			likely((off = filetag_pos(fd, num, off)) >= 0))
+		filetag_put(ft, addr, num, off);
+
+	PIN_ReleaseLock(&filetag_lock);
+}
+
+/*
+ * record the tags of the data that are written into a file
+ *
+ * called after writev(2)/pwritev(2)/pwritev2(2)
+ *
+ * @fd:		the descriptor
+ * @iov:	the iovec array
+ * @iovcnt:	the number of iovec structures
+ * @num:	the number of bytes written
+ * @off:	the file offset; negative for the current one
+ */
+void
+filetag_storev(int fd, const struct iovec *iov, size_t iovcnt, size_t num,
+		off64_t off)
+{
+	/* the store */
+	filetag_t *ft;
+
+	/* bytes in the iovec */
+	size_t len;
+
+	/* disabled; optimized branch */
+	if (likely(filetag_dir.empty()) || unlikely(num == 0))
+		return;
+
+	PIN_GetLock(&filetag_lock, PIN_ThreadId() + 1);
+
+	/* not a regular file */
+	if ((ft = filetag_get(fd)) == NULL ||
+			(off = filetag_pos(fd, num, off)) < 0)
+		goto done;
+
+	/* traverse the iovec array */
+	for (; iovcnt > 0 && num > 0; iov++, iovcnt--, off += len, num -= len)
+		/* record the tags */
+		if ((len = min((size_t)iov->iov_len, num)) > 0)
+			filetag_put(ft, (size_t)iov->iov_base, len, off);
+
+done:	/* cleanup */
+	PIN_ReleaseLock(&filetag_lock);
+}
+
+/*
+ * restore the tags of the data that are read from a file
+ *
+ * called after read(2)/pread64(2)/mmap2(2); nothing happens if no
+ * part of the data was written before, so that the caller can
+ * apply its own policy
+ *
+ * @fd:		the descriptor
+ * @addr:	the virtual address of the data
+ * @num:	the number of bytes read
+ * @off:	the file offset; negative for the current one
+ * @color:	the tag value of the bytes that were not written
+ *
+ * returns:	1 if the tags were restored, 0 otherwise
+ */
+size_t
+filetag_load(int fd, size_t addr, size_t num, off64_t off, uint8_t color)
+{
+	/* the store */
+	filetag_t *ft;
+
+	/* restored */
+	size_t ret = 0;
+
+	/* disabled; optimized branch */
+	if (likely(filetag_dir.empty()) || unlikely(num == 0))
+		return 0;
+
+	PIN_GetLock(&filetag_lock, PIN_ThreadId() + 1);
+
+	/* a regular file, and part of the data was written */
+	if ((ft = filetag_get(fd)) != NULL && !ft->runs.empty() &&
+			(off = filetag_pos(fd, num, off)) >= 0 &&
+			filetag_overlaps(ft, off, off + (off64_t)num)) {
+		/* restore the tags */
+		filetag_fetch(ft, addr, num, off, color);
+		ret = 1;
+	}
+
+	PIN_ReleaseLock(&filetag_lock);
+
+	/* done */
+	return ret;
+}
+
+/*
+ * restore the tags of the data that are read from a file
+ *
+ * called after readv(2)/preadv(2)/preadv2(2); see filetag_load()
+ *
+ * @fd:		the descriptor
+ * @iov:	the iovec array
+ * @iovcnt:	the number of iovec structures
+ * @num:	the number of bytes read
+ * @off:	the file offset; negative for the current one
+ * @color:	the tag value of the bytes that were not written
+ *
+ * returns:	1 if the tags were restored, 0 otherwise
+ */
+size_t
+filetag_loadv(int fd, const struct iovec *iov, size_t iovcnt, size_t num,
+		off64_t off, uint8_t color)
+{
+	/* the store */
+	filetag_t *ft;
+
+	/* bytes in the iovec */
+	size_t len;
+
+	/* restored */
+	size_t ret = 0;
+
+	/* disabled; optimized branch */
+	if (likely(filetag_dir.empty()) || unlikely(num == 0))
+		return 0;
+
+	PIN_GetLock(&filetag_lock, PIN_ThreadId() + 1);
+
+	/* not a regular file, or nothing written */
+	if ((ft = filetag_get(fd)) == NULL || ft->runs.empty() ||
+			(off = filetag_pos(fd, num, off)) < 0 ||
+			!filetag_overlaps(ft, off, off + (off64_t)num))
+		goto done;
+
+	/* traverse the iovec array */
+	for (; iovcnt > 0 && num > 0; iov++, iovcnt--, off += len, num -= len)
+		/* restore the tags */
+		if ((len = min((size_t)iov->iov_len, num)) > 0)
+			filetag_fetch(ft, (size_t)iov->iov_base, len, off,
+					color);
+	ret = 1;
+
+done:	/* cleanup */
+	PIN_ReleaseLock(&filetag_lock);
+
+	/* done */
+	return ret;
+}
+
+/*
+ * a file is truncated
+ *
+ * called after ftruncate(2), or open(2) with O_TRUNC
+ *
+ * @fd:		the descriptor
+ * @len:	the new file size
+ */
+void
+filetag_trunc(int fd, off64_t len)
+{
+	/* the store */
+	filetag_t *ft;
+
+	/* iterator */
+	map<off64_t, off64_t>::iterator it;
+
+	/* disabled; optimized branch */
+	if (likely(filetag_dir.empty()))
+		return;
+
+	PIN_GetLock(&filetag_lock, PIN_ThreadId() + 1);
+
+	/* not a regular file, or nothing written */
+	if ((ft = filetag_get(fd)) == NULL || ft->runs.empty())
+		goto done;
+
+	/* the ranges that start at, or after, len are dropped */
+	it = ft->runs.lower_bound(len);
+	ft->runs.erase(it, ft->runs.end());
+
+	/* the last range may cross len */
+	if (!ft->runs.empty() && (it = --ft->runs.end())->second > len)
+		it->second = len;
+
+	/* drop the stale tags */
+	if (!ft->path.empty() && filetag_shadow(ft) == 0)
+		(void)ftruncate64(ft->fd, len);
+
+done:	/* cleanup */
+	PIN_ReleaseLock(&filetag_lock);
+}
+
+/*
+ * a descriptor is duplicated
+ *
+ * @oldfd:	the old descriptor
+ * @newfd:	the new descriptor
+ */
+void
+filetag_dup(int oldfd, int newfd)
+{
+	/* iterator */
+	map<int, filetag_t *>::iterator it;
+
+	/* disabled; optimized branch */
+	if (likely(filetag_dir.empty()))
+		return;
+
+	PIN_GetLock(&filetag_lock, PIN_ThreadId() + 1);
+
+	/* newfd is implicitly closed */
+	filetag_drop(newfd);
+
+	/* share the cached store */
+	if ((it = filetag_fds.find(oldfd)) != filetag_fds.end()) {
+		filetag_fds[newfd] = it->second;
+		if (it->second != NULL)
+			it->second->refs++;
+	}
+
+	PIN_ReleaseLock(&filetag_lock);
+}
+
+/*
+ * a descriptor is closed
+ *
+ * @fd:		the descriptor
+ */
+void
+filetag_close(int fd)
+{
+	/* disabled; optimized branch */
+	if (likely(filetag_dir.empty()))
+		return;
+
+	/* forget the cached store */
+	PIN_GetLock(&filetag_lock, PIN_ThreadId() + 1);
+	filetag_drop(fd);
+	PIN_ReleaseLock(&filetag_lock);
+}
+
+/*
+ * give the child its own shadow files
+ *
+ * called in the child after fork; the shadow files of the parent
+ * are copied (only the written ranges), so that parent and child
+ * do not overwrite each other's tags
+ *
+ * @tid:	the thread id of the child
+ * @ctx:	CPU context
+ * @v:		callback value
+ */
+static void
+filetag_fork(THREADID tid, const CONTEXT *ctx, VOID *v)
+{
+	/* iterators */
+	map<pair<dev_t, ino_t>, filetag_t *>::iterator it;
+	map<off64_t, off64_t>::iterator rt;
+
+	/* the store */
+	filetag_t *ft;
+
+	/* the shadow file of the parent */
+	int src;
+
+	/* position and length of the current chunk */
+	off64_t pos;
+	ssize_t len;
+
+	/* the lock may be held by a thread that does not exist anymore */
+	PIN_InitLock(&filetag_lock);
+
+	/* traverse the stores */
+	for (it = filetags.begin(); it != filetags.end(); it++) {
+		/* no shadow file */
+		if ((ft = it->second)->path.empty())
+			continue;
+
+		/* the shadow file of the parent */
+		if ((src = ft->fd) < 0 && unlikely((src = open(ft->path.c_str(),
+				O_RDONLY | O_LARGEFILE | O_CLOEXEC)) < 0))
+			goto err;
+
+		/* create the shadow file of the child */
+		ft->fd = -1;
+		ft->path.clear();
+		if (unlikely(filetag_shadow(ft) != 0))
+			goto err;
+
+		/* copy the written ranges */
+		for (rt = ft->runs.begin(); rt != ft->runs.end(); rt++)
+			for (pos = rt->first; pos < rt->second; pos += len)
+				if (unlikely((len = pread64(src, filetag_buf,
+					min((off64_t)FILETAG_CHUNK,
+						rt->second - pos), pos)) <= 0) ||
+					unlikely(pwrite64(ft->fd, filetag_buf,
+						len, pos) != len))
+					goto err;
+
+		/* cleanup */
+		(void)close(src);
+
+		/* no descriptor of the file was inherited */
+		if (ft->refs == 0) {
+			(void)close(ft->fd);
+			ft->fd = -1;
+		}
+	}
+
+	/* done */
+	return;
+
+err:	/* error handling */
+
+	/* error message */
+	LOG(string(__func__) + ": failed to copy the shadow file of " +
+		decstr(ft->ino) + " (" + string(strerror(errno)) + ")\n");
+
+	/* die */
+	libdft_die();
+}
+
+/*
+ * remove the shadow files
+ *
+ * called when the process exits
+ *
+ * @code:	exit code of the application
+ * @v:		callback value
+ */
+static void
+filetag_fini(INT32 code, VOID *v)
+{
+	/* iterator */
+	map<pair<dev_t, ino_t>, filetag_t *>::iterator it;
+
+	/* traverse the stores */
+	for (it = filetags.begin(); it != filetags.end(); it++) {
+		if (it->second->fd >= 0)
+			(void)close(it->second->fd);
+		if (!it->second->path.empty())
+			(void)unlink(it->second->path.c_str());
+	}
+}
+
+/*
+ * remove the shadow files that a previous image of this process
+ * left behind (exec does not run the fini callbacks)
+ */
+static void
+filetag_clean(void)
+{
+	/* directory stream and entry */
+	DIR *dir;
+	struct dirent *de;
+
+	/* name prefix and path */
+	char pref[NAME_MAX], path[PATH_MAX];
+
+	/* the shadow files of this pid */
+	(void)snprintf(pref, NAME_MAX, "%s-%d-", FILETAG_PREF, getpid());
+
+	/* open the directory; optimized branch */
+	if (unlikely((dir = opendir(filetag_dir.c_str())) == NULL))
+		return;
+
+	/* traverse it */
+	while ((de = readdir(dir)) != NULL)
+		if (strncmp(de->d_name, pref, strlen(pref)) == 0) {
+			(void)snprintf(path, PATH_MAX, "%s/%s",
+					filetag_dir.c_str(), de->d_name);
+			(void)unlink(path);
+		}
+
+	/* cleanup */
+	(void)closedir(dir);
+}
+
+/*
+ * initialize the file tag store
+ *
+ * @dir:	the directory of the shadow files
+ *
+ * returns:	0 on success, 1 on error
+ */
+int
+filetag_init(const char *dir)
+{
+	/* the directory must be writable */
+	if (unlikely(access(dir, W_OK | X_OK) != 0)) {
+		/* error message */
+		LOG(string(__func__) + ": " + dir + " is not writable (" +
+				string(strerror(errno)) + ")\n");
+
+		/* failed */
+		return 1;
+	}
+
+	/* enable the store */
+	filetag_dir = dir;
+	PIN_InitLock(&filetag_lock);
+
+	/* leftovers of a previous image */
+	filetag_clean();
+
+	/* register the fork and exit callbacks */
+	PIN_AddForkFunction(FPOINT_AFTER_IN_CHILD, filetag_fork, NULL);
+	PIN_AddFiniFunction(filetag_fini, NULL);
+
+	/* success */
+	return 0;
+}
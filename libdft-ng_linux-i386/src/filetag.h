@@ -0,0 +1,58 @@
+/*-
+ * Copyright (c) 2011, 2012, 2013, Columbia University
+ * All rights reserved.
+ *
+ * This software was developed by Vasileios P. Kemerlis <vpk@cs.columbia.edu>
+ * at Columbia University, New York, NY, USA, in June 2011.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Columbia University nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef __FILETAG_H__
+#define __FILETAG_H__
+
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include "pin.H"
+
+#define FILETAG_PREF	"libdft-ft"	/* shadow file name prefix	*/
+#define FILETAG_FD_BASE	768		/* lowest shadow file descriptor */
+#define FILETAG_CHUNK	65536		/* copy chunk (fork)		*/
+
+
+/* file tag store API */
+int	filetag_init(const char *);
+void	filetag_store(int, size_t, size_t, off64_t);
+void	filetag_storev(int, const struct iovec *, size_t, size_t, off64_t);
+size_t	filetag_load(int, size_t, size_t, off64_t, uint8_t);
+size_t	filetag_loadv(int, const struct iovec *, size_t, size_t, off64_t,
+		uint8_t);
+void	filetag_trunc(int, off64_t);
+void	filetag_dup(int, int);
+void	filetag_close(int);
+
+#endif /* __FILETAG_H__ */
@@ -38,11 +38,21 @@
  */
 
 #include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 
+#include <map>
+#include <set>
+
 #include "libdft_api.h"
+#include "exectag.h"
 #include "libdft_core.h"
+#include "libdft_replay.h"
+#include "libdft_stats.h"
+#include "summary.h"
 #include "syscall_desc.h"
 #include "tagmap.h"
 #include "branch_pred.h"
@@ -59,12 +69,120 @@ REG thread_ctx_ptr;
 /* syscall descriptors */
 extern syscall_desc_t syscall_desc[SYSCALL_MAX];
 
+/* syscall action programs */
+extern syscall_prog_t syscall_prog[SYSCALL_MAX];
+
 /* ins descriptors */
 ins_desc_t ins_desc[XED_ICLASS_LAST];
 
 /* null_seg */
 extern void *null_seg;
 
+/* zero_seg; the read-only (untainted) shadow page */
+extern void *zero_seg;
+
+/* STAB; the shadow offsets of the pages */
+extern uint32_t *STAB;
+
+#ifdef	SYSCALL_STATS
+/*
+ * per-syscall cost counters; they are updated without
+ * locking, hence they are approximate on multithreaded
+ * applications
+ */
+static struct {
+	UINT64	calls;		/* invocations */
+	UINT64	cycles;		/* cycles in sysenter/sysexit_save() */
+	UINT64	clr;		/* cleared output bytes */
+	UINT64	skip;		/* skipped outputs (read-only shadow) */
+} syscall_stats[SYSCALL_MAX];
+#endif
+
+/* thread contexts of the running threads */
+static set<thread_ctx_t *> thread_ctx_set;
+static PIN_LOCK		thread_ctx_lock;
+
+/*
+ * vDSO routines; they are hooked and given the default
+ * post-syscall handling of the syscall that they stand for
+ */
+static vdso_desc_t vdso_desc[] = {
+	{ "gettimeofday",	__NR_gettimeofday },
+	{ "clock_gettime",	__NR_clock_gettime },
+#ifdef __NR_clock_gettime64
+	{ "clock_gettime64",	__NR_clock_gettime64 },
+#endif
+	{ "clock_getres",	__NR_clock_getres },
+#ifdef __NR_clock_getres_time64
+	{ "clock_getres_time64",__NR_clock_getres_time64 },
+#endif
+	{ "time",		__NR_time },
+#ifdef __NR_getcpu
+	{ "getcpu",		__NR_getcpu },
+#endif
+	{ NULL,			-1 }
+};
+
+/* the address ranges of the hooked vDSO routines */
+static map<ADDRINT, ADDRINT> vdso_rng;
+
+/*
+ * DFT state (i.e., enabled or disabled); requests for changing the state
+ * (or for clearing the tags) are made via libdft_ctl(), and they are
+ * applied by an internal thread while the application threads are
+ * stopped (see libdft_ctl_sync())
+ */
+static volatile size_t	dft_state	= DFT_ENABLE;	/* current state */
+static volatile size_t	ctl_state	= DFT_ENABLE;	/* requested state */
+static volatile size_t	ctl_clear	= 0;		/* clear the tags */
+static volatile size_t	ctl_busy	= 0;		/* requests are applied */
+
+/*
+ * sampling
+ *
+ * when sampling is enabled, taint-sources are tagged only for a fraction
+ * (sample_rate / SAMPLE_SCALE) of the connections (or reads), and the
+ * traces are instrumented for tag propagation only while sampled taint
+ * is live; otherwise, execution continues in an uninstrumented version
+ * of the code (VERSION_BASE). The taint outlives its sources (e.g., a
+ * request that is buffered after its connection is closed); hence, it
+ * stays live until an internal thread finds no tags left (see
+ * sample_thread()). sample_lock guards the sampling state
+ */
+static size_t		sample_rate	= SAMPLE_SCALE;	/* sampling rate */
+static size_t		sample_gran	= SAMPLE_CONN;	/* granularity */
+static REG		sample_reg	= REG_INVALID();/* version register */
+static set<int>		sample_fdset;			/* sampled fds */
+static PIN_LOCK		sample_lock;
+
+/*
+ * sampled sources are live; number of sampled descriptors
+ * (SAMPLE_CONN), or remaining syscalls (SAMPLE_READ)
+ */
+static size_t		sample_live	= 0;
+
+/* sampled taint is live (i.e., tags may exist) */
+static volatile size_t	sample_taint	= 0;
+
+/* sampling statistics */
+static size_t		sample_conn	= 0;	/* connections */
+static size_t		sample_conn_s	= 0;	/* sampled connections */
+static size_t		sample_srcs	= 0;	/* sources */
+static size_t		sample_srcs_s	= 0;	/* sampled sources */
+static UINT64		sample_bytes	= 0;	/* source bytes */
+static UINT64		sample_bytes_s	= 0;	/* sampled source bytes */
+static size_t		sample_periods	= 0;	/* live periods */
+static size_t		sample_drains	= 0;	/* periods w/o sources */
+
+/*
+ * shadow scavenger; a Pin internal thread that periodically stops the
+ * application threads and releases the shadow pages whose tags are all
+ * clear (see libdft_scavenge())
+ */
+static size_t		scav_period	= 0;	/* period (seconds) */
+static size_t		scav_passes	= 0;	/* passes */
+static size_t		scav_skipped	= 0;	/* passes w/o stopped threads */
+
 /*
  * thread start callback (analysis function)
  *
@@ -96,6 +214,17 @@ thread_alloc(THREADID tid, CONTEXT *ctx, INT32 flags, VOID *v)
 
 	/* save the address of the per-thread context to the spilled register */
 	PIN_SetContextReg(ctx, thread_ctx_ptr, (ADDRINT)tctx);
+
+	/* keep track of the thread context */
+	PIN_GetLock(&thread_ctx_lock, tid + 1);
+	thread_ctx_set.insert(tctx);
+	PIN_ReleaseLock(&thread_ctx_lock);
+
+	/* decoupled propagation; allocate the ring */
+	replay_thread_alloc(tctx);
+
+	/* the first thread after an exec; apply the handoff */
+	exectag_load(ctx);
 }
 
 /*
@@ -115,10 +244,453 @@ thread_free(THREADID tid, const CONTEXT *ctx, INT32 code, VOID *v)
 	thread_ctx_t *tctx = (thread_ctx_t *)
 		PIN_GetContextReg(ctx, thread_ctx_ptr);
 
+	/* forget the thread context */
+	PIN_GetLock(&thread_ctx_lock, tid + 1);
+	thread_ctx_set.erase(tctx);
+	PIN_ReleaseLock(&thread_ctx_lock);
+
+	/* decoupled propagation; replay the pending records */
+	replay_thread_free(tctx);
+
 	/* free the allocated space */
 	free(tctx);
 }
 
+/*
+ * fork callback (child process)
+ *
+ * the child inherits the tagmap (i.e., STAB and the segments) copy-on-
+ * write, and only the forking thread; the contexts of the other threads
+ * are stale and they are dropped (their rings are dropped by the replay
+ * logic, after being drained before the fork)
+ *
+ * @tid:	thread id
+ * @ctx:	CPU context
+ * @v:		callback value
+ */
+static void
+thread_fork(THREADID tid, const CONTEXT *ctx, VOID *v)
+{
+	/* iterator */
+	set<thread_ctx_t *>::iterator it;
+	/* the context of the forking thread */
+	thread_ctx_t *tctx = (thread_ctx_t *)
+		PIN_GetContextReg(ctx, thread_ctx_ptr);
+
+	/*
+	 * the lock may have been held by another thread at the time of
+	 * the fork; it is re-initialized, since that thread is gone
+	 */
+	PIN_InitLock(&thread_ctx_lock);
+	PIN_InitLock(&sample_lock);
+
+	/* drop the contexts of the other threads */
+	for (it = thread_ctx_set.begin(); it != thread_ctx_set.end();)
+		if (*it != tctx) {
+			free(*it);
+			thread_ctx_set.erase(it++);
+		}
+		else
+			it++;
+}
+
+/*
+ * clear all the tags; i.e., the tagmap
+ * and the VCPUs of all the threads
+ */
+static void
+tags_clrall(void)
+{
+	/* iterator */
+	set<thread_ctx_t *>::iterator it;
+
+	/* decoupled propagation; replay the pending records first */
+	replay_sync_all();
+
+	/* clear the tagmap */
+	tagmap_clrall();
+
+	/* clear the VCPUs */
+	PIN_GetLock(&thread_ctx_lock, PIN_ThreadId() + 1);
+	for (it = thread_ctx_set.begin(); it != thread_ctx_set.end(); it++)
+		(void)memset(&(*it)->vcpu, 0, sizeof(vcpu_ctx_t));
+	PIN_ReleaseLock(&thread_ctx_lock);
+}
+
+/*
+ * check whether any tag is set; i.e., in the
+ * tagmap or the VCPUs of all the threads
+ *
+ * the application threads must be stopped
+ *
+ * returns:	0 if clean, non-zero otherwise
+ */
+static size_t
+tags_issetall(void)
+{
+	/* iterator */
+	set<thread_ctx_t *>::iterator it;
+	/* clear VCPU */
+	static const vcpu_ctx_t zero = { { 0 } };
+	/* tainted (flag) */
+	size_t isset = 0;
+
+	/* decoupled propagation; replay the pending records first */
+	replay_sync_all();
+
+	/* check the VCPUs; the scratch register is dead between instructions */
+	PIN_GetLock(&thread_ctx_lock, PIN_ThreadId() + 1);
+	for (it = thread_ctx_set.begin();
+		isset == 0 && it != thread_ctx_set.end(); it++)
+		isset = (memcmp((*it)->vcpu.gpr, zero.gpr,
+				GRP_NUM * sizeof(zero.gpr[0])) != 0);
+	PIN_ReleaseLock(&thread_ctx_lock);
+
+	/* check the tagmap */
+	return isset || tagmap_issetall();
+}
+
+/*
+ * apply a pending control request
+ *
+ * invoked while the application threads are stopped, where it is safe
+ * to clear the tags and flush the code cache; the traces are
+ * re-instrumented according to the new state of DFT (see
+ * trace_inspect()). While DFT is disabled, the taint-sources and the
+ * syscall hooks keep updating the tagmap, but the tags are not
+ * propagated; hence, all the tags are cleared when it is re-enabled
+ */
+static void
+ctl_apply(void)
+{
+	/* clear all the tags; also when DFT is re-enabled */
+	if (ctl_clear != 0 ||
+		(ctl_state == DFT_ENABLE && dft_state == DFT_DISABLE)) {
+		tags_clrall();
+		ctl_clear = 0;
+	}
+
+	/* the state is not changed */
+	if (ctl_state == dft_state)
+		return;
+
+	/* update the state */
+	dft_state = ctl_state;
+
+	/* flush the code cache; optimized branch */
+	if (unlikely(!CODECACHE_FlushCache()))
+		/* error message */
+		LOG(string(__func__) + ": code cache flush failed\n");
+#ifdef DEBUG_MEMTRACK
+	/* verbose */
+	LOG(string(__func__) + ": DFT is " +
+		((dft_state == DFT_ENABLE) ? "enabled\n" : "disabled\n"));
+#endif
+}
+
+/*
+ * apply the pending control requests with the application threads stopped
+ *
+ * the application threads can only be stopped by an internal thread;
+ * the requests stay pending if it is invoked by an application thread,
+ * if the threads cannot be stopped, or if another thread applies them,
+ * and the control channel (see ctl_thread()) retries them periodically
+ */
+void
+libdft_ctl_sync(void)
+{
+	/* the id of the caller */
+	THREADID tid = PIN_ThreadId();
+
+	/* no pending requests, or an application thread */
+	if (likely(ctl_state == dft_state && ctl_clear == 0) ||
+			PIN_IsApplicationThread())
+		return;
+
+	/* another thread is applying the requests; optimized branch */
+	if (unlikely(!__sync_bool_compare_and_swap(&ctl_busy, 0, 1)))
+		return;
+
+	/* stop the application threads (see scav_thread()) */
+	if (likely(PIN_StopApplicationThreads(tid))) {
+		/* apply the requests */
+		ctl_apply();
+
+		/* resume the application threads */
+		PIN_ResumeApplicationThreads(tid);
+	}
+
+	/* done */
+	ctl_busy = 0;
+}
+
+/*
+ * shadow scavenger (internal thread)
+ *
+ * every scav_period seconds, the application threads are stopped at a
+ * safe point (i.e., not inside analysis code or callbacks) and the
+ * pending records of the decoupled propagation are replayed, so that
+ * no tags are written while tagmap_scavenge() runs
+ *
+ * @v:		thread argument (unused)
+ */
+static VOID
+scav_thread(VOID *v)
+{
+	/* the id of the scavenger */
+	THREADID tid = PIN_ThreadId();
+	/* elapsed time (ms) */
+	size_t elapsed = 0;
+
+	/* scavenge every period */
+	while (!PIN_IsProcessExiting()) {
+		PIN_Sleep(SCAVENGE_MS);
+		if ((elapsed += SCAVENGE_MS) < scav_period * 1000)
+			continue;
+		elapsed = 0;
+
+		/* stop the application threads; optimized branch */
+		if (unlikely(!PIN_StopApplicationThreads(tid))) {
+			/* e.g., the process is exiting; retry later */
+			scav_skipped++;
+			continue;
+		}
+
+		/* decoupled propagation; replay the pending records */
+		replay_sync_all();
+
+		/* release the clear shadow pages */
+		(void)tagmap_scavenge();
+		scav_passes++;
+
+		/* resume the application threads */
+		PIN_ResumeApplicationThreads(tid);
+	}
+}
+
+/*
+ * fini callback
+ *
+ * report the scavenger statistics
+ *
+ * @code:	exit code
+ * @v:		callback value
+ */
+static void
+scav_fini(INT32 code, VOID *v)
+{
+	/* usage (counters only) */
+	tagmap_usage_t usage;
+
+	/* get the reclaimed bytes */
+	tagmap_usage(&usage, 0);
+
+	LOG(string(__func__) + ": passes=" + decstr(scav_passes) +
+		" skipped=" + decstr(scav_skipped) +
+		" reclaimed=" + decstr(usage.reclaimed >> 10) + " KB\n");
+}
+
+/*
+ * check if sampled taint is live (analysis function)
+ *
+ * used for selecting the version of the code
+ * (i.e., VERSION_DFT or VERSION_BASE)
+ *
+ * returns:	1 if sampled taint is live, 0 otherwise
+ */
+static ADDRINT PIN_FAST_ANALYSIS_CALL
+sample_is_live(void)
+{
+	return (sample_taint != 0);
+}
+
+/*
+ * sampled taint drainer (internal thread)
+ *
+ * once the sampled sources are no longer live, the tags that they
+ * produced are still propagated until none is left; every
+ * SAMPLE_DRAIN_MS, the application threads are stopped (see
+ * scav_thread()) and the tags are checked, and if they are all clear,
+ * execution switches back to the uninstrumented version of the code
+ *
+ * @v:		thread argument (unused)
+ */
+static VOID
+sample_thread(VOID *v)
+{
+	/* the id of the drainer */
+	THREADID tid = PIN_ThreadId();
+
+	/* check every interval */
+	while (!PIN_IsProcessExiting()) {
+		PIN_Sleep(SAMPLE_DRAIN_MS);
+
+		/* live sources, or no sampled taint; nothing to do */
+		if (sample_live != 0 || sample_taint == 0)
+			continue;
+
+		/* stop the application threads; retry later on failure */
+		if (unlikely(!PIN_StopApplicationThreads(tid)))
+			continue;
+
+		/* no tags left, and no new sources; sampled taint is dead */
+		PIN_GetLock(&sample_lock, tid + 1);
+		if (sample_live == 0 && !tags_issetall()) {
+			sample_taint = 0;
+			sample_drains++;
+		}
+		PIN_ReleaseLock(&sample_lock);
+
+		/* resume the application threads */
+		PIN_ResumeApplicationThreads(tid);
+	}
+}
+
+/*
+ * sampled sources become live
+ *
+ * it must be called with sample_lock held
+ */
+static inline void
+sample_source(void)
+{
+	/* new live period */
+	if (sample_taint == 0)
+		sample_periods++;
+
+	/* sampled taint is live */
+	sample_taint = 1;
+}
+
+/*
+ * sampling statistics (fini callback)
+ *
+ * report the effective coverage of the sampling
+ *
+ * @code:	OS specific termination code
+ * @v:		callback value
+ */
+static void
+sample_fini(INT32 code, VOID *v)
+{
+	/* coverage (formatted) */
+	char cov[sizeof("100.00%")];
+
+	/* effective coverage; sampled source bytes */
+	(void)snprintf(cov, sizeof(cov), "%.2f%%", (sample_bytes == 0) ? 0.0 :
+			(100.0 * sample_bytes_s) / sample_bytes);
+
+	/* report */
+	LOG(string(__func__) + ": rate=" + decstr(sample_rate) + "/" +
+		decstr(SAMPLE_SCALE) +
+		" connections=" + decstr(sample_conn_s) + "/" +
+		decstr(sample_conn) +
+		" sources=" + decstr(sample_srcs_s) + "/" +
+		decstr(sample_srcs) +
+		" bytes=" + decstr(sample_bytes_s) + "/" +
+		decstr(sample_bytes) +
+		" periods=" + decstr(sample_periods) +
+		" drained=" + decstr(sample_drains) +
+		" coverage=" + string(cov) + "\n");
+}
+
+/*
+ * clear the tags of a syscall output
+ *
+ * outputs that fit in a page are cleared directly on their shadow, with
+ * a single store for the sizes that syscall_compile() specialized; the
+ * ones that land on zero_seg (i.e., untainted, read-only shadow) are
+ * skipped. The rest are left to tagmap_clrn()
+ *
+ * @addr:	the address of the output
+ * @len:	the size of the output
+ * @op:		the clear operation (SYSCALL_CLR_*)
+ *
+ * returns:	0 if the output was cleared, 1 if it was skipped
+ */
+static inline size_t
+sysexit_clr(size_t addr, size_t len, uint8_t op)
+{
+	/* the shadow of the output */
+	size_t taddr;
+
+	/* the output crosses a page; optimized branch */
+	if (unlikely(PAGE_OFFSET(addr) + len > PAGE_SZ)) {
+		tagmap_clrn(addr, len);
+		return 0;
+	}
+
+	/* get the shadow */
+	taddr = addr + STAB[VIRT2STAB(addr)];
+
+	/* read-only shadow; nothing to do */
+	if (PAGE_ALIGN(taddr) == (size_t)zero_seg)
+		return 1;
+
+	/* clear the output */
+	switch (op) {
+		/* e.g., socklen_t, int */
+		case SYSCALL_CLR_4:
+			*(uint32_t *)taddr = TAG_ZERO;
+			break;
+		/* e.g., struct timespec, struct timeval */
+		case SYSCALL_CLR_8:
+			*(uint64_t *)taddr = TAG_ZERO;
+			break;
+		/* e.g., struct __kernel_timespec */
+		case SYSCALL_CLR_16:
+			*(uint64_t *)taddr = TAG_ZERO;
+			*(uint64_t *)(taddr + sizeof(uint64_t)) = TAG_ZERO;
+			break;
+		/* e.g., struct stat64 */
+		case SYSCALL_CLR_N:
+		default:
+			(void)memset((void *)taddr, TAG_ZERO, len);
+			break;
+	}
+
+	/* cleared */
+	return 0;
+}
+
+/*
+ * clear the outputs of a syscall
+ *
+ * default post-syscall handling; it is invoked
+ * only after a successful call
+ *
+ * @syscall_ctx:	the syscall context
+ * @prog:		the action program of the syscall
+ */
+static inline void
+sysexit_clrall(syscall_ctx_t *syscall_ctx, syscall_prog_t *prog)
+{
+	/* iterator */
+	size_t i;
+	/* changed argument */
+	ADDRINT addr;
+
+	/* traverse the changed arguments */
+	for (i = 0; i < prog->nclr; i++) {
+		/* the changed argument */
+		addr = syscall_ctx->arg[prog->clr_arg[i]];
+
+		/* sanity check -- probably non needed */
+		if (unlikely((void *)addr == NULL))
+			continue;
+
+		/* clear the output */
+#ifdef	SYSCALL_STATS
+		if (sysexit_clr(addr, prog->clr_len[i], prog->clr_op[i]))
+			syscall_stats[syscall_ctx->nr].skip++;
+		else
+			syscall_stats[syscall_ctx->nr].clr += prog->clr_len[i];
+#else
+		(void)sysexit_clr(addr, prog->clr_len[i], prog->clr_op[i]);
+#endif
+	}
+}
+
 /* 
  * syscall enter notification (analysis function)
  *
@@ -133,6 +705,13 @@ thread_free(THREADID tid, const CONTEXT *ctx, INT32 code, VOID *v)
 static void
 sysenter_save(THREADID tid, CONTEXT *ctx, SYSCALL_STANDARD std, VOID *v)
 {
+	/* iterator */
+	size_t i;
+	/* arguments to save (bitmap) */
+	size_t fetch;
+	/* the action program of the syscall */
+	syscall_prog_t *prog;
+
 	/* get the thread context */
 	thread_ctx_t *thread_ctx = (thread_ctx_t *)
 		PIN_GetContextReg(ctx, thread_ctx_ptr);
@@ -152,72 +731,43 @@ sysenter_save(THREADID tid, CONTEXT *ctx, SYSCALL_STANDARD std, VOID *v)
 
 	/* pass the system call number to sysexit_save() */
 	thread_ctx->syscall_ctx.nr = syscall_nr;
+	prog = &syscall_prog[syscall_nr];
+
+	/* decoupled propagation; replay the pending records */
+	if (replay_on != 0)
+		replay_sysenter(thread_ctx, syscall_nr);
 
 	/*
-	 * check if we need to save the arguments for that syscall
-	 *
-	 * we save only when we have a callback registered or the syscall
-	 * returns a value in the arguments
+	 * the window of a sampled read shrinks; the taint that it
+	 * produced is left to sample_thread(); optimized branch
 	 */
-	if (syscall_desc[syscall_nr].save_args |
-		syscall_desc[syscall_nr].retval_args) {
-		/*
-		 * dump only the appropriate number of arguments
-		 * or yet another lame way to avoid a loop (vpk)
-		 */
-		switch (syscall_desc[syscall_nr].nargs) {
-			/* 6 */
-			case SYSCALL_ARG5 + 1:
-				thread_ctx->syscall_ctx.arg[SYSCALL_ARG5] =
-					PIN_GetSyscallArgument(ctx,
-								std,
-								SYSCALL_ARG5);
-			/* 5 */
-			case SYSCALL_ARG4 + 1:
-				thread_ctx->syscall_ctx.arg[SYSCALL_ARG4] =
-					PIN_GetSyscallArgument(ctx,
-								std,
-								SYSCALL_ARG4);
-			/* 4 */
-			case SYSCALL_ARG3 + 1:
-				thread_ctx->syscall_ctx.arg[SYSCALL_ARG3] =
-					PIN_GetSyscallArgument(ctx,
-								std,
-								SYSCALL_ARG3);
-			/* 3 */
-			case SYSCALL_ARG2 + 1:
-				thread_ctx->syscall_ctx.arg[SYSCALL_ARG2] =
-					PIN_GetSyscallArgument(ctx,
-								std,
-								SYSCALL_ARG2);
-			/* 2 */
-			case SYSCALL_ARG1 + 1:
-				thread_ctx->syscall_ctx.arg[SYSCALL_ARG1] =
-					PIN_GetSyscallArgument(ctx,
-								std,
-								SYSCALL_ARG1);
-			/* 1 */
-			case SYSCALL_ARG0 + 1:
-				thread_ctx->syscall_ctx.arg[SYSCALL_ARG0] =
-					PIN_GetSyscallArgument(ctx,
-								std,
-								SYSCALL_ARG0);
-			/* default */
-			default:
-				/* nothing to do */
-				break;
-		}
+	if (unlikely(sample_gran == SAMPLE_READ && sample_live != 0)) {
+		PIN_GetLock(&sample_lock, tid + 1);
+		if (sample_live != 0)
+			sample_live--;
+		PIN_ReleaseLock(&sample_lock);
+	}
 
-		/* 
-		 * dump the architectural state of the processor;
-		 * saved as "auxiliary" data
-		 */
-		thread_ctx->syscall_ctx.aux = ctx;
+	/* the syscall has no effects; fast path */
+	if (likely(prog->flags == 0))
+		return;
 
-		/* call the pre-syscall callback (if any) */
-		if (syscall_desc[syscall_nr].pre != NULL)
-			syscall_desc[syscall_nr].pre(&thread_ctx->syscall_ctx);
-	}
+	/* save only the arguments that are used */
+	for (i = SYSCALL_ARG0, fetch = prog->fetch; fetch != 0;
+			i++, fetch >>= 1)
+		if (fetch & 1)
+			thread_ctx->syscall_ctx.arg[i] =
+				PIN_GetSyscallArgument(ctx, std, i);
+
+	/* 
+	 * dump the architectural state of the processor;
+	 * saved as "auxiliary" data
+	 */
+	thread_ctx->syscall_ctx.aux = ctx;
+
+	/* call the pre-syscall callback (if any) */
+	if (prog->flags & SYSCALL_PROG_PRE)
+		syscall_desc[syscall_nr].pre(&thread_ctx->syscall_ctx);
 }
 
 /* 
@@ -237,8 +787,8 @@ sysenter_save(THREADID tid, CONTEXT *ctx, SYSCALL_STANDARD std, VOID *v)
 static void
 sysexit_save(THREADID tid, CONTEXT *ctx, SYSCALL_STANDARD std, VOID *v)
 {
-	/* iterator */
-	size_t i;
+	/* the action program of the syscall */
+	syscall_prog_t *prog;
 
 	/* get the thread context */
 	thread_ctx_t *thread_ctx = (thread_ctx_t *)
@@ -255,56 +805,314 @@ sysexit_save(THREADID tid, CONTEXT *ctx, SYSCALL_STANDARD std, VOID *v)
 		return;
 	}
 	
-	/*
-	 * check if we need to save the arguments for that syscall
-	 *
-	 * we save only when we have a callback registered or the syscall
-	 * returns a value in the arguments
+	/* the action program of the syscall */
+	prog = &syscall_prog[syscall_nr];
+
+	/* the syscall has no effects; fast path */
+	if (likely(prog->flags == 0))
+		return;
+
+	/* dump the return value */
+	thread_ctx->syscall_ctx.ret = PIN_GetSyscallReturn(ctx, std);
+
+	/* 
+	 * dump the architectural state of the processor;
+	 * saved as "auxiliary" data
 	 */
-	if (syscall_desc[syscall_nr].save_args |
-			syscall_desc[syscall_nr].retval_args) {
-		/* dump only the appropriate number of arguments */
-		thread_ctx->syscall_ctx.ret = PIN_GetSyscallReturn(ctx, std);
-
-		/* 
-		 * dump the architectural state of the processor;
-		 * saved as "auxiliary" data
-		 */
-		thread_ctx->syscall_ctx.aux = ctx;
+	thread_ctx->syscall_ctx.aux = ctx;
 
-		/* thread_ctx->syscall_ctx.errno =
-			PIN_GetSyscallErrno(ctx, std); */
-	
-		/* call the post-syscall callback (if any) */
-		if (syscall_desc[syscall_nr].post != NULL)
-			syscall_desc[syscall_nr].post(&thread_ctx->syscall_ctx);
-		else {
-			/* default post-syscall handling */
+	/* thread_ctx->syscall_ctx.errno =
+		PIN_GetSyscallErrno(ctx, std); */
 
-			/* 
-			 * the syscall failed; typically 0 and positive
-			 * return values indicate success
-			 */
-			if (thread_ctx->syscall_ctx.ret < 0)
-				/* no need to do anything */
-				return;
-
-			/* traverse the arguments map */
-			for (i = 0; i < syscall_desc[syscall_nr].nargs; i++)
-				/* analyze each argument; optimized branch */
-			if (unlikely(syscall_desc[syscall_nr].map_args[i] > 0)) 
-				/* sanity check -- probably non needed */
-				if (likely(
-				(void *)thread_ctx->syscall_ctx.arg[i] != NULL))
-				/* 
-				 * argument i is changed by the system call;
-				 * the length of the change is given by
-				 * map_args[i]
-				 */
-				tagmap_clrn(thread_ctx->syscall_ctx.arg[i],
-					syscall_desc[syscall_nr].map_args[i]);
-		}
+	/* call the post-syscall callback (if any) */
+	if (prog->flags & SYSCALL_PROG_POST) {
+		syscall_desc[syscall_nr].post(&thread_ctx->syscall_ctx);
+		return;
 	}
+
+	/* 
+	 * default post-syscall handling; the syscall failed
+	 * (typically 0 and positive return values indicate
+	 * success)
+	 */
+	if ((long)thread_ctx->syscall_ctx.ret < 0)
+		/* no need to do anything */
+		return;
+
+	/* 
+	 * the arguments are changed by the system call;
+	 * the length of the change is given by clr_len
+	 */
+	sysexit_clrall(&thread_ctx->syscall_ctx, prog);
+}
+
+#ifdef	SYSCALL_STATS
+/*
+ * read the time-stamp counter
+ *
+ * returns:	the number of cycles since reset
+ */
+static inline UINT64
+rdtsc(void)
+{
+	/* EDX:EAX */
+	UINT64 tsc;
+
+	__asm__ __volatile__ ("rdtsc" : "=A" (tsc));
+
+	return tsc;
+}
+
+/*
+ * syscall enter notification (analysis function); cost counters
+ *
+ * wrapper of sysenter_save() that accounts the
+ * invocation and the cycles spent in it
+ *
+ * @tid:	thread id
+ * @ctx:	CPU context
+ * @std:	syscall standard (e.g., Linux IA-32, IA-64, etc)
+ * @v:		callback value
+ */
+static void
+sysenter_stats(THREADID tid, CONTEXT *ctx, SYSCALL_STANDARD std, VOID *v)
+{
+	/* start */
+	UINT64 tsc = rdtsc();
+
+	/* get the thread context */
+	thread_ctx_t *thread_ctx = (thread_ctx_t *)
+		PIN_GetContextReg(ctx, thread_ctx_ptr);
+
+	/* invoke the handler */
+	sysenter_save(tid, ctx, std, v);
+
+	/* known syscall; account it */
+	if (likely(thread_ctx->syscall_ctx.nr >= 0)) {
+		syscall_stats[thread_ctx->syscall_ctx.nr].calls++;
+		syscall_stats[thread_ctx->syscall_ctx.nr].cycles +=
+			rdtsc() - tsc;
+	}
+}
+
+/*
+ * syscall exit notification (analysis function); cost counters
+ *
+ * wrapper of sysexit_save() that accounts the cycles spent in it
+ *
+ * @tid:	thread id
+ * @ctx:	CPU context
+ * @std:	syscall standard (e.g., Linux IA-32, IA-64, etc)
+ * @v:		callback value
+ */
+static void
+sysexit_stats(THREADID tid, CONTEXT *ctx, SYSCALL_STANDARD std, VOID *v)
+{
+	/* start */
+	UINT64 tsc = rdtsc();
+
+	/* get the thread context */
+	thread_ctx_t *thread_ctx = (thread_ctx_t *)
+		PIN_GetContextReg(ctx, thread_ctx_ptr);
+
+	/* get the syscall number; the handler may not preserve it */
+	int syscall_nr = thread_ctx->syscall_ctx.nr;
+
+	/* invoke the handler */
+	sysexit_save(tid, ctx, std, v);
+
+	/* known syscall; account it */
+	if (likely(syscall_nr >= 0))
+		syscall_stats[syscall_nr].cycles += rdtsc() - tsc;
+}
+
+/*
+ * syscall cost counters (fini callback)
+ *
+ * report the counters of every syscall that was invoked
+ *
+ * @code:	OS specific termination code
+ * @v:		callback value
+ */
+static void
+syscall_stats_fini(INT32 code, VOID *v)
+{
+	/* iterator */
+	size_t i;
+
+	/* report */
+	for (i = 0; i < SYSCALL_MAX; i++)
+		if (syscall_stats[i].calls > 0)
+			LOG(string(__func__) + ": nr=" + decstr(i) +
+				" calls=" + decstr(syscall_stats[i].calls) +
+				" cycles=" + decstr(syscall_stats[i].cycles) +
+				" avg=" + decstr(syscall_stats[i].cycles /
+					syscall_stats[i].calls) +
+				" cleared=" + decstr(syscall_stats[i].clr) +
+				" skipped=" + decstr(syscall_stats[i].skip) +
+				"\n");
+}
+#endif
+
+/*
+ * vDSO routine entry (analysis function)
+ *
+ * save the arguments of the call; the vDSO
+ * routines take up to three arguments
+ *
+ * @thread_ctx:	the thread context
+ * @nr:		the syscall that the routine stands for
+ * @arg0:	1st argument
+ * @arg1:	2nd argument
+ * @arg2:	3rd argument
+ */
+static void PIN_FAST_ANALYSIS_CALL
+vdso_enter(thread_ctx_t *thread_ctx, ADDRINT nr,
+		ADDRINT arg0, ADDRINT arg1, ADDRINT arg2)
+{
+	/* save the call context */
+	thread_ctx->vdso_ctx.nr				= nr;
+	thread_ctx->vdso_ctx.arg[SYSCALL_ARG0]		= arg0;
+	thread_ctx->vdso_ctx.arg[SYSCALL_ARG1]		= arg1;
+	thread_ctx->vdso_ctx.arg[SYSCALL_ARG2]		= arg2;
+}
+
+/*
+ * vDSO routine exit (analysis function)
+ *
+ * apply the default post-syscall handling of the syscall that the
+ * routine stands for (i.e., clear its outputs after a successful call);
+ * the instructions of the routine are not instrumented, hence the tags
+ * of EAX (return value), ECX, and EDX (caller-saved) are cleared
+ *
+ * @thread_ctx:	the thread context
+ * @ret:	the return value
+ */
+static void PIN_FAST_ANALYSIS_CALL
+vdso_exit(thread_ctx_t *thread_ctx, ADDRINT ret)
+{
+	/* the return value and the caller-saved registers */
+	thread_ctx->vcpu.gpr[7] = TAG_ZERO;
+	thread_ctx->vcpu.gpr[6] = TAG_ZERO;
+	thread_ctx->vcpu.gpr[5] = TAG_ZERO;
+
+	/* save the return value */
+	thread_ctx->vdso_ctx.ret = ret;
+
+	/* the call failed; nothing is written */
+	if (unlikely((long)ret < 0))
+		return;
+
+	/* clear the outputs */
+	sysexit_clrall(&thread_ctx->vdso_ctx,
+			&syscall_prog[thread_ctx->vdso_ctx.nr]);
+}
+
+/*
+ * ELF image loading callback
+ *
+ * hook the time (and getcpu) routines of the vDSO, since the calls
+ * that are served by them never reach sysenter_save/sysexit_save();
+ * the routines run natively, and only the effect of the corresponding
+ * syscall (see syscall_prog) is applied once they return
+ *
+ * @img:	image handle
+ * @v:		callback value
+ */
+static void
+vdso_load(IMG img, VOID *v)
+{
+	/* iterators */
+	RTN rtn;
+	vdso_desc_t *desc;
+
+	/* not the vDSO; optimized branch */
+	if (likely(!IMG_IsVDSO(img)))
+		return;
+
+	/* traverse the hooked routines */
+	for (desc = vdso_desc; desc->name != NULL; desc++) {
+		/* look for the routine (or its alias) */
+		rtn = RTN_FindByName(img,
+				(string(VDSO_PREFIX) + desc->name).c_str());
+		if (!RTN_Valid(rtn))
+			rtn = RTN_FindByName(img, desc->name);
+
+		/* not exported by this kernel */
+		if (!RTN_Valid(rtn))
+			continue;
+
+		/* aliases are the same routine; hooked already */
+		if (vdso_rng.find(RTN_Address(rtn)) != vdso_rng.end())
+			continue;
+
+		/* hook the entry and exit points */
+		RTN_Open(rtn);
+		RTN_InsertCall(rtn,
+			IPOINT_BEFORE,
+			(AFUNPTR)vdso_enter,
+			IARG_FAST_ANALYSIS_CALL,
+			IARG_REG_VALUE, thread_ctx_ptr,
+			IARG_ADDRINT, (ADDRINT)desc->nr,
+			IARG_FUNCARG_ENTRYPOINT_VALUE, 0,
+			IARG_FUNCARG_ENTRYPOINT_VALUE, 1,
+			IARG_FUNCARG_ENTRYPOINT_VALUE, 2,
+			IARG_END);
+
+		/*
+		 * decoupled propagation; the tags are updated
+		 * directly, hence the records of the thread
+		 * must be replayed first
+		 */
+		if (replay_on != 0)
+			RTN_InsertCall(rtn,
+				IPOINT_AFTER,
+				(AFUNPTR)replay_sync,
+				IARG_FAST_ANALYSIS_CALL,
+				IARG_REG_VALUE, thread_ctx_ptr,
+				IARG_END);
+		RTN_InsertCall(rtn,
+			IPOINT_AFTER,
+			(AFUNPTR)vdso_exit,
+			IARG_FAST_ANALYSIS_CALL,
+			IARG_REG_VALUE, thread_ctx_ptr,
+			IARG_FUNCRET_EXITPOINT_VALUE,
+			IARG_END);
+		RTN_Close(rtn);
+
+		/* record the address range */
+		vdso_rng[RTN_Address(rtn)] = RTN_Address(rtn) + RTN_Size(rtn);
+#ifdef DEBUG_MEMTRACK
+		/* verbose */
+		LOG(string(__func__) + ": " + RTN_Name(rtn) + " " +
+			hexstr(RTN_Address(rtn)) + "-" +
+			hexstr(RTN_Address(rtn) + RTN_Size(rtn)) + "\n");
+#endif
+	}
+}
+
+/*
+ * check if an address belongs to a hooked vDSO routine
+ *
+ * @addr:	the instruction address
+ *
+ * returns:	1 if the address is covered by a hook, 0 otherwise
+ */
+static inline size_t
+vdso_covers(ADDRINT addr)
+{
+	/* iterator */
+	map<ADDRINT, ADDRINT>::iterator it;
+
+	/* find the first range that starts after addr */
+	it = vdso_rng.upper_bound(addr);
+
+	/* no range starts before addr */
+	if (it == vdso_rng.begin())
+		return 0;
+
+	/* check the closest range that starts before addr */
+	return (addr < (--it)->second) ? 1 : 0;
 }
 
 /*
@@ -324,9 +1132,69 @@ trace_inspect(TRACE trace, VOID *v)
 	BBL bbl;
 	INS ins;
 	xed_iclass_enum_t ins_indx;
+	/* summarized routine (flag) */
+	size_t summarized;
+	/* the version is selected at the head of the BBL (flag) */
+	size_t versioned;
+
+	/* DFT is disabled; no instrumentation */
+	if (unlikely(dft_state == DFT_DISABLE))
+		return;
+
+	/* instrumentation statistics */
+	if (unlikely(stats_on != 0))
+		stats_trace(trace);
+
+	/*
+	 * traverse all the BBLs in the trace; when sampling is enabled,
+	 * the version is selected at the head of the trace, and after
+	 * every system call (i.e., a taint-source) in it; the rest of
+	 * the BBLs of the uninstrumented version are left untouched
+	 */
+	for (bbl = TRACE_BblHead(trace), versioned = 1;
+			BBL_Valid(bbl);
+			versioned = INS_IsSyscall(BBL_InsTail(bbl)),
+			bbl = BBL_Next(bbl)) {
+		/* sampling is enabled; optimized branch */
+		if (unlikely(sample_reg != REG_INVALID()) && versioned) {
+			/* check if sampled taint is live */
+			INS_InsertCall(BBL_InsHead(bbl),
+				IPOINT_BEFORE,
+				(AFUNPTR)sample_is_live,
+				IARG_FAST_ANALYSIS_CALL,
+				IARG_RETURN_REGS, sample_reg,
+				IARG_END);
+
+			/* uninstrumented version */
+			if (TRACE_Version(trace) == VERSION_BASE)
+				/* switch to tag propagation when live */
+				INS_InsertVersionCase(BBL_InsHead(bbl),
+						sample_reg, 1, VERSION_DFT,
+						IARG_END);
+			else
+				/* switch to the uninstrumented version */
+				INS_InsertVersionCase(BBL_InsHead(bbl),
+						sample_reg, 0, VERSION_BASE,
+						IARG_END);
+		}
+
+		/* uninstrumented version; nothing else to do */
+		if (unlikely(sample_reg != REG_INVALID()) &&
+				TRACE_Version(trace) == VERSION_BASE)
+			continue;
+
+		/*
+		 * the tag effects of summarized routines are applied
+		 * at their entry point, and the ones of the hooked vDSO
+		 * routines at their exit; no propagation inside them
+		 */
+		summarized = summary_covers(BBL_Address(bbl)) |
+			vdso_covers(BBL_Address(bbl));
+
+		/* decoupled propagation; check the ring space */
+		if (replay_on != 0)
+			replay_bbl(bbl);
 
-	/* traverse all the BBLs in the trace */
-	for (bbl = TRACE_BblHead(trace); BBL_Valid(bbl); bbl = BBL_Next(bbl)) {
 		/* traverse all the instructions in the BBL */
 		for (ins = BBL_InsHead(bbl);
 				INS_Valid(ins);
@@ -346,7 +1214,8 @@ trace_inspect(TRACE trace, VOID *v)
 				/* 
 				 * analyze the instruction (default handler)
 				 */
-				if (ins_desc[ins_indx].dflact == INSDFL_ENABLE)
+				if (ins_desc[ins_indx].dflact == INSDFL_ENABLE &&
+						likely(!summarized))
 					ins_inspect(ins);
 
 				/* 
@@ -384,9 +1253,13 @@ thread_ctx_init(void)
 	 * keep track of the threads and allocate/free space for the
 	 * per-thread logistics (i.e., syscall context, VCPU, etc)
 	 */
+	PIN_InitLock(&thread_ctx_lock);
 	PIN_AddThreadStartFunction(thread_alloc, NULL);
 	PIN_AddThreadFiniFunction(thread_free,	NULL);
 
+	/* the child of a fork keeps only the forking thread */
+	PIN_AddForkFunction(FPOINT_AFTER_IN_CHILD, thread_fork, NULL);
+
 	/* success */
 	return 0;
 }
@@ -472,11 +1345,37 @@ libdft_init(void)
 	 * and invoke registered callbacks (if any)
 	 */
 
+	/* initialize the syscall descriptors; optimized branch */
+	if (unlikely(syscall_desc_init()))
+		/* syscall table initialization failed */
+		return 1;
+
+	/* carry the tags of argv/envp across exec */
+	exectag_init();
+	(void)syscall_set_pre(&syscall_desc[__NR_execve], exectag_pre);
+	(void)syscall_set_post(&syscall_desc[__NR_execve], exectag_post);
+#ifdef __NR_execveat
+	(void)syscall_set_pre(&syscall_desc[__NR_execveat], exectag_pre);
+	(void)syscall_set_post(&syscall_desc[__NR_execveat], exectag_post);
+#endif
+
+	/* apply the syscall effects to the vDSO calls */
+	IMG_AddInstrumentFunction(vdso_load, NULL);
+
+#ifdef	SYSCALL_STATS
+	/* register the cost counters of sysenter/sysexit_save() */
+	PIN_AddSyscallEntryFunction(sysenter_stats, NULL);
+	PIN_AddSyscallExitFunction(sysexit_stats, NULL);
+
+	/* report the cost counters at exit */
+	PIN_AddFiniFunction(syscall_stats_fini, NULL);
+#else
 	/* register sysenter_save() to be called before every syscall */
 	PIN_AddSyscallEntryFunction(sysenter_save, NULL);
 	
 	/* register sysexit_save() to be called after every syscall */
 	PIN_AddSyscallExitFunction(sysexit_save, NULL);
+#endif
 	
 	/* initialize the ins descriptors */
 	(void)memset(ins_desc, 0, sizeof(ins_desc));
@@ -484,6 +1383,9 @@ libdft_init(void)
 	/* register trace_ins() to be called for every trace */
 	TRACE_AddInstrumentFunction(trace_inspect, NULL);
 
+	/* report the analysis calls that were elided at exit */
+	PIN_AddFiniFunction(ins_elide_fini, NULL);
+
 	/* 
 	 * register excpt_hdlr() to be called for handling internal
 	 * (i.e., libdft or tool-related) exceptions
@@ -509,6 +1411,277 @@ libdft_die(void)
        PIN_Detach();
 }
 
+/*
+ * request a change in the state of DFT
+ *
+ * if it is invoked from an internal thread (e.g., the control channel),
+ * the request is applied at once, with the application threads stopped;
+ * otherwise (e.g., from a callback), it is applied by the control channel
+ * (see libdft_ctl_sync()). While DFT is disabled, the code is not
+ * instrumented and the tags are not propagated; the tagmap is still
+ * maintained (e.g., on mmap(2)), and it is cleared when DFT is re-enabled
+ *
+ * @state:	the new state (DFT_ENABLE or DFT_DISABLE)
+ * @clear:	clear all the tags (flag)
+ *
+ * returns:	0 on success, 1 on error
+ */
+int
+libdft_ctl(size_t state, size_t clear)
+{
+	/* sanity check; optimized branch */
+	if (unlikely(state != DFT_ENABLE && state != DFT_DISABLE))
+		/* return with failure */
+		return 1;
+
+	/* post the request */
+	if (clear != 0)
+		ctl_clear = 1;
+	ctl_state = state;
+
+	/* apply it */
+	libdft_ctl_sync();
+
+	/* success */
+	return 0;
+}
+
+/*
+ * get the state of DFT
+ *
+ * returns:	DFT_ENABLE or DFT_DISABLE
+ */
+size_t
+libdft_state(void)
+{
+	return dft_state;
+}
+
+/*
+ * enable the shadow scavenger
+ *
+ * shadow pages stay resident after their tags are cleared; for
+ * long-running processes (e.g., servers that recycle their buffers)
+ * this ratchets the memory usage up. The scavenger releases the clear
+ * shadow pages every period seconds, while the application threads
+ * are stopped (see scav_thread()). It must be called after
+ * libdft_init() and before PIN_StartProgram()
+ *
+ * @period:	the period (seconds)
+ *
+ * returns:	0 on success, 1 on error
+ */
+int
+libdft_scavenge(size_t period)
+{
+	/* sanity check; optimized branch */
+	if (unlikely(period == 0))
+		/* return with failure */
+		return 1;
+
+	/* set the period before the thread gets the chance to run */
+	scav_period = period;
+
+	/* spawn the internal thread; optimized branch */
+	if (unlikely(PIN_SpawnInternalThread(scav_thread, NULL, 0, NULL) ==
+				INVALID_THREADID)) {
+		/* error message */
+		LOG(string(__func__) + ": internal thread spawn failed\n");
+
+		/* failed */
+		return 1;
+	}
+
+	/* report the statistics at exit */
+	PIN_AddFiniFunction(scav_fini, NULL);
+
+	/* success */
+	return 0;
+}
+
+/*
+ * enable sampling
+ *
+ * taint-sources are tagged only for a fraction of the connections
+ * (SAMPLE_CONN) or reads (SAMPLE_READ), and the code is instrumented
+ * for tag propagation only while sampled taint is live. It must be
+ * called after libdft_init() and before PIN_StartProgram()
+ *
+ * @rate:	sampling rate (out of SAMPLE_SCALE)
+ * @gran:	sampling granularity (SAMPLE_CONN or SAMPLE_READ)
+ *
+ * returns:	0 on success, 1 on error
+ */
+int
+sample_init(size_t rate, size_t gran)
+{
+	/* sanity checks; optimized branch */
+	if (unlikely(rate > SAMPLE_SCALE ||
+			(gran != SAMPLE_CONN && gran != SAMPLE_READ)))
+		/* return with failure */
+		return 1;
+
+	/* claim a tool register for the version selection; optimized branch */
+	if (unlikely((sample_reg = PIN_ClaimToolRegister()) == REG_INVALID())) {
+		/* error message */
+		LOG(string(__func__) + ": register claim failed\n");
+
+		/* failed */
+		return 1;
+	}
+
+	/* setup */
+	PIN_InitLock(&sample_lock);
+	sample_rate	= rate;
+	sample_gran	= gran;
+	srand(PIN_GetPid() ^ time(NULL));
+
+	/* spawn the drainer; optimized branch */
+	if (unlikely(PIN_SpawnInternalThread(sample_thread, NULL, 0, NULL) ==
+				INVALID_THREADID)) {
+		/* error message */
+		LOG(string(__func__) + ": internal thread spawn failed\n");
+
+		/* failed */
+		return 1;
+	}
+
+	/* report the coverage at exit */
+	PIN_AddFiniFunction(sample_fini, NULL);
+
+	/* success */
+	return 0;
+}
+
+/*
+ * a new descriptor (connection) is opened
+ *
+ * with per-connection sampling, decide if the descriptor is sampled
+ *
+ * @fd:		the descriptor
+ *
+ * returns:	1 if the descriptor is sampled, 0 otherwise
+ */
+size_t
+sample_open(int fd)
+{
+	/* sampling is disabled, or per-read; optimized branch */
+	if (likely(sample_reg == REG_INVALID() || sample_gran != SAMPLE_CONN))
+		return 1;
+
+	/* sampled (flag) */
+	size_t sampled;
+
+	PIN_GetLock(&sample_lock, PIN_ThreadId() + 1);
+
+	/* statistics */
+	sample_conn++;
+
+	/* sampled; sampled sources become live */
+	if ((sampled = ((size_t)(rand() % SAMPLE_SCALE) < sample_rate))) {
+		if (sample_fdset.insert(fd).second)
+			sample_live++;
+		sample_source();
+
+		/* statistics */
+		sample_conn_s++;
+	}
+
+	PIN_ReleaseLock(&sample_lock);
+
+	/* return the decision */
+	return sampled;
+}
+
+/*
+ * a descriptor is duplicated
+ *
+ * the new descriptor is sampled if the old one is
+ *
+ * @oldfd:	the old descriptor
+ * @newfd:	the new descriptor
+ */
+void
+sample_dup(int oldfd, int newfd)
+{
+	PIN_GetLock(&sample_lock, PIN_ThreadId() + 1);
+
+	/* the old descriptor is sampled */
+	if (sample_fdset.find(oldfd) != sample_fdset.end() &&
+			sample_fdset.insert(newfd).second)
+		sample_live++;
+
+	PIN_ReleaseLock(&sample_lock);
+}
+
+/*
+ * a descriptor (connection) is closed
+ *
+ * no new taint is sourced from it; the tags of the
+ * data that were read from it are kept (see sample_thread())
+ *
+ * @fd:		the descriptor
+ */
+void
+sample_close(int fd)
+{
+	PIN_GetLock(&sample_lock, PIN_ThreadId() + 1);
+
+	/* the descriptor is sampled */
+	if (sample_fdset.erase(fd) != 0)
+		sample_live--;
+
+	PIN_ReleaseLock(&sample_lock);
+}
+
+/*
+ * check if a taint-source is sampled
+ *
+ * it must be called by the taint-sources (i.e., syscall
+ * hooks) before tagging the data that are read from fd
+ *
+ * @fd:		the descriptor
+ * @len:	the number of bytes read
+ *
+ * returns:	1 if the data must be tagged, 0 otherwise
+ */
+size_t
+sample_src(int fd, size_t len)
+{
+	/* sampled (flag) */
+	size_t sampled;
+
+	/* sampling is disabled; optimized branch */
+	if (likely(sample_reg == REG_INVALID()))
+		return 1;
+
+	PIN_GetLock(&sample_lock, PIN_ThreadId() + 1);
+
+	/* per-connection sampling */
+	if (sample_gran == SAMPLE_CONN)
+		sampled = (sample_fdset.find(fd) != sample_fdset.end());
+	/* per-read sampling */
+	else if ((sampled =
+		((size_t)(rand() % SAMPLE_SCALE) < sample_rate))) {
+		/* sampled sources become live */
+		sample_live = SAMPLE_WINDOW;
+		sample_source();
+	}
+
+	/* statistics */
+	sample_srcs++;
+	sample_bytes += len;
+	if (sampled) {
+		sample_srcs_s++;
+		sample_bytes_s += len;
+	}
+
+	PIN_ReleaseLock(&sample_lock);
+
+	/* return the decision */
+	return sampled;
+}
+
 /*
  * add a new pre-ins callback into an instruction descriptor
  *
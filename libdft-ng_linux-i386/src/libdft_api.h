@@ -34,35 +34,28 @@
 #define __LIBDFT_API_H__
 
 #include <sys/syscall.h>
-#include <linux/version.h>
 
 #include "pin.H"
 
-#if LINUX_VERSION_CODE < KERNEL_VERSION(2,6,26)
-#error "Your kernel is tool old and this version of libdft does not support it"
-#elif LINUX_VERSION_CODE == KERNEL_VERSION(2,6,26)
-#define SYSCALL_MAX	__NR_timerfd_gettime+1	/* max syscall number */
-#elif LINUX_VERSION_CODE >= KERNEL_VERSION(2,6,27) && \
-		LINUX_VERSION_CODE <= KERNEL_VERSION(2,6,29)
-#define SYSCALL_MAX	__NR_inotify_init1+1	/* max syscall number */
-#elif LINUX_VERSION_CODE == KERNEL_VERSION(2,6,30)
-#define SYSCALL_MAX	__NR_pwritev+1		/* max syscall number */
-#elif LINUX_VERSION_CODE == KERNEL_VERSION(2,6,31)
-#define SYSCALL_MAX	__NR_perf_counter_open+1/* max syscall number */
-#elif LINUX_VERSION_CODE == KERNEL_VERSION(2,6,32)
-#define SYSCALL_MAX	__NR_perf_event_open+1	/* max syscall number */
-#elif LINUX_VERSION_CODE >= KERNEL_VERSION(2,6,33) && \
-		LINUX_VERSION_CODE <= KERNEL_VERSION(2,6,35)
-#define SYSCALL_MAX	__NR_recvmmsg+1		/* max syscall number */
-#elif LINUX_VERSION_CODE >= KERNEL_VERSION(2,6,36) && \
-		LINUX_VERSION_CODE <= KERNEL_VERSION(2,6,38)
-#define SYSCALL_MAX	__NR_prlimit64+1	/* max syscall number */
-#else
-#define SYSCALL_MAX	__NR_syncfs+1		/* max syscall number */
-#endif
+/*
+ * max syscall number; the syscall table is dense and covers the
+ * current i386 table (see syscall.tbl)
+ */
+#define SYSCALL_MAX	512
 
 #define GRP_NUM		8			/* general purpose registers */
 
+#define SAMPLE_SCALE	1000			/* sampling rate scale (per mille) */
+#define SAMPLE_WINDOW	1024			/* syscalls that a sampled read
+						   keeps the sources live */
+#define SAMPLE_DRAIN_MS	1000			/* interval of the checks for
+						   remaining sampled taint (ms) */
+
+#define VDSO_PREFIX	"__vdso_"		/* prefix of the vDSO routines */
+
+#define SCAVENGE_MS	1000			/* wakeup interval of the
+						   scavenger (ms) */
+
 /* FIXME: turn off the EFLAGS.AC bit by applying the corresponding mask */
 #define CLEAR_EFLAGS_AC(eflags)	((eflags & 0xfffbffff))
 
@@ -77,6 +70,21 @@ enum {
 /* #define */ SYSCALL_ARG_NUM = 6		/* syscall arguments */
 };
 
+enum {						 /* DFT state */
+/* #define */ DFT_DISABLE	= 0,
+/* #define */ DFT_ENABLE	= 1
+};
+
+enum {						 /* sampling granularity */
+/* #define */ SAMPLE_CONN	= 0,		/* per connection (descriptor) */
+/* #define */ SAMPLE_READ	= 1		/* per read */
+};
+
+enum {						 /* trace versions */
+/* #define */ VERSION_DFT	= 0,		/* tag propagation */
+/* #define */ VERSION_BASE	= 1		/* no instrumentation */
+};
+
 enum {						 /* {en,dis}able (ins_desc_t) */
 /* #define */ INSDFL_ENABLE	= 0,
 /* #define */ INSDFL_DISABLE	= 1
@@ -127,8 +135,16 @@ typedef struct {
 	vcpu_ctx_t	vcpu;		/* VCPU context */
 	syscall_ctx_t	syscall_ctx;	/* syscall context */
 	void		*uval;		/* local storage */
+	void		*ring;		/* replay ring (decoupled DFT) */
+	syscall_ctx_t	vdso_ctx;	/* vDSO call context */
 } thread_ctx_t;
 
+/* vDSO routine descriptor */
+typedef struct {
+	const char	*name;		/* routine name (w/o VDSO_PREFIX) */
+	int		nr;		/* the syscall that it stands for */
+} vdso_desc_t;
+
 /* instruction (ins) descriptor */
 typedef struct {
 	void 	(* pre)(INS ins);	/* pre-ins instrumentation callback */
@@ -140,6 +156,17 @@ typedef struct {
 /* libdft API */
 int	libdft_init(void);
 void	libdft_die(void);
+int	libdft_ctl(size_t, size_t);
+void	libdft_ctl_sync(void);
+size_t	libdft_state(void);
+int	libdft_scavenge(size_t);
+
+/* sampling API */
+int	sample_init(size_t, size_t);
+size_t	sample_open(int);
+void	sample_dup(int, int);
+void	sample_close(int);
+size_t	sample_src(int, size_t);
 
 /* ins API */
 int	ins_set_pre(ins_desc_t*, void (*)(INS));
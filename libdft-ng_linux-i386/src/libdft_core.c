@@ -32,11 +32,11 @@
 
 #include <errno.h>
 #include <string.h>
-#include <wchar.h>
 
 #include "pin.H"
 #include "libdft_api.h"
 #include "libdft_core.h"
+#include "libdft_replay.h"
 #include "tagmap.h"
 #include "branch_pred.h"
 
@@ -47,6 +47,13 @@ extern REG	thread_ctx_ptr;
 /* STAB */
 extern uint32_t	*STAB;
 
+/* analysis calls that ins_elide() handled at instrumentation time */
+static struct {
+	UINT64	nop;		/* tag no-ops; no call */
+	UINT64	clr;		/* clear-only calls */
+	UINT64	mask;		/* narrowed calls */
+} elide_stats;
+
 /*
  * tag propagation (analysis function)
  *
@@ -602,6 +609,8 @@ _cmpxchg_r2m_opl_slow(thread_ctx_t *thread_ctx, ADDRINT dst, uint32_t src)
 	/* update */
 	*((uint32_t *)(dst + STAB[VIRT2STAB(dst)])) =
 		thread_ctx->vcpu.gpr[src];
+	TSUM_MARK(dst, sizeof(uint32_t),
+		*((uint32_t *)(dst + STAB[VIRT2STAB(dst)])));
 }
 
 /*
@@ -661,6 +670,8 @@ _cmpxchg_r2m_opw_slow(thread_ctx_t *thread_ctx, ADDRINT dst, uint32_t src)
 	/* update */
 	*((uint16_t *)(dst + STAB[VIRT2STAB(dst)])) =
 		*((uint16_t *)&thread_ctx->vcpu.gpr[src]);
+	TSUM_MARK(dst, sizeof(uint16_t),
+		*((uint16_t *)(dst + STAB[VIRT2STAB(dst)])));
 }
 
 /*
@@ -686,6 +697,8 @@ _xchg_r2m_opl(thread_ctx_t *thread_ctx, ADDRINT dst, uint32_t src)
 	/* swap */
 	*((uint32_t *)(dst + STAB[VIRT2STAB(dst)])) =
 		thread_ctx->vcpu.gpr[src];
+	TSUM_MARK(dst, sizeof(uint32_t),
+		*((uint32_t *)(dst + STAB[VIRT2STAB(dst)])));
 		
 	thread_ctx->vcpu.gpr[src] = tmp_tag;
 }
@@ -713,6 +726,8 @@ _xchg_r2m_opw(thread_ctx_t *thread_ctx, ADDRINT dst, uint32_t src)
 	/* swap */
 	*((uint16_t *)(dst + STAB[VIRT2STAB(dst)])) =
 		*((uint16_t *)&thread_ctx->vcpu.gpr[src]);
+	TSUM_MARK(dst, sizeof(uint16_t),
+		*((uint16_t *)(dst + STAB[VIRT2STAB(dst)])));
 		
 	*((uint16_t *)&thread_ctx->vcpu.gpr[src]) = tmp_tag;
 }
@@ -740,6 +755,8 @@ _xchg_r2m_opb_u(thread_ctx_t *thread_ctx, ADDRINT dst, uint32_t src)
 	/* swap */
 	*((uint8_t *)(dst + STAB[VIRT2STAB(dst)])) =
 		*(((uint8_t *)&thread_ctx->vcpu.gpr[src]) + 1);
+	TSUM_MARK(dst, sizeof(uint8_t),
+		*((uint8_t *)(dst + STAB[VIRT2STAB(dst)])));
 	
 	*(((uint8_t *)&thread_ctx->vcpu.gpr[src]) + 1) = tmp_tag;
 }
@@ -767,6 +784,8 @@ _xchg_r2m_opb_l(thread_ctx_t *thread_ctx, ADDRINT dst, uint32_t src)
 	/* swap */
 	*((uint8_t *)(dst + STAB[VIRT2STAB(dst)])) =
 		*((uint8_t *)&thread_ctx->vcpu.gpr[src]);
+	TSUM_MARK(dst, sizeof(uint8_t),
+		*((uint8_t *)(dst + STAB[VIRT2STAB(dst)])));
 	
 	*((uint8_t *)&thread_ctx->vcpu.gpr[src]) = tmp_tag;
 }
@@ -794,6 +813,8 @@ _xadd_r2m_opl(thread_ctx_t *thread_ctx, ADDRINT dst, uint32_t src)
 	/* swap */
 	*((uint32_t *)(dst + STAB[VIRT2STAB(dst)])) |=
 		thread_ctx->vcpu.gpr[src];
+	TSUM_MARK(dst, sizeof(uint32_t),
+		*((uint32_t *)(dst + STAB[VIRT2STAB(dst)])));
 		
 	thread_ctx->vcpu.gpr[src] = tmp_tag;
 }
@@ -821,6 +842,8 @@ _xadd_r2m_opw(thread_ctx_t *thread_ctx, ADDRINT dst, uint32_t src)
 	/* swap */
 	*((uint16_t *)(dst + STAB[VIRT2STAB(dst)])) |=
 		*((uint16_t *)&thread_ctx->vcpu.gpr[src]);
+	TSUM_MARK(dst, sizeof(uint16_t),
+		*((uint16_t *)(dst + STAB[VIRT2STAB(dst)])));
 		
 	*((uint16_t *)&thread_ctx->vcpu.gpr[src]) = tmp_tag;
 }
@@ -848,6 +871,8 @@ _xadd_r2m_opb_u(thread_ctx_t *thread_ctx, ADDRINT dst, uint32_t src)
 	/* swap */
 	*((uint8_t *)(dst + STAB[VIRT2STAB(dst)])) |=
 		*(((uint8_t *)&thread_ctx->vcpu.gpr[src]) + 1);
+	TSUM_MARK(dst, sizeof(uint8_t),
+		*((uint8_t *)(dst + STAB[VIRT2STAB(dst)])));
 	
 	*(((uint8_t *)&thread_ctx->vcpu.gpr[src]) + 1) = tmp_tag;
 }
@@ -875,6 +900,8 @@ _xadd_r2m_opb_l(thread_ctx_t *thread_ctx, ADDRINT dst, uint32_t src)
 	/* swap */
 	*((uint8_t *)(dst + STAB[VIRT2STAB(dst)])) |=
 		*((uint8_t *)&thread_ctx->vcpu.gpr[src]);
+	TSUM_MARK(dst, sizeof(uint8_t),
+		*((uint8_t *)(dst + STAB[VIRT2STAB(dst)])));
 	
 	*((uint8_t *)&thread_ctx->vcpu.gpr[src]) = tmp_tag;
 }
@@ -1283,6 +1310,8 @@ r2m_binary_opb_u(thread_ctx_t *thread_ctx, ADDRINT dst, uint32_t src)
 {
 	*((uint8_t *)(dst + STAB[VIRT2STAB(dst)])) |= 
 		*(((uint8_t *)&thread_ctx->vcpu.gpr[src]) + 1);
+	TSUM_MARK(dst, sizeof(uint8_t),
+		*((uint8_t *)(dst + STAB[VIRT2STAB(dst)])));
 }
 
 /*
@@ -1301,6 +1330,8 @@ r2m_binary_opb_l(thread_ctx_t *thread_ctx, ADDRINT dst, uint32_t src)
 {
 	*((uint8_t *)(dst + STAB[VIRT2STAB(dst)])) |= 
 		*((uint8_t *)&thread_ctx->vcpu.gpr[src]);
+	TSUM_MARK(dst, sizeof(uint8_t),
+		*((uint8_t *)(dst + STAB[VIRT2STAB(dst)])));
 }
 
 /*
@@ -1319,6 +1350,8 @@ r2m_binary_opw(thread_ctx_t *thread_ctx, ADDRINT dst, uint32_t src)
 {
 	*((uint16_t *)(dst + STAB[VIRT2STAB(dst)])) |= 
 		*((uint16_t *)&thread_ctx->vcpu.gpr[src]);
+	TSUM_MARK(dst, sizeof(uint16_t),
+		*((uint16_t *)(dst + STAB[VIRT2STAB(dst)])));
 }
 
 /*
@@ -1337,6 +1370,8 @@ r2m_binary_opl(thread_ctx_t *thread_ctx, ADDRINT dst, uint32_t src)
 {
 	*((uint32_t *)(dst + STAB[VIRT2STAB(dst)])) |=
 		thread_ctx->vcpu.gpr[src];
+	TSUM_MARK(dst, sizeof(uint32_t),
+		*((uint32_t *)(dst + STAB[VIRT2STAB(dst)])));
 }
 
 /*
@@ -1427,6 +1462,52 @@ r_clrb_l(thread_ctx_t *thread_ctx, uint32_t reg)
 	*((uint8_t *)&thread_ctx->vcpu.gpr[reg]) = TAG_ZERO;
 }
 
+/*
+ * tag propagation (analysis function)
+ *
+ * clear the tags of the bytes of a register that are
+ * masked out by a constant (e.g., and eax, 0xFF)
+ *
+ * @thread_ctx:	the thread context
+ * @reg:	register index (VCPU)
+ * @mask:	the tag bytes to keep (0xFF) or clear (0x00)
+ */
+static void PIN_FAST_ANALYSIS_CALL
+r_andl(thread_ctx_t *thread_ctx, uint32_t reg, uint32_t mask)
+{
+	thread_ctx->vcpu.gpr[reg] &= mask;
+}
+
+/*
+ * tag propagation (analysis function)
+ *
+ * clear the tags of the bytes of a 32-bit memory
+ * location that are masked out by a constant
+ *
+ * @dst:	destination memory address
+ * @mask:	the tag bytes to keep (0xFF) or clear (0x00)
+ */
+static void PIN_FAST_ANALYSIS_CALL
+m_andl(ADDRINT dst, uint32_t mask)
+{
+	*((uint32_t *)(dst + STAB[VIRT2STAB(dst)])) &= mask;
+}
+
+/*
+ * tag propagation (analysis function)
+ *
+ * clear the tags of the bytes of a 16-bit memory
+ * location that are masked out by a constant
+ *
+ * @dst:	destination memory address
+ * @mask:	the tag bytes to keep (0xFF) or clear (0x00)
+ */
+static void PIN_FAST_ANALYSIS_CALL
+m_andw(ADDRINT dst, uint32_t mask)
+{
+	*((uint16_t *)(dst + STAB[VIRT2STAB(dst)])) &= (uint16_t)mask;
+}
+
 /*
  * tag propagation (analysis function)
  *
@@ -1599,7 +1680,6 @@ m2r_xfer_opl(thread_ctx_t *thread_ctx, uint32_t dst, ADDRINT src)
 	thread_ctx->vcpu.gpr[dst] = *((uint32_t *)(src + STAB[VIRT2STAB(src)]));
 }
 
-#if 0
 /*
  * tag propagation (analysis function)
  *
@@ -1607,6 +1687,9 @@ m2r_xfer_opl(thread_ctx_t *thread_ctx, uint32_t dst, ADDRINT src)
  * register and a n-memory locations as
  * t[dst] = t[src]; src is AL
  *
+ * NOTE: invoked once (i.e., before the first
+ * repetition) for the whole rep stosb
+ *
  * @thread_ctx:	the thread context
  * @dst:	destination memory address
  * @count:	memory bytes
@@ -1618,16 +1701,14 @@ r2m_xfer_opbn(thread_ctx_t *thread_ctx,
 		uint32_t count,
 		uint32_t eflags)
 {
-	if (likely(EFLAGS_DF(eflags) == 0))
-		/* EFLAGS.DF = 0 */
-		(void)memset((void *)(dst + STAB[VIRT2STAB(dst)]),
-			thread_ctx->vcpu.gpr[7], count);
-	else
-		/* EFLAGS.DF = 1 */
-		(void)memset((void *)(dst + STAB[VIRT2STAB(dst)] - count + 1),
-			thread_ctx->vcpu.gpr[7], count);
+	/* EFLAGS.DF = 1; dst is the last byte */
+	if (unlikely(EFLAGS_DF(eflags) != 0))
+		dst -= count - 1;
+
+	/* fill the tags */
+	tagmap_filln(dst, count,
+		(thread_ctx->vcpu.gpr[7] & TAG_ALL8) * 0x01010101U);
 }
-#endif
 
 /*
  * tag propagation (analysis function)
@@ -1645,6 +1726,8 @@ r2m_xfer_opb_u(thread_ctx_t *thread_ctx, ADDRINT dst, uint32_t src)
 {
 	*((uint8_t *)(dst + STAB[VIRT2STAB(dst)])) =
 		*(((uint8_t *)&thread_ctx->vcpu.gpr[src]) + 1);
+	TSUM_MARK(dst, sizeof(uint8_t),
+		*((uint8_t *)(dst + STAB[VIRT2STAB(dst)])));
 }
 
 /*
@@ -1663,9 +1746,10 @@ r2m_xfer_opb_l(thread_ctx_t *thread_ctx, ADDRINT dst, uint32_t src)
 {
 	*((uint8_t *)(dst + STAB[VIRT2STAB(dst)])) =
 		*((uint8_t *)&thread_ctx->vcpu.gpr[src]);
+	TSUM_MARK(dst, sizeof(uint8_t),
+		*((uint8_t *)(dst + STAB[VIRT2STAB(dst)])));
 }
 
-#if 0
 /*
  * tag propagation (analysis function)
  *
@@ -1673,6 +1757,9 @@ r2m_xfer_opb_l(thread_ctx_t *thread_ctx, ADDRINT dst, uint32_t src)
  * register and a n-memory locations as
  * t[dst] = t[src]; src is AX
  *
+ * NOTE: invoked once (i.e., before the first
+ * repetition) for the whole rep stosw
+ *
  * @thread_ctx:	the thread context
  * @dst:	destination memory address
  * @count:	memory words
@@ -1684,52 +1771,16 @@ r2m_xfer_opwn(thread_ctx_t *thread_ctx,
 		uint32_t count,
 		uint32_t eflags)
 {
-	/* temporaries */
-	uint32_t tmp_tag	= *((uint16_t *)&thread_ctx->vcpu.gpr[7]);
-	uint32_t addr		= (dst + STAB[VIRT2STAB(dst)]);
+	/* the tag of AX */
+	uint32_t tag = thread_ctx->vcpu.gpr[7] & 0xFFFFU;
 
-	/* extend the value of tmp_tag */
-	tmp_tag |= (tmp_tag << 16);
-		
-	/* count is odd */
-	if ((count != 0) && (count % 2 != 0)) {
-		if (likely(EFLAGS_DF(eflags) == 0)) {
-			/* EFLAGS.DF = 0 */
-			/* fast path */
-			(void)wmemset((wchar_t *)addr, (wchar_t)tmp_tag,
-				(count - 1) >> 1);
-
-			/* remainder */
-			*(uint16_t *)(addr + (count << 1) - 2) =
-				(uint16_t)tmp_tag;
-		}
-		else {
-			/* EFLAGS.DF = 1 */
-			/* fast path */
-			(void)wmemset((wchar_t *) (addr - (count << 1) + 3),
-					(wchar_t)tmp_tag, (count - 1) >> 1);
-
-			/* remainder */
-			*(uint16_t *)(addr - (count << 1) + 1) =
-				(uint16_t)tmp_tag;
-		}
-	}
-	/* count is even */
-	else {
+	/* EFLAGS.DF = 1; dst is the last word */
+	if (unlikely(EFLAGS_DF(eflags) != 0))
+		dst -= (count - 1) << 1;
 
-		if (likely(EFLAGS_DF(eflags) == 0 || count == 0))
-			/* EFLAGS.DF = 0 */
-			(void)wmemset((wchar_t *)addr,
-					(wchar_t)tmp_tag,
-					count >> 1);
-		else
-			/* EFLAGS.DF = 1 */
-			(void)wmemset((wchar_t *)(addr - (count << 1) + 1),
-					(wchar_t)tmp_tag,
-					count >> 1);
-	}
+	/* fill the tags */
+	tagmap_filln(dst, count << 1, tag | (tag << 16));
 }
-#endif
 
 /*
  * tag propagation (analysis function)
@@ -1747,9 +1798,10 @@ r2m_xfer_opw(thread_ctx_t *thread_ctx, ADDRINT dst, uint32_t src)
 {
 	*((uint16_t *)(dst + STAB[VIRT2STAB(dst)])) =
 		*((uint16_t *)&thread_ctx->vcpu.gpr[src]);
+	TSUM_MARK(dst, sizeof(uint16_t),
+		*((uint16_t *)(dst + STAB[VIRT2STAB(dst)])));
 }
 
-#if 0
 /*
  * tag propagation (analysis function)
  *
@@ -1757,9 +1809,11 @@ r2m_xfer_opw(thread_ctx_t *thread_ctx, ADDRINT dst, uint32_t src)
  * register and a n-memory locations as
  * t[dst] = t[src]; src is EAX
  *
+ * NOTE: invoked once (i.e., before the first
+ * repetition) for the whole rep stosd
+ *
  * @thread_ctx:	the thread context
  * @dst:	destination memory address
- * @src:	source register index (VCPU)
  * @count:	memory double words
  * @eflags:	the value of the EFLAGS register
  */
@@ -1769,17 +1823,13 @@ r2m_xfer_opln(thread_ctx_t *thread_ctx,
 		uint32_t count,
 		uint32_t eflags)
 {
-	if (likely(EFLAGS_DF(eflags) == 0))
-		/* EFLAGS.DF = 0 */
-		(void)wmemset((wchar_t *)(dst + STAB[VIRT2STAB(dst)]),
-			(wchar_t)thread_ctx->vcpu.gpr[7], count);
-	else
-		/* EFLAGS.DF = 1 */
-		(void)wmemset((wchar_t *)
-			(dst + STAB[VIRT2STAB(dst)] - (count << 2) + 1),
-				(wchar_t)thread_ctx->vcpu.gpr[7], count);
+	/* EFLAGS.DF = 1; dst is the last double word */
+	if (unlikely(EFLAGS_DF(eflags) != 0))
+		dst -= (count - 1) << 2;
+
+	/* fill the tags */
+	tagmap_filln(dst, count << 2, thread_ctx->vcpu.gpr[7]);
 }
-#endif
 
 /*
  * tag propagation (analysis function)
@@ -1797,6 +1847,8 @@ r2m_xfer_opl(thread_ctx_t *thread_ctx, ADDRINT dst, uint32_t src)
 {
 	*((uint32_t *)(dst + STAB[VIRT2STAB(dst)])) =
 		thread_ctx->vcpu.gpr[src];
+	TSUM_MARK(dst, sizeof(uint32_t),
+		*((uint32_t *)(dst + STAB[VIRT2STAB(dst)])));
 }
 
 /*
@@ -1813,6 +1865,8 @@ m2m_xfer_opw(ADDRINT dst, ADDRINT src)
 {
 	*((uint16_t *)(dst + STAB[VIRT2STAB(dst)])) =
 		*((uint16_t *)(src + STAB[VIRT2STAB(src)]));
+	TSUM_MARK(dst, sizeof(uint16_t),
+		*((uint16_t *)(dst + STAB[VIRT2STAB(dst)])));
 	
 }
 
@@ -1830,6 +1884,8 @@ m2m_xfer_opb(ADDRINT dst, ADDRINT src)
 {
 	*((uint8_t *)(dst + STAB[VIRT2STAB(dst)])) =
 		*((uint8_t *)(src + STAB[VIRT2STAB(src)]));
+	TSUM_MARK(dst, sizeof(uint8_t),
+		*((uint8_t *)(dst + STAB[VIRT2STAB(dst)])));
 }
 
 /*
@@ -1846,6 +1902,8 @@ m2m_xfer_opl(ADDRINT dst, ADDRINT src)
 {
 	*((uint32_t *)(dst + STAB[VIRT2STAB(dst)])) =
 		*((uint32_t *)(src + STAB[VIRT2STAB(src)]));
+	TSUM_MARK(dst, sizeof(uint32_t),
+		*((uint32_t *)(dst + STAB[VIRT2STAB(dst)])));
 }
 
 /*
@@ -1862,17 +1920,14 @@ m2m_xfer_opl(ADDRINT dst, ADDRINT src)
 static void PIN_FAST_ANALYSIS_CALL
 m2m_xfer_opwn(ADDRINT dst, ADDRINT src, uint32_t count, uint32_t eflags)
 {
-	if (likely(EFLAGS_DF(eflags) == 0))
-		/* EFLAGS.DF = 0 */
-		(void)memcpy((void *)(dst + STAB[VIRT2STAB(dst)]),
-			(void *)(src + STAB[VIRT2STAB(src)]),
-			count << 1);
-	else
-		/* EFLAGS.DF = 1 */
-		(void)memcpy((void *)
-			(dst + STAB[VIRT2STAB(dst)] - (count << 1) + 1),
-			(void *)(src + STAB[VIRT2STAB(src)] - (count << 1) + 1),
-			count << 1);
+	/* EFLAGS.DF = 1; dst and src are the last words */
+	if (unlikely(EFLAGS_DF(eflags) != 0)) {
+		dst -= (count - 1) << 1;
+		src -= (count - 1) << 1;
+	}
+
+	/* move the tags in the direction of the string operation */
+	tagmap_movn(dst, src, count << 1, EFLAGS_DF(eflags));
 }
 
 /*
@@ -1889,16 +1944,14 @@ m2m_xfer_opwn(ADDRINT dst, ADDRINT src, uint32_t count, uint32_t eflags)
 static void PIN_FAST_ANALYSIS_CALL
 m2m_xfer_opbn(ADDRINT dst, ADDRINT src, uint32_t count, uint32_t eflags)
 {
-	if (likely(EFLAGS_DF(eflags) == 0))
-		/* EFLAGS.DF = 0 */
-		(void)memcpy((void *)(dst + STAB[VIRT2STAB(dst)]),
-			(void *)(src + STAB[VIRT2STAB(src)]),
-			count);
-	else
-		/* EFLAGS.DF = 1 */
-		(void)memcpy((void *)(dst + STAB[VIRT2STAB(dst)] - count + 1),
-			(void *)(src + STAB[VIRT2STAB(src)] - count + 1),
-			count);
+	/* EFLAGS.DF = 1; dst and src are the last bytes */
+	if (unlikely(EFLAGS_DF(eflags) != 0)) {
+		dst -= count - 1;
+		src -= count - 1;
+	}
+
+	/* move the tags in the direction of the string operation */
+	tagmap_movn(dst, src, count, EFLAGS_DF(eflags));
 }
 
 /*
@@ -1915,17 +1968,14 @@ m2m_xfer_opbn(ADDRINT dst, ADDRINT src, uint32_t count, uint32_t eflags)
 static void PIN_FAST_ANALYSIS_CALL
 m2m_xfer_opln(ADDRINT dst, ADDRINT src, uint32_t count, uint32_t eflags)
 {
-	if (likely(EFLAGS_DF(eflags) == 0))
-		/* EFLAGS.DF = 0 */
-		(void)memcpy((void *)(dst + STAB[VIRT2STAB(dst)]),
-			(void *)(src + STAB[VIRT2STAB(src)]),
-			count << 2);
-	else
-		/* EFLAGS.DF = 1 */
-		(void)memcpy((void *)
-			(dst + STAB[VIRT2STAB(dst)] - (count << 2) + 1),
-			(void *)(src + STAB[VIRT2STAB(src)] - (count << 2) + 1),
-			count << 2);
+	/* EFLAGS.DF = 1; dst and src are the last double words */
+	if (unlikely(EFLAGS_DF(eflags) != 0)) {
+		dst -= (count - 1) << 2;
+		src -= (count - 1) << 2;
+	}
+
+	/* move the tags in the direction of the string operation */
+	tagmap_movn(dst, src, count << 2, EFLAGS_DF(eflags));
 }
 
 /*
@@ -1934,10 +1984,10 @@ m2m_xfer_opln(ADDRINT dst, ADDRINT src, uint32_t count, uint32_t eflags)
  * instrumentation helper; returns the flag that
  * takes as argument -- seems lame, but it is
  * necessary for aiding conditional analysis to
- * be inlined. Typically used with INS_InsertIfCall()
+ * be inlined. Typically used with DFT_INS_IFCALL()
  * in order to return true (i.e., allow the execution
  * of the function that has been instrumented with
- * INS_InsertThenCall()) only once
+ * DFT_INS_THENCALL()) only once
  *
  * first_iteration:	flag; indicates whether the rep-prefixed instruction is
  * 			executed for the first time or not
@@ -2034,87 +2084,1179 @@ m2r_restore_opl(thread_ctx_t *thread_ctx, ADDRINT src)
 }
 
 /*
- * tag propagation (analysis function)
+ * tag propagation (analysis function)
+ *
+ * save the tag values for all the 16-bit
+ * general purpose registers into the memory
+ *
+ * NOTE: special case for PUSHA instruction
+ *
+ * @thread_ctx:	the thread context
+ * @dst:	the destination memory address
+ */
+static void PIN_FAST_ANALYSIS_CALL
+r2m_save_opw(thread_ctx_t *thread_ctx, ADDRINT dst)
+{
+	/* tagmap address */
+	uint32_t dst_val = dst + STAB[VIRT2STAB(dst)];
+
+	/* save DI */
+	*(uint16_t *)dst_val =  *((uint16_t *)&thread_ctx->vcpu.gpr[0]);
+
+	/* save SI */
+	*(uint16_t *)(dst_val + 2) = *((uint16_t *)&thread_ctx->vcpu.gpr[1]);
+
+	/* save BP */
+	*(uint16_t *)(dst_val + 4) = *((uint16_t *)&thread_ctx->vcpu.gpr[2]);
+
+	/* save SP */
+	*(uint16_t *)(dst_val + 6) = *((uint16_t *)&thread_ctx->vcpu.gpr[3]);
+
+	/* save BX */
+	*(uint16_t *)(dst_val + 8) = *((uint16_t *)&thread_ctx->vcpu.gpr[4]);
+
+	/* save DX */
+	*(uint16_t *)(dst_val + 10) = *((uint16_t *)&thread_ctx->vcpu.gpr[5]);
+
+	/* save CX */
+	*(uint16_t *)(dst_val + 12) = *((uint16_t *)&thread_ctx->vcpu.gpr[6]);
+
+	/* save AX */
+	*(uint16_t *)(dst_val + 14) = *((uint16_t *)&thread_ctx->vcpu.gpr[7]);
+
+	/* taint summary; any of the registers may be tainted */
+	TSUM_MARK(dst, 16, thread_ctx->vcpu.gpr[0] | thread_ctx->vcpu.gpr[1] |
+		thread_ctx->vcpu.gpr[2] | thread_ctx->vcpu.gpr[3] |
+		thread_ctx->vcpu.gpr[4] | thread_ctx->vcpu.gpr[5] |
+		thread_ctx->vcpu.gpr[6] | thread_ctx->vcpu.gpr[7]);
+}
+
+/*
+ * tag propagation (analysis function)
+ *
+ * save the tag values for all the 32-bit
+ * general purpose registers into the memory
+ *
+ * NOTE: special case for PUSHAD instruction 
+ *
+ * @thread_ctx:	the thread context
+ * @dst:	the destination memory address
+ */
+static void PIN_FAST_ANALYSIS_CALL
+r2m_save_opl(thread_ctx_t *thread_ctx, ADDRINT dst)
+{
+	/* tagmap address */
+	uint32_t dst_val = dst + STAB[VIRT2STAB(dst)];
+
+	/* save EDI */
+	*(uint32_t *)dst_val = thread_ctx->vcpu.gpr[0];
+
+	/* save ESI */
+	*(uint32_t *)(dst_val + 4) = thread_ctx->vcpu.gpr[1];
+
+	/* save EBP */
+	*(uint32_t *)(dst_val + 8) = thread_ctx->vcpu.gpr[2];
+
+	/* save ESP */
+	*(uint32_t *)(dst_val + 12) = thread_ctx->vcpu.gpr[3];
+
+	/* save EBX */
+	*(uint32_t *)(dst_val + 16) = thread_ctx->vcpu.gpr[4];
+
+	/* save EDX */
+	*(uint32_t *)(dst_val + 20) = thread_ctx->vcpu.gpr[5];
+
+	/* save ECX */
+	*(uint32_t *)(dst_val + 24) = thread_ctx->vcpu.gpr[6];
+
+	/* save EAX */
+	*(uint32_t *)(dst_val + 28) = thread_ctx->vcpu.gpr[7];
+
+	/* taint summary; any of the registers may be tainted */
+	TSUM_MARK(dst, 32, thread_ctx->vcpu.gpr[0] | thread_ctx->vcpu.gpr[1] |
+		thread_ctx->vcpu.gpr[2] | thread_ctx->vcpu.gpr[3] |
+		thread_ctx->vcpu.gpr[4] | thread_ctx->vcpu.gpr[5] |
+		thread_ctx->vcpu.gpr[6] | thread_ctx->vcpu.gpr[7]);
+}
+
+/*
+ * tag propagation (analysis function)
+ *
+ * shift the tags of a 32-bit register left
+ * by whole bytes as t[dst] <<= n
+ *
+ * @thread_ctx:	the thread context
+ * @dst:	destination register index (VCPU)
+ * @n:		the shift count in bits (8, 16, or 24)
+ */
+static void PIN_FAST_ANALYSIS_CALL
+r_shl_opl(thread_ctx_t *thread_ctx, uint32_t dst, uint32_t n)
+{
+	thread_ctx->vcpu.gpr[dst] <<= n;
+}
+
+/*
+ * tag propagation (analysis function)
+ *
+ * shift the tags of a 32-bit register right
+ * by whole bytes as t[dst] >>= n
+ *
+ * @thread_ctx:	the thread context
+ * @dst:	destination register index (VCPU)
+ * @n:		the shift count in bits (8, 16, or 24)
+ */
+static void PIN_FAST_ANALYSIS_CALL
+r_shr_opl(thread_ctx_t *thread_ctx, uint32_t dst, uint32_t n)
+{
+	thread_ctx->vcpu.gpr[dst] >>= n;
+}
+
+/*
+ * tag propagation (analysis function)
+ *
+ * shift the tags of a 32-bit register right by whole
+ * bytes, filling the vacated bytes with the tag of the
+ * most significant byte (i.e., the sign)
+ *
+ * @thread_ctx:	the thread context
+ * @dst:	destination register index (VCPU)
+ * @n:		the shift count in bits (8, 16, or 24)
+ */
+static void PIN_FAST_ANALYSIS_CALL
+r_sar_opl(thread_ctx_t *thread_ctx, uint32_t dst, uint32_t n)
+{
+	/* temporaries */
+	uint32_t tag = thread_ctx->vcpu.gpr[dst];
+
+	thread_ctx->vcpu.gpr[dst] = (tag >> n) |
+		(((tag >> 24) * 0x01010101U) << (32 - n));
+}
+
+/*
+ * tag propagation (analysis function)
+ *
+ * rotate the tags of a 32-bit register left by whole
+ * bytes; ror is a rol by 32 - n
+ *
+ * @thread_ctx:	the thread context
+ * @dst:	destination register index (VCPU)
+ * @n:		the rotate count in bits (8, 16, or 24)
+ */
+static void PIN_FAST_ANALYSIS_CALL
+r_rol_opl(thread_ctx_t *thread_ctx, uint32_t dst, uint32_t n)
+{
+	/* temporaries */
+	uint32_t tag = thread_ctx->vcpu.gpr[dst];
+
+	thread_ctx->vcpu.gpr[dst] = (tag << n) | (tag >> (32 - n));
+}
+
+/*
+ * tag propagation (analysis function)
+ *
+ * combine the tags of a 32-bit register; every byte
+ * gets the union of the tags of all the bytes
+ *
+ * @thread_ctx:	the thread context
+ * @dst:	destination register index (VCPU)
+ */
+static void PIN_FAST_ANALYSIS_CALL
+r_union_opl(thread_ctx_t *thread_ctx, uint32_t dst)
+{
+	/* temporaries */
+	uint32_t tag = thread_ctx->vcpu.gpr[dst];
+
+	/* fold and replicate */
+	tag |= (tag >> 16);
+	tag |= (tag >> 8);
+	thread_ctx->vcpu.gpr[dst] = (tag & TAG_ALL8) * 0x01010101U;
+}
+
+/*
+ * tag propagation (analysis function)
+ *
+ * shift the tags of a 16-bit register
+ * left by a byte as t[dst] <<= 8
+ *
+ * @thread_ctx:	the thread context
+ * @dst:	destination register index (VCPU)
+ */
+static void PIN_FAST_ANALYSIS_CALL
+r_shl_opw(thread_ctx_t *thread_ctx, uint32_t dst)
+{
+	*((uint16_t *)&thread_ctx->vcpu.gpr[dst]) <<= 8;
+}
+
+/*
+ * tag propagation (analysis function)
+ *
+ * shift the tags of a 16-bit register
+ * right by a byte as t[dst] >>= 8
+ *
+ * @thread_ctx:	the thread context
+ * @dst:	destination register index (VCPU)
+ */
+static void PIN_FAST_ANALYSIS_CALL
+r_shr_opw(thread_ctx_t *thread_ctx, uint32_t dst)
+{
+	*((uint16_t *)&thread_ctx->vcpu.gpr[dst]) >>= 8;
+}
+
+/*
+ * tag propagation (analysis function)
+ *
+ * shift the tags of a 16-bit register right by a byte;
+ * the most significant byte (i.e., the sign) keeps its tag
+ *
+ * @thread_ctx:	the thread context
+ * @dst:	destination register index (VCPU)
+ */
+static void PIN_FAST_ANALYSIS_CALL
+r_sar_opw(thread_ctx_t *thread_ctx, uint32_t dst)
+{
+	/* temporaries */
+	uint16_t tag = *((uint16_t *)&thread_ctx->vcpu.gpr[dst]);
+
+	*((uint16_t *)&thread_ctx->vcpu.gpr[dst]) = (tag >> 8) | (tag & 0xFF00);
+}
+
+/*
+ * tag propagation (analysis function)
+ *
+ * rotate the tags of a 16-bit register by a byte
+ * (i.e., swap them); rol and ror are the same
+ *
+ * @thread_ctx:	the thread context
+ * @dst:	destination register index (VCPU)
+ */
+static void PIN_FAST_ANALYSIS_CALL
+r_rol_opw(thread_ctx_t *thread_ctx, uint32_t dst)
+{
+	/* temporaries */
+	uint16_t tag = *((uint16_t *)&thread_ctx->vcpu.gpr[dst]);
+
+	*((uint16_t *)&thread_ctx->vcpu.gpr[dst]) = (tag << 8) | (tag >> 8);
+}
+
+/*
+ * tag propagation (analysis function)
+ *
+ * combine the tags of a 16-bit register; both
+ * bytes get the union of their tags
+ *
+ * @thread_ctx:	the thread context
+ * @dst:	destination register index (VCPU)
+ */
+static void PIN_FAST_ANALYSIS_CALL
+r_union_opw(thread_ctx_t *thread_ctx, uint32_t dst)
+{
+	/* temporaries */
+	uint16_t tag = *((uint16_t *)&thread_ctx->vcpu.gpr[dst]);
+
+	*((uint16_t *)&thread_ctx->vcpu.gpr[dst]) =
+		((tag | (tag >> 8)) & TAG_ALL8) * 0x0101U;
+}
+
+/*
+ * tag propagation (analysis function)
+ *
+ * shift the tags of a 32-bit memory location
+ * left by whole bytes as t[dst] <<= n
+ *
+ * @dst:	destination memory address
+ * @n:		the shift count in bits (8, 16, or 24)
+ */
+static void PIN_FAST_ANALYSIS_CALL
+m_shl_opl(ADDRINT dst, uint32_t n)
+{
+	*((uint32_t *)(dst + STAB[VIRT2STAB(dst)])) <<= n;
+	TSUM_MARK(dst, sizeof(uint32_t),
+		*((uint32_t *)(dst + STAB[VIRT2STAB(dst)])));
+}
+
+/*
+ * tag propagation (analysis function)
+ *
+ * shift the tags of a 32-bit memory location
+ * right by whole bytes as t[dst] >>= n
+ *
+ * @dst:	destination memory address
+ * @n:		the shift count in bits (8, 16, or 24)
+ */
+static void PIN_FAST_ANALYSIS_CALL
+m_shr_opl(ADDRINT dst, uint32_t n)
+{
+	*((uint32_t *)(dst + STAB[VIRT2STAB(dst)])) >>= n;
+	TSUM_MARK(dst, sizeof(uint32_t),
+		*((uint32_t *)(dst + STAB[VIRT2STAB(dst)])));
+}
+
+/*
+ * tag propagation (analysis function)
+ *
+ * shift the tags of a 32-bit memory location right by
+ * whole bytes, filling the vacated bytes with the tag
+ * of the most significant byte (i.e., the sign)
+ *
+ * @dst:	destination memory address
+ * @n:		the shift count in bits (8, 16, or 24)
+ */
+static void PIN_FAST_ANALYSIS_CALL
+m_sar_opl(ADDRINT dst, uint32_t n)
+{
+	/* temporaries */
+	uint32_t *taddr	= (uint32_t *)(dst + STAB[VIRT2STAB(dst)]);
+	uint32_t tag	= *taddr;
+
+	*taddr = (tag >> n) | (((tag >> 24) * 0x01010101U) << (32 - n));
+	TSUM_MARK(dst, sizeof(uint32_t), *taddr);
+}
+
+/*
+ * tag propagation (analysis function)
+ *
+ * rotate the tags of a 32-bit memory location left
+ * by whole bytes; ror is a rol by 32 - n
+ *
+ * @dst:	destination memory address
+ * @n:		the rotate count in bits (8, 16, or 24)
+ */
+static void PIN_FAST_ANALYSIS_CALL
+m_rol_opl(ADDRINT dst, uint32_t n)
+{
+	/* temporaries */
+	uint32_t *taddr	= (uint32_t *)(dst + STAB[VIRT2STAB(dst)]);
+	uint32_t tag	= *taddr;
+
+	*taddr = (tag << n) | (tag >> (32 - n));
+	TSUM_MARK(dst, sizeof(uint32_t), *taddr);
+}
+
+/*
+ * tag propagation (analysis function)
+ *
+ * combine the tags of a 32-bit memory location; every
+ * byte gets the union of the tags of all the bytes
+ *
+ * @dst:	destination memory address
+ */
+static void PIN_FAST_ANALYSIS_CALL
+m_union_opl(ADDRINT dst)
+{
+	/* temporaries */
+	uint32_t *taddr	= (uint32_t *)(dst + STAB[VIRT2STAB(dst)]);
+	uint32_t tag	= *taddr;
+
+	/* fold and replicate */
+	tag |= (tag >> 16);
+	tag |= (tag >> 8);
+	*taddr = (tag & TAG_ALL8) * 0x01010101U;
+	TSUM_MARK(dst, sizeof(uint32_t), *taddr);
+}
+
+/*
+ * tag propagation (analysis function)
+ *
+ * shift the tags of a 16-bit memory
+ * location left by a byte as t[dst] <<= 8
+ *
+ * @dst:	destination memory address
+ */
+static void PIN_FAST_ANALYSIS_CALL
+m_shl_opw(ADDRINT dst)
+{
+	*((uint16_t *)(dst + STAB[VIRT2STAB(dst)])) <<= 8;
+	TSUM_MARK(dst, sizeof(uint16_t),
+		*((uint16_t *)(dst + STAB[VIRT2STAB(dst)])));
+}
+
+/*
+ * tag propagation (analysis function)
+ *
+ * shift the tags of a 16-bit memory
+ * location right by a byte as t[dst] >>= 8
+ *
+ * @dst:	destination memory address
+ */
+static void PIN_FAST_ANALYSIS_CALL
+m_shr_opw(ADDRINT dst)
+{
+	*((uint16_t *)(dst + STAB[VIRT2STAB(dst)])) >>= 8;
+	TSUM_MARK(dst, sizeof(uint16_t),
+		*((uint16_t *)(dst + STAB[VIRT2STAB(dst)])));
+}
+
+/*
+ * tag propagation (analysis function)
+ *
+ * shift the tags of a 16-bit memory location right by a
+ * byte; the most significant byte (i.e., the sign) keeps
+ * its tag
+ *
+ * @dst:	destination memory address
+ */
+static void PIN_FAST_ANALYSIS_CALL
+m_sar_opw(ADDRINT dst)
+{
+	/* temporaries */
+	uint16_t *taddr	= (uint16_t *)(dst + STAB[VIRT2STAB(dst)]);
+	uint16_t tag	= *taddr;
+
+	*taddr = (tag >> 8) | (tag & 0xFF00);
+	TSUM_MARK(dst, sizeof(uint16_t), *taddr);
+}
+
+/*
+ * tag propagation (analysis function)
+ *
+ * rotate the tags of a 16-bit memory location by
+ * a byte (i.e., swap them); rol and ror are the same
+ *
+ * @dst:	destination memory address
+ */
+static void PIN_FAST_ANALYSIS_CALL
+m_rol_opw(ADDRINT dst)
+{
+	/* temporaries */
+	uint16_t *taddr	= (uint16_t *)(dst + STAB[VIRT2STAB(dst)]);
+	uint16_t tag	= *taddr;
+
+	*taddr = (tag << 8) | (tag >> 8);
+	TSUM_MARK(dst, sizeof(uint16_t), *taddr);
+}
+
+/*
+ * tag propagation (analysis function)
+ *
+ * combine the tags of a 16-bit memory location;
+ * both bytes get the union of their tags
+ *
+ * @dst:	destination memory address
+ */
+static void PIN_FAST_ANALYSIS_CALL
+m_union_opw(ADDRINT dst)
+{
+	/* temporaries */
+	uint16_t *taddr	= (uint16_t *)(dst + STAB[VIRT2STAB(dst)]);
+	uint16_t tag	= *taddr;
+
+	*taddr = ((tag | (tag >> 8)) & TAG_ALL8) * 0x0101U;
+	TSUM_MARK(dst, sizeof(uint16_t), *taddr);
+}
+
+/*
+ * tag propagation (analysis function)
+ *
+ * double precision left shift of 32-bit registers by
+ * whole bytes as t[dst] = t[dst] << n | t[src] >> (32 - n)
+ *
+ * @thread_ctx:	the thread context
+ * @dst:	destination register index (VCPU)
+ * @src:	source register index (VCPU)
+ * @n:		the shift count in bits (8, 16, or 24)
+ */
+static void PIN_FAST_ANALYSIS_CALL
+r2r_shld_opl(thread_ctx_t *thread_ctx, uint32_t dst, uint32_t src, uint32_t n)
+{
+	thread_ctx->vcpu.gpr[dst] = (thread_ctx->vcpu.gpr[dst] << n) |
+		(thread_ctx->vcpu.gpr[src] >> (32 - n));
+}
+
+/*
+ * tag propagation (analysis function)
+ *
+ * double precision right shift of 32-bit registers by
+ * whole bytes as t[dst] = t[dst] >> n | t[src] << (32 - n)
+ *
+ * @thread_ctx:	the thread context
+ * @dst:	destination register index (VCPU)
+ * @src:	source register index (VCPU)
+ * @n:		the shift count in bits (8, 16, or 24)
+ */
+static void PIN_FAST_ANALYSIS_CALL
+r2r_shrd_opl(thread_ctx_t *thread_ctx, uint32_t dst, uint32_t src, uint32_t n)
+{
+	thread_ctx->vcpu.gpr[dst] = (thread_ctx->vcpu.gpr[dst] >> n) |
+		(thread_ctx->vcpu.gpr[src] << (32 - n));
+}
+
+/*
+ * tag propagation (analysis function)
+ *
+ * double precision shift of 32-bit registers by an arbitrary
+ * count; every byte of dst gets the union of the tags of dst
+ * and src
+ *
+ * @thread_ctx:	the thread context
+ * @dst:	destination register index (VCPU)
+ * @src:	source register index (VCPU)
+ */
+static void PIN_FAST_ANALYSIS_CALL
+r2r_union_opl(thread_ctx_t *thread_ctx, uint32_t dst, uint32_t src)
+{
+	/* temporaries */
+	uint32_t tag = thread_ctx->vcpu.gpr[dst] | thread_ctx->vcpu.gpr[src];
+
+	/* fold and replicate */
+	tag |= (tag >> 16);
+	tag |= (tag >> 8);
+	thread_ctx->vcpu.gpr[dst] = (tag & TAG_ALL8) * 0x01010101U;
+}
+
+/*
+ * tag propagation (analysis function)
+ *
+ * double precision shift of 16-bit registers; both bytes
+ * of dst get the union of the tags of dst and src
+ *
+ * @thread_ctx:	the thread context
+ * @dst:	destination register index (VCPU)
+ * @src:	source register index (VCPU)
+ */
+static void PIN_FAST_ANALYSIS_CALL
+r2r_union_opw(thread_ctx_t *thread_ctx, uint32_t dst, uint32_t src)
+{
+	/* temporaries */
+	uint16_t tag = *((uint16_t *)&thread_ctx->vcpu.gpr[dst]) |
+		*((uint16_t *)&thread_ctx->vcpu.gpr[src]);
+
+	*((uint16_t *)&thread_ctx->vcpu.gpr[dst]) =
+		((tag | (tag >> 8)) & TAG_ALL8) * 0x0101U;
+}
+
+/*
+ * tag propagation (analysis function)
+ *
+ * double precision left shift of a 32-bit memory location
+ * and a 32-bit register by whole bytes as
+ * t[dst] = t[dst] << n | t[src] >> (32 - n)
+ *
+ * @thread_ctx:	the thread context
+ * @dst:	destination memory address
+ * @src:	source register index (VCPU)
+ * @n:		the shift count in bits (8, 16, or 24)
+ */
+static void PIN_FAST_ANALYSIS_CALL
+r2m_shld_opl(thread_ctx_t *thread_ctx, ADDRINT dst, uint32_t src, uint32_t n)
+{
+	/* temporaries */
+	uint32_t *taddr	= (uint32_t *)(dst + STAB[VIRT2STAB(dst)]);
+
+	*taddr = (*taddr << n) | (thread_ctx->vcpu.gpr[src] >> (32 - n));
+	TSUM_MARK(dst, sizeof(uint32_t), *taddr);
+}
+
+/*
+ * tag propagation (analysis function)
+ *
+ * double precision right shift of a 32-bit memory location
+ * and a 32-bit register by whole bytes as
+ * t[dst] = t[dst] >> n | t[src] << (32 - n)
+ *
+ * @thread_ctx:	the thread context
+ * @dst:	destination memory address
+ * @src:	source register index (VCPU)
+ * @n:		the shift count in bits (8, 16, or 24)
+ */
+static void PIN_FAST_ANALYSIS_CALL
+r2m_shrd_opl(thread_ctx_t *thread_ctx, ADDRINT dst, uint32_t src, uint32_t n)
+{
+	/* temporaries */
+	uint32_t *taddr	= (uint32_t *)(dst + STAB[VIRT2STAB(dst)]);
+
+	*taddr = (*taddr >> n) | (thread_ctx->vcpu.gpr[src] << (32 - n));
+	TSUM_MARK(dst, sizeof(uint32_t), *taddr);
+}
+
+/*
+ * tag propagation (analysis function)
+ *
+ * double precision shift of a 32-bit memory location and
+ * a 32-bit register by an arbitrary count; every byte of
+ * dst gets the union of the tags of dst and src
+ *
+ * @thread_ctx:	the thread context
+ * @dst:	destination memory address
+ * @src:	source register index (VCPU)
+ */
+static void PIN_FAST_ANALYSIS_CALL
+r2m_union_opl(thread_ctx_t *thread_ctx, ADDRINT dst, uint32_t src)
+{
+	/* temporaries */
+	uint32_t *taddr	= (uint32_t *)(dst + STAB[VIRT2STAB(dst)]);
+	uint32_t tag	= *taddr | thread_ctx->vcpu.gpr[src];
+
+	/* fold and replicate */
+	tag |= (tag >> 16);
+	tag |= (tag >> 8);
+	*taddr = (tag & TAG_ALL8) * 0x01010101U;
+	TSUM_MARK(dst, sizeof(uint32_t), *taddr);
+}
+
+/*
+ * tag propagation (analysis function)
+ *
+ * double precision shift of a 16-bit memory location and
+ * a 16-bit register; both bytes of dst get the union of
+ * the tags of dst and src
+ *
+ * @thread_ctx:	the thread context
+ * @dst:	destination memory address
+ * @src:	source register index (VCPU)
+ */
+static void PIN_FAST_ANALYSIS_CALL
+r2m_union_opw(thread_ctx_t *thread_ctx, ADDRINT dst, uint32_t src)
+{
+	/* temporaries */
+	uint16_t *taddr	= (uint16_t *)(dst + STAB[VIRT2STAB(dst)]);
+	uint16_t tag	= *taddr | *((uint16_t *)&thread_ctx->vcpu.gpr[src]);
+
+	*taddr = ((tag | (tag >> 8)) & TAG_ALL8) * 0x0101U;
+	TSUM_MARK(dst, sizeof(uint16_t), *taddr);
+}
+
+/*
+ * operand classification (instrumentation function)
  *
- * save the tag values for all the 16-bit
- * general purpose registers into the memory
+ * pre-pass of ins_inspect(); it handles the operand patterns whose tag
+ * effect is known at instrumentation time, and leaves the rest to the
+ * default handlers:
  *
- * NOTE: special case for PUSHA instruction
+ * 	- tag no-ops get no analysis call at all (e.g., mov eax, eax,
+ * 	  xchg eax, eax, or eax, eax, lea esp, [esp + 8])
+ * 	- and/or with an immediate that forces bytes to a constant
+ * 	  (i.e., 0x00 and 0xFF respectively) clear the tags of those
+ * 	  bytes only (e.g., and eax, 0 clears eax, and eax, 0xFF keeps
+ * 	  the tag of al)
+ * 	- lea with the same base and index register moves a single tag
  *
- * @thread_ctx:	the thread context
- * @dst:	the destination memory address
+ * @ins:	the instruction to be instrumented
+ * @ins_indx:	the instruction class
+ *
+ * returns:	1 if the instruction was handled, 0 otherwise
  */
-static void PIN_FAST_ANALYSIS_CALL
-r2m_save_opw(thread_ctx_t *thread_ctx, ADDRINT dst)
+static size_t
+ins_elide(INS ins, xed_iclass_enum_t ins_indx)
 {
-	/* tagmap address */
-	uint32_t dst_val = dst + STAB[VIRT2STAB(dst)];
+	/* destination, source, base, and index registers */
+	REG reg_dst, reg_src, reg_base, reg_indx;
+	/* the immediate and its width */
+	UINT64 imm;
+	UINT32 width;
+	/* the tag bytes that are kept */
+	uint32_t mask;
+	/* operand size (bytes) and iterator */
+	USIZE sz, i;
+
+	/* classify */
+	switch (ins_indx) {
+		/* mov, xchg, cmovcc */
+		case XED_ICLASS_MOV:
+		case XED_ICLASS_XCHG:
+		case XED_ICLASS_CMOVB:
+		case XED_ICLASS_CMOVBE:
+		case XED_ICLASS_CMOVL:
+		case XED_ICLASS_CMOVLE:
+		case XED_ICLASS_CMOVNB:
+		case XED_ICLASS_CMOVNBE:
+		case XED_ICLASS_CMOVNL:
+		case XED_ICLASS_CMOVNLE:
+		case XED_ICLASS_CMOVNO:
+		case XED_ICLASS_CMOVNP:
+		case XED_ICLASS_CMOVNS:
+		case XED_ICLASS_CMOVNZ:
+		case XED_ICLASS_CMOVO:
+		case XED_ICLASS_CMOVP:
+		case XED_ICLASS_CMOVS:
+		case XED_ICLASS_CMOVZ:
+		/* add, adc; t[dst] |= t[dst] */
+		case XED_ICLASS_ADD:
+		case XED_ICLASS_ADC:
+			/* both operands are the same register; no-op */
+			if (INS_OperandIsReg(ins, OP_0) &&
+					INS_OperandIsReg(ins, OP_1) &&
+					INS_OperandReg(ins, OP_0) ==
+					INS_OperandReg(ins, OP_1)) {
+				elide_stats.nop++;
+				return 1;
+			}
 
-	/* save DI */
-	*(uint16_t *)dst_val =  *((uint16_t *)&thread_ctx->vcpu.gpr[0]);
+			/* default handler */
+			return 0;
+		/* and, or */
+		case XED_ICLASS_AND:
+		case XED_ICLASS_OR:
+			/* both operands are the same register; no-op */
+			if (INS_OperandIsReg(ins, OP_0) &&
+					INS_OperandIsReg(ins, OP_1) &&
+					INS_OperandReg(ins, OP_0) ==
+					INS_OperandReg(ins, OP_1)) {
+				elide_stats.nop++;
+				return 1;
+			}
 
-	/* save SI */
-	*(uint16_t *)(dst_val + 2) = *((uint16_t *)&thread_ctx->vcpu.gpr[1]);
+			/* not an immediate; default handler */
+			if (!INS_OperandIsImmediate(ins, OP_1))
+				return 0;
 
-	/* save BP */
-	*(uint16_t *)(dst_val + 4) = *((uint16_t *)&thread_ctx->vcpu.gpr[2]);
+			/* operand size */
+			if (INS_OperandIsReg(ins, OP_0)) {
+				reg_dst = INS_OperandReg(ins, OP_0);
+				sz = REG_is_gr32(reg_dst) ?
+					BIT2BYTE(MEM_LONG_LEN) :
+					(REG_is_gr16(reg_dst) ?
+					 BIT2BYTE(MEM_WORD_LEN) :
+					 BIT2BYTE(MEM_BYTE_LEN));
+			}
+			else {
+				reg_dst = REG_INVALID();
+				sz = INS_MemoryWriteSize(ins);
+			}
 
-	/* save SP */
-	*(uint16_t *)(dst_val + 6) = *((uint16_t *)&thread_ctx->vcpu.gpr[3]);
+			/* the immediate; sign-extended to the operand size */
+			imm	= INS_OperandImmediate(ins, OP_1);
+			width	= INS_OperandWidth(ins, OP_1);
+			if (width > 0 && width < 64) {
+				imm &= (1ULL << width) - 1;
+				if (imm & (1ULL << (width - 1)))
+					imm |= ~((1ULL << width) - 1);
+			}
 
-	/* save BX */
-	*(uint16_t *)(dst_val + 8) = *((uint16_t *)&thread_ctx->vcpu.gpr[4]);
+			/*
+			 * the bytes that are not forced to
+			 * a constant keep their tags
+			 */
+			for (i = 0, mask = 0; i < sz; i++)
+				if ((ins_indx == XED_ICLASS_AND) ?
+					(((imm >> (i << 3)) & 0xFF) != 0x00) :
+					(((imm >> (i << 3)) & 0xFF) != 0xFF))
+					mask |= (0xFFU << (i << 3));
 
-	/* save DX */
-	*(uint16_t *)(dst_val + 10) = *((uint16_t *)&thread_ctx->vcpu.gpr[5]);
+			/* no byte is forced; nothing to do (as before) */
+			if (mask == (uint32_t)((1ULL << (sz << 3)) - 1))
+				return 1;
 
-	/* save CX */
-	*(uint16_t *)(dst_val + 12) = *((uint16_t *)&thread_ctx->vcpu.gpr[6]);
+			/* register operand */
+			if (reg_dst != REG_INVALID()) {
+				/* every byte is forced; clear */
+				if (mask == 0 && sz == BIT2BYTE(MEM_LONG_LEN))
+					DFT_INS_CALL(ins,
+						IPOINT_BEFORE,
+						(AFUNPTR)r_clrl,
+						IARG_FAST_ANALYSIS_CALL,
+						IARG_REG_VALUE, thread_ctx_ptr,
+					IARG_UINT32, REG32_INDX(reg_dst),
+						IARG_END);
+				else if (mask == 0 &&
+						sz == BIT2BYTE(MEM_WORD_LEN))
+					DFT_INS_CALL(ins,
+						IPOINT_BEFORE,
+						(AFUNPTR)r_clrw,
+						IARG_FAST_ANALYSIS_CALL,
+						IARG_REG_VALUE, thread_ctx_ptr,
+					IARG_UINT32, REG16_INDX(reg_dst),
+						IARG_END);
+				else if (sz == BIT2BYTE(MEM_BYTE_LEN))
+					DFT_INS_CALL(ins,
+						IPOINT_BEFORE,
+						REG_is_Upper8(reg_dst) ?
+							(AFUNPTR)r_clrb_u :
+							(AFUNPTR)r_clrb_l,
+						IARG_FAST_ANALYSIS_CALL,
+						IARG_REG_VALUE, thread_ctx_ptr,
+						IARG_UINT32, REG8_INDX(reg_dst),
+						IARG_END);
+				/* some bytes are forced; mask them out */
+				else
+					DFT_INS_CALL(ins,
+						IPOINT_BEFORE,
+						(AFUNPTR)r_andl,
+						IARG_FAST_ANALYSIS_CALL,
+						IARG_REG_VALUE, thread_ctx_ptr,
+						IARG_UINT32,
+						(sz == BIT2BYTE(MEM_LONG_LEN)) ?
+							REG32_INDX(reg_dst) :
+							REG16_INDX(reg_dst),
+						IARG_UINT32,
+						(sz == BIT2BYTE(MEM_LONG_LEN)) ?
+							mask : (mask | 0xFFFF0000U),
+						IARG_END);
+			}
+			/* memory operand */
+			else {
+				/* every byte is forced; clear */
+				if (mask == 0)
+					DFT_INS_CALL(ins,
+						IPOINT_BEFORE,
+						(sz == BIT2BYTE(MEM_LONG_LEN)) ?
+							(AFUNPTR)tagmap_clrl :
+						((sz == BIT2BYTE(MEM_WORD_LEN)) ?
+							(AFUNPTR)tagmap_clrw :
+							(AFUNPTR)tagmap_clrb),
+						IARG_FAST_ANALYSIS_CALL,
+						IARG_MEMORYWRITE_EA,
+						IARG_END);
+				/* some bytes are forced; mask them out */
+				else
+					DFT_INS_CALL(ins,
+						IPOINT_BEFORE,
+						(sz == BIT2BYTE(MEM_LONG_LEN)) ?
+							(AFUNPTR)m_andl :
+							(AFUNPTR)m_andw,
+						IARG_FAST_ANALYSIS_CALL,
+						IARG_MEMORYWRITE_EA,
+						IARG_UINT32, mask,
+						IARG_END);
+			}
 
-	/* save AX */
-	*(uint16_t *)(dst_val + 14) = *((uint16_t *)&thread_ctx->vcpu.gpr[7]);
+			/* update the statistics */
+			if (mask == 0)
+				elide_stats.clr++;
+			else
+				elide_stats.mask++;
+
+			/* done */
+			return 1;
+		/* lea */
+		case XED_ICLASS_LEA:
+			/* extract the operands */
+			reg_dst		= INS_OperandReg(ins, OP_0);
+			reg_base	= INS_MemoryBaseReg(ins);
+			reg_indx	= INS_MemoryIndexReg(ins);
+
+			/* 16-bit operands; default handler */
+			if (!REG_is_gr32(reg_dst))
+				return 0;
+
+			/* the single source register (if any) */
+			if (reg_base == REG_INVALID() || reg_base == reg_indx)
+				reg_src = reg_indx;
+			else if (reg_indx == REG_INVALID())
+				reg_src = reg_base;
+			else
+				/* base and index; default handler */
+				return 0;
+
+			/* no register; default handler (clear) */
+			if (reg_src == REG_INVALID())
+				return 0;
+
+			/*
+			 * pointer arithmetic on the register itself
+			 * (e.g., lea esp, [esp + 8]); no-op
+			 */
+			if (reg_src == reg_dst) {
+				elide_stats.nop++;
+				return 1;
+			}
+
+			/* same base and index register; a single tag */
+			if (reg_base == reg_indx) {
+				DFT_INS_CALL(ins,
+					IPOINT_BEFORE,
+					(AFUNPTR)r2r_xfer_opl,
+					IARG_FAST_ANALYSIS_CALL,
+					IARG_REG_VALUE, thread_ctx_ptr,
+					IARG_UINT32, REG32_INDX(reg_dst),
+					IARG_UINT32, REG32_INDX(reg_src),
+					IARG_END);
+				elide_stats.mask++;
+				return 1;
+			}
+
+			/* default handler */
+			return 0;
+		/* default handler */
+		default:
+			return 0;
+	}
 }
 
 /*
- * tag propagation (analysis function)
+ * elided analysis calls (fini callback)
  *
- * save the tag values for all the 32-bit
- * general purpose registers into the memory
+ * report the instructions that the operand
+ * classification of ins_elide() handled
  *
- * NOTE: special case for PUSHAD instruction 
+ * @code:	OS specific termination code
+ * @v:		callback value
+ */
+void
+ins_elide_fini(INT32 code, VOID *v)
+{
+	/* report */
+	LOG(string(__func__) + ": no-op=" + decstr(elide_stats.nop) +
+		" clear=" + decstr(elide_stats.clr) +
+		" narrowed=" + decstr(elide_stats.mask) + "\n");
+}
+
+/*
+ * shift and rotate inspection (instrumentation function)
  *
- * @thread_ctx:	the thread context
- * @dst:	the destination memory address
+ * shifts and rotates by an immediate count that is a multiple of 8
+ * move whole bytes, hence their tags are moved the same way; every
+ * other count (including CL, and the rotates through the carry flag)
+ * mixes adjacent bytes, and the operand gets the union of its tags.
+ * 8-bit operands keep their tags either way
+ *
+ * @ins:	the instruction to be instrumented
+ * @ins_indx:	the instruction class
  */
-static void PIN_FAST_ANALYSIS_CALL
-r2m_save_opl(thread_ctx_t *thread_ctx, ADDRINT dst)
+static void
+ins_shift(INS ins, xed_iclass_enum_t ins_indx)
 {
-	/* tagmap address */
-	uint32_t dst_val = dst + STAB[VIRT2STAB(dst)];
+	/* destination register */
+	REG reg_dst;
+	/* shift count (bits); 0 if not byte-granular */
+	uint32_t n = 0;
+	/* operand size (bytes) */
+	USIZE sz;
+	/* analysis functions; register and memory operand */
+	AFUNPTR rfn = (AFUNPTR)NULL, mfn = (AFUNPTR)NULL;
+
+	/* immediate count; masked like the processor does */
+	if (INS_OperandIsImmediate(ins, OP_1)) {
+		n = (uint32_t)INS_OperandImmediate(ins, OP_1) & 0x1F;
+
+		/* no shift; the flags are not tracked */
+		if (n == 0)
+			return;
+
+		/* the rotates through carry mix CF in */
+		if ((n & 0x7) != 0 || ins_indx == XED_ICLASS_RCL ||
+				ins_indx == XED_ICLASS_RCR)
+			n = 0;
+	}
 
-	/* save EDI */
-	*(uint32_t *)dst_val = thread_ctx->vcpu.gpr[0];
+	/* operand size */
+	if (INS_OperandIsReg(ins, OP_0)) {
+		reg_dst = INS_OperandReg(ins, OP_0);
+		sz = REG_is_gr32(reg_dst) ? BIT2BYTE(MEM_LONG_LEN) :
+			(REG_is_gr16(reg_dst) ? BIT2BYTE(MEM_WORD_LEN) : 1);
+	}
+	else {
+		reg_dst = REG_INVALID();
+		sz = INS_MemoryWriteSize(ins);
+	}
 
-	/* save ESI */
-	*(uint32_t *)(dst_val + 4) = thread_ctx->vcpu.gpr[1];
+	/* 16-bit operands; only shifts by a byte are byte-granular */
+	if (sz == BIT2BYTE(MEM_WORD_LEN) && n != 8)
+		n = 0;
 
-	/* save EBP */
-	*(uint32_t *)(dst_val + 8) = thread_ctx->vcpu.gpr[2];
+	/* select the analysis functions */
+	if (sz == BIT2BYTE(MEM_LONG_LEN)) {
+		switch (n == 0 ? XED_ICLASS_INVALID : ins_indx) {
+			case XED_ICLASS_SHL:
+				rfn = (AFUNPTR)r_shl_opl;
+				mfn = (AFUNPTR)m_shl_opl;
+				break;
+			case XED_ICLASS_SHR:
+				rfn = (AFUNPTR)r_shr_opl;
+				mfn = (AFUNPTR)m_shr_opl;
+				break;
+			case XED_ICLASS_SAR:
+				rfn = (AFUNPTR)r_sar_opl;
+				mfn = (AFUNPTR)m_sar_opl;
+				break;
+			/* ror by n is rol by 32 - n */
+			case XED_ICLASS_ROR:
+				n = 32 - n;
+				/* fall through */
+			case XED_ICLASS_ROL:
+				rfn = (AFUNPTR)r_rol_opl;
+				mfn = (AFUNPTR)m_rol_opl;
+				break;
+			default:
+				rfn = (AFUNPTR)r_union_opl;
+				mfn = (AFUNPTR)m_union_opl;
+				n = 0;
+				break;
+		}
+	}
+	else if (sz == BIT2BYTE(MEM_WORD_LEN)) {
+		switch (n == 0 ? XED_ICLASS_INVALID : ins_indx) {
+			case XED_ICLASS_SHL:
+				rfn = (AFUNPTR)r_shl_opw;
+				mfn = (AFUNPTR)m_shl_opw;
+				break;
+			case XED_ICLASS_SHR:
+				rfn = (AFUNPTR)r_shr_opw;
+				mfn = (AFUNPTR)m_shr_opw;
+				break;
+			case XED_ICLASS_SAR:
+				rfn = (AFUNPTR)r_sar_opw;
+				mfn = (AFUNPTR)m_sar_opw;
+				break;
+			case XED_ICLASS_ROR:
+			case XED_ICLASS_ROL:
+				rfn = (AFUNPTR)r_rol_opw;
+				mfn = (AFUNPTR)m_rol_opw;
+				break;
+			default:
+				rfn = (AFUNPTR)r_union_opw;
+				mfn = (AFUNPTR)m_union_opw;
+				break;
+		}
 
-	/* save ESP */
-	*(uint32_t *)(dst_val + 12) = thread_ctx->vcpu.gpr[3];
+		/* the 16-bit handlers shift by a byte */
+		n = 0;
+	}
+	/* 8-bit operands; nothing to do */
+	else
+		return;
 
-	/* save EBX */
-	*(uint32_t *)(dst_val + 16) = thread_ctx->vcpu.gpr[4];
+	/* register operand */
+	if (reg_dst != REG_INVALID()) {
+		/* byte-granular (32-bit) */
+		if (n != 0)
+			DFT_INS_CALL(ins,
+				IPOINT_BEFORE,
+				rfn,
+				IARG_FAST_ANALYSIS_CALL,
+				IARG_REG_VALUE, thread_ctx_ptr,
+				IARG_UINT32, REG32_INDX(reg_dst),
+				IARG_UINT32, n,
+				IARG_END);
+		/* union, or 16-bit */
+		else
+			DFT_INS_CALL(ins,
+				IPOINT_BEFORE,
+				rfn,
+				IARG_FAST_ANALYSIS_CALL,
+				IARG_REG_VALUE, thread_ctx_ptr,
+				IARG_UINT32, (sz == BIT2BYTE(MEM_LONG_LEN)) ?
+					REG32_INDX(reg_dst) :
+					REG16_INDX(reg_dst),
+				IARG_END);
+	}
+	/* memory operand */
+	else {
+		/* byte-granular (32-bit) */
+		if (n != 0)
+			DFT_INS_CALL(ins,
+				IPOINT_BEFORE,
+				mfn,
+				IARG_FAST_ANALYSIS_CALL,
+				IARG_MEMORYWRITE_EA,
+				IARG_UINT32, n,
+				IARG_END);
+		/* union, or 16-bit */
+		else
+			DFT_INS_CALL(ins,
+				IPOINT_BEFORE,
+				mfn,
+				IARG_FAST_ANALYSIS_CALL,
+				IARG_MEMORYWRITE_EA,
+				IARG_END);
+	}
+}
 
-	/* save EDX */
-	*(uint32_t *)(dst_val + 20) = thread_ctx->vcpu.gpr[5];
+/*
+ * double precision shift inspection (instrumentation function)
+ *
+ * same as ins_shift(); shld and shrd by an immediate count that is a
+ * multiple of 8 move whole bytes of src into dst, whereas every other
+ * count gives dst the union of the tags of both operands. 16-bit
+ * operands always get the union
+ *
+ * @ins:	the instruction to be instrumented
+ * @ins_indx:	the instruction class
+ */
+static void
+ins_shiftd(INS ins, xed_iclass_enum_t ins_indx)
+{
+	/* source and destination registers */
+	REG reg_dst, reg_src = INS_OperandReg(ins, OP_1);
+	/* shift count (bits); 0 if not byte-granular */
+	uint32_t n = 0;
+
+	/* immediate count; masked like the processor does */
+	if (INS_OperandIsImmediate(ins, OP_2)) {
+		n = (uint32_t)INS_OperandImmediate(ins, OP_2) & 0x1F;
+
+		/* no shift; the flags are not tracked */
+		if (n == 0)
+			return;
+
+		/* not byte-granular */
+		if ((n & 0x7) != 0 || !REG_is_gr32(reg_src))
+			n = 0;
+	}
 
-	/* save ECX */
-	*(uint32_t *)(dst_val + 24) = thread_ctx->vcpu.gpr[6];
+	/* register operand */
+	if (INS_OperandIsReg(ins, OP_0)) {
+		reg_dst = INS_OperandReg(ins, OP_0);
 
-	/* save EAX */
-	*(uint32_t *)(dst_val + 28) = thread_ctx->vcpu.gpr[7];
+		/* byte-granular (32-bit) */
+		if (n != 0)
+			DFT_INS_CALL(ins,
+				IPOINT_BEFORE,
+				(ins_indx == XED_ICLASS_SHLD) ?
+					(AFUNPTR)r2r_shld_opl :
+					(AFUNPTR)r2r_shrd_opl,
+				IARG_FAST_ANALYSIS_CALL,
+				IARG_REG_VALUE, thread_ctx_ptr,
+				IARG_UINT32, REG32_INDX(reg_dst),
+				IARG_UINT32, REG32_INDX(reg_src),
+				IARG_UINT32, n,
+				IARG_END);
+		/* 32-bit operands */
+		else if (REG_is_gr32(reg_dst))
+			DFT_INS_CALL(ins,
+				IPOINT_BEFORE,
+				(AFUNPTR)r2r_union_opl,
+				IARG_FAST_ANALYSIS_CALL,
+				IARG_REG_VALUE, thread_ctx_ptr,
+				IARG_UINT32, REG32_INDX(reg_dst),
+				IARG_UINT32, REG32_INDX(reg_src),
+				IARG_END);
+		/* 16-bit operands */
+		else
+			DFT_INS_CALL(ins,
+				IPOINT_BEFORE,
+				(AFUNPTR)r2r_union_opw,
+				IARG_FAST_ANALYSIS_CALL,
+				IARG_REG_VALUE, thread_ctx_ptr,
+				IARG_UINT32, REG16_INDX(reg_dst),
+				IARG_UINT32, REG16_INDX(reg_src),
+				IARG_END);
+	}
+	/* memory operand */
+	else {
+		/* byte-granular (32-bit) */
+		if (n != 0)
+			DFT_INS_CALL(ins,
+				IPOINT_BEFORE,
+				(ins_indx == XED_ICLASS_SHLD) ?
+					(AFUNPTR)r2m_shld_opl :
+					(AFUNPTR)r2m_shrd_opl,
+				IARG_FAST_ANALYSIS_CALL,
+				IARG_REG_VALUE, thread_ctx_ptr,
+				IARG_MEMORYWRITE_EA,
+				IARG_UINT32, REG32_INDX(reg_src),
+				IARG_UINT32, n,
+				IARG_END);
+		/* 32-bit operands */
+		else if (REG_is_gr32(reg_src))
+			DFT_INS_CALL(ins,
+				IPOINT_BEFORE,
+				(AFUNPTR)r2m_union_opl,
+				IARG_FAST_ANALYSIS_CALL,
+				IARG_REG_VALUE, thread_ctx_ptr,
+				IARG_MEMORYWRITE_EA,
+				IARG_UINT32, REG32_INDX(reg_src),
+				IARG_END);
+		/* 16-bit operands */
+		else
+			DFT_INS_CALL(ins,
+				IPOINT_BEFORE,
+				(AFUNPTR)r2m_union_opw,
+				IARG_FAST_ANALYSIS_CALL,
+				IARG_REG_VALUE, thread_ctx_ptr,
+				IARG_MEMORYWRITE_EA,
+				IARG_UINT32, REG16_INDX(reg_src),
+				IARG_END);
+	}
 }
 
 /*
@@ -2147,6 +3289,11 @@ ins_inspect(INS ins)
 		return;
 	}
 
+	/* the tag effect is known at instrumentation time */
+	if (ins_elide(ins, ins_indx))
+		/* done */
+		return;
+
 	/* analyze the instruction */
 	switch (ins_indx) {
 		/* adc */
@@ -2192,7 +3339,7 @@ ins_inspect(INS ins)
 							if (reg_dst == reg_src) 
 							{
 								/* clear */
-							INS_InsertCall(ins,
+							DFT_INS_CALL(ins,
 								IPOINT_BEFORE,
 								(AFUNPTR)r_clrl,
 							IARG_FAST_ANALYSIS_CALL,
@@ -2211,7 +3358,7 @@ ins_inspect(INS ins)
 							 * propagate the tag
 							 * markings accordingly
 							 */
-							INS_InsertCall(ins,
+							DFT_INS_CALL(ins,
 							IPOINT_BEFORE,
 							(AFUNPTR)r2r_binary_opl,
 							IARG_FAST_ANALYSIS_CALL,
@@ -2236,7 +3383,7 @@ ins_inspect(INS ins)
 							if (reg_dst == reg_src) 
 							{
 								/* clear */
-							INS_InsertCall(ins,
+							DFT_INS_CALL(ins,
 								IPOINT_BEFORE,
 								(AFUNPTR)r_clrw,
 							IARG_FAST_ANALYSIS_CALL,
@@ -2252,7 +3399,7 @@ ins_inspect(INS ins)
 						/* default behavior */
 						default:
 						/* propagate tags accordingly */
-							INS_InsertCall(ins,
+							DFT_INS_CALL(ins,
 								IPOINT_BEFORE,
 							(AFUNPTR)r2r_binary_opw,
 							IARG_FAST_ANALYSIS_CALL,
@@ -2279,7 +3426,7 @@ ins_inspect(INS ins)
 							/* 8-bit upper */
 						if (REG_is_Upper8(reg_dst))
 								/* clear */
-							INS_InsertCall(ins,
+							DFT_INS_CALL(ins,
 								IPOINT_BEFORE,
 							(AFUNPTR)r_clrb_u,
 							IARG_FAST_ANALYSIS_CALL,
@@ -2291,7 +3438,7 @@ ins_inspect(INS ins)
 							/* 8-bit lower */
 						else 
 								/* clear */
-							INS_InsertCall(ins,
+							DFT_INS_CALL(ins,
 								IPOINT_BEFORE,
 							(AFUNPTR)r_clrb_l,
 							IARG_FAST_ANALYSIS_CALL,
@@ -2310,7 +3457,7 @@ ins_inspect(INS ins)
 					if (REG_is_Lower8(reg_dst) &&
 							REG_is_Lower8(reg_src))
 						/* lower 8-bit registers */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_binary_opb_l,
 						IARG_FAST_ANALYSIS_CALL,
@@ -2321,7 +3468,7 @@ ins_inspect(INS ins)
 					else if(REG_is_Upper8(reg_dst) &&
 							REG_is_Upper8(reg_src))
 						/* upper 8-bit registers */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_binary_opb_u,
 						IARG_FAST_ANALYSIS_CALL,
@@ -2336,7 +3483,7 @@ ins_inspect(INS ins)
 						 * source register is an upper
 						 * 8-bit register
 						 */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_binary_opb_lu,
 						IARG_FAST_ANALYSIS_CALL,
@@ -2351,7 +3498,7 @@ ins_inspect(INS ins)
 						 * source register is a lower
 						 * 8-bit register
 						 */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_binary_opb_ul,
 						IARG_FAST_ANALYSIS_CALL,
@@ -2376,7 +3523,7 @@ ins_inspect(INS ins)
 				/* 32-bit operands */
 				if (REG_is_gr32(reg_dst))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)m2r_binary_opl,
 						IARG_FAST_ANALYSIS_CALL,
@@ -2387,7 +3534,7 @@ ins_inspect(INS ins)
 				/* 16-bit operands */
 				else if (REG_is_gr16(reg_dst))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)m2r_binary_opw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -2398,7 +3545,7 @@ ins_inspect(INS ins)
 				/* 8-bit operand (upper) */
 				else if (REG_is_Upper8(reg_dst))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)m2r_binary_opb_u,
 						IARG_FAST_ANALYSIS_CALL,
@@ -2409,7 +3556,7 @@ ins_inspect(INS ins)
 				/* 8-bit operand (lower) */
 				else 
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)m2r_binary_opb_l,
 						IARG_FAST_ANALYSIS_CALL,
@@ -2426,7 +3573,7 @@ ins_inspect(INS ins)
 				/* 32-bit operands */
 				if (REG_is_gr32(reg_src))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2m_binary_opl,
 						IARG_FAST_ANALYSIS_CALL,
@@ -2437,7 +3584,7 @@ ins_inspect(INS ins)
 				/* 16-bit operands */
 				else if (REG_is_gr16(reg_src))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2m_binary_opw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -2448,7 +3595,7 @@ ins_inspect(INS ins)
 				/* 8-bit operand (upper) */
 				else if (REG_is_Upper8(reg_src))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2m_binary_opb_u,
 						IARG_FAST_ANALYSIS_CALL,
@@ -2459,7 +3606,7 @@ ins_inspect(INS ins)
 				/* 8-bit operand (lower) */
 				else
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2m_binary_opb_l,
 						IARG_FAST_ANALYSIS_CALL,
@@ -2509,7 +3656,7 @@ ins_inspect(INS ins)
 						/* 4 bytes */
 						case MEM_LONG_LEN:
 					/* propagate the tag accordingly */
-						INS_InsertCall(ins,
+						DFT_INS_CALL(ins,
 							IPOINT_BEFORE,
 							(AFUNPTR)tagmap_clrl,
 							IARG_FAST_ANALYSIS_CALL,
@@ -2521,7 +3668,7 @@ ins_inspect(INS ins)
 						/* 2 bytes */
 						case MEM_WORD_LEN:
 					/* propagate the tag accordingly */
-						INS_InsertCall(ins,
+						DFT_INS_CALL(ins,
 							IPOINT_BEFORE,
 							(AFUNPTR)tagmap_clrw,
 							IARG_FAST_ANALYSIS_CALL,
@@ -2533,7 +3680,7 @@ ins_inspect(INS ins)
 						/* 1 byte */
 						case MEM_BYTE_LEN:
 					/* propagate the tag accordingly */
-						INS_InsertCall(ins,
+						DFT_INS_CALL(ins,
 							IPOINT_BEFORE,
 							(AFUNPTR)tagmap_clrb,
 							IARG_FAST_ANALYSIS_CALL,
@@ -2560,7 +3707,7 @@ ins_inspect(INS ins)
 					/* 32-bit operand */
 					if (REG_is_gr32(reg_dst))
 					/* propagate the tag accordingly */
-						INS_InsertCall(ins,
+						DFT_INS_CALL(ins,
 							IPOINT_BEFORE,
 							(AFUNPTR)r_clrl,
 							IARG_FAST_ANALYSIS_CALL,
@@ -2570,7 +3717,7 @@ ins_inspect(INS ins)
 					/* 16-bit operand */
 					else if (REG_is_gr16(reg_dst))
 					/* propagate the tag accordingly */
-						INS_InsertCall(ins,
+						DFT_INS_CALL(ins,
 							IPOINT_BEFORE,
 							(AFUNPTR)r_clrw,
 							IARG_FAST_ANALYSIS_CALL,
@@ -2580,7 +3727,7 @@ ins_inspect(INS ins)
 					/* 8-bit operand (upper) */
 					else if (REG_is_Upper8(reg_dst))
 					/* propagate the tag accordingly */
-						INS_InsertCall(ins,
+						DFT_INS_CALL(ins,
 							IPOINT_BEFORE,
 							(AFUNPTR)r_clrb_u,
 							IARG_FAST_ANALYSIS_CALL,
@@ -2590,7 +3737,7 @@ ins_inspect(INS ins)
 					/* 8-bit operand (lower) */
 					else
 					/* propagate the tag accordingly */
-						INS_InsertCall(ins,
+						DFT_INS_CALL(ins,
 							IPOINT_BEFORE,
 							(AFUNPTR)r_clrb_l,
 							IARG_FAST_ANALYSIS_CALL,
@@ -2608,7 +3755,7 @@ ins_inspect(INS ins)
 				/* 32-bit operands */
 				if (REG_is_gr32(reg_dst))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opl,
 						IARG_FAST_ANALYSIS_CALL,
@@ -2619,7 +3766,7 @@ ins_inspect(INS ins)
 				/* 16-bit operands */
 				else if (REG_is_gr16(reg_dst))
 					/* propagate tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -2633,7 +3780,7 @@ ins_inspect(INS ins)
 					if (REG_is_Lower8(reg_dst) &&
 							REG_is_Lower8(reg_src))
 						/* lower 8-bit registers */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opb_l,
 						IARG_FAST_ANALYSIS_CALL,
@@ -2644,7 +3791,7 @@ ins_inspect(INS ins)
 					else if(REG_is_Upper8(reg_dst) &&
 							REG_is_Upper8(reg_src))
 						/* upper 8-bit registers */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opb_u,
 						IARG_FAST_ANALYSIS_CALL,
@@ -2659,7 +3806,7 @@ ins_inspect(INS ins)
 						 * source register is an upper
 						 * 8-bit register
 						 */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opb_lu,
 						IARG_FAST_ANALYSIS_CALL,
@@ -2674,7 +3821,7 @@ ins_inspect(INS ins)
 						 * source register is a lower
 						 * 8-bit register
 						 */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opb_ul,
 						IARG_FAST_ANALYSIS_CALL,
@@ -2698,7 +3845,7 @@ ins_inspect(INS ins)
 				/* 32-bit operands */
 				if (REG_is_gr32(reg_dst))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)m2r_xfer_opl,
 						IARG_FAST_ANALYSIS_CALL,
@@ -2709,7 +3856,7 @@ ins_inspect(INS ins)
 				/* 16-bit operands */
 				else if (REG_is_gr16(reg_dst))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)m2r_xfer_opw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -2720,7 +3867,7 @@ ins_inspect(INS ins)
 				/* 8-bit operands (upper) */
 				else if (REG_is_Upper8(reg_dst)) 
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)m2r_xfer_opb_u,
 						IARG_FAST_ANALYSIS_CALL,
@@ -2731,7 +3878,7 @@ ins_inspect(INS ins)
 				/* 8-bit operands (lower) */
 				else
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)m2r_xfer_opb_l,
 						IARG_FAST_ANALYSIS_CALL,
@@ -2748,7 +3895,7 @@ ins_inspect(INS ins)
 				/* 32-bit operands */
 				if (REG_is_gr32(reg_src))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2m_xfer_opl,
 						IARG_FAST_ANALYSIS_CALL,
@@ -2759,7 +3906,7 @@ ins_inspect(INS ins)
 				/* 16-bit operands */
 				else if (REG_is_gr16(reg_src))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2m_xfer_opw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -2770,7 +3917,7 @@ ins_inspect(INS ins)
 				/* 8-bit operands (upper) */
 				else if (REG_is_Upper8(reg_src))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2m_xfer_opb_u,
 						IARG_FAST_ANALYSIS_CALL,
@@ -2781,7 +3928,7 @@ ins_inspect(INS ins)
 				/* 8-bit operands (lower) */
 				else 
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2m_xfer_opb_l,
 						IARG_FAST_ANALYSIS_CALL,
@@ -2826,7 +3973,7 @@ ins_inspect(INS ins)
 				/* 32-bit operands */
 				if (REG_is_gr32(reg_dst))
 					/* propagate the tag accordingly */
-					INS_InsertPredicatedCall(ins,
+					DFT_INS_PCALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opl,
 						IARG_FAST_ANALYSIS_CALL,
@@ -2837,7 +3984,7 @@ ins_inspect(INS ins)
 				/* 16-bit operands */
 				else 
 					/* propagate tag accordingly */
-					INS_InsertPredicatedCall(ins,
+					DFT_INS_PCALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -2860,7 +4007,7 @@ ins_inspect(INS ins)
 				/* 32-bit operands */
 				if (REG_is_gr32(reg_dst))
 					/* propagate the tag accordingly */
-					INS_InsertPredicatedCall(ins,
+					DFT_INS_PCALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)m2r_xfer_opl,
 						IARG_FAST_ANALYSIS_CALL,
@@ -2871,7 +4018,7 @@ ins_inspect(INS ins)
 				/* 16-bit operands */
 				else
 					/* propagate the tag accordingly */
-					INS_InsertPredicatedCall(ins,
+					DFT_INS_PCALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)m2r_xfer_opw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -2892,7 +4039,7 @@ ins_inspect(INS ins)
 		 */
 		case XED_ICLASS_CBW:
 			/* propagate the tag accordingly */
-			INS_InsertCall(ins,
+			DFT_INS_CALL(ins,
 				IPOINT_BEFORE,
 				(AFUNPTR)r2r_xfer_opb_ul,
 				IARG_FAST_ANALYSIS_CALL,
@@ -2912,7 +4059,7 @@ ins_inspect(INS ins)
 		 */
 		case XED_ICLASS_CWD:
 			/* propagate the tag accordingly */
-			INS_InsertCall(ins,
+			DFT_INS_CALL(ins,
 				IPOINT_BEFORE,
 				(AFUNPTR)r2r_xfer_opw,
 				IARG_FAST_ANALYSIS_CALL,
@@ -2932,7 +4079,7 @@ ins_inspect(INS ins)
 		 */
 		case XED_ICLASS_CWDE:
 			/* propagate the tag accordingly */
-			INS_InsertCall(ins,
+			DFT_INS_CALL(ins,
 				IPOINT_BEFORE,
 				(AFUNPTR)_cwde,
 				IARG_FAST_ANALYSIS_CALL,
@@ -2950,7 +4097,7 @@ ins_inspect(INS ins)
 		 */
 		case XED_ICLASS_CDQ:
 			/* propagate the tag accordingly */
-			INS_InsertCall(ins,
+			DFT_INS_CALL(ins,
 				IPOINT_BEFORE,
 				(AFUNPTR)r2r_xfer_opl,
 				IARG_FAST_ANALYSIS_CALL,
@@ -2986,7 +4133,7 @@ ins_inspect(INS ins)
 					/* upper 8-bit */
 					if (REG_is_Upper8(reg_src))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_movsx_r2r_opwb_u,
 						IARG_FAST_ANALYSIS_CALL,
@@ -2996,7 +4143,7 @@ ins_inspect(INS ins)
 						IARG_END);
 					else
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_movsx_r2r_opwb_l,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3008,7 +4155,7 @@ ins_inspect(INS ins)
 				/* 32-bit & 16-bit operands */
 				else if (REG_is_gr16(reg_src))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_movsx_r2r_oplw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3019,7 +4166,7 @@ ins_inspect(INS ins)
 				/* 32-bit & 8-bit operands (upper 8-bit) */
 				else if (REG_is_Upper8(reg_src))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_movsx_r2r_oplb_u,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3030,7 +4177,7 @@ ins_inspect(INS ins)
 				/* 32-bit & 8-bit operands (lower 8-bit) */
 				else
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_movsx_r2r_oplb_l,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3047,7 +4194,7 @@ ins_inspect(INS ins)
 				/* 16-bit & 8-bit operands */
 				if (REG_is_gr16(reg_dst))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_movsx_m2r_opwb,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3059,7 +4206,7 @@ ins_inspect(INS ins)
 				else if (INS_MemoryWriteSize(ins) ==
 						BIT2BYTE(MEM_WORD_LEN))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_movsx_m2r_oplw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3070,7 +4217,7 @@ ins_inspect(INS ins)
 				/* 32-bit & 8-bit operands */
 				else
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_movsx_m2r_oplb,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3108,7 +4255,7 @@ ins_inspect(INS ins)
 					/* upper 8-bit */
 					if (REG_is_Upper8(reg_src))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_movzx_r2r_opwb_u,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3118,7 +4265,7 @@ ins_inspect(INS ins)
 						IARG_END);
 					else
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_movzx_r2r_opwb_l,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3130,7 +4277,7 @@ ins_inspect(INS ins)
 				/* 32-bit & 16-bit operands */
 				else if (REG_is_gr16(reg_src))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_movzx_r2r_oplw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3141,7 +4288,7 @@ ins_inspect(INS ins)
 				/* 32-bit & 8-bit operands (upper 8-bit) */
 				else if (REG_is_Upper8(reg_src))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_movzx_r2r_oplb_u,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3152,7 +4299,7 @@ ins_inspect(INS ins)
 				/* 32-bit & 8-bit operands (lower 8-bit) */
 				else
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_movzx_r2r_oplb_l,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3169,7 +4316,7 @@ ins_inspect(INS ins)
 				/* 16-bit & 8-bit operands */
 				if (REG_is_gr16(reg_dst))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_movzx_m2r_opwb,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3181,7 +4328,7 @@ ins_inspect(INS ins)
 				else if (INS_MemoryWriteSize(ins) ==
 						BIT2BYTE(MEM_WORD_LEN))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_movzx_m2r_oplw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3192,7 +4339,7 @@ ins_inspect(INS ins)
 				/* 32-bit & 8-bit operands */
 				else
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_movzx_m2r_oplb,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3224,7 +4371,7 @@ ins_inspect(INS ins)
 					/* 4 bytes */
 					case BIT2BYTE(MEM_LONG_LEN):
 					/* propagate the tag accordingly */
-						INS_InsertCall(ins,
+						DFT_INS_CALL(ins,
 							IPOINT_BEFORE,
 						(AFUNPTR)m2r_ternary_opl,
 							IARG_FAST_ANALYSIS_CALL,
@@ -3237,7 +4384,7 @@ ins_inspect(INS ins)
 					/* 2 bytes */
 					case BIT2BYTE(MEM_WORD_LEN):
 					/* propagate the tag accordingly */
-						INS_InsertCall(ins,
+						DFT_INS_CALL(ins,
 							IPOINT_BEFORE,
 						(AFUNPTR)m2r_ternary_opw,
 							IARG_FAST_ANALYSIS_CALL,
@@ -3251,7 +4398,7 @@ ins_inspect(INS ins)
 					case BIT2BYTE(MEM_BYTE_LEN):
 					default:
 					/* propagate the tag accordingly */
-						INS_InsertCall(ins,
+						DFT_INS_CALL(ins,
 							IPOINT_BEFORE,
 						(AFUNPTR)m2r_ternary_opb,
 							IARG_FAST_ANALYSIS_CALL,
@@ -3270,7 +4417,7 @@ ins_inspect(INS ins)
 				/* 32-bit operand */
 				if (REG_is_gr32(reg_src))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_ternary_opl,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3280,7 +4427,7 @@ ins_inspect(INS ins)
 				/* 16-bit operand */
 				else if (REG_is_gr16(reg_src))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_ternary_opw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3290,7 +4437,7 @@ ins_inspect(INS ins)
 				/* 8-bit operand (upper) */
 				else if (REG_is_Upper8(reg_src))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_ternary_opb_u,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3300,7 +4447,7 @@ ins_inspect(INS ins)
 				/* 8-bit operand (lower) */
 				else 
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_ternary_opb_l,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3328,7 +4475,7 @@ ins_inspect(INS ins)
 					/* 4 bytes */
 					case BIT2BYTE(MEM_LONG_LEN):
 					/* propagate the tag accordingly */
-						INS_InsertCall(ins,
+						DFT_INS_CALL(ins,
 							IPOINT_BEFORE,
 						(AFUNPTR)m2r_ternary_opl,
 							IARG_FAST_ANALYSIS_CALL,
@@ -3341,7 +4488,7 @@ ins_inspect(INS ins)
 					/* 2 bytes */
 					case BIT2BYTE(MEM_WORD_LEN):
 					/* propagate the tag accordingly */
-						INS_InsertCall(ins,
+						DFT_INS_CALL(ins,
 							IPOINT_BEFORE,
 						(AFUNPTR)m2r_ternary_opw,
 							IARG_FAST_ANALYSIS_CALL,
@@ -3355,7 +4502,7 @@ ins_inspect(INS ins)
 					case BIT2BYTE(MEM_BYTE_LEN):
 					default:
 					/* propagate the tag accordingly */
-						INS_InsertCall(ins,
+						DFT_INS_CALL(ins,
 							IPOINT_BEFORE,
 						(AFUNPTR)m2r_ternary_opb,
 							IARG_FAST_ANALYSIS_CALL,
@@ -3374,7 +4521,7 @@ ins_inspect(INS ins)
 				/* 32-bit operand */
 				if (REG_is_gr32(reg_src))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_ternary_opl,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3384,7 +4531,7 @@ ins_inspect(INS ins)
 				/* 16-bit operand */
 				else if (REG_is_gr16(reg_src))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_ternary_opw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3394,7 +4541,7 @@ ins_inspect(INS ins)
 				/* 8-bit operand (upper) */
 				else if (REG_is_Upper8(reg_src))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_ternary_opb_u,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3404,7 +4551,7 @@ ins_inspect(INS ins)
 				/* 8-bit operand (lower) */
 				else
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_ternary_opb_l,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3428,7 +4575,7 @@ ins_inspect(INS ins)
 					/* 32-bit operands */
 					if (REG_is_gr32(reg_dst))
 					/* propagate the tag accordingly */
-						INS_InsertCall(ins,
+						DFT_INS_CALL(ins,
 							IPOINT_BEFORE,
 							(AFUNPTR)r2r_binary_opl,
 							IARG_FAST_ANALYSIS_CALL,
@@ -3439,7 +4586,7 @@ ins_inspect(INS ins)
 					/* 16-bit operands */
 					else
 					/* propagate tag accordingly */
-						INS_InsertCall(ins,
+						DFT_INS_CALL(ins,
 							IPOINT_BEFORE,
 							(AFUNPTR)r2r_binary_opw,
 							IARG_FAST_ANALYSIS_CALL,
@@ -3462,7 +4609,7 @@ ins_inspect(INS ins)
 					/* 32-bit operands */
 					if (REG_is_gr32(reg_dst))
 					/* propagate the tag accordingly */
-						INS_InsertCall(ins,
+						DFT_INS_CALL(ins,
 							IPOINT_BEFORE,
 							(AFUNPTR)m2r_binary_opl,
 							IARG_FAST_ANALYSIS_CALL,
@@ -3473,7 +4620,7 @@ ins_inspect(INS ins)
 					/* 16-bit operands */
 					else
 					/* propagate the tag accordingly */
-						INS_InsertCall(ins,
+						DFT_INS_CALL(ins,
 							IPOINT_BEFORE,
 							(AFUNPTR)m2r_binary_opw,
 							IARG_FAST_ANALYSIS_CALL,
@@ -3515,7 +4662,7 @@ ins_inspect(INS ins)
 				/* 8-bit operand (upper) */
 				if (REG_is_Upper8(reg_dst))	
 					/* propagate tag accordingly */
-					INS_InsertPredicatedCall(ins,
+					DFT_INS_PCALL(ins,
 							IPOINT_BEFORE,
 						(AFUNPTR)r_clrb_u,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3525,7 +4672,7 @@ ins_inspect(INS ins)
 				/* 8-bit operand (lower) */
 				else 
 					/* propagate tag accordingly */
-					INS_InsertPredicatedCall(ins,
+					DFT_INS_PCALL(ins,
 							IPOINT_BEFORE,
 						(AFUNPTR)r_clrb_l,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3536,7 +4683,7 @@ ins_inspect(INS ins)
 			/* memory operand */
 			else
 				/* propagate the tag accordingly */
-				INS_InsertPredicatedCall(ins,
+				DFT_INS_PCALL(ins,
 					IPOINT_BEFORE,
 					(AFUNPTR)tagmap_clrb,
 					IARG_FAST_ANALYSIS_CALL,
@@ -3551,7 +4698,7 @@ ins_inspect(INS ins)
 		 */
 		case XED_ICLASS_STMXCSR:
 			/* propagate tag accordingly */
-			INS_InsertCall(ins,
+			DFT_INS_CALL(ins,
 				IPOINT_BEFORE,
 				(AFUNPTR)tagmap_clrl,
 				IARG_FAST_ANALYSIS_CALL,
@@ -3586,7 +4733,7 @@ ins_inspect(INS ins)
 				/* 16-bit register */
 				if (REG_is_gr16(reg_dst))
 					/* propagate tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r_clrw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3596,7 +4743,7 @@ ins_inspect(INS ins)
 				/* 32-bit register */
 				else 
 					/* propagate tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r_clrl,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3607,7 +4754,7 @@ ins_inspect(INS ins)
 			/* memory operand */
 			else
 				/* propagate tag accordingly */
-				INS_InsertCall(ins,
+				DFT_INS_CALL(ins,
 					IPOINT_BEFORE,
 					(AFUNPTR)tagmap_clrw,
 					IARG_FAST_ANALYSIS_CALL,
@@ -3627,7 +4774,7 @@ ins_inspect(INS ins)
 			/* 16-bit register */
 			if (REG_is_gr16(reg_dst))
 				/* propagate tag accordingly */
-				INS_InsertCall(ins,
+				DFT_INS_CALL(ins,
 					IPOINT_BEFORE,
 					(AFUNPTR)r_clrw,
 					IARG_FAST_ANALYSIS_CALL,
@@ -3637,7 +4784,7 @@ ins_inspect(INS ins)
 			/* 32-bit register */
 			else
 				/* propagate tag accordingly */
-				INS_InsertCall(ins,
+				DFT_INS_CALL(ins,
 					IPOINT_BEFORE,
 					(AFUNPTR)r_clrl,
 					IARG_FAST_ANALYSIS_CALL,
@@ -3656,7 +4803,7 @@ ins_inspect(INS ins)
 			 * EAX and EDX
 			 */
 			/* propagate tag accordingly */
-			INS_InsertCall(ins,
+			DFT_INS_CALL(ins,
 				IPOINT_BEFORE,
 				(AFUNPTR)r_clrl2,
 				IARG_FAST_ANALYSIS_CALL,
@@ -3672,7 +4819,7 @@ ins_inspect(INS ins)
 		 */
 		case XED_ICLASS_CPUID:
 			/* propagate tag accordingly */
-			INS_InsertCall(ins,
+			DFT_INS_CALL(ins,
 				IPOINT_BEFORE,
 				(AFUNPTR)r_clrl4,
 				IARG_FAST_ANALYSIS_CALL,
@@ -3687,7 +4834,7 @@ ins_inspect(INS ins)
 		 */
 		case XED_ICLASS_LAHF:
 			/* propagate tag accordingly */
-			INS_InsertCall(ins,
+			DFT_INS_CALL(ins,
 				IPOINT_BEFORE,
 				(AFUNPTR)r_clrb_u,
 				IARG_FAST_ANALYSIS_CALL,
@@ -3713,7 +4860,7 @@ ins_inspect(INS ins)
 				/* 32-bit operands */
 				if (REG_is_gr32(reg_dst)) {
 				/* propagate tag accordingly; fast path */
-					INS_InsertIfCall(ins,
+					DFT_INS_IFCALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_cmpxchg_r2r_opl_fast,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3723,7 +4870,7 @@ ins_inspect(INS ins)
 						IARG_REG_VALUE, reg_dst,
 						IARG_END);
 				/* propagate tag accordingly; slow path */
-					INS_InsertThenCall(ins,
+					DFT_INS_THENCALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_cmpxchg_r2r_opl_slow,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3735,7 +4882,7 @@ ins_inspect(INS ins)
 				/* 16-bit operands */
 				else if (REG_is_gr16(reg_dst)) {
 				/* propagate tag accordingly; fast path */
-					INS_InsertIfCall(ins,
+					DFT_INS_IFCALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_cmpxchg_r2r_opw_fast,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3745,7 +4892,7 @@ ins_inspect(INS ins)
 						IARG_REG_VALUE, reg_dst,
 						IARG_END);
 				/* propagate tag accordingly; slow path */
-					INS_InsertThenCall(ins,
+					DFT_INS_THENCALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_cmpxchg_r2r_opw_slow,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3768,7 +4915,7 @@ ins_inspect(INS ins)
 				/* 32-bit operands */
 				if (REG_is_gr32(reg_src)) {
 				/* propagate tag accordingly; fast path */
-					INS_InsertIfCall(ins,
+					DFT_INS_IFCALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_cmpxchg_m2r_opl_fast,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3777,7 +4924,7 @@ ins_inspect(INS ins)
 						IARG_MEMORYREAD_EA,
 						IARG_END);
 				/* propagate tag accordingly; slow path */
-					INS_InsertThenCall(ins,
+					DFT_INS_THENCALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_cmpxchg_r2m_opl_slow,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3789,7 +4936,7 @@ ins_inspect(INS ins)
 				/* 16-bit operands */
 				else if (REG_is_gr16(reg_src)) {
 				/* propagate tag accordingly; fast path */
-					INS_InsertIfCall(ins,
+					DFT_INS_IFCALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_cmpxchg_m2r_opw_fast,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3798,7 +4945,7 @@ ins_inspect(INS ins)
 						IARG_MEMORYREAD_EA,
 						IARG_END);
 				/* propagate tag accordingly; slow path */
-					INS_InsertThenCall(ins,
+					DFT_INS_THENCALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_cmpxchg_r2m_opw_slow,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3830,7 +4977,7 @@ ins_inspect(INS ins)
 				/* 32-bit operands */
 				if (REG_is_gr32(reg_dst)) {
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opl,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3838,7 +4985,7 @@ ins_inspect(INS ins)
 						IARG_UINT32, 8,
 					IARG_UINT32, REG32_INDX(reg_dst),
 						IARG_END);
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opl,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3846,7 +4993,7 @@ ins_inspect(INS ins)
 					IARG_UINT32, REG32_INDX(reg_dst),
 					IARG_UINT32, REG32_INDX(reg_src),
 						IARG_END);
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opl,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3858,7 +5005,7 @@ ins_inspect(INS ins)
 				/* 16-bit operands */
 				else if (REG_is_gr16(reg_dst)) { 
 					/* propagate tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3866,7 +5013,7 @@ ins_inspect(INS ins)
 						IARG_UINT32, 8,
 					IARG_UINT32, REG16_INDX(reg_dst),
 						IARG_END);
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3874,7 +5021,7 @@ ins_inspect(INS ins)
 					IARG_UINT32, REG16_INDX(reg_dst),
 					IARG_UINT32, REG16_INDX(reg_src),
 						IARG_END);
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3889,7 +5036,7 @@ ins_inspect(INS ins)
 					if (REG_is_Lower8(reg_dst) &&
 						REG_is_Lower8(reg_src)) {
 						/* lower 8-bit registers */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opb_l,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3897,7 +5044,7 @@ ins_inspect(INS ins)
 						IARG_UINT32, 8,
 						IARG_UINT32, REG8_INDX(reg_dst),
 						IARG_END);
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opb_l,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3905,7 +5052,7 @@ ins_inspect(INS ins)
 						IARG_UINT32, REG8_INDX(reg_dst),
 						IARG_UINT32, REG8_INDX(reg_src),
 						IARG_END);
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opb_l,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3917,7 +5064,7 @@ ins_inspect(INS ins)
 					else if(REG_is_Upper8(reg_dst) &&
 						REG_is_Upper8(reg_src)) {
 						/* upper 8-bit registers */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opb_u,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3925,7 +5072,7 @@ ins_inspect(INS ins)
 						IARG_UINT32, 8,
 						IARG_UINT32, REG8_INDX(reg_dst),
 						IARG_END);
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opb_u,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3933,7 +5080,7 @@ ins_inspect(INS ins)
 						IARG_UINT32, REG8_INDX(reg_dst),
 						IARG_UINT32, REG8_INDX(reg_src),
 						IARG_END);
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opb_u,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3949,7 +5096,7 @@ ins_inspect(INS ins)
 						 * source register is an upper
 						 * 8-bit register
 						 */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opb_l,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3957,7 +5104,7 @@ ins_inspect(INS ins)
 						IARG_UINT32, 8,
 						IARG_UINT32, REG8_INDX(reg_dst),
 						IARG_END);
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opb_lu,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3965,7 +5112,7 @@ ins_inspect(INS ins)
 						IARG_UINT32, REG8_INDX(reg_dst),
 						IARG_UINT32, REG8_INDX(reg_src),
 						IARG_END);
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opb_ul,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3981,7 +5128,7 @@ ins_inspect(INS ins)
 						 * source register is a lower
 						 * 8-bit register
 						 */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opb_u,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3989,7 +5136,7 @@ ins_inspect(INS ins)
 						IARG_UINT32, 8,
 						IARG_UINT32, REG8_INDX(reg_dst),
 						IARG_END);
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opb_ul,
 						IARG_FAST_ANALYSIS_CALL,
@@ -3997,7 +5144,7 @@ ins_inspect(INS ins)
 						IARG_UINT32, REG8_INDX(reg_dst),
 						IARG_UINT32, REG8_INDX(reg_src),
 						IARG_END);
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opb_lu,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4022,7 +5169,7 @@ ins_inspect(INS ins)
 				/* 32-bit operands */
 				if (REG_is_gr32(reg_dst))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_xchg_r2m_opl,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4033,7 +5180,7 @@ ins_inspect(INS ins)
 				/* 16-bit operands */
 				else if (REG_is_gr16(reg_dst))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_xchg_r2m_opw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4044,7 +5191,7 @@ ins_inspect(INS ins)
 				/* 8-bit operands (upper) */
 				else if (REG_is_Upper8(reg_dst))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_xchg_r2m_opb_u,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4055,7 +5202,7 @@ ins_inspect(INS ins)
 				/* 8-bit operands (lower) */
 				else
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_xchg_r2m_opb_l,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4072,7 +5219,7 @@ ins_inspect(INS ins)
 				/* 32-bit operands */
 				if (REG_is_gr32(reg_src))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_xchg_r2m_opl,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4083,7 +5230,7 @@ ins_inspect(INS ins)
 				/* 16-bit operands */
 				else if (REG_is_gr16(reg_src))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_xchg_r2m_opw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4094,7 +5241,7 @@ ins_inspect(INS ins)
 				/* 8-bit operands (upper) */
 				else if (REG_is_Upper8(reg_src))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_xchg_r2m_opb_u,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4105,7 +5252,7 @@ ins_inspect(INS ins)
 				/* 8-bit operands (lower) */
 				else
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_xchg_r2m_opb_l,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4132,7 +5279,7 @@ ins_inspect(INS ins)
 				/* 32-bit operands */
 				if (REG_is_gr32(reg_dst)) {
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opl,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4140,7 +5287,7 @@ ins_inspect(INS ins)
 						IARG_UINT32, 8,
 					IARG_UINT32, REG32_INDX(reg_dst),
 						IARG_END);
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opl,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4148,7 +5295,7 @@ ins_inspect(INS ins)
 					IARG_UINT32, REG32_INDX(reg_dst),
 					IARG_UINT32, REG32_INDX(reg_src),
 						IARG_END);
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opl,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4156,7 +5303,7 @@ ins_inspect(INS ins)
 					IARG_UINT32, REG32_INDX(reg_src),
 						IARG_UINT32, 8,
 						IARG_END);
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_binary_opl,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4168,7 +5315,7 @@ ins_inspect(INS ins)
 				/* 16-bit operands */
 				else if (REG_is_gr16(reg_dst)) { 
 					/* propagate tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4176,7 +5323,7 @@ ins_inspect(INS ins)
 						IARG_UINT32, 8,
 					IARG_UINT32, REG16_INDX(reg_dst),
 						IARG_END);
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4184,7 +5331,7 @@ ins_inspect(INS ins)
 					IARG_UINT32, REG16_INDX(reg_dst),
 					IARG_UINT32, REG16_INDX(reg_src),
 						IARG_END);
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4192,7 +5339,7 @@ ins_inspect(INS ins)
 					IARG_UINT32, REG16_INDX(reg_src),
 						IARG_UINT32, 8,
 						IARG_END);
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_binary_opw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4207,7 +5354,7 @@ ins_inspect(INS ins)
 					if (REG_is_Lower8(reg_dst) &&
 						REG_is_Lower8(reg_src)) {
 						/* lower 8-bit registers */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opb_l,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4215,7 +5362,7 @@ ins_inspect(INS ins)
 						IARG_UINT32, 8,
 						IARG_UINT32, REG8_INDX(reg_dst),
 						IARG_END);
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opb_l,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4223,7 +5370,7 @@ ins_inspect(INS ins)
 						IARG_UINT32, REG8_INDX(reg_dst),
 						IARG_UINT32, REG8_INDX(reg_src),
 						IARG_END);
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opb_l,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4231,7 +5378,7 @@ ins_inspect(INS ins)
 						IARG_UINT32, REG8_INDX(reg_src),
 						IARG_UINT32, 8,
 						IARG_END);
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_binary_opb_l,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4243,7 +5390,7 @@ ins_inspect(INS ins)
 					else if(REG_is_Upper8(reg_dst) &&
 						REG_is_Upper8(reg_src)) {
 						/* upper 8-bit registers */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opb_u,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4251,7 +5398,7 @@ ins_inspect(INS ins)
 						IARG_UINT32, 8,
 						IARG_UINT32, REG8_INDX(reg_dst),
 						IARG_END);
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opb_u,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4259,7 +5406,7 @@ ins_inspect(INS ins)
 						IARG_UINT32, REG8_INDX(reg_dst),
 						IARG_UINT32, REG8_INDX(reg_src),
 						IARG_END);
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opb_u,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4267,7 +5414,7 @@ ins_inspect(INS ins)
 						IARG_UINT32, REG8_INDX(reg_src),
 						IARG_UINT32, 8,
 						IARG_END);
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_binary_opb_u,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4283,7 +5430,7 @@ ins_inspect(INS ins)
 						 * source register is an upper
 						 * 8-bit register
 						 */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opb_l,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4291,7 +5438,7 @@ ins_inspect(INS ins)
 						IARG_UINT32, 8,
 						IARG_UINT32, REG8_INDX(reg_dst),
 						IARG_END);
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opb_lu,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4299,7 +5446,7 @@ ins_inspect(INS ins)
 						IARG_UINT32, REG8_INDX(reg_dst),
 						IARG_UINT32, REG8_INDX(reg_src),
 						IARG_END);
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opb_ul,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4307,7 +5454,7 @@ ins_inspect(INS ins)
 						IARG_UINT32, REG8_INDX(reg_src),
 						IARG_UINT32, 8,
 						IARG_END);
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_binary_opb_lu,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4323,7 +5470,7 @@ ins_inspect(INS ins)
 						 * source register is a lower
 						 * 8-bit register
 						 */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opb_u,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4331,7 +5478,7 @@ ins_inspect(INS ins)
 						IARG_UINT32, 8,
 						IARG_UINT32, REG8_INDX(reg_dst),
 						IARG_END);
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opb_ul,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4339,7 +5486,7 @@ ins_inspect(INS ins)
 						IARG_UINT32, REG8_INDX(reg_dst),
 						IARG_UINT32, REG8_INDX(reg_src),
 						IARG_END);
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opb_lu,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4347,7 +5494,7 @@ ins_inspect(INS ins)
 						IARG_UINT32, REG8_INDX(reg_src),
 						IARG_UINT32, 8,
 						IARG_END);
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_binary_opb_ul,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4366,7 +5513,7 @@ ins_inspect(INS ins)
 				/* 32-bit operands */
 				if (REG_is_gr32(reg_src))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_xadd_r2m_opl,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4377,7 +5524,7 @@ ins_inspect(INS ins)
 				/* 16-bit operands */
 				else if (REG_is_gr16(reg_src))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_xadd_r2m_opw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4388,7 +5535,7 @@ ins_inspect(INS ins)
 				/* 8-bit operand (upper) */
 				else if (REG_is_Upper8(reg_src))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_xadd_r2m_opb_u,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4399,7 +5546,7 @@ ins_inspect(INS ins)
 				/* 8-bit operand (lower) */
 				else
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_xadd_r2m_opb_l,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4414,7 +5561,7 @@ ins_inspect(INS ins)
 		/* xlat; similar to a mov between a memory location and AL */
 		case XED_ICLASS_XLAT:
 			/* propagate the tag accordingly */
-			INS_InsertCall(ins,
+			DFT_INS_CALL(ins,
 				IPOINT_BEFORE,
 				(AFUNPTR)m2r_xfer_opb_l,
 				IARG_FAST_ANALYSIS_CALL,
@@ -4428,7 +5575,7 @@ ins_inspect(INS ins)
 		/* lodsb; similar to a mov between a memory location and AL */
 		case XED_ICLASS_LODSB:
 			/* propagate the tag accordingly */
-			INS_InsertPredicatedCall(ins,
+			DFT_INS_PCALL(ins,
 				IPOINT_BEFORE,
 				(AFUNPTR)m2r_xfer_opb_l,
 				IARG_FAST_ANALYSIS_CALL,
@@ -4442,7 +5589,7 @@ ins_inspect(INS ins)
 		/* lodsw; similar to a mov between a memory location and AX */
 		case XED_ICLASS_LODSW:
 			/* propagate the tag accordingly */
-			INS_InsertPredicatedCall(ins,
+			DFT_INS_PCALL(ins,
 				IPOINT_BEFORE,
 				(AFUNPTR)m2r_xfer_opw,
 				IARG_FAST_ANALYSIS_CALL,
@@ -4456,7 +5603,7 @@ ins_inspect(INS ins)
 		/* lodsd; similar to a mov between a memory location and EAX */
 		case XED_ICLASS_LODSD:
 			/* propagate the tag accordingly */
-			INS_InsertPredicatedCall(ins,
+			DFT_INS_PCALL(ins,
 				IPOINT_BEFORE,
 				(AFUNPTR)m2r_xfer_opl,
 				IARG_FAST_ANALYSIS_CALL,
@@ -4476,17 +5623,16 @@ ins_inspect(INS ins)
 		 * inlined code
 		 */
 		case XED_ICLASS_STOSB:
-#if 0
 			/* the instruction is rep prefixed */
 			if (INS_RepPrefix(ins)) {
 				/* propagate the tag accordingly */
-				INS_InsertIfPredicatedCall(ins,
+				DFT_INS_IFPCALL(ins,
 					IPOINT_BEFORE,
 					(AFUNPTR)rep_predicate,
 					IARG_FAST_ANALYSIS_CALL,
 					IARG_FIRST_REP_ITERATION,
 					IARG_END);
-				INS_InsertThenPredicatedCall(ins,
+				DFT_INS_THENPCALL(ins,
 					IPOINT_BEFORE,
 					(AFUNPTR)r2m_xfer_opbn,
 					IARG_FAST_ANALYSIS_CALL,
@@ -4498,9 +5644,8 @@ ins_inspect(INS ins)
 			}
 			/* no rep prefix */
 			else
-#endif
 				/* the instruction is not rep prefixed */
-				INS_InsertPredicatedCall(ins,
+				DFT_INS_PCALL(ins,
 					IPOINT_BEFORE,
 					(AFUNPTR)r2m_xfer_opb_l,
 					IARG_FAST_ANALYSIS_CALL,
@@ -4520,17 +5665,16 @@ ins_inspect(INS ins)
 		 * inlined code
 		 */
 		case XED_ICLASS_STOSW:
-#if 0
 			/* the instruction is rep prefixed */
 			if (INS_RepPrefix(ins)) {
 				/* propagate the tag accordingly */
-				INS_InsertIfPredicatedCall(ins,
+				DFT_INS_IFPCALL(ins,
 					IPOINT_BEFORE,
 					(AFUNPTR)rep_predicate,
 					IARG_FAST_ANALYSIS_CALL,
 					IARG_FIRST_REP_ITERATION,
 					IARG_END);
-				INS_InsertThenPredicatedCall(ins,
+				DFT_INS_THENPCALL(ins,
 					IPOINT_BEFORE,
 					(AFUNPTR)r2m_xfer_opwn,
 					IARG_FAST_ANALYSIS_CALL,
@@ -4542,9 +5686,8 @@ ins_inspect(INS ins)
 			}
 			/* no rep prefix */
 			else
-#endif
 				/* the instruction is not rep prefixed */
-				INS_InsertPredicatedCall(ins,
+				DFT_INS_PCALL(ins,
 					IPOINT_BEFORE,
 					(AFUNPTR)r2m_xfer_opw,
 					IARG_FAST_ANALYSIS_CALL,
@@ -4564,17 +5707,16 @@ ins_inspect(INS ins)
 		 * inlined code
 		 */
 		case XED_ICLASS_STOSD:
-#if 0
 			/* the instruction is rep prefixed */
 			if (INS_RepPrefix(ins)) {
 				/* propagate the tag accordingly */
-				INS_InsertIfPredicatedCall(ins,
+				DFT_INS_IFPCALL(ins,
 					IPOINT_BEFORE,
 					(AFUNPTR)rep_predicate,
 					IARG_FAST_ANALYSIS_CALL,
 					IARG_FIRST_REP_ITERATION,
 					IARG_END);
-				INS_InsertThenPredicatedCall(ins,
+				DFT_INS_THENPCALL(ins,
 					IPOINT_BEFORE,
 					(AFUNPTR)r2m_xfer_opln,
 					IARG_FAST_ANALYSIS_CALL,
@@ -4586,8 +5728,7 @@ ins_inspect(INS ins)
 			}
 			/* no rep prefix */
 			else
-#endif
-				INS_InsertPredicatedCall(ins,
+				DFT_INS_PCALL(ins,
 					IPOINT_BEFORE,
 					(AFUNPTR)r2m_xfer_opl,
 					IARG_FAST_ANALYSIS_CALL,
@@ -4603,13 +5744,13 @@ ins_inspect(INS ins)
 			/* the instruction is rep prefixed */
 			if (INS_RepPrefix(ins)) {
 				/* propagate the tag accordingly */
-				INS_InsertIfPredicatedCall(ins,
+				DFT_INS_IFPCALL(ins,
 					IPOINT_BEFORE,
 					(AFUNPTR)rep_predicate,
 					IARG_FAST_ANALYSIS_CALL,
 					IARG_FIRST_REP_ITERATION,
 					IARG_END);
-				INS_InsertThenPredicatedCall(ins,
+				DFT_INS_THENPCALL(ins,
 					IPOINT_BEFORE,
 					(AFUNPTR)m2m_xfer_opln,
 					IARG_FAST_ANALYSIS_CALL,
@@ -4622,7 +5763,7 @@ ins_inspect(INS ins)
 			/* no rep prefix */
 			else 
 				/* propagate the tag accordingly */
-				INS_InsertCall(ins,
+				DFT_INS_CALL(ins,
 					IPOINT_BEFORE,
 					(AFUNPTR)m2m_xfer_opl,
 					IARG_FAST_ANALYSIS_CALL,
@@ -4637,13 +5778,13 @@ ins_inspect(INS ins)
 			/* the instruction is rep prefixed */
 			if (INS_RepPrefix(ins)) {
 				/* propagate the tag accordingly */
-				INS_InsertIfPredicatedCall(ins,
+				DFT_INS_IFPCALL(ins,
 					IPOINT_BEFORE,
 					(AFUNPTR)rep_predicate,
 					IARG_FAST_ANALYSIS_CALL,
 					IARG_FIRST_REP_ITERATION,
 					IARG_END);
-				INS_InsertThenPredicatedCall(ins,
+				DFT_INS_THENPCALL(ins,
 					IPOINT_BEFORE,
 					(AFUNPTR)m2m_xfer_opwn,
 					IARG_FAST_ANALYSIS_CALL,
@@ -4656,7 +5797,7 @@ ins_inspect(INS ins)
 			/* no rep prefix */
 			else 
 				/* propagate the tag accordingly */
-				INS_InsertCall(ins,
+				DFT_INS_CALL(ins,
 					IPOINT_BEFORE,
 					(AFUNPTR)m2m_xfer_opw,
 					IARG_FAST_ANALYSIS_CALL,
@@ -4671,13 +5812,13 @@ ins_inspect(INS ins)
 			/* the instruction is rep prefixed */
 			if (INS_RepPrefix(ins)) {
 				/* propagate the tag accordingly */
-				INS_InsertIfPredicatedCall(ins,
+				DFT_INS_IFPCALL(ins,
 					IPOINT_BEFORE,
 					(AFUNPTR)rep_predicate,
 					IARG_FAST_ANALYSIS_CALL,
 					IARG_FIRST_REP_ITERATION,
 					IARG_END);
-				INS_InsertThenPredicatedCall(ins,
+				DFT_INS_THENPCALL(ins,
 					IPOINT_BEFORE,
 					(AFUNPTR)m2m_xfer_opbn,
 					IARG_FAST_ANALYSIS_CALL,
@@ -4690,7 +5831,7 @@ ins_inspect(INS ins)
 			/* no rep prefix */
 			else 
 				/* propagate the tag accordingly */
-				INS_InsertCall(ins,
+				DFT_INS_CALL(ins,
 					IPOINT_BEFORE,
 					(AFUNPTR)m2m_xfer_opb,
 					IARG_FAST_ANALYSIS_CALL,
@@ -4703,7 +5844,7 @@ ins_inspect(INS ins)
 		/* sal */
 		case XED_ICLASS_SALC:
 			/* propagate the tag accordingly */
-			INS_InsertCall(ins,
+			DFT_INS_CALL(ins,
 				IPOINT_BEFORE,
 				(AFUNPTR)r_clrb_l,
 				IARG_FAST_ANALYSIS_CALL,
@@ -4713,7 +5854,6 @@ ins_inspect(INS ins)
 
 			/* done */
 			break;
-		/* TODO: shifts are not handled (yet) */
 		/* rcl */ 	 
 		case XED_ICLASS_RCL:
 		/* rcr */ 	 
@@ -4728,9 +5868,17 @@ ins_inspect(INS ins)
 		case XED_ICLASS_SAR:
 		/* shr */
 		case XED_ICLASS_SHR:
+			/* propagate the tag accordingly */
+			ins_shift(ins, ins_indx);
+
+			/* done */
+			break;
 		/* shld */
 		case XED_ICLASS_SHLD:
+		/* shrd */
 		case XED_ICLASS_SHRD:
+			/* propagate the tag accordingly */
+			ins_shiftd(ins, ins_indx);
 
 			/* done */
 			break;
@@ -4744,7 +5892,7 @@ ins_inspect(INS ins)
 				/* 32-bit operand */
 				if (REG_is_gr32(reg_dst))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)m2r_xfer_opl,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4755,7 +5903,7 @@ ins_inspect(INS ins)
 				/* 16-bit operand */
 				else
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)m2r_xfer_opw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4770,7 +5918,7 @@ ins_inspect(INS ins)
 				if (INS_MemoryWriteSize(ins) ==
 						BIT2BYTE(MEM_LONG_LEN))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)m2m_xfer_opl,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4780,7 +5928,7 @@ ins_inspect(INS ins)
 				/* 16-bit operand */
 				else
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)m2m_xfer_opw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4801,7 +5949,7 @@ ins_inspect(INS ins)
 				/* 32-bit operand */
 				if (REG_is_gr32(reg_src))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2m_xfer_opl,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4812,7 +5960,7 @@ ins_inspect(INS ins)
 				/* 16-bit operand */
 				else
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2m_xfer_opw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4827,7 +5975,7 @@ ins_inspect(INS ins)
 				if (INS_MemoryWriteSize(ins) ==
 						BIT2BYTE(MEM_LONG_LEN))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)m2m_xfer_opl,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4837,7 +5985,7 @@ ins_inspect(INS ins)
 				/* 16-bit operand */
 				else
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)m2m_xfer_opw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4852,7 +6000,7 @@ ins_inspect(INS ins)
 					/* 4 bytes */
 					case MEM_LONG_LEN:
 				/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)tagmap_clrl,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4864,7 +6012,7 @@ ins_inspect(INS ins)
 					/* 2 bytes */
 					case MEM_WORD_LEN:
 				/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)tagmap_clrw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4876,7 +6024,7 @@ ins_inspect(INS ins)
 					/* 1 byte */
 					case MEM_BYTE_LEN:
 				/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)tagmap_clrb,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4900,7 +6048,7 @@ ins_inspect(INS ins)
 		 */
 		case XED_ICLASS_POPA:
 			/* propagate the tag accordingly */
-			INS_InsertCall(ins,
+			DFT_INS_CALL(ins,
 				IPOINT_BEFORE,
 				(AFUNPTR)m2r_restore_opw,
 				IARG_FAST_ANALYSIS_CALL,
@@ -4916,7 +6064,7 @@ ins_inspect(INS ins)
 		 */
 		case XED_ICLASS_POPAD:
 			/* propagate the tag accordingly */
-			INS_InsertCall(ins,
+			DFT_INS_CALL(ins,
 				IPOINT_BEFORE,
 				(AFUNPTR)m2r_restore_opl,
 				IARG_FAST_ANALYSIS_CALL,
@@ -4932,7 +6080,7 @@ ins_inspect(INS ins)
 		 */
 		case XED_ICLASS_PUSHA:
 			/* propagate the tag accordingly */
-			INS_InsertCall(ins,
+			DFT_INS_CALL(ins,
 				IPOINT_BEFORE,
 				(AFUNPTR)r2m_save_opw,
 				IARG_FAST_ANALYSIS_CALL,
@@ -4948,7 +6096,7 @@ ins_inspect(INS ins)
 		 */
 		case XED_ICLASS_PUSHAD:
 			/* propagate the tag accordingly */
-			INS_InsertCall(ins,
+			DFT_INS_CALL(ins,
 				IPOINT_BEFORE,
 				(AFUNPTR)r2m_save_opl,
 				IARG_FAST_ANALYSIS_CALL,
@@ -4961,7 +6109,7 @@ ins_inspect(INS ins)
 		/* pushf; clear a memory word (i.e., 16-bits) */
 		case XED_ICLASS_PUSHF:
 			/* propagate the tag accordingly */
-			INS_InsertCall(ins,
+			DFT_INS_CALL(ins,
 				IPOINT_BEFORE,
 				(AFUNPTR)tagmap_clrw,
 				IARG_FAST_ANALYSIS_CALL,
@@ -4973,7 +6121,7 @@ ins_inspect(INS ins)
 		/* pushfd; clear a double memory word (i.e., 32-bits) */
 		case XED_ICLASS_PUSHFD:
 			/* propagate the tag accordingly */
-			INS_InsertCall(ins,
+			DFT_INS_CALL(ins,
 				IPOINT_BEFORE,
 				(AFUNPTR)tagmap_clrl,
 				IARG_FAST_ANALYSIS_CALL,
@@ -4989,7 +6137,7 @@ ins_inspect(INS ins)
 				/* 32-bit operand */
 				if (INS_OperandWidth(ins, OP_0) == MEM_LONG_LEN)
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)tagmap_clrl,
 						IARG_FAST_ANALYSIS_CALL,
@@ -4998,7 +6146,7 @@ ins_inspect(INS ins)
 				/* 16-bit operand */
 				else
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)tagmap_clrw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -5013,7 +6161,7 @@ ins_inspect(INS ins)
 				/* 32-bit operand */
 				if (REG_is_gr32(reg_src))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)tagmap_clrl,
 						IARG_FAST_ANALYSIS_CALL,
@@ -5022,7 +6170,7 @@ ins_inspect(INS ins)
 				/* 16-bit operand */
 				else
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)tagmap_clrw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -5034,7 +6182,7 @@ ins_inspect(INS ins)
 				/* 32-bit operand */
 				if (INS_OperandWidth(ins, OP_0) == MEM_LONG_LEN)
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)tagmap_clrl,
 						IARG_FAST_ANALYSIS_CALL,
@@ -5044,7 +6192,7 @@ ins_inspect(INS ins)
 				/* 16-bit operand */
 				else
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)tagmap_clrw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -5066,7 +6214,7 @@ ins_inspect(INS ins)
 			/* 32-bit operands */	
 			if (REG_is_gr32(reg_dst)) {
 				/* propagate the tag accordingly */
-				INS_InsertCall(ins,
+				DFT_INS_CALL(ins,
 					IPOINT_BEFORE,
 					(AFUNPTR)r2r_xfer_opl,
 					IARG_FAST_ANALYSIS_CALL,
@@ -5074,7 +6222,7 @@ ins_inspect(INS ins)
 					IARG_UINT32, REG32_INDX(reg_dst),
 					IARG_UINT32, REG32_INDX(reg_src),
 					IARG_END);
-				INS_InsertCall(ins,
+				DFT_INS_CALL(ins,
 					IPOINT_BEFORE,
 					(AFUNPTR)m2r_xfer_opl,
 					IARG_FAST_ANALYSIS_CALL,
@@ -5086,7 +6234,7 @@ ins_inspect(INS ins)
 			/* 16-bit operands */
 			else {
 				/* propagate the tag accordingly */
-				INS_InsertCall(ins,
+				DFT_INS_CALL(ins,
 					IPOINT_BEFORE,
 					(AFUNPTR)r2r_xfer_opw,
 					IARG_FAST_ANALYSIS_CALL,
@@ -5094,7 +6242,7 @@ ins_inspect(INS ins)
 					IARG_UINT32, REG16_INDX(reg_dst),
 					IARG_UINT32, REG16_INDX(reg_src),
 					IARG_END);
-				INS_InsertCall(ins,
+				DFT_INS_CALL(ins,
 					IPOINT_BEFORE,
 					(AFUNPTR)m2r_xfer_opw,
 					IARG_FAST_ANALYSIS_CALL,
@@ -5127,7 +6275,7 @@ ins_inspect(INS ins)
 				/* 32-bit operands */
 				if (REG_is_gr32(reg_dst))
 					/* clear */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r_clrl,
 						IARG_FAST_ANALYSIS_CALL,
@@ -5138,7 +6286,7 @@ ins_inspect(INS ins)
 				/* 16-bit operands */
 				else 
 					/* clear */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r_clrw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -5153,7 +6301,7 @@ ins_inspect(INS ins)
 				/* 32-bit operands */
 				if (REG_is_gr32(reg_dst))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opl,
 						IARG_FAST_ANALYSIS_CALL,
@@ -5164,7 +6312,7 @@ ins_inspect(INS ins)
 				/* 16-bit operands */
 				else 
 					/* propagate tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -5179,7 +6327,7 @@ ins_inspect(INS ins)
 				/* 32-bit operands */
 				if (REG_is_gr32(reg_dst))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opl,
 						IARG_FAST_ANALYSIS_CALL,
@@ -5190,7 +6338,7 @@ ins_inspect(INS ins)
 				/* 16-bit operands */
 				else
 					/* propagate tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)r2r_xfer_opw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -5205,7 +6353,7 @@ ins_inspect(INS ins)
 				/* 32-bit operands */
 				if (REG_is_gr32(reg_dst))
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_lea_r2r_opl,
 						IARG_FAST_ANALYSIS_CALL,
@@ -5217,7 +6365,7 @@ ins_inspect(INS ins)
 				/* 16-bit operands */
 				else
 					/* propagate the tag accordingly */
-					INS_InsertCall(ins,
+					DFT_INS_CALL(ins,
 						IPOINT_BEFORE,
 						(AFUNPTR)_lea_r2r_opw,
 						IARG_FAST_ANALYSIS_CALL,
@@ -59,5 +59,6 @@ enum {
 
 /* core API */
 void ins_inspect(INS);
+void ins_elide_fini(INT32, VOID *);
 
 #endif /* __LIBDFT_CORE_H__ */
@@ -0,0 +1,248 @@
+/*-
+ * Copyright (c) 2011, 2012, 2013, Columbia University
+ * All rights reserved.
+ *
+ * This software was developed by Vasileios P. Kemerlis <vpk@cs.columbia.edu>
+ * at Columbia University, New York, NY, USA, in June 2011.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Columbia University nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * control channel
+ *
+ * DFT can be turned on and off while the application is running, via
+ * a UNIX domain socket that is served by a Pin internal thread. Every
+ * connection carries a single command (one line) and gets back a single
+ * reply line. The following commands are supported:
+ *
+ * 	on [clear]	enable DFT (optionally, clear all the tags first)
+ * 	off [clear]	disable DFT (optionally, clear all the tags)
+ * 	clear		clear all the tags
+ * 	status		get the state of DFT
+ *
+ * e.g., echo "off clear" | socat - UNIX-CONNECT:/tmp/libdft.ctl
+ */
+
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "libdft_api.h"
+#include "libdft_ctl.h"
+#include "branch_pred.h"
+
+
+/* control socket path */
+static string ctl_path;
+
+/* control socket */
+static int ctl_fd = -1;
+
+/*
+ * execute a control command
+ *
+ * @cmd:	the command (NUL-terminated)
+ *
+ * returns:	the reply
+ */
+static const char *
+ctl_exec(char *cmd)
+{
+	/* the command and its argument */
+	char *op	= strtok(cmd, " \t\r\n");
+	char *arg	= strtok(NULL, " \t\r\n");
+	/* clear all the tags (flag) */
+	size_t clear	= (arg != NULL && strcmp(arg, CTL_CMD_CLEAR) == 0);
+
+	/* empty command, or unknown argument */
+	if (op == NULL || (arg != NULL && !clear))
+		return "error\n";
+
+	/* enable */
+	if (strcmp(op, CTL_CMD_ON) == 0)
+		(void)libdft_ctl(DFT_ENABLE, clear);
+	/* disable */
+	else if (strcmp(op, CTL_CMD_OFF) == 0)
+		(void)libdft_ctl(DFT_DISABLE, clear);
+	/* clear; the state is not changed */
+	else if (strcmp(op, CTL_CMD_CLEAR) == 0 && arg == NULL)
+		(void)libdft_ctl(libdft_state(), 1);
+	/* status */
+	else if (strcmp(op, CTL_CMD_STATUS) == 0 && arg == NULL)
+		return (libdft_state() == DFT_ENABLE) ? "on\n" : "off\n";
+	/* unknown command */
+	else
+		return "error\n";
+
+	/* the request is applied (see libdft_ctl()) */
+	return "ok\n";
+}
+
+/*
+ * control channel (Pin internal thread)
+ *
+ * accept connections on the control socket and execute the commands;
+ * the socket is polled, so that the thread notices when the process
+ * is exiting, and applies the control requests that are still pending
+ * (see libdft_ctl_sync())
+ *
+ * @v:		thread argument (unused)
+ */
+static VOID
+ctl_thread(VOID *v)
+{
+	/* client socket */
+	int cfd;
+	/* command buffer */
+	char cmd[CTL_CMD_MAX];
+	/* bytes read */
+	ssize_t len;
+	/* reply */
+	const char *reply;
+	/* poll(2) descriptor */
+	struct pollfd pfd;
+
+	/* setup */
+	pfd.fd		= ctl_fd;
+	pfd.events	= POLLIN;
+
+	/* serve the control socket */
+	while (!PIN_IsProcessExiting()) {
+		/* retry the requests that are still pending */
+		libdft_ctl_sync();
+
+		/* wait for a connection */
+		if (poll(&pfd, 1, CTL_POLL_MS) <= 0)
+			continue;
+
+		/* accept it; optimized branch */
+		if (unlikely((cfd = accept(ctl_fd, NULL, NULL)) == -1))
+			continue;
+
+		/* read the command */
+		if ((len = read(cfd, cmd, CTL_CMD_MAX - 1)) > 0) {
+			/* NUL-terminate */
+			cmd[len] = '\0';
+
+			/* execute and reply */
+			reply = ctl_exec(cmd);
+			(void)write(cfd, reply, strlen(reply));
+		}
+
+		/* cleanup */
+		(void)close(cfd);
+	}
+}
+
+/*
+ * process exit callback
+ *
+ * remove the control socket
+ *
+ * @code:	OS specific termination code
+ * @v:		callback value
+ */
+static void
+ctl_fini(INT32 code, VOID *v)
+{
+	/* cleanup */
+	(void)close(ctl_fd);
+	(void)unlink(ctl_path.c_str());
+}
+
+/*
+ * initialize the control channel
+ *
+ * create the control socket and spawn the internal thread that
+ * serves it. It must be called after libdft_init() and before
+ * PIN_StartProgram()
+ *
+ * @path:	the path of the control socket
+ *
+ * returns:	0 on success, 1 on error
+ */
+int
+ctl_init(const char *path)
+{
+	/* socket address */
+	struct sockaddr_un addr;
+
+	/* sanity check; optimized branch */
+	if (unlikely(path == NULL || strlen(path) >= sizeof(addr.sun_path)))
+		/* return with failure */
+		return 1;
+
+	/* setup the address */
+	(void)memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	(void)strcpy(addr.sun_path, path);
+	ctl_path = path;
+
+	/* remove stale sockets */
+	(void)unlink(path);
+
+	/* create the control socket; optimized branch */
+	if (unlikely((ctl_fd = socket(AF_UNIX, SOCK_STREAM, 0)) == -1 ||
+		bind(ctl_fd, (struct sockaddr *)&addr, sizeof(addr)) == -1 ||
+		listen(ctl_fd, CTL_BACKLOG) == -1)) {
+		/* error message */
+		LOG(string(__func__) + ": control socket setup failed (" +
+				string(strerror(errno)) + ")\n");
+
+		/* failed */
+		goto err;
+	}
+
+	/* spawn the internal thread; optimized branch */
+	if (unlikely(PIN_SpawnInternalThread(ctl_thread, NULL, 0, NULL) ==
+				INVALID_THREADID)) {
+		/* error message */
+		LOG(string(__func__) + ": internal thread spawn failed\n");
+
+		/* failed */
+		goto err;
+	}
+
+	/* remove the control socket at exit */
+	PIN_AddFiniFunction(ctl_fini, NULL);
+
+	/* success */
+	return 0;
+
+err:	/* error handling */
+
+	/* cleanup */
+	if (ctl_fd != -1)
+		(void)close(ctl_fd);
+	ctl_fd = -1;
+
+	/* return with failure */
+	return 1;
+}
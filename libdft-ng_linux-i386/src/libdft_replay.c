@@ -0,0 +1,1318 @@
+/*-
+ * Copyright (c) 2011, 2012, 2013, Columbia University
+ * All rights reserved.
+ *
+ * This software was developed by Vasileios P. Kemerlis <vpk@cs.columbia.edu>
+ * at Columbia University, New York, NY, USA, in June 2011.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Columbia University nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * decoupled DFT
+ *
+ * the application threads do not propagate tags themselves; every
+ * analysis function call that is placed by libdft (via the DFT_INS_*()
+ * wrappers) is turned into an op, and the application only logs the op
+ * index along with the dynamic arguments of the call (e.g., effective
+ * addresses, register values) into a per-thread ring. An internal thread,
+ * which is typically pinned to a different core, consumes the rings
+ * and replays the analysis functions in program order (per thread)
+ *
+ * NOTE: the application logs one record per analysis call, and it
+ * synchronizes with the replay thread before system calls and sinks
+ * (DFT_SINK_*()); the producer is therefore not much cheaper than inline
+ * propagation, and the gain is limited to the tag work that is moved
+ * off the application's critical path
+ */
+
+#include <sys/mman.h>
+
+#include <errno.h>
+#include <sched.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "libdft_api.h"
+#include "libdft_replay.h"
+#include "branch_pred.h"
+
+
+/* thread context pointer (TLS emulation) */
+extern REG	thread_ctx_ptr;
+
+/* decoupled propagation is enabled (flag) */
+size_t replay_on = 0;
+
+/* dynamic arguments of an op; instrumentation-time only */
+typedef struct {
+	size_t		num;			/* number of arguments */
+	IARG_TYPE	type[REPLAY_DYN_MAX];	/* IARG type */
+	REG		reg[REPLAY_DYN_MAX];	/* register (IARG_REG_VALUE) */
+} replay_dyn_t;
+
+/*
+ * ops; allocated in chunks that never move, so that the replay thread
+ * can use them while new ones are added. Op 0 is reserved (see
+ * replay_op_t.then)
+ */
+static replay_op_t	*replay_ops[REPLAY_OPS_CHUNKS];
+static uint32_t		replay_nops	= 1;
+
+/* rings of the running threads */
+static replay_ring_t * volatile	replay_rings[REPLAY_THREADS_MAX];
+static volatile size_t		replay_nrings	= 0;
+
+/* replay thread */
+static int		replay_cpu	= -1;	/* CPU to run on (-1 any) */
+static volatile size_t	replay_running	= 0;	/* running (flag) */
+static volatile size_t	replay_pass	= 0;	/* passes over the rings */
+
+/*
+ * pending if-op (INS_InsertIfCall()); it is
+ * linked with the next then-op of the instruction
+ */
+static size_t		pending		= 0;	/* pending (flag) */
+static size_t		pending_app	= 0;	/* executed natively (flag) */
+static size_t		pending_type	= REPLAY_IFCALL;
+static uint32_t		pending_id	= 0;	/* if-op */
+static replay_dyn_t	pending_dyn;		/* if-op dynamic arguments */
+
+/* ring words logged for the current instruction */
+static ADDRINT		ins_addr	= 0;
+static size_t		ins_words	= 0;
+
+/* statistics */
+static UINT64		replay_records	= 0;	/* replayed records */
+static volatile size_t	replay_stalls	= 0;	/* full rings */
+static volatile size_t	replay_syncs	= 0;	/* sync points */
+
+/* analysis function types; fast (PIN_FAST_ANALYSIS_CALL) and regular */
+typedef ADDRINT (PIN_FAST_ANALYSIS_CALL *fast0_t)(void);
+typedef ADDRINT (PIN_FAST_ANALYSIS_CALL *fast1_t)(ADDRINT);
+typedef ADDRINT (PIN_FAST_ANALYSIS_CALL *fast2_t)(ADDRINT, ADDRINT);
+typedef ADDRINT (PIN_FAST_ANALYSIS_CALL *fast3_t)(ADDRINT, ADDRINT, ADDRINT);
+typedef ADDRINT (PIN_FAST_ANALYSIS_CALL *fast4_t)(ADDRINT, ADDRINT, ADDRINT,
+		ADDRINT);
+typedef ADDRINT (PIN_FAST_ANALYSIS_CALL *fast5_t)(ADDRINT, ADDRINT, ADDRINT,
+		ADDRINT, ADDRINT);
+typedef ADDRINT (PIN_FAST_ANALYSIS_CALL *fast6_t)(ADDRINT, ADDRINT, ADDRINT,
+		ADDRINT, ADDRINT, ADDRINT);
+typedef ADDRINT (*call0_t)(void);
+typedef ADDRINT (*call1_t)(ADDRINT);
+typedef ADDRINT (*call2_t)(ADDRINT, ADDRINT);
+typedef ADDRINT (*call3_t)(ADDRINT, ADDRINT, ADDRINT);
+typedef ADDRINT (*call4_t)(ADDRINT, ADDRINT, ADDRINT, ADDRINT);
+typedef ADDRINT (*call5_t)(ADDRINT, ADDRINT, ADDRINT, ADDRINT, ADDRINT);
+typedef ADDRINT (*call6_t)(ADDRINT, ADDRINT, ADDRINT, ADDRINT, ADDRINT,
+		ADDRINT);
+
+/* get the op with index id */
+#define REPLAY_OP(id)	\
+	(&replay_ops[(id) / REPLAY_OPS_CHUNK][(id) % REPLAY_OPS_CHUNK])
+
+/*
+ * spin-wait hint
+ */
+static inline void
+replay_pause(void)
+{
+	__asm__ __volatile__ ("pause" ::: "memory");
+}
+
+/*
+ * log an op (analysis function)
+ *
+ * write the op index and its dynamic arguments into the ring of
+ * the thread; the head is advanced (published) last
+ *
+ * @thread_ctx:	the thread context
+ * @id:		op index
+ * @a0-a5:	dynamic arguments
+ */
+static void PIN_FAST_ANALYSIS_CALL
+replay_log0(thread_ctx_t *thread_ctx, ADDRINT id)
+{
+	/* the ring of the thread */
+	replay_ring_t *ring	= (replay_ring_t *)thread_ctx->ring;
+	uint32_t head		= ring->head;
+
+	/* log the record */
+	ring->buf[head & REPLAY_RING_MASK]		= id;
+
+	/* publish */
+	ring->head = head + 1;
+}
+
+static void PIN_FAST_ANALYSIS_CALL
+replay_log1(thread_ctx_t *thread_ctx, ADDRINT id, ADDRINT a0)
+{
+	/* the ring of the thread */
+	replay_ring_t *ring	= (replay_ring_t *)thread_ctx->ring;
+	uint32_t head		= ring->head;
+
+	/* log the record */
+	ring->buf[head & REPLAY_RING_MASK]		= id;
+	ring->buf[(head + 1) & REPLAY_RING_MASK]	= a0;
+
+	/* publish */
+	ring->head = head + 2;
+}
+
+static void PIN_FAST_ANALYSIS_CALL
+replay_log2(thread_ctx_t *thread_ctx, ADDRINT id, ADDRINT a0, ADDRINT a1)
+{
+	/* the ring of the thread */
+	replay_ring_t *ring	= (replay_ring_t *)thread_ctx->ring;
+	uint32_t head		= ring->head;
+
+	/* log the record */
+	ring->buf[head & REPLAY_RING_MASK]		= id;
+	ring->buf[(head + 1) & REPLAY_RING_MASK]	= a0;
+	ring->buf[(head + 2) & REPLAY_RING_MASK]	= a1;
+
+	/* publish */
+	ring->head = head + 3;
+}
+
+static void PIN_FAST_ANALYSIS_CALL
+replay_log3(thread_ctx_t *thread_ctx, ADDRINT id, ADDRINT a0, ADDRINT a1,
+		ADDRINT a2)
+{
+	/* the ring of the thread */
+	replay_ring_t *ring	= (replay_ring_t *)thread_ctx->ring;
+	uint32_t head		= ring->head;
+
+	/* log the record */
+	ring->buf[head & REPLAY_RING_MASK]		= id;
+	ring->buf[(head + 1) & REPLAY_RING_MASK]	= a0;
+	ring->buf[(head + 2) & REPLAY_RING_MASK]	= a1;
+	ring->buf[(head + 3) & REPLAY_RING_MASK]	= a2;
+
+	/* publish */
+	ring->head = head + 4;
+}
+
+static void PIN_FAST_ANALYSIS_CALL
+replay_log4(thread_ctx_t *thread_ctx, ADDRINT id, ADDRINT a0, ADDRINT a1,
+		ADDRINT a2, ADDRINT a3)
+{
+	/* the ring of the thread */
+	replay_ring_t *ring	= (replay_ring_t *)thread_ctx->ring;
+	uint32_t head		= ring->head;
+
+	/* log the record */
+	ring->buf[head & REPLAY_RING_MASK]		= id;
+	ring->buf[(head + 1) & REPLAY_RING_MASK]	= a0;
+	ring->buf[(head + 2) & REPLAY_RING_MASK]	= a1;
+	ring->buf[(head + 3) & REPLAY_RING_MASK]	= a2;
+	ring->buf[(head + 4) & REPLAY_RING_MASK]	= a3;
+
+	/* publish */
+	ring->head = head + 5;
+}
+
+static void PIN_FAST_ANALYSIS_CALL
+replay_log5(thread_ctx_t *thread_ctx, ADDRINT id, ADDRINT a0, ADDRINT a1,
+		ADDRINT a2, ADDRINT a3, ADDRINT a4)
+{
+	/* the ring of the thread */
+	replay_ring_t *ring	= (replay_ring_t *)thread_ctx->ring;
+	uint32_t head		= ring->head;
+
+	/* log the record */
+	ring->buf[head & REPLAY_RING_MASK]		= id;
+	ring->buf[(head + 1) & REPLAY_RING_MASK]	= a0;
+	ring->buf[(head + 2) & REPLAY_RING_MASK]	= a1;
+	ring->buf[(head + 3) & REPLAY_RING_MASK]	= a2;
+	ring->buf[(head + 4) & REPLAY_RING_MASK]	= a3;
+	ring->buf[(head + 5) & REPLAY_RING_MASK]	= a4;
+
+	/* publish */
+	ring->head = head + 6;
+}
+
+static void PIN_FAST_ANALYSIS_CALL
+replay_log6(thread_ctx_t *thread_ctx, ADDRINT id, ADDRINT a0, ADDRINT a1,
+		ADDRINT a2, ADDRINT a3, ADDRINT a4, ADDRINT a5)
+{
+	/* the ring of the thread */
+	replay_ring_t *ring	= (replay_ring_t *)thread_ctx->ring;
+	uint32_t head		= ring->head;
+
+	/* log the record */
+	ring->buf[head & REPLAY_RING_MASK]		= id;
+	ring->buf[(head + 1) & REPLAY_RING_MASK]	= a0;
+	ring->buf[(head + 2) & REPLAY_RING_MASK]	= a1;
+	ring->buf[(head + 3) & REPLAY_RING_MASK]	= a2;
+	ring->buf[(head + 4) & REPLAY_RING_MASK]	= a3;
+	ring->buf[(head + 5) & REPLAY_RING_MASK]	= a4;
+	ring->buf[(head + 6) & REPLAY_RING_MASK]	= a5;
+
+	/* publish */
+	ring->head = head + 7;
+}
+
+/* log functions; indexed by the number of dynamic arguments */
+static const AFUNPTR replay_log[REPLAY_DYN_MAX + 1] = {
+	(AFUNPTR)replay_log0,
+	(AFUNPTR)replay_log1,
+	(AFUNPTR)replay_log2,
+	(AFUNPTR)replay_log3,
+	(AFUNPTR)replay_log4,
+	(AFUNPTR)replay_log5,
+	(AFUNPTR)replay_log6
+};
+
+/*
+ * check if the ring of a thread lacks space (analysis function)
+ *
+ * returns a positive value when there are less than
+ * words free slots in the ring; used with INS_InsertIfCall()
+ *
+ * @thread_ctx:	the thread context
+ * @words:	ring words that are about to be logged
+ *
+ * returns:	0 (space), >0 (full)
+ */
+static ADDRINT PIN_FAST_ANALYSIS_CALL
+replay_full(thread_ctx_t *thread_ctx, uint32_t words)
+{
+	/* the ring of the thread */
+	replay_ring_t *ring = (replay_ring_t *)thread_ctx->ring;
+
+	return (ring->head - ring->tail) > (REPLAY_RING_SZ - words);
+}
+
+/*
+ * wait for the replay thread to catch up (analysis function)
+ *
+ * called (INS_InsertThenCall()) whenever replay_full() returns true;
+ * the thread stalls until half of the ring is consumed
+ *
+ * @thread_ctx:	the thread context
+ */
+static void PIN_FAST_ANALYSIS_CALL
+replay_wait(thread_ctx_t *thread_ctx)
+{
+	/* the ring of the thread */
+	replay_ring_t *ring = (replay_ring_t *)thread_ctx->ring;
+
+	/* update the statistics */
+	(void)__sync_fetch_and_add(&replay_stalls, 1);
+
+	/* wait */
+	while ((ring->head - ring->tail) > (REPLAY_RING_SZ >> 1) &&
+			likely(replay_running != 0))
+		replay_pause();
+}
+
+/*
+ * replay an op
+ *
+ * collect the arguments of the op (i.e., static, thread
+ * context, and dynamic from the ring) and call its analysis
+ * function
+ *
+ * @ring:	the ring
+ * @op:		the op
+ * @pos:	position of the dynamic arguments; advanced accordingly
+ * @exec:	call the analysis function (flag)
+ *
+ * returns:	the return value of the analysis function
+ */
+static inline ADDRINT
+replay_exec(replay_ring_t *ring, replay_op_t *op, uint32_t *pos, size_t exec)
+{
+	/* arguments */
+	ADDRINT a[REPLAY_ARGS_MAX];
+	/* iterator */
+	size_t i;
+
+	/* collect the arguments */
+	for (i = 0; i < op->nargs; i++)
+		switch (op->kind[i]) {
+			case REPLAY_ARG_STATIC:
+				a[i] = op->arg[i];
+				break;
+			case REPLAY_ARG_CTX:
+				a[i] = (ADDRINT)ring->thread_ctx;
+				break;
+			default:
+				a[i] = ring->buf[(*pos)++ & REPLAY_RING_MASK];
+				break;
+		}
+
+	/* skipped (e.g., then-op whose if-op returned 0) */
+	if (exec == 0)
+		return 0;
+
+	/* PIN_FAST_ANALYSIS_CALL; exact arity */
+	if (likely(op->fast != 0))
+		switch (op->nargs) {
+			case 0:
+				return ((fast0_t)op->fn)();
+			case 1:
+				return ((fast1_t)op->fn)(a[0]);
+			case 2:
+				return ((fast2_t)op->fn)(a[0], a[1]);
+			case 3:
+				return ((fast3_t)op->fn)(a[0], a[1], a[2]);
+			case 4:
+				return ((fast4_t)op->fn)(a[0], a[1], a[2],
+						a[3]);
+			case 5:
+				return ((fast5_t)op->fn)(a[0], a[1], a[2],
+						a[3], a[4]);
+			default:
+				return ((fast6_t)op->fn)(a[0], a[1], a[2],
+						a[3], a[4], a[5]);
+		}
+
+	/* regular call */
+	switch (op->nargs) {
+		case 0:
+			return ((call0_t)op->fn)();
+		case 1:
+			return ((call1_t)op->fn)(a[0]);
+		case 2:
+			return ((call2_t)op->fn)(a[0], a[1]);
+		case 3:
+			return ((call3_t)op->fn)(a[0], a[1], a[2]);
+		case 4:
+			return ((call4_t)op->fn)(a[0], a[1], a[2], a[3]);
+		case 5:
+			return ((call5_t)op->fn)(a[0], a[1], a[2], a[3], a[4]);
+		default:
+			return ((call6_t)op->fn)(a[0], a[1], a[2], a[3], a[4],
+					a[5]);
+	}
+}
+
+/*
+ * replay the records of a ring
+ *
+ * @ring:	the ring
+ *
+ * returns:	the number of replayed records
+ */
+static size_t
+replay_drain(replay_ring_t *ring)
+{
+	/* the logged records; snapshot */
+	uint32_t head	= ring->head;
+	uint32_t pos	= ring->tail;
+	/* replayed records */
+	size_t n	= 0;
+	/* the op of the record */
+	ADDRINT id;
+	replay_op_t *op;
+
+	/* replay */
+	while (pos != head) {
+		/* get the op */
+		id = ring->buf[pos++ & REPLAY_RING_MASK];
+		op = REPLAY_OP(id);
+
+		/* if-op; the then-op is replayed only if it returns true */
+		if (op->then != 0)
+			(void)replay_exec(ring, REPLAY_OP(op->then), &pos,
+					replay_exec(ring, op, &pos, 1) != 0);
+		else
+			(void)replay_exec(ring, op, &pos, 1);
+
+		/* consume the record */
+		ring->tail = pos;
+		n++;
+	}
+
+	return n;
+}
+
+/*
+ * replay thread (internal thread)
+ *
+ * consume the rings of all the threads and replay
+ * their records; the thread spins (and eventually
+ * yields the CPU) when there is nothing to replay
+ *
+ * @v:		thread argument
+ */
+static VOID
+replay_thread(VOID *v)
+{
+	/* CPU set */
+	cpu_set_t cpus;
+	/* iterator */
+	size_t i;
+	/* replayed records (pass) */
+	size_t n;
+	/* idle passes */
+	size_t idle = 0;
+	/* ring */
+	replay_ring_t *ring;
+
+	/* pin the thread */
+	if (replay_cpu >= 0) {
+		CPU_ZERO(&cpus);
+		CPU_SET(replay_cpu, &cpus);
+
+		/* failed; not fatal */
+		if (unlikely(sched_setaffinity(0, sizeof(cpus), &cpus) == -1))
+			LOG(string(__func__) + ": failed to pin to CPU " +
+				decstr(replay_cpu) + " (" +
+				string(strerror(errno)) + ")\n");
+	}
+
+	/* replay */
+	while (!PIN_IsProcessExiting()) {
+		/* traverse the rings */
+		for (i = 0, n = 0; i < replay_nrings; i++)
+			if ((ring = replay_rings[i]) != NULL)
+				n += replay_drain(ring);
+
+		/* a pass is over; see replay_thread_free() */
+		replay_pass++;
+		replay_records += n;
+
+		/* busy */
+		if (n != 0)
+			idle = 0;
+		/* idle; spin and yield the CPU occasionally */
+		else if (++idle < REPLAY_SPIN)
+			replay_pause();
+		else {
+			idle = 0;
+			PIN_Yield();
+		}
+	}
+
+	/* final pass */
+	for (i = 0; i < replay_nrings; i++)
+		if ((ring = replay_rings[i]) != NULL)
+			replay_records += replay_drain(ring);
+
+	/* done */
+	replay_running = 0;
+}
+
+/*
+ * spawn the replay thread
+ *
+ * returns:	0 on success, 1 on error
+ */
+static int
+replay_spawn(void)
+{
+	/* set the flag before the thread gets the chance to run */
+	replay_running = 1;
+
+	/* spawn the internal thread; optimized branch */
+	if (unlikely(PIN_SpawnInternalThread(replay_thread, NULL, 0, NULL) ==
+				INVALID_THREADID)) {
+		/* error message */
+		LOG(string(__func__) + ": internal thread spawn failed\n");
+
+		/* failed */
+		replay_running = 0;
+		return 1;
+	}
+
+	/* success */
+	return 0;
+}
+
+/*
+ * fork callback (before the fork)
+ *
+ * drain all the rings so that the child
+ * inherits up-to-date tags
+ *
+ * @tid:	thread id
+ * @ctx:	CPU context
+ * @v:		callback value
+ */
+static void
+replay_fork(THREADID tid, const CONTEXT *ctx, VOID *v)
+{
+	replay_sync_all();
+}
+
+/*
+ * fork callback (child process)
+ *
+ * internal threads are not inherited; drop the rings of the
+ * threads that are gone, and respawn the replay thread
+ *
+ * @tid:	thread id
+ * @ctx:	CPU context
+ * @v:		callback value
+ */
+static void
+replay_fork_child(THREADID tid, const CONTEXT *ctx, VOID *v)
+{
+	/* iterator */
+	size_t i;
+	/* a ring */
+	replay_ring_t *ring;
+	/* the context of the forking thread */
+	thread_ctx_t *thread_ctx = (thread_ctx_t *)
+		PIN_GetContextReg(ctx, thread_ctx_ptr);
+
+	/* the rings of the other threads are stale (and drained) */
+	for (i = 0; i < replay_nrings; i++)
+		if ((ring = replay_rings[i]) != NULL &&
+				ring != thread_ctx->ring) {
+			replay_rings[i] = NULL;
+			(void)munmap(ring, sizeof(replay_ring_t));
+		}
+
+	/* the child gets a fresh replay thread; optimized branch */
+	if (unlikely(replay_spawn()))
+		/* die */
+		libdft_die();
+}
+
+/*
+ * fini callback
+ *
+ * report the replay statistics
+ *
+ * @code:	exit code
+ * @v:		callback value
+ */
+static void
+replay_fini(INT32 code, VOID *v)
+{
+	LOG(string(__func__) + ": records=" + decstr(replay_records) +
+		" stalls=" + decstr(replay_stalls) +
+		" syncs=" + decstr(replay_syncs) +
+		" ops=" + decstr(replay_nops - 1) + "\n");
+}
+
+/*
+ * allocate an op
+ *
+ * returns:	the index of the op
+ */
+static uint32_t
+replay_op_alloc(void)
+{
+	/* the chunk of the new op */
+	size_t chunk = replay_nops / REPLAY_OPS_CHUNK;
+
+	/* out of ops; optimized branch */
+	if (unlikely(chunk >= REPLAY_OPS_CHUNKS)) {
+		/* error message */
+		LOG(string(__func__) + ": out of ops\n");
+
+		/* die */
+		libdft_die();
+	}
+
+	/* allocate the chunk; optimized branch */
+	if (unlikely(replay_ops[chunk] == NULL &&
+		(replay_ops[chunk] = (replay_op_t *)calloc(REPLAY_OPS_CHUNK,
+					sizeof(replay_op_t))) == NULL)) {
+		/* error message */
+		LOG(string(__func__) + ": op allocation failed (" +
+				string(strerror(errno)) + ")\n");
+
+		/* die */
+		libdft_die();
+	}
+
+	return replay_nops++;
+}
+
+/*
+ * parse the arguments of an analysis function (INS_InsertCall() style)
+ *
+ * static arguments are saved in the op, the thread context is resolved
+ * by the replay thread, and the rest are logged at runtime (dynamic)
+ *
+ * @ins:	the instruction
+ * @op:		the op
+ * @dyn:	dynamic arguments
+ * @ap:		the IARG list (up to IARG_END)
+ */
+static void
+replay_parse(INS ins, replay_op_t *op, replay_dyn_t *dyn, va_list ap)
+{
+	/* IARG type */
+	IARG_TYPE type;
+	/* register */
+	REG reg;
+	/* argument kind and value */
+	uint8_t kind;
+	ADDRINT val;
+
+	/* traverse the IARG list */
+	while ((type = (IARG_TYPE)va_arg(ap, int)) != IARG_END) {
+		/* default; dynamic argument */
+		kind	= REPLAY_ARG_DYN;
+		val	= 0;
+		reg	= REG_INVALID();
+
+		switch (type) {
+			/* calling convention */
+			case IARG_FAST_ANALYSIS_CALL:
+				op->fast = 1;
+				continue;
+			/* static */
+			case IARG_UINT32:
+				kind	= REPLAY_ARG_STATIC;
+				val	= va_arg(ap, UINT32);
+				break;
+			case IARG_ADDRINT:
+				kind	= REPLAY_ARG_STATIC;
+				val	= va_arg(ap, ADDRINT);
+				break;
+			case IARG_PTR:
+				kind	= REPLAY_ARG_STATIC;
+				val	= (ADDRINT)va_arg(ap, VOID *);
+				break;
+			case IARG_BOOL:
+				kind	= REPLAY_ARG_STATIC;
+				val	= va_arg(ap, int);
+				break;
+			case IARG_INST_PTR:
+				kind	= REPLAY_ARG_STATIC;
+				val	= INS_Address(ins);
+				break;
+			/* register value; thread context or dynamic */
+			case IARG_REG_VALUE:
+				reg = (REG)va_arg(ap, int);
+				if (reg == thread_ctx_ptr)
+					kind = REPLAY_ARG_CTX;
+				break;
+			/* dynamic */
+			case IARG_MEMORYREAD_EA:
+			case IARG_MEMORYREAD2_EA:
+			case IARG_MEMORYWRITE_EA:
+			case IARG_BRANCH_TARGET_ADDR:
+			case IARG_FIRST_REP_ITERATION:
+				break;
+			/* unsupported */
+			default:
+				/* error message */
+				LOG(string(__func__) +
+					": unsupported argument (type=" +
+					decstr(type) + ")\n");
+
+				/* die */
+				libdft_die();
+		}
+
+		/* too many arguments; optimized branch */
+		if (unlikely(op->nargs >= REPLAY_ARGS_MAX ||
+			(kind == REPLAY_ARG_DYN && dyn->num >= REPLAY_DYN_MAX))) {
+			/* error message */
+			LOG(string(__func__) + ": too many arguments (ins=" +
+				hexstr(INS_Address(ins)) + ")\n");
+
+			/* die */
+			libdft_die();
+		}
+
+		/* save the argument */
+		op->kind[op->nargs]	= kind;
+		op->arg[op->nargs++]	= val;
+
+		/* dynamic argument */
+		if (kind == REPLAY_ARG_DYN) {
+			dyn->type[dyn->num]	= type;
+			dyn->reg[dyn->num++]	= reg;
+			op->ndyn++;
+		}
+	}
+}
+
+/*
+ * add dynamic arguments to an IARG list
+ *
+ * @args:	the IARG list
+ * @dyn:	dynamic arguments
+ */
+static void
+replay_args(IARGLIST args, replay_dyn_t *dyn)
+{
+	/* iterator */
+	size_t i;
+
+	for (i = 0; i < dyn->num; i++)
+		if (dyn->type[i] == IARG_REG_VALUE)
+			IARGLIST_AddArguments(args, IARG_REG_VALUE,
+					dyn->reg[i], IARG_END);
+		else
+			IARGLIST_AddArguments(args, dyn->type[i], IARG_END);
+}
+
+/*
+ * reserve ring space for an op
+ *
+ * the space for a BBL is checked once at its head (see replay_bbl());
+ * rep-prefixed instructions are checked at every iteration
+ *
+ * @ins:	the instruction
+ * @ipoint:	instrumentation point
+ * @words:	ring words of the op
+ */
+static void
+replay_reserve(INS ins, IPOINT ipoint, size_t words)
+{
+	/* rep-prefixed; check before every iteration */
+	if (INS_HasRealRep(ins)) {
+		INS_InsertIfCall(ins,
+			ipoint,
+			(AFUNPTR)replay_full,
+			IARG_FAST_ANALYSIS_CALL,
+			IARG_REG_VALUE, thread_ctx_ptr,
+			IARG_UINT32, words,
+			IARG_END);
+		INS_InsertThenCall(ins,
+			ipoint,
+			(AFUNPTR)replay_wait,
+			IARG_FAST_ANALYSIS_CALL,
+			IARG_REG_VALUE, thread_ctx_ptr,
+			IARG_END);
+
+		return;
+	}
+
+	/* account the words of the instruction */
+	if (INS_Address(ins) != ins_addr) {
+		ins_addr	= INS_Address(ins);
+		ins_words	= 0;
+	}
+
+	/* over the budget of replay_bbl(); optimized branch */
+	if (unlikely((ins_words += words) > REPLAY_INS_WORDS)) {
+		/* error message */
+		LOG(string(__func__) + ": too many ring words (ins=" +
+			hexstr(INS_Address(ins)) + ")\n");
+
+		/* die */
+		libdft_die();
+	}
+}
+
+/*
+ * insert a log call for an op
+ *
+ * @ins:	the instruction
+ * @ipoint:	instrumentation point
+ * @type:	insertion type (REPLAY_*CALL)
+ * @id:		the op
+ * @dyn:	dynamic arguments
+ * @then:	dynamic arguments of the then-op (or NULL)
+ */
+static void
+replay_log_insert(INS ins, IPOINT ipoint, size_t type, uint32_t id,
+		replay_dyn_t *dyn, replay_dyn_t *then)
+{
+	/* dynamic arguments */
+	IARGLIST args	= IARGLIST_Alloc();
+	size_t num	= dyn->num + ((then != NULL) ? then->num : 0);
+	/* log function */
+	AFUNPTR fn;
+
+	/* too many arguments; optimized branch */
+	if (unlikely(num > REPLAY_DYN_MAX)) {
+		/* error message */
+		LOG(string(__func__) + ": too many arguments (ins=" +
+			hexstr(INS_Address(ins)) + ")\n");
+
+		/* die */
+		libdft_die();
+	}
+
+	/* the IARG list of the record */
+	replay_args(args, dyn);
+	if (then != NULL)
+		replay_args(args, then);
+	fn = replay_log[num];
+
+	/* reserve ring space */
+	replay_reserve(ins, ipoint, num + 1);
+
+	/* insert the log call */
+	switch (type) {
+		case REPLAY_CALL:
+			INS_InsertCall(ins, ipoint, fn,
+				IARG_FAST_ANALYSIS_CALL,
+				IARG_REG_VALUE, thread_ctx_ptr,
+				IARG_UINT32, id,
+				IARG_IARGLIST, args,
+				IARG_END);
+			break;
+		case REPLAY_PCALL:
+			INS_InsertPredicatedCall(ins, ipoint, fn,
+				IARG_FAST_ANALYSIS_CALL,
+				IARG_REG_VALUE, thread_ctx_ptr,
+				IARG_UINT32, id,
+				IARG_IARGLIST, args,
+				IARG_END);
+			break;
+		case REPLAY_THENCALL:
+			INS_InsertThenCall(ins, ipoint, fn,
+				IARG_FAST_ANALYSIS_CALL,
+				IARG_REG_VALUE, thread_ctx_ptr,
+				IARG_UINT32, id,
+				IARG_IARGLIST, args,
+				IARG_END);
+			break;
+		default:
+			INS_InsertThenPredicatedCall(ins, ipoint, fn,
+				IARG_FAST_ANALYSIS_CALL,
+				IARG_REG_VALUE, thread_ctx_ptr,
+				IARG_UINT32, id,
+				IARG_IARGLIST, args,
+				IARG_END);
+			break;
+	}
+
+	/* cleanup */
+	IARGLIST_Free(args);
+}
+
+/*
+ * place an if-op natively
+ *
+ * if-ops that only check IARG_FIRST_REP_ITERATION (e.g., rep_predicate())
+ * do not touch any tags; they are executed by the application, and the
+ * then-op is logged conditionally (INS_InsertThenCall())
+ *
+ * @ins:	the instruction
+ * @ipoint:	instrumentation point
+ * @type:	insertion type (REPLAY_IF{,P}CALL)
+ * @op:		the if-op
+ * @dyn:	dynamic arguments
+ */
+static void
+replay_if_native(INS ins, IPOINT ipoint, size_t type, replay_op_t *op,
+		replay_dyn_t *dyn)
+{
+	/* arguments */
+	IARGLIST args = IARGLIST_Alloc();
+
+	/* rep-prefixed; check the ring before the if-op */
+	replay_reserve(ins, ipoint, REPLAY_DYN_MAX + 1);
+
+	/* the IARG list of the if-op */
+	replay_args(args, dyn);
+
+	/* insert the call */
+	if (type == REPLAY_IFCALL && op->fast)
+		INS_InsertIfCall(ins, ipoint, op->fn,
+			IARG_FAST_ANALYSIS_CALL,
+			IARG_IARGLIST, args,
+			IARG_END);
+	else if (type == REPLAY_IFCALL)
+		INS_InsertIfCall(ins, ipoint, op->fn,
+			IARG_IARGLIST, args,
+			IARG_END);
+	else if (op->fast)
+		INS_InsertIfPredicatedCall(ins, ipoint, op->fn,
+			IARG_FAST_ANALYSIS_CALL,
+			IARG_IARGLIST, args,
+			IARG_END);
+	else
+		INS_InsertIfPredicatedCall(ins, ipoint, op->fn,
+			IARG_IARGLIST, args,
+			IARG_END);
+
+	/* cleanup */
+	IARGLIST_Free(args);
+}
+
+/*
+ * initialize decoupled propagation
+ *
+ * spawn the replay thread and enable the DFT_INS_*() wrappers;
+ * called after libdft_init() and before PIN_StartProgram()
+ *
+ * @cpu:	CPU to pin the replay thread to (-1 for any)
+ *
+ * returns:	0 on success, 1 on error
+ */
+int
+replay_init(int cpu)
+{
+	/* the CPU of the replay thread */
+	replay_cpu = cpu;
+
+	/* spawn the replay thread; optimized branch */
+	if (unlikely(replay_spawn()))
+		/* return with failure */
+		return 1;
+
+	/* drain the rings before forking; respawn in the child */
+	PIN_AddForkFunction(FPOINT_BEFORE, replay_fork, NULL);
+	PIN_AddForkFunction(FPOINT_AFTER_IN_CHILD, replay_fork_child, NULL);
+
+	/* report the statistics at exit */
+	PIN_AddFiniFunction(replay_fini, NULL);
+
+	/* enable */
+	replay_on = 1;
+
+	/* success */
+	return 0;
+}
+
+/*
+ * DFT_INS_*() backend (instrumentation function)
+ *
+ * turn an analysis function call into an op and insert the
+ * call that logs it; if-ops are combined with the following
+ * then-op into a single record
+ *
+ * @ins:	the instruction
+ * @type:	insertion type (REPLAY_*CALL)
+ * @ipoint:	instrumentation point
+ * @fn:		analysis function
+ * @...:	IARG list (up to IARG_END)
+ */
+void
+replay_insert(INS ins, size_t type, IPOINT ipoint, AFUNPTR fn, ...)
+{
+	/* the IARG list */
+	va_list ap;
+	/* the op */
+	uint32_t id = replay_op_alloc();
+	replay_op_t *op = REPLAY_OP(id);
+	/* dynamic arguments */
+	replay_dyn_t dyn;
+	/* iterator */
+	size_t i;
+
+	/* setup */
+	op->fn	= fn;
+	dyn.num	= 0;
+
+	/* parse the arguments */
+	va_start(ap, fn);
+	replay_parse(ins, op, &dyn, ap);
+	va_end(ap);
+
+	switch (type) {
+		/* unconditional and predicated calls */
+		case REPLAY_CALL:
+		case REPLAY_PCALL:
+			replay_log_insert(ins, ipoint, type, id, &dyn, NULL);
+			break;
+		/* if-op; wait for the then-op */
+		case REPLAY_IFCALL:
+		case REPLAY_IFPCALL:
+			pending		= 1;
+			pending_type	= type;
+			pending_id	= id;
+			pending_dyn	= dyn;
+
+			/* rep_predicate() and alike */
+			for (i = 0, pending_app = (op->ndyn == op->nargs);
+					pending_app && i < dyn.num; i++)
+				pending_app =
+					(dyn.type[i] == IARG_FIRST_REP_ITERATION);
+
+			/* executed natively */
+			if (pending_app)
+				replay_if_native(ins, ipoint, type, op, &dyn);
+			break;
+		/* then-op */
+		default:
+			/* no if-op; optimized branch */
+			if (unlikely(pending == 0)) {
+				/* error message */
+				LOG(string(__func__) + ": then-op without if-op (ins=" +
+					hexstr(INS_Address(ins)) + ")\n");
+
+				/* die */
+				libdft_die();
+			}
+			pending = 0;
+
+			/* the if-op is native; log the then-op conditionally */
+			if (pending_app)
+				replay_log_insert(ins, ipoint, type, id, &dyn,
+						NULL);
+			/* a single record for both the if-op and the then-op */
+			else {
+				REPLAY_OP(pending_id)->then = id;
+				replay_log_insert(ins, ipoint,
+					(pending_type == REPLAY_IFPCALL ||
+					 type == REPLAY_THENPCALL) ?
+					REPLAY_PCALL : REPLAY_CALL,
+					pending_id, &pending_dyn, &dyn);
+			}
+			break;
+	}
+}
+
+/*
+ * check the ring space at the head of a BBL (instrumentation function)
+ *
+ * every instruction logs at most REPLAY_INS_WORDS ring words,
+ * hence a single check per BBL is enough (rep-prefixed
+ * instructions are handled separately; see replay_reserve())
+ *
+ * @bbl:	the BBL
+ */
+void
+replay_bbl(BBL bbl)
+{
+	INS_InsertIfCall(BBL_InsHead(bbl),
+		IPOINT_BEFORE,
+		(AFUNPTR)replay_full,
+		IARG_FAST_ANALYSIS_CALL,
+		IARG_REG_VALUE, thread_ctx_ptr,
+		IARG_UINT32, BBL_NumIns(bbl) * REPLAY_INS_WORDS,
+		IARG_END);
+	INS_InsertThenCall(BBL_InsHead(bbl),
+		IPOINT_BEFORE,
+		(AFUNPTR)replay_wait,
+		IARG_FAST_ANALYSIS_CALL,
+		IARG_REG_VALUE, thread_ctx_ptr,
+		IARG_END);
+}
+
+/*
+ * synchronize before a sink (instrumentation function)
+ *
+ * the records of the thread are replayed before the sink is evaluated,
+ * hence a sink acts synchronously (e.g., before a hijacked branch is
+ * taken), at the cost of waiting for the replay thread to catch up
+ *
+ * @ins:	the instruction
+ * @ipoint:	instrumentation point
+ */
+void
+replay_sink(INS ins, IPOINT ipoint)
+{
+	/* inline propagation; the tags are always up to date */
+	if (likely(replay_on == 0))
+		return;
+
+	INS_InsertCall(ins,
+		ipoint,
+		(AFUNPTR)replay_sync,
+		IARG_FAST_ANALYSIS_CALL,
+		IARG_REG_VALUE, thread_ctx_ptr,
+		IARG_END);
+}
+
+/*
+ * allocate the ring of a thread
+ *
+ * called by the thread start callback
+ *
+ * @thread_ctx:	the thread context
+ */
+void
+replay_thread_alloc(thread_ctx_t *thread_ctx)
+{
+	/* the ring */
+	replay_ring_t *ring;
+	/* iterator */
+	size_t i;
+
+	/* decoupled propagation is disabled */
+	if (replay_on == 0)
+		return;
+
+	/* allocate the ring; optimized branch */
+	if (unlikely((ring = (replay_ring_t *)mmap(NULL,
+			sizeof(replay_ring_t),
+			PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS,
+			-1, 0)) == MAP_FAILED)) {
+		/* error message */
+		LOG(string(__func__) + ": ring allocation failed (" +
+				string(strerror(errno)) + ")\n");
+
+		/* die */
+		libdft_die();
+	}
+
+	/* find a free slot */
+	for (i = 0; i < REPLAY_THREADS_MAX && replay_rings[i] != NULL; i++);
+
+	/* out of slots; optimized branch */
+	if (unlikely(i == REPLAY_THREADS_MAX)) {
+		/* error message */
+		LOG(string(__func__) + ": too many threads\n");
+
+		/* die */
+		libdft_die();
+	}
+
+	/* setup */
+	ring->thread_ctx	= thread_ctx;
+	thread_ctx->ring	= ring;
+
+	/* register the ring */
+	replay_rings[i] = ring;
+	if (i >= replay_nrings)
+		replay_nrings = i + 1;
+}
+
+/*
+ * free the ring of a thread
+ *
+ * called by the thread finish callback; the
+ * pending records are replayed first
+ *
+ * @thread_ctx:	the thread context
+ */
+void
+replay_thread_free(thread_ctx_t *thread_ctx)
+{
+	/* the ring */
+	replay_ring_t *ring = (replay_ring_t *)thread_ctx->ring;
+	/* iterator */
+	size_t i;
+	/* replay pass */
+	size_t pass;
+
+	/* no ring */
+	if (ring == NULL)
+		return;
+
+	/* replay the pending records */
+	replay_sync(thread_ctx);
+
+	/* unregister the ring */
+	for (i = 0; i < replay_nrings; i++)
+		if (replay_rings[i] == ring)
+			replay_rings[i] = NULL;
+
+	/* make sure that the replay thread is not using it */
+	for (pass = replay_pass; replay_running != 0 &&
+			replay_pass - pass < 2;)
+		PIN_Yield();
+
+	/* cleanup */
+	(void)munmap(ring, sizeof(replay_ring_t));
+	thread_ctx->ring = NULL;
+}
+
+/*
+ * syscall sync point
+ *
+ * called before every syscall; the records of the thread are replayed
+ * before the syscall (and its pre/post handlers) updates the tags.
+ * Syscalls that unmap (or remap) memory, and hence its shadow, wait
+ * for the records of all the threads
+ *
+ * @thread_ctx:	the thread context
+ * @nr:		syscall number
+ */
+void
+replay_sysenter(thread_ctx_t *thread_ctx, size_t nr)
+{
+	/* no ring */
+	if (thread_ctx->ring == NULL)
+		return;
+
+	switch (nr) {
+		/* the shadow memory is (un)mapped */
+		case __NR_brk:
+		case __NR_mmap:
+		case __NR_mmap2:
+		case __NR_munmap:
+		case __NR_mremap:
+		case __NR_mprotect:
+		case __NR_ipc:
+#ifdef	__NR_shmdt
+		case __NR_shmdt:
+#endif
+		case __NR_execve:
+			replay_sync_all();
+			break;
+		/* the rest */
+		default:
+			replay_sync(thread_ctx);
+			break;
+	}
+}
+
+/*
+ * wait for the records of a thread to be replayed (analysis function)
+ *
+ * @thread_ctx:	the thread context
+ */
+void PIN_FAST_ANALYSIS_CALL
+replay_sync(thread_ctx_t *thread_ctx)
+{
+	/* the ring of the thread */
+	replay_ring_t *ring = (replay_ring_t *)thread_ctx->ring;
+
+	/* no ring, or nothing to replay */
+	if (ring == NULL || ring->tail == ring->head)
+		return;
+
+	/* update the statistics */
+	(void)__sync_fetch_and_add(&replay_syncs, 1);
+
+	/* wait */
+	while (ring->tail != ring->head && likely(replay_running != 0))
+		replay_pause();
+}
+
+/*
+ * wait for the records of all the threads to be replayed
+ *
+ * only the records that are logged up to this
+ * point are waited for; the rest of the threads
+ * keep running
+ */
+void
+replay_sync_all(void)
+{
+	/* iterator */
+	size_t i;
+	/* the ring */
+	replay_ring_t *ring;
+	/* snapshot of the head */
+	uint32_t head;
+
+	/* decoupled propagation is disabled */
+	if (replay_on == 0)
+		return;
+
+	/* update the statistics */
+	(void)__sync_fetch_and_add(&replay_syncs, 1);
+
+	/* wait */
+	for (i = 0; i < replay_nrings; i++)
+		if ((ring = replay_rings[i]) != NULL)
+			for (head = ring->head;
+				(int32_t)(head - ring->tail) > 0 &&
+				likely(replay_running != 0);)
+				replay_pause();
+}
@@ -0,0 +1,162 @@
+/*-
+ * Copyright (c) 2011, 2012, 2013, Columbia University
+ * All rights reserved.
+ *
+ * This software was developed by Vasileios P. Kemerlis <vpk@cs.columbia.edu>
+ * at Columbia University, New York, NY, USA, in June 2011.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Columbia University nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __LIBDFT_REPLAY_H__
+#define __LIBDFT_REPLAY_H__
+
+#include "pin.H"
+#include "libdft_api.h"
+#include "libdft_stats.h"
+#include "branch_pred.h"
+
+#define REPLAY_RING_SZ		(1U << 20)	/* ring size (words); 4 MB	*/
+#define REPLAY_RING_MASK	(REPLAY_RING_SZ - 1)
+#define REPLAY_INS_WORDS	32		/* ring words per instruction	*/
+#define REPLAY_THREADS_MAX	1024		/* maximum number of threads	*/
+#define REPLAY_ARGS_MAX		6		/* analysis function arguments	*/
+#define REPLAY_DYN_MAX		6		/* dynamic arguments per record	*/
+#define REPLAY_OPS_CHUNK	4096		/* ops per chunk		*/
+#define REPLAY_OPS_CHUNKS	1024		/* maximum number of chunks	*/
+#define REPLAY_SPIN		1024		/* idle spins before yielding	*/
+
+enum {						 /* argument kinds (replay_op_t) */
+/* #define */ REPLAY_ARG_STATIC	= 0,		/* known at instrumentation */
+/* #define */ REPLAY_ARG_CTX	= 1,		/* thread context */
+/* #define */ REPLAY_ARG_DYN	= 2		/* logged at runtime */
+};
+
+enum {						 /* insertion type */
+/* #define */ REPLAY_CALL	= 0,		/* INS_InsertCall() */
+/* #define */ REPLAY_PCALL	= 1,		/* INS_InsertPredicatedCall() */
+/* #define */ REPLAY_IFCALL	= 2,		/* INS_InsertIfCall() */
+/* #define */ REPLAY_THENCALL	= 3,		/* INS_InsertThenCall() */
+/* #define */ REPLAY_IFPCALL	= 4,		/* INS_InsertIfPredicatedCall() */
+/* #define */ REPLAY_THENPCALL	= 5		/* INS_InsertThenPredicatedCall() */
+};
+
+/*
+ * analysis function call that is replayed (op);
+ * it is created at instrumentation time, and the
+ * records in the rings refer to it by its index
+ */
+typedef struct {
+	AFUNPTR		fn;			/* analysis function */
+	uint8_t		fast;			/* PIN_FAST_ANALYSIS_CALL */
+	uint8_t		nargs;			/* number of arguments */
+	uint8_t		ndyn;			/* dynamic arguments */
+	uint8_t		kind[REPLAY_ARGS_MAX];	/* argument kinds */
+	ADDRINT		arg[REPLAY_ARGS_MAX];	/* static arguments */
+	uint32_t	then;			/* then-op (if-ops); 0 if none */
+} replay_op_t;
+
+/*
+ * per-thread ring
+ *
+ * single producer (the application thread) and single consumer (the
+ * replay thread); head and tail are free-running word counters and
+ * they are kept in different cache lines
+ */
+typedef struct {
+	volatile uint32_t	head;			/* producer */
+	uint8_t			pad0[60];
+	volatile uint32_t	tail;			/* consumer */
+	uint8_t			pad1[60];
+	thread_ctx_t		*thread_ctx;		/* thread context */
+	volatile ADDRINT	buf[REPLAY_RING_SZ];	/* records */
+} replay_ring_t;
+
+/* decoupled propagation is enabled (flag) */
+extern size_t replay_on;
+
+/*
+ * instrumentation wrappers
+ *
+ * drop-in replacements for the INS_Insert*Call() family; when decoupled
+ * propagation is enabled, the analysis function is replayed by the
+ * replay thread and the application thread only logs its dynamic
+ * arguments (e.g., effective addresses, register values); every
+ * inserted call is accounted when the statistics are enabled
+ */
+#define DFT_INS_STATS(ins)						\
+	(unlikely(stats_on != 0) ? stats_call(ins) : (void)0)
+#define DFT_INS_CALL(ins, ...)						\
+	(DFT_INS_STATS(ins), likely(replay_on == 0) ?			\
+		INS_InsertCall(ins, __VA_ARGS__) :			\
+		replay_insert(ins, REPLAY_CALL, __VA_ARGS__))
+#define DFT_INS_PCALL(ins, ...)						\
+	(DFT_INS_STATS(ins), likely(replay_on == 0) ?			\
+		INS_InsertPredicatedCall(ins, __VA_ARGS__) :		\
+		replay_insert(ins, REPLAY_PCALL, __VA_ARGS__))
+#define DFT_INS_IFCALL(ins, ...)					\
+	(DFT_INS_STATS(ins), likely(replay_on == 0) ?			\
+		INS_InsertIfCall(ins, __VA_ARGS__) :			\
+		replay_insert(ins, REPLAY_IFCALL, __VA_ARGS__))
+#define DFT_INS_THENCALL(ins, ...)					\
+	(DFT_INS_STATS(ins), likely(replay_on == 0) ?			\
+		INS_InsertThenCall(ins, __VA_ARGS__) :			\
+		replay_insert(ins, REPLAY_THENCALL, __VA_ARGS__))
+#define DFT_INS_IFPCALL(ins, ...)					\
+	(DFT_INS_STATS(ins), likely(replay_on == 0) ?			\
+		INS_InsertIfPredicatedCall(ins, __VA_ARGS__) :		\
+		replay_insert(ins, REPLAY_IFPCALL, __VA_ARGS__))
+#define DFT_INS_THENPCALL(ins, ...)					\
+	(DFT_INS_STATS(ins), likely(replay_on == 0) ?			\
+		INS_InsertThenPredicatedCall(ins, __VA_ARGS__) :	\
+		replay_insert(ins, REPLAY_THENPCALL, __VA_ARGS__))
+
+/*
+ * sink wrappers
+ *
+ * checks that must act before the instruction executes (e.g., the
+ * branch target assertions of DTA) are never replayed; they run on
+ * the application thread, after the records of the thread have been
+ * replayed (see replay_sink()), so that they see the current tags
+ */
+#define DFT_SINK_IFCALL(ins, ipoint, ...)				\
+	(DFT_INS_STATS(ins), replay_sink(ins, ipoint),			\
+		INS_InsertIfCall(ins, ipoint, __VA_ARGS__))
+#define DFT_SINK_THENCALL(ins, ...)					\
+	(DFT_INS_STATS(ins), INS_InsertThenCall(ins, __VA_ARGS__))
+
+
+/* decoupled propagation API */
+int	replay_init(int);
+void	replay_insert(INS, size_t, IPOINT, AFUNPTR, ...);
+void	replay_bbl(BBL);
+void	replay_sink(INS, IPOINT);
+void	replay_thread_alloc(thread_ctx_t *);
+void	replay_thread_free(thread_ctx_t *);
+void	replay_sysenter(thread_ctx_t *, size_t);
+void	PIN_FAST_ANALYSIS_CALL replay_sync(thread_ctx_t *);
+void	replay_sync_all(void);
+
+#endif /* __LIBDFT_REPLAY_H__ */
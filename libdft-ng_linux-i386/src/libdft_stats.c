@@ -0,0 +1,321 @@
+/*-
+ * Copyright (c) 2011, 2012, 2013, Columbia University
+ * All rights reserved.
+ *
+ * This software was developed by Vasileios P. Kemerlis <vpk@cs.columbia.edu>
+ * at Columbia University, New York, NY, USA, in June 2011.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Columbia University nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * instrumentation statistics
+ *
+ * count the traces that libdft instruments, the analysis calls that
+ * ins_inspect() (and the rest of the instrumentation) inserts per
+ * instruction class, and how the code cache of Pin copes with them
+ * (fills, flushes, expansion of the original code); the report is
+ * written at exit to <path>.<pid>, as one "key value" pair per line,
+ * e.g.,
+ *
+ * 	traces.instrumented	1024
+ * 	traces.regenerated	12
+ * 	calls.total		23110
+ * 	calls.MOV		8841
+ * 	cache.flushes		0
+ * 	cache.expansion		9.42
+ *
+ * every process writes its own report; a child starts from zero at
+ * fork, and an image loaded by execve(2) (-follow_execv) takes over the
+ * report of its process (the previous image never reaches its fini)
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include <set>
+
+#include "libdft_api.h"
+#include "libdft_stats.h"
+#include "branch_pred.h"
+
+
+/* instrumentation statistics are enabled (flag) */
+size_t stats_on = 0;
+
+/* report file and the path that it is derived from */
+static FILE *stats_fp = NULL;
+static string stats_path;
+
+/* instrumented traces (address, version); see stats_trace() */
+static set< pair<ADDRINT, ADDRINT> > stats_seen;
+
+/* counters */
+static struct {
+	UINT64	traces;				/* traces instrumented */
+	UINT64	regen;				/* ...that were seen before */
+	UINT64	bbls;				/* BBLs instrumented */
+	UINT64	ins;				/* instructions instrumented */
+	UINT64	calls;				/* analysis calls inserted */
+	UINT64	iclass[XED_ICLASS_LAST];	/* ...per instruction class */
+	UINT64	inserted;			/* traces placed in the cache */
+	UINT64	orig_sz;			/* ...original size (bytes) */
+	UINT64	cache_sz;			/* ...code cache size (bytes) */
+	UINT64	fills;				/* code cache full events */
+	UINT64	flushes;			/* code cache flushes */
+} stats;
+
+/*
+ * account a trace that is being instrumented
+ *
+ * a trace that is instrumented more than once (at the same version)
+ * has been regenerated; e.g., after a code cache flush
+ *
+ * @trace:	the trace; given by PIN
+ */
+void
+stats_trace(TRACE trace)
+{
+	/* trace counters */
+	stats.traces++;
+	stats.bbls	+= TRACE_NumBbl(trace);
+	stats.ins	+= TRACE_NumIns(trace);
+
+	/* regenerated trace */
+	if (!stats_seen.insert(make_pair(TRACE_Address(trace),
+					TRACE_Version(trace))).second)
+		stats.regen++;
+}
+
+/*
+ * account an analysis call; invoked by the DFT_INS_* wrappers
+ *
+ * @ins:	the instrumented instruction
+ */
+void
+stats_call(INS ins)
+{
+	/* call counters */
+	stats.calls++;
+	stats.iclass[INS_Opcode(ins)]++;
+}
+
+/*
+ * code cache callback; a trace was placed in the code cache
+ *
+ * @trace:	the trace; given by PIN
+ * @v:		callback value
+ */
+static void
+stats_cache_insert(TRACE trace, VOID *v)
+{
+	/* expansion counters */
+	stats.inserted++;
+	stats.orig_sz	+= TRACE_Size(trace);
+	stats.cache_sz	+= TRACE_CodeCacheSize(trace);
+}
+
+/*
+ * code cache callback; the code cache is full
+ *
+ * @trace_sz:	size of the trace that did not fit
+ * @stub_sz:	size of its exit stubs
+ */
+static void
+stats_cache_full(UINT32 trace_sz, UINT32 stub_sz)
+{
+	stats.fills++;
+}
+
+/*
+ * code cache callback; the code cache was flushed
+ */
+static void
+stats_cache_flushed(void)
+{
+	stats.flushes++;
+}
+
+/*
+ * open the report of the current process (<path>.<pid>)
+ *
+ * returns:	0 on success, 1 on error
+ */
+static int
+stats_open(void)
+{
+	/* the report of this process */
+	string path = stats_path + "." + decstr(getpid());
+
+	/* open the report; optimized branch */
+	if (unlikely((stats_fp = fopen(path.c_str(), "w")) == NULL)) {
+		/* error message */
+		LOG(string(__func__) + ": " + path +
+				" open failed (" + string(strerror(errno)) +
+				")\n");
+
+		/* failed */
+		return 1;
+	}
+
+	/* success */
+	return 0;
+}
+
+/*
+ * give the child its own report
+ *
+ * called in the child after fork; the report of the parent is closed
+ * (nothing has been written to it yet), and the counters start from
+ * zero, so that the report covers the child only
+ *
+ * @tid:	the thread id of the child
+ * @ctx:	CPU context
+ * @v:		callback value
+ */
+static void
+stats_fork(THREADID tid, const CONTEXT *ctx, VOID *v)
+{
+	/* drop the report of the parent */
+	(void)fclose(stats_fp);
+	stats_fp = NULL;
+
+	/* reset the counters */
+	(void)memset(&stats, 0, sizeof(stats));
+
+	/* open the report of the child; optimized branch */
+	if (unlikely(stats_open() != 0))
+		/* no report for this process */
+		stats_on = 0;
+}
+
+/*
+ * write the report (fini function)
+ *
+ * @code:	exit code of the application
+ * @v:		callback value
+ */
+static void
+stats_fini(INT32 code, VOID *v)
+{
+	/* iterator */
+	size_t i;
+
+	/* no report (the child could not open its own) */
+	if (unlikely(stats_fp == NULL))
+		return;
+
+	/* traces */
+	(void)fprintf(stats_fp, "traces.instrumented\t%llu\n",
+			(unsigned long long)stats.traces);
+	(void)fprintf(stats_fp, "traces.regenerated\t%llu\n",
+			(unsigned long long)stats.regen);
+	(void)fprintf(stats_fp, "traces.bbls\t%llu\n",
+			(unsigned long long)stats.bbls);
+	(void)fprintf(stats_fp, "traces.ins\t%llu\n",
+			(unsigned long long)stats.ins);
+
+	/* analysis calls */
+	(void)fprintf(stats_fp, "calls.total\t%llu\n",
+			(unsigned long long)stats.calls);
+	(void)fprintf(stats_fp, "calls.per_ins\t%.2f\n", (stats.ins == 0) ?
+			0.0 : (double)stats.calls / stats.ins);
+	for (i = 0; i < XED_ICLASS_LAST; i++)
+		if (stats.iclass[i] != 0)
+			(void)fprintf(stats_fp, "calls.%s\t%llu\n",
+				xed_iclass_enum_t2str((xed_iclass_enum_t)i),
+				(unsigned long long)stats.iclass[i]);
+
+	/* code cache */
+	(void)fprintf(stats_fp, "cache.traces\t%llu\n",
+			(unsigned long long)stats.inserted);
+	(void)fprintf(stats_fp, "cache.fills\t%llu\n",
+			(unsigned long long)stats.fills);
+	(void)fprintf(stats_fp, "cache.flushes\t%llu\n",
+			(unsigned long long)stats.flushes);
+	(void)fprintf(stats_fp, "cache.expansion\t%.2f\n",
+			(stats.orig_sz == 0) ?
+			0.0 : (double)stats.cache_sz / stats.orig_sz);
+	(void)fprintf(stats_fp, "cache.used\t%u\n", CODECACHE_CodeMemUsed());
+	(void)fprintf(stats_fp, "cache.reserved\t%u\n",
+			CODECACHE_CodeMemReserved());
+	(void)fprintf(stats_fp, "cache.limit\t%u\n",
+			CODECACHE_CacheSizeLimit());
+	(void)fprintf(stats_fp, "cache.block\t%u\n", CODECACHE_BlockSize());
+	(void)fprintf(stats_fp, "cache.resident\t%u\n",
+			CODECACHE_NumTracesInCache());
+	(void)fprintf(stats_fp, "cache.stubs\t%u\n",
+			CODECACHE_ExitStubsInCache());
+
+	/* cleanup */
+	(void)fclose(stats_fp);
+	stats_fp = NULL;
+}
+
+/*
+ * enable the instrumentation statistics
+ *
+ * must be invoked before the application starts
+ * (i.e., before any trace is instrumented)
+ *
+ * @path:	the path of the report (the pid is appended)
+ *
+ * returns:	0 on success, 1 on error
+ */
+int
+stats_init(const char *path)
+{
+	/* sanity check; optimized branch */
+	if (unlikely(path == NULL))
+		/* return with failure */
+		return 1;
+
+	/* open the report; optimized branch */
+	stats_path = path;
+	if (unlikely(stats_open() != 0))
+		/* failed */
+		return 1;
+
+	/* reset the counters */
+	(void)memset(&stats, 0, sizeof(stats));
+
+	/* register the code cache callbacks */
+	CODECACHE_AddTraceInsertedFunction(stats_cache_insert, NULL);
+	CODECACHE_AddFullCacheFunction(stats_cache_full, NULL);
+	CODECACHE_AddCacheFlushedFunction(stats_cache_flushed, NULL);
+
+	/* write the report at exit; a child writes its own */
+	PIN_AddFiniFunction(stats_fini, NULL);
+	PIN_AddForkFunction(FPOINT_AFTER_IN_CHILD, stats_fork, NULL);
+
+	/* enable the accounting */
+	stats_on = 1;
+
+	/* success */
+	return 0;
+}
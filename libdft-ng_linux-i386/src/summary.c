@@ -0,0 +1,553 @@
+/*-
+ * Copyright (c) 2011, 2012, 2013, Columbia University
+ * All rights reserved.
+ *
+ * This software was developed by Vasileios P. Kemerlis <vpk@cs.columbia.edu>
+ * at Columbia University, New York, NY, USA, in June 2011.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Columbia University nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * function summaries
+ *
+ * the string and memory routines of libc (e.g., memcpy(3), strlen(3))
+ * are executed through thousands of instrumented instructions, whereas
+ * their effect on the tagmap can be expressed with a single bulk tagmap
+ * operation. We hook the entry point of every such routine (and its
+ * optimized variants) and apply the corresponding tag effect at once;
+ * the instructions of the routine are not instrumented for propagation
+ * (see summary_covers() and trace_inspect())
+ *
+ * NOTE: the effect is applied before the routine is executed; this is
+ * safe since the source operands are not modified by the routines, and
+ * no propagation takes place inside them. The caller-saved registers
+ * (i.e., ECX and EDX) are dead after the call, and their tags are cleared.
+ * The strings and buffers of the application are scanned with
+ * PIN_SafeCopy(); if they are not readable, the summary has no effect
+ * and the routine faults in the application as it would natively
+ */
+
+#include <string.h>
+
+#include "libdft_api.h"
+#include "libdft_replay.h"
+#include "summary.h"
+#include "tagmap.h"
+#include "branch_pred.h"
+
+
+/* thread context */
+extern REG thread_ctx_ptr;
+
+/* the address ranges of the summarized routines */
+static map<ADDRINT, ADDRINT> summary_rng;
+
+/*
+ * set the tags of the registers that are modified by a summarized routine
+ *
+ * EAX holds the return value; ECX and EDX are caller-saved and dead
+ *
+ * @thread_ctx:	the thread context
+ * @tag:	the tag value of the return value (EAX)
+ */
+static inline void
+summary_ret(thread_ctx_t *thread_ctx, uint32_t tag)
+{
+	thread_ctx->vcpu.gpr[7] = tag;
+	thread_ctx->vcpu.gpr[6] = TAG_ZERO;
+	thread_ctx->vcpu.gpr[5] = TAG_ZERO;
+}
+
+/*
+ * get the length of a string in the address space of the application
+ *
+ * the string is fetched in chunks with PIN_SafeCopy(), so that an
+ * invalid pointer does not fault inside the tool
+ *
+ * @s:		the string address
+ * @n:		the maximum number of bytes to scan
+ * @nul:	set to 1 if the terminating NUL byte was found, 0 otherwise
+ *
+ * returns:	the number of bytes before the NUL byte, the first
+ * 		unreadable byte, or n (whichever comes first)
+ */
+size_t
+summary_strnlen(ADDRINT s, size_t n, size_t *nul)
+{
+	/* chunk */
+	char buf[SUMMARY_CHUNK];
+	/* iterators */
+	size_t len = 0, cnt, i;
+
+	/* scan chunk by chunk */
+	for (*nul = 0; len < n; len += cnt) {
+		/* fetch the chunk; stop at the first unreadable byte */
+		if (unlikely((cnt = PIN_SafeCopy(buf, (const VOID *)(s + len),
+			(n - len < SUMMARY_CHUNK) ? n - len :
+			SUMMARY_CHUNK)) == 0))
+			break;
+
+		/* look for the NUL byte */
+		for (i = 0; i < cnt; i++)
+			if (buf[i] == '\0') {
+				*nul = 1;
+				return len + i;
+			}
+	}
+
+	/* no NUL byte */
+	return len;
+}
+
+/*
+ * find the first pair of bytes that differ in two
+ * buffers in the address space of the application
+ *
+ * the buffers are fetched in chunks with PIN_SafeCopy() (see
+ * summary_strnlen()); for strings (str = 1), the scan also stops
+ * after the first pair of equal NUL bytes
+ *
+ * @s1:		the first buffer address
+ * @s2:		the second buffer address
+ * @n:		the maximum number of bytes to scan
+ * @str:	flag; the buffers are strings
+ * @pos:	set to the offset of the deciding pair of bytes
+ *
+ * returns:	1 if a deciding pair was found, 0 if the buffers
+ * 		are equal (n bytes), -1 on an unreadable byte
+ */
+static inline int
+summary_cmp(ADDRINT s1, ADDRINT s2, size_t n, size_t str, size_t *pos)
+{
+	/* chunks */
+	char buf1[SUMMARY_CHUNK], buf2[SUMMARY_CHUNK];
+	/* iterators */
+	size_t len = 0, cnt, i;
+
+	/* scan chunk by chunk */
+	for (; len < n; len += cnt) {
+		/* fetch the chunks; the shorter one limits the comparison */
+		cnt = PIN_SafeCopy(buf1, (const VOID *)(s1 + len),
+			(n - len < SUMMARY_CHUNK) ? n - len : SUMMARY_CHUNK);
+		cnt = PIN_SafeCopy(buf2, (const VOID *)(s2 + len), cnt);
+
+		/* unreadable; optimized branch */
+		if (unlikely(cnt == 0))
+			return -1;
+
+		/* compare */
+		for (i = 0; i < cnt; i++)
+			if (buf1[i] != buf2[i] || (str && buf1[i] == '\0')) {
+				*pos = len + i;
+				return 1;
+			}
+	}
+
+	/* equal */
+	return 0;
+}
+
+/*
+ * memcpy(3) summary (analysis function)
+ *
+ * t[dst] = t[src] for n bytes; t[eax] = t[dst (argument)]
+ *
+ * @thread_ctx:	the thread context
+ * @argp:	pointer to the arguments (stack)
+ * @dst:	destination address
+ * @src:	source address
+ * @n:		number of bytes
+ */
+static void PIN_FAST_ANALYSIS_CALL
+memcpy_summary(thread_ctx_t *thread_ctx, ADDRINT *argp,
+		ADDRINT dst, ADDRINT src, ADDRINT n)
+{
+	/* copy the tags; memmove(3) semantics anyway */
+	tagmap_cpyn(dst, src, n);
+
+	/* the return value is the destination pointer */
+	summary_ret(thread_ctx, tagmap_getl((size_t)argp));
+}
+
+/*
+ * memset(3) summary (analysis function)
+ *
+ * t[dst] = t[c] for n bytes; t[eax] = t[dst (argument)]
+ *
+ * @thread_ctx:	the thread context
+ * @argp:	pointer to the arguments (stack)
+ * @dst:	destination address
+ * @c:		constant byte (unused)
+ * @n:		number of bytes
+ */
+static void PIN_FAST_ANALYSIS_CALL
+memset_summary(thread_ctx_t *thread_ctx, ADDRINT *argp,
+		ADDRINT dst, ADDRINT c, ADDRINT n)
+{
+	/* the tag of the constant byte */
+	uint8_t tag = tagmap_getb((size_t)(argp + 1));
+
+	/* fill the destination; optimized branch */
+	if (likely(tag == TAG_ZERO))
+		tagmap_clrn(dst, n);
+	else
+		tagmap_setn(dst, n, tag);
+
+	/* the return value is the destination pointer */
+	summary_ret(thread_ctx, tagmap_getl((size_t)argp));
+}
+
+/*
+ * strcpy(3) summary (analysis function)
+ *
+ * t[dst] = t[src] for strlen(src) + 1 bytes; t[eax] = t[dst (argument)]
+ *
+ * @thread_ctx:	the thread context
+ * @argp:	pointer to the arguments (stack)
+ * @dst:	destination address
+ * @src:	source address
+ * @n:		unused
+ */
+static void PIN_FAST_ANALYSIS_CALL
+strcpy_summary(thread_ctx_t *thread_ctx, ADDRINT *argp,
+		ADDRINT dst, ADDRINT src, ADDRINT n)
+{
+	/* the length of the string, and whether it is terminated */
+	size_t nul, len = summary_strnlen(src, (size_t)-1, &nul);
+
+	/* unreadable string; it faults in the application */
+	if (unlikely(nul == 0))
+		return;
+
+	/* copy the tags, including the terminating NUL byte */
+	tagmap_cpyn(dst, src, len + 1);
+
+	/* the return value is the destination pointer */
+	summary_ret(thread_ctx, tagmap_getl((size_t)argp));
+}
+
+/*
+ * strncpy(3) summary (analysis function)
+ *
+ * t[dst] = t[src] for strnlen(src, n) bytes; the
+ * NUL padding (if any) is clear; t[eax] = t[dst (argument)]
+ *
+ * @thread_ctx:	the thread context
+ * @argp:	pointer to the arguments (stack)
+ * @dst:	destination address
+ * @src:	source address
+ * @n:		number of bytes
+ */
+static void PIN_FAST_ANALYSIS_CALL
+strncpy_summary(thread_ctx_t *thread_ctx, ADDRINT *argp,
+		ADDRINT dst, ADDRINT src, ADDRINT n)
+{
+	/* the number of bytes copied from src */
+	size_t nul, len = summary_strnlen(src, n, &nul);
+
+	/* unreadable string; it faults in the application */
+	if (unlikely(nul == 0 && len < n))
+		return;
+
+	/* copy the tags */
+	tagmap_cpyn(dst, src, len);
+
+	/* clear the padding */
+	if (len < n)
+		tagmap_clrn(dst + len, n - len);
+
+	/* the return value is the destination pointer */
+	summary_ret(thread_ctx, tagmap_getl((size_t)argp));
+}
+
+/*
+ * strlen(3) summary (analysis function)
+ *
+ * the length is computed using pointer arithmetic; t[eax] = 0
+ *
+ * @thread_ctx:	the thread context
+ * @argp:	pointer to the arguments (stack)
+ * @s:		string address (unused)
+ * @a1:		unused
+ * @a2:		unused
+ */
+static void PIN_FAST_ANALYSIS_CALL
+strlen_summary(thread_ctx_t *thread_ctx, ADDRINT *argp,
+		ADDRINT s, ADDRINT a1, ADDRINT a2)
+{
+	/* clear the return value */
+	summary_ret(thread_ctx, TAG_ZERO);
+}
+
+/*
+ * strcmp(3) summary (analysis function)
+ *
+ * the result is computed from the first pair of bytes that differ
+ * (or the terminating NUL bytes); t[eax] = t[s1[i]] | t[s2[i]]
+ *
+ * @thread_ctx:	the thread context
+ * @argp:	pointer to the arguments (stack)
+ * @s1:		first string address
+ * @s2:		second string address
+ * @n:		unused
+ */
+static void PIN_FAST_ANALYSIS_CALL
+strcmp_summary(thread_ctx_t *thread_ctx, ADDRINT *argp,
+		ADDRINT s1, ADDRINT s2, ADDRINT n)
+{
+	/* offset of the deciding pair of bytes */
+	size_t i;
+	/* the tag of the result */
+	uint32_t tag;
+
+	/* find the deciding pair; unreadable strings fault in the application */
+	if (unlikely(summary_cmp(s1, s2, (size_t)-1, 1, &i) != 1))
+		return;
+
+	/* extend the tag to all the bytes of the result */
+	tag = (tagmap_getb(s1 + i) | tagmap_getb(s2 + i)) * 0x01010101U;
+
+	/* set the tag of the return value */
+	summary_ret(thread_ctx, tag);
+}
+
+/*
+ * memcmp(3) summary (analysis function)
+ *
+ * the result is computed from the first pair of bytes that differ;
+ * t[eax] = t[s1[i]] | t[s2[i]], or clear if the buffers are equal
+ *
+ * @thread_ctx:	the thread context
+ * @argp:	pointer to the arguments (stack)
+ * @s1:		first buffer address
+ * @s2:		second buffer address
+ * @n:		number of bytes
+ */
+static void PIN_FAST_ANALYSIS_CALL
+memcmp_summary(thread_ctx_t *thread_ctx, ADDRINT *argp,
+		ADDRINT s1, ADDRINT s2, ADDRINT n)
+{
+	/* offset of the deciding pair of bytes, and the outcome */
+	size_t i;
+	int ret;
+	/* the tag of the result */
+	uint32_t tag = TAG_ZERO;
+
+	/* find the deciding pair; unreadable buffers fault in the application */
+	if (unlikely((ret = summary_cmp(s1, s2, n, 0, &i)) < 0))
+		return;
+
+	/* the buffers differ; extend the tag to all the bytes of the result */
+	if (ret > 0)
+		tag = (tagmap_getb(s1 + i) | tagmap_getb(s2 + i)) * 0x01010101U;
+
+	/* set the tag of the return value */
+	summary_ret(thread_ctx, tag);
+}
+
+/* summarized routines */
+static summary_desc_t summary_desc[] = {
+	{ "memcpy",	(AFUNPTR)memcpy_summary },
+	{ "memmove",	(AFUNPTR)memcpy_summary },
+	{ "memset",	(AFUNPTR)memset_summary },
+	{ "strcpy",	(AFUNPTR)strcpy_summary },
+	{ "strncpy",	(AFUNPTR)strncpy_summary },
+	{ "strlen",	(AFUNPTR)strlen_summary },
+	{ "strcmp",	(AFUNPTR)strcmp_summary },
+	{ "memcmp",	(AFUNPTR)memcmp_summary },
+	{ NULL,		NULL }
+};
+
+/*
+ * match a routine name against a summary descriptor
+ *
+ * a routine matches if its name is the name of the descriptor, or
+ * one of the optimized (or checked) variants that libc selects with
+ * IFUNC (e.g., __memcpy_ssse3, __memcpy_chk)
+ *
+ * @name:	the routine name
+ * @desc:	the summary descriptor
+ *
+ * returns:	1 on match, 0 otherwise
+ */
+static inline int
+summary_match(const string &name, const summary_desc_t *desc)
+{
+	/* exact match */
+	if (name.compare(desc->name) == 0)
+		return 1;
+
+	/* optimized variant */
+	return (name.compare(0, strlen(SUMMARY_VAR_PREFIX),
+				SUMMARY_VAR_PREFIX) == 0 &&
+		name.compare(strlen(SUMMARY_VAR_PREFIX),
+				strlen(desc->name), desc->name) == 0 &&
+		name.compare(strlen(SUMMARY_VAR_PREFIX) + strlen(desc->name),
+			strlen(SUMMARY_VAR_SUFFIX), SUMMARY_VAR_SUFFIX) == 0);
+}
+
+/*
+ * ELF image loading callback
+ *
+ * hook the entry point of every routine that is summarized,
+ * and record its address range
+ *
+ * @img:	image handle
+ * @v:		callback value
+ */
+static void
+summary_load(IMG img, VOID *v)
+{
+	/* iterators */
+	SEC sec;
+	RTN rtn;
+	summary_desc_t *desc;
+
+	/* traverse the routines of the image */
+	for (sec = IMG_SecHead(img); SEC_Valid(sec); sec = SEC_Next(sec))
+		for (rtn = SEC_RtnHead(sec); RTN_Valid(rtn);
+				rtn = RTN_Next(rtn)) {
+			/*
+			 * IFUNC resolvers share their name with the
+			 * routine that they resolve; skip them
+			 */
+			if (unlikely(SYM_IFuncResolver(RTN_Sym(rtn))))
+				continue;
+
+			/* look for a summary */
+			for (desc = summary_desc; desc->name != NULL; desc++)
+				if (summary_match(RTN_Name(rtn), desc))
+					break;
+
+			/* not summarized; optimized branch */
+			if (likely(desc->name == NULL))
+				continue;
+
+			/* hook the entry point */
+			RTN_Open(rtn);
+
+			/*
+			 * decoupled propagation; the summary updates
+			 * the tags directly, hence the records of the
+			 * thread must be replayed first
+			 */
+			if (replay_on != 0)
+				RTN_InsertCall(rtn,
+					IPOINT_BEFORE,
+					(AFUNPTR)replay_sync,
+					IARG_FAST_ANALYSIS_CALL,
+					IARG_REG_VALUE, thread_ctx_ptr,
+					IARG_END);
+			RTN_InsertCall(rtn,
+				IPOINT_BEFORE,
+				desc->summary,
+				IARG_FAST_ANALYSIS_CALL,
+				IARG_REG_VALUE, thread_ctx_ptr,
+				IARG_FUNCARG_ENTRYPOINT_REFERENCE, 0,
+				IARG_FUNCARG_ENTRYPOINT_VALUE, 0,
+				IARG_FUNCARG_ENTRYPOINT_VALUE, 1,
+				IARG_FUNCARG_ENTRYPOINT_VALUE, 2,
+				IARG_END);
+			RTN_Close(rtn);
+
+			/* record the address range */
+			summary_rng[RTN_Address(rtn)] =
+				RTN_Address(rtn) + RTN_Size(rtn);
+#ifdef DEBUG_MEMTRACK
+			/* verbose */
+			LOG(string(__func__) + ": " + RTN_Name(rtn) + " " +
+				hexstr(RTN_Address(rtn)) + "-" +
+				hexstr(RTN_Address(rtn) + RTN_Size(rtn)) +
+				"\n");
+#endif
+		}
+}
+
+/*
+ * ELF image unloading callback
+ *
+ * forget the address ranges of the summarized
+ * routines that belong to the unloaded image
+ *
+ * @img:	image handle
+ * @v:		callback value
+ */
+static void
+summary_unload(IMG img, VOID *v)
+{
+	/* erase the ranges inside the image */
+	summary_rng.erase(summary_rng.lower_bound(IMG_LowAddress(img)),
+			summary_rng.upper_bound(IMG_HighAddress(img)));
+}
+
+/*
+ * check if an address belongs to a summarized routine
+ *
+ * invoked at instrumentation time; instructions of summarized
+ * routines are not instrumented for tag propagation
+ *
+ * @addr:	the instruction address
+ *
+ * returns:	1 if the address is covered by a summary, 0 otherwise
+ */
+size_t
+summary_covers(ADDRINT addr)
+{
+	/* iterator */
+	map<ADDRINT, ADDRINT>::iterator it;
+
+	/* no summaries; optimized branch */
+	if (likely(summary_rng.empty()))
+		return 0;
+
+	/* find the first range that starts after addr */
+	it = summary_rng.upper_bound(addr);
+
+	/* no range starts before addr */
+	if (it == summary_rng.begin())
+		return 0;
+
+	/* check the closest range that starts before addr */
+	return (addr < (--it)->second) ? 1 : 0;
+}
+
+/*
+ * initialize the function summaries
+ *
+ * it must be called after libdft_init() and PIN_InitSymbols()
+ *
+ * returns:	0 on success, 1 on error
+ */
+int
+summary_init(void)
+{
+	/* register the image (un)loading callbacks */
+	IMG_AddInstrumentFunction(summary_load, NULL);
+	IMG_AddUnloadFunction(summary_unload, NULL);
+
+	/* success */
+	return 0;
+}
@@ -0,0 +1,63 @@
+/*-
+ * Copyright (c) 2011, 2012, 2013, Columbia University
+ * All rights reserved.
+ *
+ * This software was developed by Vasileios P. Kemerlis <vpk@cs.columbia.edu>
+ * at Columbia University, New York, NY, USA, in June 2011.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Columbia University nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __SUMMARY_H__
+#define __SUMMARY_H__
+
+#include "pin.H"
+
+/* prefix of the optimized variants of a libc routine (e.g., __memcpy_ssse3) */
+#define SUMMARY_VAR_PREFIX	"__"
+#define SUMMARY_VAR_SUFFIX	"_"
+
+/* bytes of application memory that are fetched at a time (PIN_SafeCopy()) */
+#define SUMMARY_CHUNK		64
+
+/*
+ * function summary descriptor
+ *
+ * the summary handler receives the thread context, a pointer to the first
+ * argument of the routine on the stack (i.e., for fetching the tags of the
+ * arguments), and the values of the first three arguments
+ */
+typedef struct {
+	const char	*name;		/* routine name */
+	AFUNPTR		summary;	/* summary handler */
+} summary_desc_t;
+
+
+/* summary API */
+int	summary_init(void);
+size_t	summary_covers(ADDRINT);
+size_t	summary_strnlen(ADDRINT, size_t, size_t *);
+
+#endif /* __SUMMARY_H__ */
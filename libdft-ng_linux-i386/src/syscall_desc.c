@@ -48,6 +48,7 @@
 #include <string.h>
 #include <unistd.h>
 
+#include "filetag.h"
 #include "syscall_desc.h"
 #include "tagmap.h"
 #include <linux/mempolicy.h>
@@ -56,9 +57,7 @@
 
 
 /* ``hardcoded'' tagmap segments */
-#ifdef TAGMAP_COLLAPSE
 extern void *zero_seg;
-#endif
 extern void *null_seg;
 
 /* STAB */
@@ -82,9 +81,7 @@ static void post_socketcall_hook(syscall_ctx_t*);
 static void post_syslog_hook(syscall_ctx_t*);
 static void post_ipc_hook(syscall_ctx_t*);
 static void post_modify_ldt_hook(syscall_ctx_t*);
-#ifdef TAGMAP_COLLAPSE
 static void post_mprotect_hook(syscall_ctx_t*);
-#endif
 static void post_quotactl_hook(syscall_ctx_t *ctx);
 static void post_readv_hook(syscall_ctx_t*);
 static void post__sysctl_hook(syscall_ctx_t*);
@@ -103,753 +100,246 @@ static void post_lookup_dcookie_hook(syscall_ctx_t *ctx);
 static void post_mq_timedreceive_hook(syscall_ctx_t *ctx);
 static void post_readlinkat_hook(syscall_ctx_t*);
 static void post_epoll_wait_hook(syscall_ctx_t *ctx);
-#if LINUX_VERSION_CODE >= KERNEL_VERSION(2,6,33)
+static void post_getrandom_hook(syscall_ctx_t *ctx);
+static void post_process_vm_readv_hook(syscall_ctx_t *ctx);
+static void post_sysv_hook(syscall_ctx_t *ctx);
+static void post_socket_hook(syscall_ctx_t *ctx);
 static void post_recvmmsg_hook(syscall_ctx_t *ctx);
+
+#ifndef	MREMAP_DONTUNMAP
+#define	MREMAP_DONTUNMAP	4	/* see linux/mman.h; Linux 5.7	*/
 #endif
 
-/* syscall descriptors */
-syscall_desc_t syscall_desc[SYSCALL_MAX] = {
-	/* __NR_restart_syscall */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_exit */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_fork */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_read */
-	{ 3, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_read_hook },
-	/* __NR_write */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_open */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_close */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_waitpid */
-	{ 3, 0, 1, { 0, sizeof(int), 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_creat */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_link */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_unlink */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },	/* 10 */
-	/* __NR_execve */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_chdir */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_time */
-	{ 1, 0, 1, { sizeof(time_t), 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_mknod */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_chmod */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_lchown16 */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_break; not implemented */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_stat */
-	{ 2, 0, 1, { 0, sizeof(struct __old_kernel_stat), 0, 0, 0, 0 }, NULL,
-	NULL },
-	/* __NR_lseek */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_getpid */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },	/* 20 */
-	/* __NR_mount */
-	{ 5, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_oldumount */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_setuid16 */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_getuid16 */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_stime */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_ptrace */
-	{ 4, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_alarm */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_fstat */
-	{ 2, 0, 1, { 0, sizeof(struct __old_kernel_stat), 0, 0, 0, 0 }, NULL,
-	NULL },
-	/* __NR_pause */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_utime */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },	/* 30 */
-	/* __NR_stty; not implemented */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_gtty; not implemented */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_access */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_nice */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_ftime; not implemented */
-	{ 0, 0, 1, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_sync */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_kill */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_rename */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_mkdir */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_rmdir */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },	/* 40 */
-	/* __NR_dup */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_pipe */
-	{ 1, 0, 1, { sizeof(int) * 2, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_times */
-	{ 1, 0, 1, { sizeof(struct tms), 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_prof; not implemented */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_brk */
-	{ 1, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_brk_hook },
-	/* __NR_setgid16 */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_getgid16 */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_signal */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_geteuid16 */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_getegid16 */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },	/* 50 */
-	/* __NR_acct */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_umount */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_lock; not implemented */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_ioctl; TODO */
-	{ 3, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_fcntl */
-	{ 3, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_fcntl_hook },
-	/* __NR_mpx; not implemented */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_setpgid */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_ulimit; not implemented */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_olduname */
-	{ 1, 0, 1, { sizeof(struct oldold_utsname), 0, 0, 0, 0, 0 }, NULL,
-	NULL },
-	/* __NR_umask */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },	/* 60 */
-	/* __NR_chroot */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_ustat */
-	{ 2, 0, 1, { 0, sizeof(struct ustat), 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_dup2 */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_getppid */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_getpgrp */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_setsid */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_sigaction */
-	{ 3, 0, 1, { 0, 0, sizeof(struct sigaction), 0, 0, 0 }, NULL, NULL },
-	/* __NR_sgetmask */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_ssetmask */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_setreuid16 */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },	/* 70 */
-	/* __NR_setregid16 */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_sigsuspend */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_sigpending*/
-	{ 1, 0, 1, { sizeof(old_sigset_t), 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_sethostname */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_setrlimit */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_old_getrlimit */
-	{ 2, 0, 1, { 0, sizeof(struct rlimit), 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_getrusage */
-	{ 2, 0, 1, { 0, sizeof(struct rusage), 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_gettimeofday */
-	{ 2, 0, 1, { sizeof(struct timeval), sizeof(struct timezone), 0,
-	 0, 0, 0 }, NULL, NULL },
-	/* __NR_settimeofday */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_getgroups */
-	{ 2, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_getgroups16_hook }, /* 80 */
-	/* __NR_setgroups16 */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_select */
-	{ 5, 0, 1, { 0, sizeof(fd_set), sizeof(fd_set), sizeof(fd_set), 
-	sizeof(struct timeval), 0 }, NULL, NULL },
-	/* __NR_symlink */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_lstat */
-	{ 2, 0, 1, { 0, sizeof(struct __old_kernel_stat), 0, 0, 0, 0 }, NULL,
-	NULL },
-	/* __NR_readlink */
-	{ 3, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_read_hook },
-	/* __NR_uselib; TODO */
-	{ 1, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_uselib_hook },
-	/* __NR_swapon */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_reboot */
-	{ 4, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_old_readdir */
-	{ 3, 0, 1, { 0, sizeof(struct old_linux_dirent), 0, 0, 0, 0 }, NULL, 		NULL },
-	/* __NR_old_mmap */
-	{ 6, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_mmap_hook }, /* 90 */
-	/* __NR_munmap */
-	{ 2, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_munmap_hook },
-	/* __NR_truncate */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_ftruncate */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_fchmod */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_fchown16 */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_getpriority */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_setpriority */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_profil; not implemented */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_statfs */
-	{ 2, 0, 1, { 0, sizeof(struct statfs), 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_fstatfs */
-	{ 2, 0, 1, { 0, sizeof(struct statfs), 0, 0, 0, 0 }, NULL, NULL },
-	/* 100 */
-	/* __NR_ioperm */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_socketcall */
-	{ 2, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_socketcall_hook },
-	/* __NR_syslog */
-	{ 3, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_syslog_hook },
-	/* __NR_setitimer */
-	{ 3, 0, 1, { 0, 0, sizeof(struct itimerval), 0, 0, 0 }, NULL, NULL },
-	/* __NR_getitimer */
-	{ 2, 0, 1, { 0, sizeof(struct itimerval), 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_newstat */
-	{ 2, 0, 1, { 0, sizeof(struct stat), 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_newlstat */
-	{ 2, 0, 1, { 0, sizeof(struct stat), 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_newfstat */
-	{ 2, 0, 1, { 0, sizeof(struct stat), 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_uname */
-	{ 1, 0, 1, { sizeof(struct new_utsname), 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_iopl */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },	/* 110 */
-	/* __NR_vhangup */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_idle; not implemented */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_vm86old */
-	{ 2, 0, 1, { sizeof(struct vm86_struct), 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_wait4 */
-	{ 4, 0, 1, { 0, sizeof(int), 0, sizeof(struct rusage), 0, 0 },
-	NULL, NULL },
-	/* __NR_swapoff */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_sysinfo */
-	{ 1, 0, 1, { sizeof(struct sysinfo), 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_ipc */
-	{ 6, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_ipc_hook },
-	/* __NR_fsync */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_sigreturn */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_clone */
-	{ 5, 0, 1, { 0, 0, sizeof(int), 0, 0, 0 }, NULL, NULL },
-	/* 120 */
-	/* __NR_setdomainname */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_newuname */
-	{ 1, 0, 1, { sizeof(struct new_utsname), 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_modify_ldt */
-	{ 3, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_modify_ldt_hook },
-	/* __NR_adjtimex */
-	{ 1, 0, 1, { sizeof(struct timex), 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_mprotect */
-#ifdef TAGMAP_COLLAPSE
-	{ 3, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_mprotect_hook },
+#ifndef	MAP_STACK
+#define	MAP_STACK	0x20000		/* thread stacks (glibc)	*/
+#endif
+
+/* file offset of a mapping; mmap2(2) takes it in pages */
+#ifdef __NR_mmap2
+#define MMAP_OFF(ctx)	(((ctx)->nr == __NR_mmap2) ?			\
+			((off64_t)(ctx)->arg[SYSCALL_ARG5] << PAGE_SHIFT) :	\
+			(off64_t)(ctx)->arg[SYSCALL_ARG5])
 #else
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL},
+#define MMAP_OFF(ctx)	((off64_t)(ctx)->arg[SYSCALL_ARG5])
 #endif
-	/* __NR_sigprocmask */
-	{ 3, 0, 1, { 0, 0, sizeof(old_sigset_t), 0, 0, 0 }, NULL, NULL },
-	/* __NR_create_module; not implemented */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_init_module */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_delete_module */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_get_kernel_syms; not implemented */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },	/* 130 */
-	/* __NR_quotactl */
-	{ 4, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_quotactl_hook },
-	/* __NR_getpgid */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_fchdir */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_bdflush */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_sysfs */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_personality */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_afs_syscall; not implemented */
-        { 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_setfsuid16 */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_setfsgid16 */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR__llseek */
-	{ 5, 0, 1, { 0, 0, 0, sizeof(loff_t), 0, 0 }, NULL, NULL },/* 140 */
-	/* __NR_getdents */
-	{ 3, 0, 1, { 0, sizeof(struct linux_dirent), 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_select */
-	{ 5, 0, 1, { 0, sizeof(fd_set), sizeof(fd_set), sizeof(fd_set), 
-	sizeof(struct timeval), 0 }, NULL, NULL },
-	/* __NR_flock */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_msync */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_readv */
-	{ 3, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_readv_hook },
-	/* __NR_writev */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_getsid */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_fdatasync */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR__sysctl */
-	{ 1, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post__sysctl_hook },
-	/* __NR_mlock */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL }, /* 150 */
-	/* __NR_munlock */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_mlockall */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_munlockall */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_sched_setparam */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_sched_getparam */
-	{ 2, 0, 1, { 0, sizeof(struct sched_param), 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_sched_setscheduler */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_sched_getscheduler*/
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_sched_yield */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_sched_get_priority_max */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_sched_get_priority_min */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL }, /* 160 */
-	/* __NR_sched_rr_get_interval */
-	{ 2, 0, 1, { 0, sizeof(struct timespec), 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_nanosleep */
-	{ 2, 0, 1, { 0, sizeof(struct timespec), 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_mremap; TODO */
-	{ 5, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_mremap_hook },
-	/* __NR_setresuid16 */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_getresuid16 */
-	{ 3, 0, 1, { sizeof(old_uid_t), sizeof(old_uid_t), sizeof(old_uid_t), 0,
-	0, 0 }, NULL, NULL },
-	/* __NR_ptregs_vm86 */
-	{ 3, 0, 1, { 0, sizeof(struct vm86plus_struct), 0, 0, 0, 0 }, NULL,
-	NULL },
-	/* __NR_query_module; not implemented */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_poll */
-	{ 3, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_poll_hook },
-	/* __NR_nfsservctl; TODO */
-	{ 3, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_setresgid16 */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL }, /* 170 */
-	/* __NR_getresgid16 */
-	{ 3, 0, 1, { sizeof(old_gid_t), sizeof(old_gid_t), sizeof(old_gid_t), 0,
-	0, 0 }, NULL, NULL },
-	/* __NR_prctl */
-	{ 5, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_rt_sigreturn */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_rt_sigaction */
-	{ 4, 0, 1, { 0, 0, sizeof(struct sigaction), 0, 0, 0 }, NULL, NULL },
-	/* __NR_rt_sigprocmask */
-	{ 4, 0, 1, { 0, 0, sizeof(sigset_t), 0, 0, 0 }, NULL, NULL },
-	/* __NR_rt_sigpending */
-	{ 2, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_rt_sigpending_hook },
-	/* __NR_rt_sigtimedwait */
-	{ 4, 0, 1, { 0, sizeof(siginfo_t), 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_rt_sigqueueinfo */
-	{ 3, 0, 1, { 0, 0, sizeof(siginfo_t), 0, 0, 0 }, NULL, NULL },
-	/* __NR_rt_sigsuspend */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_pread64 */
-	{ 4, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_read_hook }, /* 180 */
-	/* __NR_pwrite64 */
-	{ 4, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_chown16 */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_getcwd */
-	{ 2, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_getcwd_hook },
-	/* __NR_capget */
-	{ 2, 0, 1, { sizeof(cap_user_header_t), sizeof(cap_user_data_t), 0, 0,
-	0, 0 }, NULL, NULL },
-	/* __NR_capset */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_sigaltstack */
-	{ 2, 0, 1, { 0, sizeof(stack_t), 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_sendfile */
-	{ 4, 0, 1, { 0, 0, sizeof(off_t), 0, 0, 0 }, NULL, NULL },
-	/* __NR_streams1; not implemented */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_streams2; not implemented */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_vfork */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL }, /* 190 */
-	/* __NR_getrlimit */
-	{ 2, 0, 1, { 0, sizeof(struct rlimit), 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_mmap2 */
-	{ 6, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_mmap_hook },
-	/* __NR_truncate64 */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_ftruncate64 */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_stat64 */
-	{ 2, 0, 1, { 0, sizeof(struct stat64), 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_lstat64 */
-	{ 2, 0, 1, { 0, sizeof(struct stat64), 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_fstat64 */
-	{ 2, 0, 1, { 0, sizeof(struct stat64), 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_lchown */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_getuid */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_getgid */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL }, /* 200 */
-	/* __NR_geteuid */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_getegid */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_setreuid */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_setregid */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_getgroups */
-	{ 2, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_getgroups_hook },
-	/* __NR_setgroups */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_fchown */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_setresuid */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_getresuid */
-	{ 3, 0, 1, { sizeof(uid_t), sizeof(uid_t), sizeof(uid_t), 0, 0, 0 },
-	NULL, NULL },
-	/* __NR_setresgid */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL }, /* 210 */
-	/* __NR_getresgid */
-	{ 3, 0, 1, { sizeof(gid_t), sizeof(gid_t), sizeof(gid_t), 0, 0, 0 },
-	NULL, NULL },
-	/* __NR_chown */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_setuid */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_setgid */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_setfsuid */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_setfsgid */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_pivot_root */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_mincore */
-	{ 3, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_mincore_hook },
-	/* __NR_madvise */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_getdents */
-	{ 3, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_getdents_hook }, /* 220 */
-	/* __NR_fcntl64 */
-	{ 3, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_fcntl_hook },
-	/* __NR_TUX; not implemented */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_223 ; not implemented  */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_gettid */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_readahead */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_setxattr */
-	{ 5, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_lsetxattr */
-	{ 5, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_fsetxattr */
-	{ 5, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_getxattr */
-	{ 4, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_getxattr_hook },
-	/* __NR_lgetxattr */
-	{ 4, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_getxattr_hook }, /* 230 */
-	/* __NR_fgetxattr */
-	{ 4, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_getxattr_hook },
-	/* __NR_listxattr */
-	{ 3, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_listxattr_hook },
-	/* __NR_llistxattr */
-	{ 3, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_listxattr_hook },
-	/* __NR_flistxattr */
-	{ 3, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_listxattr_hook },
-	/* __NR_removexattr */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_lremovexattr */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_fremovexattr */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_tkill */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_sendfile64 */
-	{ 4, 0, 1, { 0, 0, sizeof(loff_t), 0, 0, 0 }, NULL, NULL },
-	/* __NR_futex */
-	{ 6, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL }, /* 240 */
-	/* __NR_sched_setaffinity */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_sched_getaffinity */
-	{ 3, 0, 1, { 0, 0, sizeof(cpu_set_t), 0, 0, 0 }, NULL, NULL },
-	/* __NR_set_thread_area */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_get_thread_area */
-	{ 1, 0, 1, { sizeof(struct user_desc), 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_io_setup */
-	{ 2, 0, 1, { 0, sizeof(aio_context_t), 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_io_destroy */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_io_getevents */
-	{ 5, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_io_getevents_hook },
-	/* __NR_io_submit */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_io_cancel */
-	{ 3, 0, 1, { 0, 0, sizeof(struct io_event), 0, 0, 0 }, NULL, NULL },
-	/* __NR_fadvise64 */
-	{ 4, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL }, /* 250 */
-	/* __NR_251; not implemented */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_exit_group */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_lookup_dcookie */
-	{ 3, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_lookup_dcookie_hook },
-	/* __NR_epoll_create */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_epoll_ctl */
-	{ 4, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_epoll_wait */
-	{ 4, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_epoll_wait_hook },
-	/* __NR_remap_file_pages; TODO */
-	{ 5, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_set_tid_address */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_timer_create */
-	{ 3, 0, 1, { 0, 0, sizeof(timer_t), 0, 0, 0 }, NULL, NULL },
-	/* __NR_timer_settime */
-	{ 4, 0, 1, { 0, 0, 0, sizeof(struct itimerspec), 0, 0 }, NULL, NULL },
-	/* 260 */
-	/* __NR_timer_gettime */
-	{ 2, 0, 1, { 0, sizeof(struct itimerspec), 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_timer_getoverrun */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_timer_delete */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_clock_settime */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_clock_gettime */
-	{ 2, 0, 1, { 0, sizeof(struct timespec), 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_clock_getres */
-	{ 2, 0, 1, { 0, sizeof(struct timespec), 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_clock_nanosleep */
-	{ 4, 0, 1, { 0, 0, 0, sizeof(struct timespec), 0, 0 }, NULL, NULL },
-	/* __NR_statfs64 */
-	{ 3, 0, 1, { 0, 0, sizeof(struct statfs64), 0, 0, 0 }, NULL, NULL },
-	/* __NR_fstatfs64 */
-	{ 3, 0, 1, { 0, 0, sizeof(struct statfs64), 0, 0, 0 }, NULL, NULL },
-	/* __NR_tgkill */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL }, /* 270 */
-	/* __NR_utimes */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_fadvise64_64 */
-	{ 4, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_vserver; not implemented */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_mbind */
-	{ 6, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_get_mempolicy */
-	{ 5, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_get_mempolicy_hook },
-	/* __NR_set_mempolicy */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_mq_open */
-	{ 4, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_mq_unlink */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_mq_timedsend */
-	{ 5, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },	
-	/* __NR_mq_timedreceive */
-	{ 5, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_mq_timedreceive_hook },
-	/* 280 */
-	/* __NR_mq_notify */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_mq_getsetattr */
-	{ 3, 0, 1, { 0, 0, sizeof(struct mq_attr), 0, 0, 0 }, NULL, NULL },
-	/* __NR_kexec_load */
-	{ 4, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_waitid */
-	{ 4, 0, 1, { 0, 0, sizeof(siginfo_t), 0, sizeof(struct rusage), 0 },
-	NULL, NULL },
-	/* __NR_285; not implemented */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_add_key */
-	{ 5, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_request_key */
-	{ 4, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_keyctl */
-	{ 5, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_ioprio_set */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_ioprio_get */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL }, /* 290 */
-	/* __NR_inotify_init */
-	{ 0, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_inotify_add_watch */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_inotify_rm_watch */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_migrate_pages */
-	{ 4, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_openat */
-	{ 4, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_mkdirat */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_mknodat */
-	{ 4, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_fchownat */
-	{ 5, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_futimesat */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_fstatat64 */
-	{ 4, 0, 1, { 0, 0, sizeof(struct stat64), 0, 0, 0 }, NULL, NULL },
-	/* 300 */
-	/* __NR_unlinkat */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_renameat */
-	{ 4, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_linkat */
-	{ 5, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_symlinkat */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_readlinkat */
-	{ 4, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_readlinkat_hook },
-	/* __NR_fchmodat */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_faccessat */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_pselect6 */
-	{ 6, 0, 1, { 0, sizeof(fd_set), sizeof(fd_set), sizeof(fd_set), 0, 0 }, 
-	NULL, NULL },
-	/* __NR_ppoll */
-	{ 5, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_poll_hook },
-	/* __NR_unshare */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL }, /* 310 */
-	/* __NR_set_robust_list */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_get_robust_list */
-	{ 3, 0, 1, { 0, sizeof(struct robust_list_head*), sizeof(size_t), 0, 0,
-	0 }, NULL, NULL },
-	/* __NR_splice */
-	{ 6, 0, 1, { 0, sizeof(loff_t), 0, sizeof(loff_t), 0, 0 }, NULL, NULL },
-	/* __NR_sync_file_range */
-	{ 4, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_tee */
-	{ 4, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_vmsplice */
-	{ 4, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_move_pages */
-	{ 6, 0, 1, { 0, 0, 0, 0, sizeof(int), 0 }, NULL, NULL },
-	/* __NR_getcpu */
-	{ 3, 0, 1, { sizeof(unsigned), sizeof(unsigned),
-	sizeof(struct getcpu_cache), 0, 0, 0 }, NULL, NULL },
-	/* __NR_epoll_pwait */
-	{ 6, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_epoll_wait_hook },
-	/* __NR_utimensat */
-	{ 4, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL }, /* 320 */
-	/* __NR_signalfd */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_timerfd_create */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_eventfd */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_fallocate */
-	{ 4, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_timerfd_settime */
-	{ 4, 0, 1, { 0, 0, 0, sizeof(struct itimerspec), 0, 0 }, NULL, NULL },
-#if LINUX_VERSION_CODE >= KERNEL_VERSION(2,6,26)
-	/* __NR_timerfd_gettime  */
-	{ 2, 0, 1, { 0, sizeof(struct itimerspec), 0, 0, 0, 0 }, NULL, NULL },
+
+/* syscall specification (i.e., syscall.tbl) */
+typedef struct {
+	size_t	nr;				/* syscall number */
+	size_t	nargs;				/* number of arguments */
+	size_t	map_args[SYSCALL_ARG_NUM];	/* arguments map */
+	void	(* post)(syscall_ctx_t*);	/* post-syscall callback */
+} syscall_spec_t;
+
+/* the entries of the syscalls that are known to the system headers */
+static const syscall_spec_t syscall_spec[] = {
+#include "syscall_tbl.h"
+};
+
+/* syscall descriptors; indexed by the syscall number (see syscall_spec) */
+syscall_desc_t syscall_desc[SYSCALL_MAX];
+
+/* syscall action programs; see syscall_compile() */
+syscall_prog_t syscall_prog[SYSCALL_MAX];
+
+/*
+ * select the clear operation of a syscall output
+ *
+ * @len:	the size of the output
+ *
+ * returns:	the clear operation (SYSCALL_CLR_*)
+ */
+static inline uint8_t
+syscall_clr_op(size_t len)
+{
+	/* specialized stores */
+	switch (len) {
+		case 4:
+			return SYSCALL_CLR_4;
+		case 8:
+			return SYSCALL_CLR_8;
+		case 16:
+			return SYSCALL_CLR_16;
+		default:
+			return SYSCALL_CLR_N;
+	}
+}
+
+/*
+ * compile a syscall descriptor into its action program
+ *
+ * the arguments are saved only when there is a callback registered, or
+ * when the syscall returns a value in them; syscalls with a callback
+ * get all their arguments, whereas the rest get only the ones that need
+ * to be cleared; the clears of 4, 8, and 16 bytes (e.g., struct timespec
+ * and struct timeval) are specialized into single stores
+ *
+ * @desc:	the syscall descriptor
+ */
+static void
+syscall_compile(syscall_desc_t *desc)
+{
+	/* the action program */
+	syscall_prog_t prog;
+	/* iterator */
+	size_t i;
+
+	/* not in the syscall table */
+	if (desc < syscall_desc || desc >= syscall_desc + SYSCALL_MAX)
+		return;
+
+	/* setup */
+	(void)memset(&prog, 0, sizeof(prog));
+
+	/* the syscall has effects */
+	if (desc->save_args | desc->retval_args) {
+		/* callbacks; all the arguments are saved */
+		if (desc->pre != NULL)
+			prog.flags |= SYSCALL_PROG_PRE;
+		if (desc->post != NULL)
+			prog.flags |= SYSCALL_PROG_POST;
+		if (prog.flags != 0)
+			prog.fetch = (1U << desc->nargs) - 1;
+
+		/* default post-syscall handling; clear the arguments map */
+		if (desc->post == NULL)
+			for (i = 0; i < desc->nargs; i++)
+				if (desc->map_args[i] > 0) {
+					prog.clr_arg[prog.nclr]	= i;
+					prog.clr_len[prog.nclr]	=
+						desc->map_args[i];
+					prog.clr_op[prog.nclr++] =
+						syscall_clr_op(desc->map_args[i]);
+					prog.fetch |= (1U << i);
+				}
+
+		/* there is something to clear */
+		if (prog.nclr > 0)
+			prog.flags |= SYSCALL_PROG_CLR;
+	}
+
+	/* update */
+	syscall_prog[desc - syscall_desc] = prog;
+}
+
+/*
+ * map a direct socket syscall to its socketcall(2) call
+ *
+ * since 4.3, i386 kernels export every socket call as a separate
+ * syscall, and recent C libraries use them instead of socketcall(2);
+ * the syscall arguments are laid out exactly like the socketcall(2)
+ * ones, hence the socketcall(2) handlers can be reused as they are
+ *
+ * @nr:		the syscall number
+ *
+ * returns:	the socket call (SYS_*), or -1 if it is not a socket syscall
+ */
+int
+syscall_sockcall(int nr)
+{
+	/* map the syscall */
+	switch (nr) {
+#ifdef __NR_socket
+		case __NR_socket:
+			return SYS_SOCKET;
 #endif
-#if LINUX_VERSION_CODE >= KERNEL_VERSION(2,6,27)
-	/* __NR_signalfd4 */
-	{ 4, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_eventfd2 */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_epoll_create1 */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_dup3 */
-	{ 3, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL }, /* 330 */
-	/* __NR_pipe2 */
-	{ 2, 0, 1, { sizeof(int) * 2, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_inotify_init1 */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
+#ifdef __NR_accept
+		case __NR_accept:
+			return SYS_ACCEPT;
 #endif
-#if LINUX_VERSION_CODE >= KERNEL_VERSION(2,6,30)
-	/* __NR_preadv */
-	{ 5, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_readv_hook },
-	/* __NR_pwritev */
-	{ 5, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
+#ifdef __NR_accept4
+		case __NR_accept4:
+			return SYS_ACCEPT4;
 #endif
-#if LINUX_VERSION_CODE == KERNEL_VERSION(2,6,31)
-	/* __NR_rt_tgsigqueueinfo */
-	{ 4, 0, 1, { 0, 0, 0, sizeof(siginfo_t), 0, 0 }, NULL, NULL },
-	/* __NR_perf_counter_open */
-	{ 5, 0, 1, { sizeof(struct perf_counter_attr), 0, 0, 0, 0, 0 }, NULL,
-	NULL },
+#ifdef __NR_getsockname
+		case __NR_getsockname:
+			return SYS_GETSOCKNAME;
 #endif
-#if LINUX_VERSION_CODE >= KERNEL_VERSION(2,6,32)
-	/* __NR_rt_tgsigqueueinfo */
-	{ 4, 0, 1, { 0, 0, 0, sizeof(siginfo_t), 0, 0 }, NULL, NULL },
-	/* __NR_perf_event_open */
-	{ 5, 0, 1, { sizeof(struct perf_event_attr), 0, 0, 0, 0, 0 }, NULL,
-	NULL },
+#ifdef __NR_getpeername
+		case __NR_getpeername:
+			return SYS_GETPEERNAME;
 #endif
-#if LINUX_VERSION_CODE >= KERNEL_VERSION(2,6,33)
-	/* __NR_recvmmsg */
-	{ 5, 1, 0, { 0, 0, 0, 0, 0, 0 }, NULL, post_recvmmsg_hook },
+#ifdef __NR_socketpair
+		case __NR_socketpair:
+			return SYS_SOCKETPAIR;
 #endif
-#if LINUX_VERSION_CODE >= KERNEL_VERSION(2,6,36)
-	/* __NR_fanotify_init */
-	{ 2, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_fanotify_mark */
-	{ 5, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_pnatedmlimit64 */
-	{ 4, 0, 1, { 0, 0, 0, sizeof(struct rlimit64), 0, 0 }, NULL, NULL },
+#ifdef __NR_recvfrom
+		case __NR_recvfrom:
+			return SYS_RECVFROM;
 #endif
-#if LINUX_VERSION_CODE >= KERNEL_VERSION(2,6,39)
-	/* __NR_name_to_handle_at */
-	{ 5, 0, 1, { 0, 0, sizeof(struct file_handle), sizeof(int), 0, 0 },
-	NULL, NULL },
-	/* __NR_open_by_handle_at */
-	{ 3, 0, 1, { 0, sizeof(struct file_handle), 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_clock_adjtime */
-	{ 2, 0, 1, { 0, sizeof(struct timex), 0, 0, 0, 0 }, NULL, NULL },
-	/* __NR_syncfs */
-	{ 1, 0, 0, { 0, 0, 0, 0, 0, 0 }, NULL, NULL },
+#ifdef __NR_getsockopt
+		case __NR_getsockopt:
+			return SYS_GETSOCKOPT;
 #endif
-};
+#ifdef __NR_recvmsg
+		case __NR_recvmsg:
+			return SYS_RECVMSG;
+#endif
+#if defined(__NR_recvmmsg) && defined(SYS_RECVMMSG)
+		case __NR_recvmmsg:
+			return SYS_RECVMMSG;
+#endif
+#if defined(__NR_recvmmsg_time64) && defined(SYS_RECVMMSG)
+		case __NR_recvmmsg_time64:
+			return SYS_RECVMMSG;
+#endif
+		default:
+			/* not a socket call */
+			return -1;
+	}
+}
+
+/*
+ * initialize the syscall descriptors
+ *
+ * the descriptor table is dense (i.e., indexed by the syscall number)
+ * and it is filled from the syscall specification; syscalls that are
+ * not specified have no effects. Called by libdft_init()
+ *
+ * returns:	0 on success, 1 on error
+ */
+int
+syscall_desc_init(void)
+{
+	/* iterators */
+	size_t i, j;
+	/* the descriptor */
+	syscall_desc_t *desc;
+
+	/* fill the descriptors */
+	for (i = 0; i < sizeof(syscall_spec) / sizeof(syscall_spec[0]); i++) {
+		/* out of range; optimized branch */
+		if (unlikely(syscall_spec[i].nr >= SYSCALL_MAX)) {
+			/* error message */
+			LOG(string(__func__) + ": syscall out of range (num=" +
+				decstr(syscall_spec[i].nr) + ")\n");
+
+			/* return with failure */
+			return 1;
+		}
+
+		/* the descriptor of the syscall */
+		desc = &syscall_desc[syscall_spec[i].nr];
+
+		/* setup */
+		desc->nargs		= syscall_spec[i].nargs;
+		desc->save_args		= (syscall_spec[i].post != NULL);
+		desc->retval_args	= 0;
+		desc->pre		= NULL;
+		desc->post		= syscall_spec[i].post;
+		for (j = 0; j < SYSCALL_ARG_NUM; j++)
+			if ((desc->map_args[j] =
+					syscall_spec[i].map_args[j]) > 0)
+				desc->retval_args = 1;
+	}
+
+	/* compile the action programs */
+	for (i = 0; i < SYSCALL_MAX; i++)
+		syscall_compile(&syscall_desc[i]);
+
+	/* success */
+	return 0;
+}
 
 /*
  * add a new pre-syscall callback into a syscall descriptor
@@ -873,6 +363,9 @@ syscall_set_pre(syscall_desc_t *desc, void (* pre)(syscall_ctx_t*))
 	/* set the save arguments flag */
 	desc->save_args = 1;
 
+	/* update the action program */
+	syscall_compile(desc);
+
 	/* success */
 	return 0;
 }
@@ -899,6 +392,9 @@ syscall_set_post(syscall_desc_t *desc, void (* post)(syscall_ctx_t*))
 	/* set the save arguments flag */
 	desc->save_args = 1;
 
+	/* update the action program */
+	syscall_compile(desc);
+
 	/* success */
 	return 0;
 }
@@ -926,6 +422,9 @@ syscall_clr_pre(syscall_desc_t *desc)
 		/* clear */
 		desc->save_args = 0;
 
+	/* update the action program */
+	syscall_compile(desc);
+
 	/* return with success */
 	return 0;
 }
@@ -953,6 +452,9 @@ syscall_clr_post(syscall_desc_t *desc)
 		/* clear */
 		desc->save_args = 0;
 
+	/* update the action program */
+	syscall_compile(desc);
+
 	/* return with success */
 	return 0;
 }
@@ -997,19 +499,16 @@ post_brk_hook(syscall_ctx_t *ctx)
 	if (unlikely(addr == brk_end))
 		return;
 	
-	/* the first segment is allocated with calloc(3) */
+	/* the first segment is allocated with tagmap_seg_alloc() */
 	if (unlikely(brk_start == brk_end)) {
 #ifdef DEBUG_MEMTRACK
 		/* verbose */
 		LOG(string(__func__) + ": expand mapping "
 			+ hexstr(brk_start) + "-" + hexstr(addr) + "\n");
 #endif
-		/*
-		 * allocate space for a new tagmap
-		 * segment by invoking calloc(3)
-		 */
-		if (unlikely((tseg = calloc(PAGE_ALIGN(addr) -
-				PAGE_ALIGN(brk_start) + PAGE_SZ, 1)) == NULL)) {
+		/* allocate space for a new tagmap segment */
+		if (unlikely((tseg = tagmap_seg_alloc(PAGE_ALIGN(addr) -
+				PAGE_ALIGN(brk_start) + PAGE_SZ)) == NULL)) {
 			/* error message */
 			LOG(string(__func__) +
 				": tagmap segment allocation failed (" +
@@ -1026,9 +525,13 @@ post_brk_hook(syscall_ctx_t *ctx)
 		LOG(string(__func__) + ": expand mapping "
 			+ hexstr(brk_start) + "-" + hexstr(addr) + "\n");
 #endif
-		/* additional segments are allocated with realloc(3) */
-		if (unlikely((tseg = realloc((void *)
+		/*
+		 * additional segments are allocated with
+		 * tagmap_seg_realloc(); the new part is clear
+		 */
+		if (unlikely((tseg = tagmap_seg_realloc((void *)
 			(brk_start + STAB[VIRT2STAB(brk_start)]),
+			PAGE_ALIGN(brk_end) - PAGE_ALIGN(brk_start) + PAGE_SZ,
 			PAGE_ALIGN(addr) - PAGE_ALIGN(brk_start) + PAGE_SZ))
 							== NULL)) {
 			/* error message */
@@ -1039,11 +542,6 @@ post_brk_hook(syscall_ctx_t *ctx)
 				/* die */
 				libdft_die();
 		}
-				
-		/* cleanup the new tagmap segment */
-		(void)memset(((char *)tseg) + PAGE_ALIGN(brk_end) -
-			PAGE_ALIGN(brk_start) + PAGE_SZ, 0,
-			PAGE_ALIGN(addr) - PAGE_ALIGN(brk_end));
 	}
 	/* shrink */
 	else if (PAGE_ALIGN(addr) < PAGE_ALIGN(brk_end)) {
@@ -1052,9 +550,10 @@ post_brk_hook(syscall_ctx_t *ctx)
 		LOG(string(__func__) + ": shrink mapping "
 			+ hexstr(brk_start) + "-" + hexstr(addr) + "\n");
 #endif
-		/* segments are deallocated with realloc(3) */
-		if (unlikely((tseg = realloc((void *)
+		/* segments are deallocated with tagmap_seg_realloc() */
+		if (unlikely((tseg = tagmap_seg_realloc((void *)
 			(brk_start + STAB[VIRT2STAB(brk_start)]),
+			PAGE_ALIGN(brk_end) - PAGE_ALIGN(brk_start) + PAGE_SZ,
 			PAGE_ALIGN(addr) - PAGE_ALIGN(brk_start) + PAGE_SZ))
 							== NULL)) {
 			/* error message */
@@ -1068,11 +567,17 @@ post_brk_hook(syscall_ctx_t *ctx)
 			/* STAB setup */
 		for (i = VIRT2STAB(brk_end); i > VIRT2STAB(addr); i--)
 			STAB[i] = (uint32_t)null_seg - STAB2VIRT(i);
+		tagmap_acct(VIRT2STAB(addr) + 1, VIRT2STAB(brk_end),
+				TAGMAP_REG_NONE);
 	}
+	/* the program break moved inside the same page; nothing to do */
+	else
+		tseg = (void *)(brk_start + STAB[VIRT2STAB(brk_start)]);
 	
 	/* STAB setup */
 	for (i = VIRT2STAB(brk_start), j = 0; i <= VIRT2STAB(addr); i++, j++)
 		STAB[i] = (uint32_t)tseg - STAB2VIRT(i) + (j * PAGE_SZ);
+	tagmap_acct(VIRT2STAB(brk_start), VIRT2STAB(addr), TAGMAP_REG_BRK);
 #ifdef DEBUG_MEMTRACK
 	/* verbose */
 	LOG(string(__func__) + ": mapping segment [" +
@@ -1137,15 +642,24 @@ post_mmap_hook(syscall_ctx_t *ctx)
 	/* tagmap segment */
 	void	*tseg = NULL;
 
+	/* the shadow is new (flag) */
+	size_t	created = 1;
+
+	/* region type (accounting) */
+	uint8_t	reg;
+
 	/* mmap() was not successful; optimized branch */
 	if (unlikely((void *)ctx->ret == MAP_FAILED))
 		return;
 
 	/* 
-	 * MAP_SHARED has been specified
-	 * TODO: handle shared memory mappings
+	 * MAP_SHARED has been specified;
+	 * the shadow is shared as well (if enabled)
 	 */
-	if (unlikely((flags & MAP_SHARED) != 0))
+	if (unlikely((flags & MAP_SHARED) != 0) &&
+		(tseg = tagmap_seg_share(((flags & MAP_ANONYMOUS) != 0) ? -1 :
+			(int)ctx->arg[SYSCALL_ARG4], NULL, MMAP_OFF(ctx),
+			size, &created)) == NULL)
 		/* issue a warning */
 	       LOG(string(__func__) + ": shared mapping via mmap(2) at " +
 			       hexstr(ctx->ret) + "\n");
@@ -1159,15 +673,18 @@ post_mmap_hook(syscall_ctx_t *ctx)
 	       LOG(string(__func__) + ": fixed mapping via mmap(2) at " +
 			       hexstr(ctx->arg[SYSCALL_ARG0]) + "\n");
 	
-	/* MAP_GROWSDOWN has been specified */
+	/*
+	 * MAP_GROWSDOWN has been specified; mmap(2) returns the
+	 * lowest address of the mapping (as with the rest)
+	 */
 	if (unlikely((flags & MAP_GROWSDOWN) != 0)) {
-		STAB_start	= VIRT2STAB(ctx->ret - size + 1);
-		STAB_end	= VIRT2STAB(ctx->ret);
+		STAB_start	= VIRT2STAB(ctx->ret);
+		STAB_end	= VIRT2STAB(ctx->ret + size - 1);
 #ifdef DEBUG_MEMTRACK
 		/* verbose */
 		LOG(string(__func__) + ": growsdown mapping\n");
-		LOG(string(__func__) + ": " + hexstr(ctx->ret - size + 1)
-			+ "-" + hexstr(ctx->ret) + " ");
+		LOG(string(__func__) + ": " + hexstr(ctx->ret)
+			+ "-" + hexstr(ctx->ret + size - 1) + " ");
 
 		if ((prot & PROT_READ) != 0) LOG("R"); else LOG("-");
 		if ((prot & PROT_WRITE) != 0) LOG("W"); else LOG("-");
@@ -1190,16 +707,17 @@ post_mmap_hook(syscall_ctx_t *ctx)
 #endif
 	}
 
-	/* writeable mapping */
-	if ((prot & PROT_WRITE) != 0) {
-		/*
-		 * allocate space for a new tagmap
-		 * segment by invoking mmap(2)
-		 */
-		if (unlikely(((tseg = mmap(NULL, size,
-			/* RW- */
-			PROT_READ | PROT_WRITE | ~PROT_EXEC,
-			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)) == MAP_FAILED))) {
+	/* writeable (or shared) mapping */
+	if ((prot & PROT_WRITE) != 0 || tseg != NULL) {
+		/* the shadow is shared, private, or of a (thread) stack */
+		reg = (tseg != NULL) ? TAGMAP_REG_SHM :
+			((flags & (MAP_STACK | MAP_GROWSDOWN)) != 0) ?
+			TAGMAP_REG_STACK : TAGMAP_REG_MMAP;
+
+		/* allocate space for a new tagmap segment */
+		if (tseg == NULL && unlikely((tseg =
+			(reg == TAGMAP_REG_STACK) ? tagmap_seg_reserve(size) :
+			tagmap_seg_alloc(size)) == NULL)) {
 				/* error message */
 				LOG(string(__func__) +
 					": tagmap segment allocation failed (" +
@@ -1212,23 +730,22 @@ post_mmap_hook(syscall_ctx_t *ctx)
 		/* STAB setup */
 		for (i = STAB_start, j = 0; i <= STAB_end; i++, j++)
 			STAB[i] = (uint32_t)tseg - STAB2VIRT(i) + (j * PAGE_SZ);
+		tagmap_acct(STAB_start, STAB_end, reg);
 #ifdef DEBUG_MEMTRACK
-		if (unlikely((flags & MAP_GROWSDOWN) != 0)) {
-			/* verbose */
-			LOG(string(__func__) + ": mapping writeable segment [" +
-				hexstr(ctx->ret - size + 1 +
-				STAB[VIRT2STAB(ctx->ret - size + 1)]) +
-				"-" + hexstr(ctx->ret +
-					STAB[VIRT2STAB(ctx->ret)]) + "]\n");
-		}
-		else {
-			/* verbose */
-			LOG(string(__func__) + ": mapping writeable segment [" +
-				hexstr(ctx->ret + STAB[VIRT2STAB(ctx->ret)]) +
-				"-" + hexstr(ctx->ret + size - 1 +
-				STAB[VIRT2STAB(ctx->ret + size - 1)]) + "]\n");
-		}
+		/* verbose */
+		LOG(string(__func__) + ": mapping writeable segment [" +
+			hexstr(ctx->ret + STAB[VIRT2STAB(ctx->ret)]) +
+			"-" + hexstr(ctx->ret + size - 1 +
+			STAB[VIRT2STAB(ctx->ret + size - 1)]) + "]\n");
 #endif
+
+		/*
+		 * file mapping; restore the tags of the file data
+		 * (unless another process shares them already)
+		 */
+		if ((flags & MAP_ANONYMOUS) == 0 && created != 0)
+			(void)filetag_load((int)ctx->arg[SYSCALL_ARG4],
+				ctx->ret, size, MMAP_OFF(ctx), TAG_ZERO);
 	}
 	/* 
 	 * read-only mapping;
@@ -1249,22 +766,13 @@ post_mmap_hook(syscall_ctx_t *ctx)
 		/* STAB setup */
 		for (i = STAB_start; i <= STAB_end; i++)
 			STAB[i] = (uint32_t)zero_seg - STAB2VIRT(i);
+		tagmap_acct(STAB_start, STAB_end, TAGMAP_REG_NONE);
 #ifdef DEBUG_MEMTRACK
-		if (unlikely((flags & MAP_GROWSDOWN) != 0)) {
-			/* verbose */
-			LOG(string(__func__) + ": mapping read-only segment [" +
-				hexstr(ctx->ret - size + 1 +
-				STAB[VIRT2STAB(ctx->ret - size + 1)]) +
-				"-" + hexstr(ctx->ret +
-					STAB[VIRT2STAB(ctx->ret)]) + "]\n");
-		}
-		else {
-			/* verbose */
-			LOG(string(__func__) + ": mapping read-only segment [" +
-				hexstr(ctx->ret + STAB[VIRT2STAB(ctx->ret)]) +
-				"-" + hexstr(ctx->ret + size - 1 +
-				STAB[VIRT2STAB(ctx->ret + size - 1)]) + "]\n");
-		}
+		/* verbose */
+		LOG(string(__func__) + ": mapping read-only segment [" +
+			hexstr(ctx->ret + STAB[VIRT2STAB(ctx->ret)]) +
+			"-" + hexstr(ctx->ret + size - 1 +
+			STAB[VIRT2STAB(ctx->ret + size - 1)]) + "]\n");
 #endif
 	}
 }
@@ -1282,15 +790,24 @@ post_mmap_hook(syscall_ctx_t *ctx)
 	/* tagmap segment */
 	void	*tseg = NULL;
 
+	/* the shadow is new (flag) */
+	size_t	created = 1;
+
+	/* region type (accounting) */
+	uint8_t	reg;
+
 	/* mmap() was not successful; optimized branch */
 	if (unlikely((void *)ctx->ret == MAP_FAILED))
 		return;
 
 	/* 
-	 * MAP_SHARED has been specified
-	 * TODO: handle shared memory mappings
+	 * MAP_SHARED has been specified;
+	 * the shadow is shared as well (if enabled)
 	 */
-	if (unlikely((flags & MAP_SHARED) != 0))
+	if (unlikely((flags & MAP_SHARED) != 0) &&
+		(tseg = tagmap_seg_share(((flags & MAP_ANONYMOUS) != 0) ? -1 :
+			(int)ctx->arg[SYSCALL_ARG4], NULL, MMAP_OFF(ctx),
+			size, &created)) == NULL)
 		/* issue a warning */
 	       LOG(string(__func__) + ": shared mapping via mmap(2) at " +
 			       hexstr(ctx->ret) + "\n");
@@ -1304,15 +821,18 @@ post_mmap_hook(syscall_ctx_t *ctx)
 	       LOG(string(__func__) + ": fixed mapping via mmap(2) at " +
 			       hexstr(ctx->arg[SYSCALL_ARG0]) + "\n");
 	
-	/* MAP_GROWSDOWN has been specified */
+	/*
+	 * MAP_GROWSDOWN has been specified; mmap(2) returns the
+	 * lowest address of the mapping (as with the rest)
+	 */
 	if (unlikely((flags & MAP_GROWSDOWN) != 0)) {
-		STAB_start	= VIRT2STAB(ctx->ret - size + 1);
-		STAB_end	= VIRT2STAB(ctx->ret);
+		STAB_start	= VIRT2STAB(ctx->ret);
+		STAB_end	= VIRT2STAB(ctx->ret + size - 1);
 #ifdef DEBUG_MEMTRACK
 		/* verbose */
 		LOG(string(__func__) + ": growsdown mapping\n");
-		LOG(string(__func__) + ": " + hexstr(ctx->ret - size + 1)
-			+ "-" + hexstr(ctx->ret) + "\n");
+		LOG(string(__func__) + ": " + hexstr(ctx->ret)
+			+ "-" + hexstr(ctx->ret + size - 1) + "\n");
 #endif
 	}
 	else {
@@ -1325,14 +845,15 @@ post_mmap_hook(syscall_ctx_t *ctx)
 #endif
 	}
 
-	/*
-	 * allocate space for a new tagmap
-	 * segment by invoking mmap(2)
-	 */
-	if (unlikely(((tseg = mmap(NULL, size,
-		/* RW- */
-		PROT_READ | PROT_WRITE | ~PROT_EXEC,
-		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)) == MAP_FAILED))) {
+	/* the shadow is shared, private, or of a (thread) stack */
+	reg = (tseg != NULL) ? TAGMAP_REG_SHM :
+		((flags & (MAP_STACK | MAP_GROWSDOWN)) != 0) ?
+		TAGMAP_REG_STACK : TAGMAP_REG_MMAP;
+
+	/* allocate space for a new tagmap segment */
+	if (tseg == NULL && unlikely((tseg = (reg == TAGMAP_REG_STACK) ?
+			tagmap_seg_reserve(size) :
+			tagmap_seg_alloc(size)) == NULL)) {
 			/* error message */
 			LOG(string(__func__) +
 				": tagmap segment allocation failed (" +
@@ -1345,23 +866,22 @@ post_mmap_hook(syscall_ctx_t *ctx)
 	/* STAB setup */
 	for (i = STAB_start, j = 0; i <= STAB_end; i++, j++)
 		STAB[i] = (uint32_t)tseg - STAB2VIRT(i) + (j * PAGE_SZ);
+	tagmap_acct(STAB_start, STAB_end, reg);
 #ifdef DEBUG_MEMTRACK
-	if (unlikely((flags & MAP_GROWSDOWN) != 0)) {
-		/* verbose */
-		LOG(string(__func__) + ": mapping segment [" +
-			hexstr(ctx->ret - size + 1 +
-			STAB[VIRT2STAB(ctx->ret - size + 1)]) +
-			"-" + hexstr(ctx->ret +
-			STAB[VIRT2STAB(ctx->ret)]) + "]\n");
-	}
-	else {
-		/* verbose */
-		LOG(string(__func__) + ": mapping segment [" +
-			hexstr(ctx->ret + STAB[VIRT2STAB(ctx->ret)]) +
-			"-" + hexstr(ctx->ret + size - 1 +
-			STAB[VIRT2STAB(ctx->ret + size - 1)]) + "]\n");
-	}
+	/* verbose */
+	LOG(string(__func__) + ": mapping segment [" +
+		hexstr(ctx->ret + STAB[VIRT2STAB(ctx->ret)]) +
+		"-" + hexstr(ctx->ret + size - 1 +
+		STAB[VIRT2STAB(ctx->ret + size - 1)]) + "]\n");
 #endif
+
+	/*
+	 * file mapping; restore the tags of the file data
+	 * (unless another process shares them already)
+	 */
+	if ((flags & MAP_ANONYMOUS) == 0 && created != 0)
+		(void)filetag_load((int)ctx->arg[SYSCALL_ARG4],
+			ctx->ret, size, MMAP_OFF(ctx), TAG_ZERO);
 }
 #endif
 
@@ -1393,11 +913,11 @@ post_munmap_hook(syscall_ctx_t *ctx)
 
 			/*
 			 * deallocate the space of the corresponding
-			 * tagmap segment by invoking munmap(2)
+			 * tagmap segment
 			 */
 			if (unlikely(
-				munmap((void *)(STAB2VIRT(i) + STAB[i]),
-					PAGE_SZ) == -1)) {
+				tagmap_seg_free((void *)(STAB2VIRT(i) +
+					STAB[i]), PAGE_SZ) == -1)) {
 				/* error message */
 				LOG(string(__func__) +
 					": tagmap segment deallocation failed ("
@@ -1417,6 +937,8 @@ post_munmap_hook(syscall_ctx_t *ctx)
 		
 		STAB[i] = (uint32_t)null_seg - STAB2VIRT(i);
 	}
+	tagmap_acct(VIRT2STAB(addr), VIRT2STAB(addr + size - 1),
+			TAGMAP_REG_NONE);
 #ifdef DEBUG_MEMTRACK
 	/* verbose */
 	LOG(string(__func__) + ": re-mapped segment [" +
@@ -1433,8 +955,8 @@ post_munmap_hook(syscall_ctx_t *ctx)
 	size_t 	addr	= ctx->arg[SYSCALL_ARG0];
 	size_t	size	= ctx->arg[SYSCALL_ARG1];
 
-	/* iterator */
-	size_t	i;
+	/* iterators */
+	size_t	i, j;
 
 	/* munmap() was not successful; optimized branch */
 	if (unlikely((int)ctx->ret == -1))
@@ -1445,29 +967,45 @@ post_munmap_hook(syscall_ctx_t *ctx)
 		hexstr(addr + size - 1) + "\n");
 #endif
 	/*
-	 * deallocate the space of the corresponding
-	 * tagmap segment by invoking munmap(2)
+	 * deallocate the space of the corresponding tagmap segments;
+	 * one run of pages with contiguous shadow at a time (the
+	 * inaccessible regions that were found when Pin attached have
+	 * none; see maps_scan())
 	 */
-	if (unlikely(munmap((void *)(addr + STAB[VIRT2STAB(addr)]),
-					size) == -1)) {
-		/* error message */
-		LOG(string(__func__) +
-			": tagmap segment deallocation failed ("
-			+ string(strerror(errno)) + ")\n");
+	for (i = VIRT2STAB(addr); i <= VIRT2STAB(addr + size - 1); i = j) {
+		/* the pages that share the shadow offset of i */
+		for (j = i + 1; j <= VIRT2STAB(addr + size - 1) &&
+				STAB[j] == STAB[i]; j++);
+
+		/* no tagmap segment */
+		if (STAB2VIRT(i) + STAB[i] == (uint32_t)zero_seg ||
+				STAB2VIRT(i) + STAB[i] == (uint32_t)null_seg)
+			continue;
+
+		/* the run [i, j) */
+		if (unlikely(tagmap_seg_free((void *)(STAB2VIRT(i) + STAB[i]),
+					(j - i) * PAGE_SZ) == -1)) {
+			/* error message */
+			LOG(string(__func__) +
+				": tagmap segment deallocation failed ("
+				+ string(strerror(errno)) + ")\n");
 
-		/* die */
-		libdft_die();
-	}
+			/* die */
+			libdft_die();
+		}
 #ifdef DEBUG_MEMTRACK
-	/* verbose */
-	LOG(string(__func__) + ": unmapping segment [" +
-		hexstr(addr + STAB[VIRT2STAB(addr)]) + "-" +
-		hexstr(addr + size - 1 + STAB[VIRT2STAB(addr + size - 1)]) +
-		"]\n");
+		/* verbose */
+		LOG(string(__func__) + ": unmapping segment [" +
+			hexstr(STAB2VIRT(i) + STAB[i]) + "-" +
+			hexstr(STAB2VIRT(j) + STAB[i] - 1) + "]\n");
 #endif
+	}
+
 	/* STAB setup */
 	for (i = VIRT2STAB(addr); i <= VIRT2STAB(addr + size - 1); i++)
 		STAB[i] = (uint32_t)null_seg - STAB2VIRT(i);
+	tagmap_acct(VIRT2STAB(addr), VIRT2STAB(addr + size - 1),
+			TAGMAP_REG_NONE);
 
 #ifdef DEBUG_MEMTRACK
 	/* verbose */
@@ -1483,35 +1021,13 @@ post_munmap_hook(syscall_ctx_t *ctx)
 static void
 post_readv_hook(syscall_ctx_t *ctx)
 {
-	/* iterators */
-	int	i;
-	struct	iovec *iov;
-	
-	/* bytes copied in a iovec structure */
-	size_t	iov_tot;
-
-	/* total bytes copied */
-	size_t	tot = (size_t)ctx->ret;
-
 	/* (p)readv() was not successful; optimized branch */
 	if (unlikely((long)ctx->ret <= 0))
 		return;
 	
-	/* iterate the iovec structures */
-	for (i = 0; i < (int)ctx->arg[SYSCALL_ARG2] && tot > 0; i++) {
-		/* get an iovec  */
-		iov = ((struct iovec *)ctx->arg[SYSCALL_ARG1]) + i;
-
-		/* get the length of the iovec */
-		iov_tot = (tot >= (size_t)iov->iov_len) ?
-				(size_t)iov->iov_len : tot;
-	
-		/* clear the tag bits */
-		tagmap_clrn((size_t)iov->iov_base, iov_tot);
-
-		/* housekeeping */
-		tot -= iov_tot;
-	}
+	/* clear the tag bits of the iovec structures */
+	tagmap_clrv((struct iovec *)ctx->arg[SYSCALL_ARG1],
+			(size_t)ctx->arg[SYSCALL_ARG2], (size_t)ctx->ret);
 }
 
 /* __NR_epoll_pwait post syscall hook */
@@ -1800,6 +1316,9 @@ post_mprotect_hook(syscall_ctx_t *ctx)
 	/* tagmap segment */
 	void	*tseg = NULL;
 
+	/* region type (accounting); kept, unless it was read-only */
+	uint8_t	reg = tagmap_reg(addr);
+
 	/* mprotect() was not successful; optimized branch */
 	if (unlikely((int)ctx->ret == -1))
 		return;
@@ -1815,14 +1334,8 @@ post_mprotect_hook(syscall_ctx_t *ctx)
 #endif
 	/* writeable mapping */
 	if ((prot & PROT_WRITE) != 0) {
-		/*
-		 * allocate space for a new tagmap
-		 * segment by invoking mmap(2)
-		 */
-		if (unlikely(((tseg = mmap(NULL, size,
-			/* RW- */
-			PROT_READ | PROT_WRITE | ~PROT_EXEC,
-			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)) == MAP_FAILED))) {
+		/* allocate space for a new tagmap segment */
+		if (unlikely((tseg = tagmap_seg_alloc(size)) == NULL)) {
 				/* error message */
 				LOG(string(__func__) +
 					": tagmap segment allocation failed (" +
@@ -1841,11 +1354,11 @@ post_mprotect_hook(syscall_ctx_t *ctx)
 			(STAB2VIRT(i) + STAB[i] != (uint32_t)null_seg)) {
 				/*
 				 * deallocate the space of the corresponding
-				 * tagmap segment by invoking munmap(2)
+				 * tagmap segment
 				 */
 				if (unlikely(
-					munmap((void *)(STAB2VIRT(i) + STAB[i]),
-						PAGE_SZ) == -1)) {
+					tagmap_seg_free((void *)(STAB2VIRT(i) +
+						STAB[i]), PAGE_SZ) == -1)) {
 					/* error message */
 					LOG(string(__func__) +
 					": tagmap segment deallocation failed ("
@@ -1865,6 +1378,8 @@ post_mprotect_hook(syscall_ctx_t *ctx)
 		
 			STAB[i] = (uint32_t)tseg - STAB2VIRT(i) + (j * PAGE_SZ);
 		}
+		tagmap_acct(VIRT2STAB(addr), VIRT2STAB(addr + size - 1),
+			(reg != TAGMAP_REG_NONE) ? reg : TAGMAP_REG_MMAP);
 	}
 	/* non-writeable mapping */
 	else {
@@ -1877,11 +1392,11 @@ post_mprotect_hook(syscall_ctx_t *ctx)
 			(STAB2VIRT(i) + STAB[i] != (uint32_t)null_seg)) {
 				/*
 				 * deallocate the space of the corresponding
-				 * tagmap segment by invoking munmap(2)
+				 * tagmap segment
 				 */
 				if (unlikely(
-					munmap((void *)(STAB2VIRT(i) + STAB[i]),
-						PAGE_SZ) == -1)) {
+					tagmap_seg_free((void *)(STAB2VIRT(i) +
+						STAB[i]), PAGE_SZ) == -1)) {
 					/* error message */
 					LOG(string(__func__) +
 					": tagmap segment deallocation failed ("
@@ -1901,6 +1416,8 @@ post_mprotect_hook(syscall_ctx_t *ctx)
 		
 			STAB[i] = (uint32_t)zero_seg - STAB2VIRT(i);
 		}
+		tagmap_acct(VIRT2STAB(addr), VIRT2STAB(addr + size - 1),
+				TAGMAP_REG_NONE);
 	}
 #ifdef DEBUG_MEMTRACK
 		/* verbose */
@@ -1910,6 +1427,70 @@ post_mprotect_hook(syscall_ctx_t *ctx)
 		"]\n");
 #endif
 }
+#else
+/*
+ * __NR_mprotect post syscall hook
+ *
+ * every mapping has a tagmap segment, except for the inaccessible
+ * regions that were found when Pin attached (zero_seg; see
+ * maps_scan()); they get one when they are made accessible
+ */
+static void
+post_mprotect_hook(syscall_ctx_t *ctx)
+{
+	/* mprotect parameters (address, size, and protection) */
+	size_t 	addr	= ctx->arg[SYSCALL_ARG0];
+	size_t	size	= ctx->arg[SYSCALL_ARG1];
+	int	prot	= ctx->arg[SYSCALL_ARG2];
+
+	/* iterators */
+	size_t	i, j, k;
+
+	/* tagmap segment */
+	void	*tseg;
+
+	/* failed, or still inaccessible; optimized branch */
+	if (unlikely((int)ctx->ret == -1) || prot == PROT_NONE ||
+			unlikely(size == 0))
+		return;
+
+	/* the runs of pages without a tagmap segment */
+	for (i = VIRT2STAB(addr); i <= VIRT2STAB(addr + size - 1); i = j) {
+		/* the run [i, j) */
+		for (j = i; j <= VIRT2STAB(addr + size - 1) &&
+			STAB2VIRT(j) + STAB[j] == (uint32_t)zero_seg; j++);
+
+		/* it has a tagmap segment; optimized branch */
+		if (likely(j == i)) {
+			j++;
+			continue;
+		}
+
+		/* allocate space for a new tagmap segment */
+		if (unlikely((tseg = tagmap_seg_alloc((j - i) * PAGE_SZ)) ==
+					NULL)) {
+			/* error message */
+			LOG(string(__func__) +
+				": tagmap segment allocation failed (" +
+				string(strerror(errno)) + ")\n");
+
+			/* die */
+			libdft_die();
+		}
+
+		/* STAB setup */
+		for (k = i; k < j; k++)
+			STAB[k] = (uint32_t)tseg - STAB2VIRT(k) +
+				((k - i) * PAGE_SZ);
+		tagmap_acct(i, j - 1, TAGMAP_REG_MMAP);
+#ifdef DEBUG_MEMTRACK
+		/* verbose */
+		LOG(string(__func__) + ": mapping segment [" +
+			hexstr((size_t)tseg) + "-" +
+			hexstr((size_t)tseg + (j - i) * PAGE_SZ - 1) + "]\n");
+#endif
+	}
+}
 #endif
 
 /* __NR_ipc post syscall hook */
@@ -1934,6 +1515,13 @@ post_ipc_hook(syscall_ctx_t *ctx)
 	/* iterators */
 	size_t i, j;
 
+	/* shared shadow key, and whether it is new (flag) */
+	char key[NAME_MAX];
+	size_t created;
+
+	/* region type (accounting) */
+	uint8_t reg;
+
 	/* ipc() is a demultiplexer for all SYSV IPC calls */
 	switch ((int)ctx->arg[SYSCALL_ARG0]) {
 		/* msgctl() */
@@ -1987,6 +1575,13 @@ post_ipc_hook(syscall_ctx_t *ctx)
 					tagmap_clrn(ctx->arg[SYSCALL_ARG4],
 						sizeof(struct shminfo));
 					break;
+				case IPC_RMID:
+					/* the shared shadow goes with it */
+					(void)snprintf(key, sizeof(key),
+						"shm.%d",
+						(int)ctx->arg[SYSCALL_ARG1]);
+					tagmap_seg_unshare(key);
+					break;
 				default:
 					/* nothing to do */
 					return;
@@ -2054,6 +1649,13 @@ post_ipc_hook(syscall_ctx_t *ctx)
 				libdft_die();
 			}
 
+			/* the shadow is shared as well (if enabled) */
+			(void)snprintf(key, sizeof(key), "shm.%d",
+					(int)ctx->arg[SYSCALL_ARG1]);
+			tseg = tagmap_seg_share(-1, key, 0, buf.shm_segsz,
+					&created);
+			reg = (tseg != NULL) ? TAGMAP_REG_SHM : TAGMAP_REG_MMAP;
+
 #ifdef TAGMAP_COLLAPSE
 #ifdef DEBUG_MEMTRACK
 			/* verbose */
@@ -2066,18 +1668,12 @@ post_ipc_hook(syscall_ctx_t *ctx)
 				LOG("R - -");
 			LOG(" (" + decstr(buf.shm_segsz) + ")\n");
 #endif
-			/* writeable mapping */
-			if (((buf.shm_perm.mode & O_RDWR) != 0)
-			&& ((ctx->arg[SYSCALL_ARG2] & SHM_RDONLY) == 0)) {
-				/*
-				 * allocate space for a new tagmap
-				 * segment by invoking mmap(2)
-			 	*/
-				if (unlikely(((tseg = mmap(NULL, buf.shm_segsz,
-					/* RW- */
-					PROT_READ | PROT_WRITE | ~PROT_EXEC,
-					MAP_PRIVATE | MAP_ANONYMOUS, -1, 0))
-							== MAP_FAILED))) {
+			/* writeable (or shared) mapping */
+			if (tseg != NULL || (((buf.shm_perm.mode & O_RDWR) != 0)
+			&& ((ctx->arg[SYSCALL_ARG2] & SHM_RDONLY) == 0))) {
+				/* allocate space for a new tagmap segment */
+				if (tseg == NULL && unlikely((tseg =
+					tagmap_seg_alloc(buf.shm_segsz)) == NULL)) {
 					/* error message */
 					LOG(string(__func__) +
 					": tagmap segment allocation failed (" +
@@ -2093,6 +1689,8 @@ post_ipc_hook(syscall_ctx_t *ctx)
 				i++, j++)
 					STAB[i] = (uint32_t)tseg - STAB2VIRT(i)
 						+ (j * PAGE_SZ);
+				tagmap_acct(VIRT2STAB(shm_addr),
+				VIRT2STAB(shm_addr + buf.shm_segsz - 1), reg);
 #ifdef DEBUG_MEMTRACK
 				/* verbose */
 				LOG(string(__func__) +
@@ -2125,6 +1723,9 @@ post_ipc_hook(syscall_ctx_t *ctx)
 				i++)
 					STAB[i] = (uint32_t)zero_seg -
 						STAB2VIRT(i);
+				tagmap_acct(VIRT2STAB(shm_addr),
+				VIRT2STAB(shm_addr + buf.shm_segsz - 1),
+				TAGMAP_REG_NONE);
 #ifdef DEBUG_MEMTRACK
 				/* verbose */
 				LOG(string(__func__) +
@@ -2140,15 +1741,9 @@ post_ipc_hook(syscall_ctx_t *ctx)
 			LOG(string(__func__) + ": " + hexstr(shm_addr) + "-" +
 				hexstr(shm_addr + buf.shm_segsz - 1) + "\n");
 #endif
-			/*
-			 * allocate space for a new tagmap
-			 * segment by invoking mmap(2)
-			 */
-			if (unlikely(((tseg = mmap(NULL, buf.shm_segsz,
-				/* RW- */
-				PROT_READ | PROT_WRITE | ~PROT_EXEC,
-				MAP_PRIVATE | MAP_ANONYMOUS, -1, 0))
-						== MAP_FAILED))) {
+			/* allocate space for a new tagmap segment */
+			if (tseg == NULL && unlikely((tseg =
+				tagmap_seg_alloc(buf.shm_segsz)) == NULL)) {
 				/* error message */
 				LOG(string(__func__) +
 				": tagmap segment allocation failed (" +
@@ -2164,6 +1759,8 @@ post_ipc_hook(syscall_ctx_t *ctx)
 				i++, j++)
 				STAB[i] = (uint32_t)tseg - STAB2VIRT(i)
 					+ (j * PAGE_SZ);
+			tagmap_acct(VIRT2STAB(shm_addr),
+				VIRT2STAB(shm_addr + buf.shm_segsz - 1), reg);
 #ifdef DEBUG_MEMTRACK
 			/* verbose */
 			LOG(string(__func__) +
@@ -2210,11 +1807,11 @@ post_ipc_hook(syscall_ctx_t *ctx)
 #endif
 				/*
 				 * deallocate the space of the corresponding
-				 * tagmap segment by invoking munmap(2)
+				 * tagmap segment
 				 */
-				if (unlikely(munmap((void *)(shm_addr +
+				if (unlikely(tagmap_seg_free((void *)(shm_addr +
 					STAB[VIRT2STAB(shm_addr)]),
-					PAGE_ALIGN(size) + PAGE_SZ) == -1)) {
+					size) == -1)) {
 					/* error message */
 					LOG(string(__func__) +
 					": tagmap segment deallocation failed ("
@@ -2232,6 +1829,9 @@ post_ipc_hook(syscall_ctx_t *ctx)
 			for (i = VIRT2STAB(shm_addr);
 				i <= VIRT2STAB(shm_addr + size - 1); i++)
 				STAB[i] = (uint32_t)null_seg - STAB2VIRT(i);
+			tagmap_acct(VIRT2STAB(shm_addr),
+				VIRT2STAB(shm_addr + size - 1),
+				TAGMAP_REG_NONE);
 #ifdef DEBUG_MEMTRACK
 			/* verbose */
 			LOG(string(__func__) + ": re-mapped segment [" +
@@ -2272,7 +1872,7 @@ post_fcntl_hook(syscall_ctx_t *ctx)
 			tagmap_clrn(ctx->arg[SYSCALL_ARG2],
 					sizeof(struct flock64));
 			break;
-#if LINUX_VERSION_CODE >= KERNEL_VERSION(2,6,32)
+#ifdef	F_GETOWN_EX
 		/* F_GETOWN_EX */
 		case F_GETOWN_EX:
 			/* clear the tag bits */
@@ -2286,28 +1886,23 @@ post_fcntl_hook(syscall_ctx_t *ctx)
 	}
 }
 
-/* __NR_socketcall post syscall hook */
+/*
+ * socket calls post syscall hook
+ *
+ * shared by socketcall(2) and the direct socket syscalls
+ *
+ * @ctx:	the syscall context
+ * @call:	the socket call (SYS_*)
+ * @args:	the socket call arguments
+ */
 static void
-post_socketcall_hook(syscall_ctx_t *ctx)
+post_sock_hook(syscall_ctx_t *ctx, int call, unsigned long *args)
 {
 	/* message header; recvmsg(2) */
 	struct	msghdr *msg;
 
-	/* iov bytes copied; recvmsg(2) */
-	size_t	iov_tot;
-
-	/* iterators */
-	size_t	i;
-	struct	iovec *iov;
-	
-	/* total bytes received */
-	size_t	tot;
-	
-	/* socket call arguments */
-	unsigned long	*args = (unsigned long *)ctx->arg[SYSCALL_ARG1];
-
-	/* demultiplex the socketcall */
-	switch ((int)ctx->arg[SYSCALL_ARG0]) {
+	/* demultiplex the socket call */
+	switch (call) {
 		case SYS_ACCEPT:
 		case SYS_ACCEPT4:
 		case SYS_GETSOCKNAME:
@@ -2405,26 +2000,10 @@ post_socketcall_hook(syscall_ctx_t *ctx)
 			/* flags; clear the tag bits */
 			tagmap_clrn((size_t)&msg->msg_flags, sizeof(int));
 
-			/* total bytes received */	
-			tot = (size_t)ctx->ret;
-
-			/* iterate the iovec structures */
-			for (i = 0; i < msg->msg_iovlen && tot > 0; i++) {
-				/* get the next I/O vector */
-				iov = &msg->msg_iov[i];
-
-				/* get the length of the iovec */
-				iov_tot = (tot > (size_t)iov->iov_len) ?
-						(size_t)iov->iov_len : tot;
-	
-				/* clear the tag bits */
-				tagmap_clrn((size_t)iov->iov_base, iov_tot);
-		
-				/* housekeeping */
-				tot -= iov_tot;
-			}
+			/* the received data; clear the tag bits */
+			tagmap_clrv(msg->msg_iov, msg->msg_iovlen,
+					(size_t)ctx->ret);
 			break;
-#if LINUX_VERSION_CODE >= KERNEL_VERSION(2,6,33)
 		case SYS_RECVMMSG:
 			/* fix the syscall context */
 			ctx->arg[SYSCALL_ARG0] = args[SYSCALL_ARG0];
@@ -2436,13 +2015,33 @@ post_socketcall_hook(syscall_ctx_t *ctx)
 			/* invoke __NR_recvmmsg post syscall hook */
 			post_recvmmsg_hook(ctx);
 			break;
-#endif
 		default:
 			/* nothing to do */
 			return;
 	}
 }
 
+/* __NR_socketcall post syscall hook */
+static void
+post_socketcall_hook(syscall_ctx_t *ctx)
+{
+	/* the socket call and its arguments are passed in memory */
+	post_sock_hook(ctx, (int)ctx->arg[SYSCALL_ARG0],
+			(unsigned long *)ctx->arg[SYSCALL_ARG1]);
+}
+
+/* direct socket syscalls post syscall hook; see syscall_sockcall() */
+static void
+post_socket_hook(syscall_ctx_t *ctx)
+{
+	/* the socket call */
+	int call = syscall_sockcall(ctx->nr);
+
+	/* the arguments are in the syscall context */
+	if (likely(call >= 0))
+		post_sock_hook(ctx, call, (unsigned long *)ctx->arg);
+}
+
 /* 
  * __NR_syslog post syscall hook
  *
@@ -2497,14 +2096,159 @@ post__sysctl_hook(syscall_ctx_t *ctx)
 	}
 }
 
-/* __NR_mremap post syscall hook */
+/*
+ * __NR_mremap post syscall hook
+ *
+ * the shadow follows the mapping; when the shadow of the old region is
+ * one private tagmap segment, it is resized (and moved) with mremap(2),
+ * as the application did, and the tags are kept without copying.
+ * Otherwise (e.g., the exported arena, a shared shadow, or a region that
+ * spans several segments), a new segment is allocated and the tags are
+ * copied; the copy of a shared shadow is private (TAGMAP_REG_MMAP). With
+ * MREMAP_DONTUNMAP, the old region stays mapped, and the tags are always
+ * copied; the old region reads as zeros afterwards (clear tags), unless
+ * its shadow is shared
+ */
 static void
 post_mremap_hook(syscall_ctx_t *ctx)
 {
-	LOG(string(__func__) + ": unhandled mremap(2)\n");
+	/* mremap parameters (old address, and page-aligned sizes) */
+	size_t	oaddr	= ctx->arg[SYSCALL_ARG0];
+	size_t	osize	= PAGE_ALIGN(ctx->arg[SYSCALL_ARG1] + PAGE_SZ - 1);
+	size_t	nsize	= PAGE_ALIGN(ctx->arg[SYSCALL_ARG2] + PAGE_SZ - 1);
+	size_t	naddr	= ctx->ret;
+
+	/* the old region stays mapped (flag) */
+	size_t	keep	= (ctx->arg[SYSCALL_ARG3] & MREMAP_DONTUNMAP) != 0;
+
+	/* iterators */
+	size_t	i, j;
+
+	/* tagmap segments (old and new), and a shadow page */
+	void	*oseg, *tseg = NULL;
+	size_t	taddr;
+
+	/* region type (accounting); it follows the mapping */
+	uint8_t	reg = tagmap_reg(oaddr);
+
+	/* mremap() was not successful; optimized branch */
+	if (unlikely((void *)ctx->ret == MAP_FAILED))
+		return;
+#ifdef DEBUG_MEMTRACK
+	/* verbose */
+	LOG(string(__func__) + ": " + hexstr(oaddr) + "-" +
+		hexstr(oaddr + osize - 1) + " -> " + hexstr(naddr) + "-" +
+		hexstr(naddr + nsize - 1) + "\n");
+#endif
+	/* the shadow of the old region */
+	oseg = (void *)(oaddr + STAB[VIRT2STAB(oaddr)]);
+
+	/* read-only region (collapsed, or the vDSO); it stays clear */
+	if (oseg == zero_seg && osize > 0) {
+		/* STAB setup */
+		if (!keep) {
+			for (i = VIRT2STAB(oaddr);
+					i <= VIRT2STAB(oaddr + osize - 1); i++)
+				STAB[i] = (uint32_t)null_seg - STAB2VIRT(i);
+			tagmap_acct(VIRT2STAB(oaddr),
+					VIRT2STAB(oaddr + osize - 1),
+					TAGMAP_REG_NONE);
+		}
+		for (i = VIRT2STAB(naddr); i <= VIRT2STAB(naddr + nsize - 1);
+				i++)
+			STAB[i] = (uint32_t)zero_seg - STAB2VIRT(i);
+		tagmap_acct(VIRT2STAB(naddr), VIRT2STAB(naddr + nsize - 1),
+				TAGMAP_REG_NONE);
+
+		/* done */
+		return;
+	}
+
+	/* the shadow is one segment (contiguous) */
+	for (i = VIRT2STAB(oaddr), j = 0;
+		j < osize / PAGE_SZ &&
+		STAB2VIRT(i) + STAB[i] == (size_t)oseg + j * PAGE_SZ;
+		i++, j++);
+
+	/* resize (and move) the segment, as the application did */
+	if (!keep && j > 0 && j == osize / PAGE_SZ && oseg != null_seg)
+		tseg = tagmap_seg_realloc(oseg, osize, nsize);
+
+	/* not a single segment (or failed); copy the tags */
+	if (tseg == NULL) {
+		/* allocate space for a new tagmap segment */
+		if (unlikely((tseg = tagmap_seg_alloc(nsize)) == NULL)) {
+			/* error message */
+			LOG(string(__func__) +
+				": tagmap segment allocation failed (" +
+				string(strerror(errno)) + ")\n");
+
+			/* die */
+			libdft_die();
+		}
+
+		/*
+		 * copy the tags page by page, and free the
+		 * old shadow (unless the old region is kept)
+		 */
+		for (i = VIRT2STAB(oaddr), j = 0; j < osize / PAGE_SZ;
+				i++, j++) {
+			/* the shadow page */
+			taddr = STAB2VIRT(i) + STAB[i];
+
+			/* clear (or unmapped); nothing to do */
+			if (taddr == (size_t)zero_seg ||
+					taddr == (size_t)null_seg)
+				continue;
+
+			/* copy the tags that are kept */
+			if (j < nsize / PAGE_SZ)
+				(void)memcpy((void *)((size_t)tseg +
+					j * PAGE_SZ), (void *)taddr, PAGE_SZ);
+
+			/* free the old shadow; optimized branch */
+			if (!keep && unlikely(tagmap_seg_free((void *)taddr,
+							PAGE_SZ) == -1)) {
+				/* error message */
+				LOG(string(__func__) +
+					": tagmap segment deallocation failed ("
+					+ string(strerror(errno)) + ")\n");
+
+				/* die */
+				libdft_die();
+			}
+		}
+	}
+
+	/* STAB setup; the old region is unmapped, unless it is reused */
+	if (osize > 0 && !keep) {
+		for (i = VIRT2STAB(oaddr); i <= VIRT2STAB(oaddr + osize - 1);
+				i++)
+			STAB[i] = (uint32_t)null_seg - STAB2VIRT(i);
+		tagmap_acct(VIRT2STAB(oaddr), VIRT2STAB(oaddr + osize - 1),
+				TAGMAP_REG_NONE);
+	}
+	/* the old region is kept, and its (private) pages are emptied */
+	else if (keep && reg != TAGMAP_REG_SHM)
+		tagmap_clrn(oaddr, osize);
+	for (i = VIRT2STAB(naddr), j = 0; i <= VIRT2STAB(naddr + nsize - 1);
+			i++, j++)
+		STAB[i] = (uint32_t)tseg - STAB2VIRT(i) + (j * PAGE_SZ);
+	tagmap_acct(VIRT2STAB(naddr), VIRT2STAB(naddr + nsize - 1),
+			(reg != TAGMAP_REG_NONE && reg != TAGMAP_REG_SHM) ?
+			reg : TAGMAP_REG_MMAP);
+
+	/* the taint summary follows the tags that are kept */
+	tagmap_tsum_move(naddr, oaddr, (osize < nsize) ? osize : nsize);
+#ifdef DEBUG_MEMTRACK
+	/* verbose */
+	LOG(string(__func__) + ": re-mapped segment [" +
+	hexstr(naddr + STAB[VIRT2STAB(naddr)]) +
+	"-" + hexstr(naddr + nsize - 1 + STAB[VIRT2STAB(naddr + nsize - 1)]) +
+	"]\n");
+#endif
 }
 
-#if LINUX_VERSION_CODE >= KERNEL_VERSION(2,6,33)
 /* __NR_recvmmsg post syscall hook */
 static void
 post_recvmmsg_hook(syscall_ctx_t *ctx)
@@ -2513,15 +2257,8 @@ post_recvmmsg_hook(syscall_ctx_t *ctx)
 	struct	mmsghdr *msg;
 	struct	msghdr *m;
 
-	/* iov bytes copied; recvmsg(2) */
-	size_t	iov_tot;
-
-	/* iterators */
-	size_t	i, j;
-	struct	iovec *iov;
-	
-	/* total bytes received */
-	size_t	tot;
+	/* iterator */
+	size_t	i;
 	
 	/* recvmmsg() was not successful; optimized branch */
 	if (unlikely((long)ctx->ret < 0))
@@ -2556,30 +2293,113 @@ post_recvmmsg_hook(syscall_ctx_t *ctx)
 		/* flags; clear the tag bits */
 		tagmap_clrn((size_t)&m->msg_flags, sizeof(int));
 		
+		/* the received data; clear the tag bits */
+		tagmap_clrv(m->msg_iov, m->msg_iovlen, (size_t)msg->msg_len);
+		
 		/* total bytes received; clear the tag bits */	
-		tot = (size_t)msg->msg_len;
 		tagmap_clrn((size_t)&msg->msg_len, sizeof(unsigned));
-		
-		/* iterate the iovec structures */
-		for (j = 0; j < m->msg_iovlen && tot > 0; j++) {
-			/* get the next I/O vector */
-			iov = &m->msg_iov[j];
-
-			/* get the length of the iovec */
-			iov_tot = (tot > (size_t)iov->iov_len) ?
-					(size_t)iov->iov_len : tot;
-	
-			/* clear the tag bits */
-			tagmap_clrn((size_t)iov->iov_base, iov_tot);
-	
-			/* housekeeping */
-			tot -= iov_tot;
-		}
 	}
 
 	/* timespec structure specified */
-	if ((struct timespec *)ctx->arg[SYSCALL_ARG4] != NULL);
+	if ((void *)ctx->arg[SYSCALL_ARG4] != NULL)
 		/* clear the tag bits */
-		tagmap_clrn(ctx->arg[SYSCALL_ARG4], sizeof(struct timespec));
+		tagmap_clrn(ctx->arg[SYSCALL_ARG4],
+#ifdef __NR_recvmmsg_time64
+			(ctx->nr == __NR_recvmmsg_time64) ? TIMESPEC64_SZ :
+#endif
+			sizeof(struct timespec));
+}
+
+/* __NR_getrandom post syscall hook */
+static void
+post_getrandom_hook(syscall_ctx_t *ctx)
+{
+	/* getrandom() was not successful; optimized branch */
+	if (unlikely((long)ctx->ret <= 0))
+		return;
+	
+	/* clear the tag bits */
+	tagmap_clrn(ctx->arg[SYSCALL_ARG0], (size_t)ctx->ret);
 }
+
+/* __NR_process_vm_readv post syscall hook */
+static void
+post_process_vm_readv_hook(syscall_ctx_t *ctx)
+{
+	/* process_vm_readv() was not successful; optimized branch */
+	if (unlikely((long)ctx->ret <= 0))
+		return;
+	
+	/* clear the tag bits of the local iovec structures */
+	tagmap_clrv((struct iovec *)ctx->arg[SYSCALL_ARG1],
+			(size_t)ctx->arg[SYSCALL_ARG2], (size_t)ctx->ret);
+}
+
+/*
+ * __NR_{shmat, shmctl, shmdt, msgrcv} post syscall hook
+ *
+ * SysV IPC syscalls that are not multiplexed by ipc(2); the
+ * context is rewritten in the ipc(2) format and it is handled
+ * by post_ipc_hook()
+ */
+static void
+post_sysv_hook(syscall_ctx_t *ctx)
+{
+	/* the ipc(2) context */
+	syscall_ctx_t ipc_ctx = *ctx;
+
+	/* attach address */
+	size_t shm_addr;
+
+	/* shmat() returns the attach address, or -errno */
+	if (unlikely(ctx->ret >= (ADDRINT)-4095))
+		return;
+
+	/* ipc() succeeded */
+	ipc_ctx.ret = 0;
+
+	switch (ctx->nr) {
+#ifdef __NR_shmat
+		/* shmat(shmid, shmaddr, shmflg) */
+		case __NR_shmat:
+			shm_addr = (size_t)ctx->ret;
+
+			ipc_ctx.arg[SYSCALL_ARG0] = SHMAT;
+			ipc_ctx.arg[SYSCALL_ARG1] = ctx->arg[SYSCALL_ARG0];
+			ipc_ctx.arg[SYSCALL_ARG2] = ctx->arg[SYSCALL_ARG2];
+			ipc_ctx.arg[SYSCALL_ARG3] = (ADDRINT)&shm_addr;
+			break;
+#endif
+#ifdef __NR_shmctl
+		/* shmctl(shmid, cmd, buf) */
+		case __NR_shmctl:
+			ipc_ctx.arg[SYSCALL_ARG0] = SHMCTL;
+			ipc_ctx.arg[SYSCALL_ARG1] = ctx->arg[SYSCALL_ARG0];
+			ipc_ctx.arg[SYSCALL_ARG2] =
+				ctx->arg[SYSCALL_ARG1] | IPC_FIX;
+			ipc_ctx.arg[SYSCALL_ARG4] = ctx->arg[SYSCALL_ARG2];
+			break;
+#endif
+#ifdef __NR_shmdt
+		/* shmdt(shmaddr) */
+		case __NR_shmdt:
+			ipc_ctx.arg[SYSCALL_ARG0] = SHMDT;
+			ipc_ctx.arg[SYSCALL_ARG4] = ctx->arg[SYSCALL_ARG0];
+			break;
 #endif
+#ifdef __NR_msgrcv
+		/* msgrcv(msqid, msgp, msgsz, msgtyp, msgflg) */
+		case __NR_msgrcv:
+			ipc_ctx.ret		  = ctx->ret;
+			ipc_ctx.arg[SYSCALL_ARG0] = MSGRCV;
+			ipc_ctx.arg[SYSCALL_ARG4] = ctx->arg[SYSCALL_ARG1];
+			break;
+#endif
+		default:
+			/* nothing to do */
+			return;
+	}
+
+	/* handle it as ipc(2) */
+	post_ipc_hook(&ipc_ctx);
+}
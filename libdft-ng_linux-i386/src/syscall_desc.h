@@ -56,9 +56,7 @@
 #include "tagmap.h"
 #include "branch_pred.h"
 
-#if LINUX_VERSION_CODE == KERNEL_VERSION(2,6,31)
-#include <linux/perf_counter.h>
-#elif LINUX_VERSION_CODE >= KERNEL_VERSION(2,6,32)
+#ifdef	__NR_perf_event_open
 #include <linux/perf_event.h>
 #endif
 
@@ -190,7 +188,8 @@ union semun {
 	struct seminfo	*__buf;
 };
 
-#if LINUX_VERSION_CODE >= KERNEL_VERSION(2,6,39)
+/* name_to_handle_at(2); glibc 2.14 and later defines it */
+#if defined(__NR_name_to_handle_at) && !defined(MAX_HANDLE_SZ)
 struct file_handle {
 	__u32		handle_bytes;
 	int		handle_type;
@@ -199,6 +198,7 @@ struct file_handle {
 };
 #endif
 
+#define SYS_SOCKET	1
 #define SYS_ACCEPT	5
 #define SYS_GETSOCKNAME	6
 #define SYS_GETPEERNAME	7
@@ -208,9 +208,12 @@ struct file_handle {
 #define SYS_GETSOCKOPT	15
 #define SYS_RECVMSG	17
 #define SYS_ACCEPT4	18
-#if LINUX_VERSION_CODE >= KERNEL_VERSION(2,6,33)
 #define SYS_RECVMMSG	19
-#endif
+
+/* 64-bit time (y2038) and statx(2) structures; i386 sizes */
+#define TIMESPEC64_SZ	16			/* struct __kernel_timespec */
+#define ITIMERSPEC64_SZ	32			/* struct __kernel_itimerspec */
+#define STATX_SZ	256			/* struct statx */
 
 /* system call descriptor */
 typedef struct {
@@ -222,7 +225,42 @@ typedef struct {
 	void	(* post)(syscall_ctx_t*);	/* post-syscall callback */
 } syscall_desc_t;
 
+/* syscall action program flags (syscall_prog_t) */
+enum {
+/* #define */ SYSCALL_PROG_PRE	= 0x1,		/* pre-syscall callback */
+/* #define */ SYSCALL_PROG_POST	= 0x2,		/* post-syscall callback */
+/* #define */ SYSCALL_PROG_CLR	= 0x4		/* clear the arguments map */
+};
+
+/* syscall action program clear operations (syscall_prog_t) */
+enum {
+/* #define */ SYSCALL_CLR_N		= 0x0,		/* any size */
+/* #define */ SYSCALL_CLR_4		= 0x1,		/* 4 bytes */
+/* #define */ SYSCALL_CLR_8		= 0x2,		/* 8 bytes */
+/* #define */ SYSCALL_CLR_16	= 0x3		/* 16 bytes */
+};
+
+/*
+ * precompiled system call descriptor (action program)
+ *
+ * derived from the syscall_desc_t of every syscall; it records only
+ * the arguments that need to be saved and the byte ranges that need
+ * to be cleared, so that syscalls without effects are skipped without
+ * fetching anything
+ */
+typedef struct {
+	uint8_t		flags;				/* SYSCALL_PROG_* */
+	uint8_t		fetch;				/* saved arguments
+							   (bitmap) */
+	uint8_t		nclr;				/* cleared arguments */
+	uint8_t		clr_arg[SYSCALL_ARG_NUM];	/* argument index */
+	uint8_t		clr_op[SYSCALL_ARG_NUM];	/* SYSCALL_CLR_* */
+	uint32_t	clr_len[SYSCALL_ARG_NUM];	/* bytes to clear */
+} syscall_prog_t;
+
 /* syscall API */
+int syscall_desc_init(void);
+int syscall_sockcall(int);
 int syscall_set_pre(syscall_desc_t*, void (*)(syscall_ctx_t*));
 int syscall_clr_pre(syscall_desc_t*);
 int syscall_set_post(syscall_desc_t*, void (*)(syscall_ctx_t*));
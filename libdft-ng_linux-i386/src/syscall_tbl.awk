@@ -0,0 +1,54 @@
+#
+# NSL DFT library (libdft)
+#
+# Columbia University, Department of Computer Science
+# Network Security Lab
+#
+# generate the syscall specification table (syscall_tbl.h)
+# from syscall.tbl; see the header of syscall.tbl for the format
+#
+# usage: awk -f syscall_tbl.awk syscall.tbl > syscall_tbl.h
+#
+
+BEGIN {
+	FS = "\t+"
+	print "/* generated from syscall.tbl by syscall_tbl.awk; do not edit */"
+}
+
+# skip comments and empty lines
+/^#/ || NF == 0 {
+	next
+}
+
+# syscall entry
+{
+	# sanity check
+	if (NF != 4 || $2 !~ /^[0-6]$/) {
+		printf("syscall.tbl:%d: malformed entry\n", NR) > "/dev/stderr"
+		exit 1
+	}
+
+	# arguments map
+	for (i = 0; i < 6; i++)
+		map[i] = "0"
+	if ($3 != "-") {
+		n = split($3, outs, ",")
+		for (i = 1; i <= n; i++) {
+			# <arg>:<bytes>
+			arg = substr(outs[i], 1, index(outs[i], ":") - 1)
+			if (arg !~ /^[0-5]$/ || arg + 0 >= $2 + 0) {
+				printf("syscall.tbl:%d: bad output argument\n",
+					NR) > "/dev/stderr"
+				exit 1
+			}
+			map[arg] = substr(outs[i], index(outs[i], ":") + 1)
+		}
+	}
+
+	# the entry; only if the syscall is known to the system headers
+	print "#ifdef __NR_" $1
+	printf("\t{ __NR_%s, %s, { %s, %s, %s, %s, %s, %s }, %s },\n",
+		$1, $2, map[0], map[1], map[2], map[3], map[4], map[5],
+		($4 == "-") ? "NULL" : $4)
+	print "#endif"
+}
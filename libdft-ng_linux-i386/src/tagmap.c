@@ -30,11 +30,28 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <sys/file.h>
 #include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
 
+#include <dlfcn.h>
+#include <elf.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <limits.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#ifdef	__SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <map>
+#include <set>
 
 #include "libdft_api.h"
 #include "tagmap.h"
@@ -49,6 +66,13 @@
 #define MAP_FLAGS	MAP_PRIVATE | MAP_ANONYMOUS
 #endif
 
+#ifndef	MADV_REMOVE
+#define	MADV_REMOVE	9		/* architecture specific */
+#endif
+#ifndef	__NR_memfd_create
+#define	__NR_memfd_create	356	/* i386 */
+#endif
+
 
 /*
  * tagmap
@@ -77,17 +101,34 @@
  */
 uint32_t	*STAB		= NULL;
 
+/*
+ * taint summary
+ *
+ * a flag per STAB entry that is set when tags may have been stored on the
+ * page (i.e., the page may be tainted), so that range queries and scans
+ * skip the clear pages without touching their shadow. Every path that
+ * stores tags sets it (TSUM_MARK() in the analysis routines, tsum_set()
+ * here), and it is cleared only when the shadow of a whole page is known
+ * to be clear (tagmap_clrn(), tagmap_cpyn(), tagmap_clrall(), and
+ * tagmap_scavenge()). Pages with shared shadows are always set, since
+ * other processes may taint them (see tagmap.h for the layout).
+ * The analysis routines mark a single slot per store; a store that
+ * crosses a page boundary sets a cross-page mark, which covers the next
+ * page as well (TSUM_PAGE()), and it is folded into the marks of both
+ * pages before either of them is unmarked (tsum_unmark())
+ */
+uint8_t		*TSUM		= NULL;
+
 /* program break */
 size_t		brk_start	= 0;
 size_t		brk_end		= 0;
 
+/* main stack; the lowest address that is shadowed (see stack_find()) */
+static size_t	stack_start	= 0;
+
 /* ``hardcoded'' tagmap segments */
 void		*null_seg	= NULL;
-#ifdef TAGMAP_COLLAPSE
 void		*zero_seg	= NULL;
-#else
-static void	*zero_seg	= NULL;
-#endif
 
 /*
  * track when the dynamic linker/loader
@@ -98,587 +139,3374 @@ static
 size_t dynldlnk_loaded	= 0;
 
 /*
- * get the starting and ending
- * addresses of the vDSO mapping
+ * tagmap arena
+ *
+ * when the tagmap is exported (see tagmap_export()), STAB and the tagmap
+ * segments are carved out of a single shared memory object that is
+ * mapped at arena_base; arena_free keeps the free extents of the arena
+ * (offset, length), and the allocation is done in a first-fit manner
+ */
+static size_t			arena_base	= 0;
+static size_t			arena_size	= 0;
+/* the arena is shared (flag); it is privatized after fork(2) */
+static size_t			arena_shared	= 0;
+/* shared memory object (descriptor and name) */
+static int			arena_fd	= -1;
+static char			arena_name[NAME_MAX];
+/* free extents */
+static map<size_t, size_t>	arena_free;
+
+/*
+ * shared shadows
+ *
+ * shared application memory gets a shadow that is shared as well (see
+ * tagmap_seg_share()); share_pref is the name prefix of the shadow
+ * objects (empty if disabled), and share_segs keeps the shared tagmap
+ * segments (address -> length, and the name of the shadow object of a
+ * file; empty for keyed objects and anonymous shared memory)
+ */
+typedef struct {
+	size_t	len;		/* length of the segment	*/
+	string	name;		/* shadow object		*/
+} share_seg_t;
+
+static char				share_pref[NAME_MAX];
+static map<size_t, share_seg_t>	share_segs;
+
+/*
+ * shadow memory accounting
+ *
+ * stab_reg keeps the region type of every STAB entry (one byte per
+ * page; see tagmap_acct()), and acct_cur/acct_peak the bytes that are
+ * reserved for each type; the updates are atomic, since the syscall
+ * hooks of different threads may remap concurrently
+ */
+static uint8_t		*stab_reg	= NULL;
+static size_t		acct_cur[TAGMAP_REG_NUM];
+static size_t		acct_peak[TAGMAP_REG_NUM];
+static size_t		acct_total_peak	= 0;
+/* shadow bytes that were reclaimed (see tagmap_scavenge()) */
+static size_t		acct_reclaimed	= 0;
+/* region type names (reports) */
+static const char	*reg_name[TAGMAP_REG_NUM] =
+	{ "none", "stab", "stack", "img", "brk", "mmap", "shm" };
+
+/*
+ * read a /proc file in bulk
  *
+ * /proc files report no size; the buffer is doubled until
+ * read(2) hits the end of the file, so that the snapshot
+ * takes a few large reads instead of a stdio call per line
  *
- * @saddr: 	the starting address of vDSO
- * @eaddr:	the ending address of VDSO
+ * @path:	the path of the file
+ * @len:	the length of the contents
  *
- * returbs:	saddr and eaddr have the appropriate
- * 		values after invocation; if vDSO
- * 		is not found saddr and eaddr will
- * 		be zero
+ * returns:	the contents (NUL-terminated; to be freed with free(3)),
+ * 		or NULL on error
  */
-static inline
-void get_vdso(size_t *saddr, size_t *eaddr)
+static char *
+proc_read(const char *path, size_t *len)
 {
-	/* file pointer */
-	FILE	*fp		= NULL;
-	/* path to /proc/<pid>/maps */
-	char	maps_path[PATH_MAX];
-	/* line buffer */
-	char	lbuf[MAPS_ENTRY_MAX];
-	
-	/* initialization */
-	*saddr = *eaddr = 0;
+	/* file descriptor */
+	int	fd;
+	/* buffer, and its size */
+	char	*buf = NULL, *nbuf;
+	size_t	sz = MAPS_BUF_SZ;
+	/* bytes read */
+	ssize_t	n;
 
-	/* cleanup */
-	(void)memset(maps_path, 0, PATH_MAX);
+	/* open the file; optimized branch */
+	if (unlikely((fd = open(path, O_RDONLY)) == -1)) {
+		/* error message */
+		LOG(string(__func__) + ": failed while trying to open " +
+			string(path) + " -- (" +
+			string(strerror(errno)) + ")\n");
 
-	/* prepare the pathname for /proc/<pid>/maps */
-	if (snprintf(maps_path, PATH_MAX, "/proc/%d/maps",
-				PIN_GetPid()) > PATH_MAX) {
 		/* failed */
-		LOG(string(__func__) + ": failed while trying to assemble "
-				+ string(maps_path) + " -- (" +
-				string(strerror(errno)) + ")\n");
-		return;
+		return NULL;
 	}
 
-	/* open /proc/<pid>/maps */
-	if ((fp = fopen(maps_path, "r")) == NULL) {
-		/* failed */
-		LOG(string(__func__) + ": failed while trying to open "
-				+ string(maps_path) + " -- (" +
-				string(strerror(errno)) + ")\n");
-		return;
-	}
-	
-	/* read the file */
-	while(!feof(fp)) {
-		/* buffer cleanup */
-		(void)memset(lbuf, 0, MAPS_ENTRY_MAX);
-	
-		/* read a line */
-		if (fgets(lbuf, MAPS_ENTRY_MAX, fp) == NULL) {
-			/* something went wrong */
-			if (ferror(fp)) {
-				/* verbose */
-				LOG(string(__func__) +
-					": failed while trying to read"
-					+ string(maps_path) + " -- (" +
-					string(strerror(errno)) + ")\n");
-				break;
-			}
+	/* read the whole file */
+	for (*len = 0, n = 1; n > 0; *len += n) {
+		/* grow the buffer; keep room for the NUL */
+		if (buf == NULL || *len + 1 == sz) {
+			if (buf != NULL)
+				sz <<= 1;
+
+			/* optimized branch */
+			if (unlikely((nbuf = (char *)realloc(buf, sz)) ==
+						NULL))
+				goto err;
+			buf = nbuf;
 		}
-		
-		/* check for the vDSO entry */
-		if (strstr(lbuf, VDSO_STR) != NULL) {
-			/* update saddr and eaddr */
-			(void)sscanf(lbuf, "%x-%x %*s:4 %*x %*s:5 %*u%*s\n",
-					saddr, eaddr);
-			/* done */
+
+		/* bulk read; optimized branch */
+		if (unlikely((n = read(fd, buf + *len, sz - *len - 1)) < 0))
+			goto err;
+	}
+
+	/* cleanup */
+	(void)close(fd);
+
+	/* done */
+	buf[*len] = '\0';
+	return buf;
+
+err:	/* error handling */
+
+	/* error message */
+	LOG(string(__func__) + ": failed while trying to read " +
+		string(path) + " -- (" + string(strerror(errno)) + ")\n");
+
+	/* cleanup */
+	(void)close(fd);
+	free(buf);
+
+	/* failed */
+	return NULL;
+}
+
+/*
+ * get the address of the vDSO
+ *
+ * the kernel passes it in the auxiliary vector
+ * (AT_SYSINFO_EHDR) of the process
+ *
+ * returns:	the starting address of the vDSO,
+ * 		or zero if it is not found
+ */
+static size_t
+get_vdso(void)
+{
+	/* the auxiliary vector */
+	char		*buf;
+	Elf32_auxv_t	*auxv;
+	size_t		len;
+	/* vDSO address */
+	size_t		vdso = 0;
+
+	/* read the auxiliary vector; optimized branch */
+	if (unlikely((buf = proc_read("/proc/self/auxv", &len)) == NULL))
+		return 0;
+
+	/* look for the vDSO entry */
+	for (auxv = (Elf32_auxv_t *)buf;
+		(char *)(auxv + 1) <= buf + len && auxv->a_type != AT_NULL;
+		auxv++)
+		if (auxv->a_type == AT_SYSINFO_EHDR) {
+			vdso = auxv->a_un.a_val;
 			break;
 		}
-	}
 
 	/* cleanup */
-	(void)fclose(fp);
+	free(buf);
+
+	/* done */
+	return vdso;
 }
 
-#ifdef TAGMAP_COLLAPSE
 /*
- * ELF image loading callback
+ * check if a tagmap segment range is a shared shadow
  *
- * capture the loading of an image and setup the tagmap accordingly;
- * read-only sections are mapped to zero_seg, whereas for each writeable
- * section we allocate a tagmap segment and adjust the STAB
+ * @addr:	the starting address of the range
  *
- * @img:	image handle
- * @v:		callback value
+ * returns:	1 if it is, 0 otherwise
  */
-static void
-elf_load(IMG img, VOID *v)
+static inline int
+seg_shared(void *addr)
 {
-	SEC	sec;	/* section iterator		*/
-	SEC	lread;	/* last read-only section	*/
-	size_t	i, j;	/* STAB iterators		*/
-	void*	tseg;	/* tagmap segment		*/
-	size_t	slen;	/* segment length 		*/
+	/* iterator */
+	map<size_t, share_seg_t>::iterator it;
 
-	/* 
-	 * after the dynamic linker/loaded is mapped into
-	 * the address space of the process, the image loading
-	 * is handled via mmap(2). However, we cannot unregister
-	 * elf_load, so we rely on this ugly hack; optimized branch
-	 */ 
-	if (likely(dynldlnk_loaded == 1))
-		return;
+	/* no shared shadows; fast path */
+	if (likely(share_segs.empty()))
+		return 0;
 
-#ifdef DEBUG_MEMTRACK
-	/* verbose */
-	LOG(string(__func__) + ": " +
-		IMG_Name(img) + " " +
-		hexstr(IMG_LowAddress(img)) + "-" +
-		hexstr(IMG_HighAddress(img)) + "\n");
+	/* the segment that starts at (or before) the address */
+	if ((it = share_segs.upper_bound((size_t)addr)) == share_segs.begin())
+		return 0;
+	it--;
 
-	for (sec = IMG_SecHead(img); SEC_Valid(sec); sec = SEC_Next(sec)) {
-		LOG("\t" + SEC_Name(sec) + ": " +
-			hexstr(SEC_Address(sec)) + "-" +
-			hexstr(SEC_Address(sec) + SEC_Size(sec) - 1) + " ");
-		if (SEC_IsReadable(sec)) LOG("R"); else LOG("-");
-		if (SEC_IsWriteable(sec)) LOG("W"); else LOG("-");
-		if (SEC_IsExecutable(sec)) LOG("X"); else LOG("-");
-		if (!SEC_Mapped(sec)) LOG(" (not mapped)");
-		LOG("\n");
+	/* done */
+	return ((size_t)addr - it->first < it->second.len);
+}
+
+/*
+ * check if a process that maps a shadow object is alive
+ *
+ * @pid:	the process id (0 for a free slot)
+ *
+ * returns:	1 if it is, 0 otherwise
+ */
+static inline int
+share_live(pid_t pid)
+{
+	return (pid > 0 && (kill(pid, 0) == 0 || errno == EPERM));
+}
+
+/*
+ * check if the process maps (part of) a shadow object
+ *
+ * @name:	the name of the object
+ *
+ * returns:	1 if it does, 0 otherwise
+ */
+static int
+share_mapped(const string &name)
+{
+	/* iterator */
+	map<size_t, share_seg_t>::iterator it;
+
+	/* traverse the shared segments */
+	for (it = share_segs.begin(); it != share_segs.end(); it++)
+		if (it->second.name == name)
+			return 1;
+
+	/* not mapped */
+	return 0;
+}
+
+/*
+ * register the process with a shadow object
+ *
+ * the header of the object (TAGMAP_SHARE_HDR) keeps the pids of the
+ * processes that map it. An object that no live process maps is stale
+ * (e.g., it was left behind by a crashed process, and the memory has
+ * changed since), and its tags are dropped
+ *
+ * @sfd:	the shadow object
+ *
+ * returns:	1 if the object was stale (its tags are clear), 0 if it is
+ * 		in use, -2 if it was removed meanwhile, and -1 on error
+ */
+static int
+share_attach(int sfd)
+{
+	/* the header, and the pid of the process */
+	pid_t	pids[TAGMAP_SHARE_PIDS], self = getpid();
+	/* iterator, live processes, and a free slot */
+	size_t	i, live = 0, slot = TAGMAP_SHARE_PIDS;
+	/* object metadata */
+	struct stat64 st;
+	/* return value */
+	int	ret = -1;
+
+	/* the header is updated by one process at a time */
+	if (unlikely(flock(sfd, LOCK_EX) == -1))
+		return -1;
+
+	/* removed by the last process that mapped it; retry */
+	if (unlikely(fstat64(sfd, &st) == -1))
+		goto done;
+	if (unlikely(st.st_nlink == 0)) {
+		ret = -2;
+		goto done;
 	}
-#endif
-	
-	/* 
-	 * iterate the sections in the ELF image (forward pass)
-	 * until the first writeable section is encountered
-	 */
-	for (sec = IMG_SecHead(img), lread = SEC_Invalid();
-			SEC_Valid(sec) && !SEC_IsWriteable(sec);
-			sec = SEC_Next(sec)) {
-		/* ignore unmapped sections; optimized branch */
-		if (unlikely(!SEC_Mapped(sec)))
-			continue;
 
-		/* update the last read-only section */
-		lread = sec;
+	/* the header; a new object reads as empty */
+	(void)memset(pids, 0, sizeof(pids));
+	if (unlikely(pread64(sfd, pids, sizeof(pids), 0) == -1))
+		goto done;
+
+	/* forget the processes that are gone; find a free slot */
+	for (i = 0; i < TAGMAP_SHARE_PIDS; i++) {
+		if (pids[i] == self || !share_live(pids[i]))
+			pids[i] = 0;
+		else
+			live++;
+		if (pids[i] == 0 && slot == TAGMAP_SHARE_PIDS)
+			slot = i;
 	}
-	
-	/* read-only sections exist; optimized branch */
-	if (likely(SEC_Valid(lread))) {
-		/* get the last read-only section
-		 * (tagmap collapse optimization)
-		 * 
-		 * read-only sections are mapped to zero_seg for reducing
-		 * address space waste; reading from zero_seg always results
-		 * in clear tags
-		 */
-		
-		/* STAB setup */
-		for (i = VIRT2STAB(IMG_LowAddress(img));
-		i <= VIRT2STAB(SEC_Address(lread) + SEC_Size(lread) - 1); i++)
-			STAB[i] = (uint32_t)zero_seg - STAB2VIRT(i);
-#ifdef DEBUG_MEMTRACK
-		/* verbose */
-		LOG(string(__func__) + ": mapping read sections " +
-			hexstr(IMG_LowAddress(img)) + "-" + 
-			hexstr(SEC_Address(lread) + SEC_Size(lread) - 1) +
-			" [" +
-			hexstr(STAB[VIRT2STAB(IMG_LowAddress(img))] + 
-					IMG_LowAddress(img)) + "-" +
-			hexstr(STAB[VIRT2STAB(SEC_Address(lread) +
-					SEC_Size(lread) - 1)] +
-			       SEC_Address(lread) + SEC_Size(lread) - 1) +
-			"]\n");	
-#endif
+
+	/* stale; drop the tags (the object is sized again) */
+	if ((ret = (live == 0)) &&
+			unlikely(ftruncate64(sfd, TAGMAP_SHARE_HDR) == -1)) {
+		ret = -1;
+		goto done;
 	}
-	
-	/* writeable sections exist; optimized branch */
-	if (likely(SEC_IsWriteable(sec))) {
-		/* estimate the length of the tagmap segment */
-		slen	= PAGE_ALIGN(IMG_HighAddress(img)) -
-				PAGE_ALIGN(SEC_Address(sec)) + PAGE_SZ;
-	
-		/*
-		 * allocate space for a new tagmap
-		 * segment by invoking mmap(2)
-		 */
-		if (unlikely(((tseg = mmap(NULL, slen,
-			/* RW- */
-			PROT_READ | PROT_WRITE | ~PROT_EXEC,
-			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)) == MAP_FAILED))) {
-			
-			/* error message */
-			LOG(string(__func__) +
-				": tagmap segment allocation failed (" +
-				string(strerror(errno)) + ")\n");
 
-			/* die */
-			libdft_die();
+	/* register; without a free slot, the others remove the object */
+	if (likely(slot < TAGMAP_SHARE_PIDS))
+		pids[slot] = self;
+	if (unlikely(pwrite64(sfd, pids, sizeof(pids), 0) != sizeof(pids)))
+		ret = -1;
+
+done:	/* cleanup */
+	(void)flock(sfd, LOCK_UN);
+	return ret;
+}
+
+/*
+ * unregister the process from a shadow object
+ *
+ * the last process that maps the object removes it
+ *
+ * @name:	the name of the object
+ */
+static void
+share_detach(const string &name)
+{
+	/* the header, and the pid of the process */
+	pid_t	pids[TAGMAP_SHARE_PIDS], self = getpid();
+	/* iterator, and live processes */
+	size_t	i, live = 0;
+	/* shadow object descriptor */
+	int	sfd;
+
+	/* removed already (e.g., by IPC_RMID; see tagmap_seg_unshare()) */
+	if ((sfd = shm_open(name.c_str(), O_RDWR, 0)) == -1)
+		return;
+
+	/* update the header */
+	if (likely(flock(sfd, LOCK_EX) == 0)) {
+		if (likely(pread64(sfd, pids, sizeof(pids), 0) ==
+					sizeof(pids))) {
+			for (i = 0; i < TAGMAP_SHARE_PIDS; i++)
+				if (pids[i] == self)
+					pids[i] = 0;
+				else if (share_live(pids[i]))
+					live++;
+
+			/* the last one; remove it */
+			if (live == 0)
+				(void)shm_unlink(name.c_str());
+			else
+				(void)pwrite64(sfd, pids, sizeof(pids), 0);
 		}
-		
-		/* STAB setup */	
-		for (i = VIRT2STAB(SEC_Address(sec)), j = 0;
-			i <= VIRT2STAB(IMG_HighAddress(img)); i++, j++)
-			STAB[i] = (uint32_t)tseg - STAB2VIRT(i) + (j * PAGE_SZ);
-#ifdef DEBUG_MEMTRACK
-		/* verbose */
-		LOG(string(__func__) + ": mapping write sections " +
-			hexstr(SEC_Address(sec)) + "-" + 
-			hexstr(IMG_HighAddress(img)) + " [" +
-			hexstr(STAB[VIRT2STAB(SEC_Address(sec))] +
-			       SEC_Address(sec)) + "-" +
-			hexstr(STAB[VIRT2STAB(IMG_HighAddress(img))] + 
-					IMG_HighAddress(img)) + "]\n");
-#endif
-	}
-	
-	/* setup the program break */
-	if (brk_end == 0) {
-		brk_start = brk_end =
-			PAGE_ALIGN(IMG_HighAddress(img)) + PAGE_SZ;
-#ifdef DEBUG_MEMTRACK
-		/* verbose */
-		LOG(string(__func__) + ": brk is set at " +
-				hexstr(brk_end) + "\n");
-#endif
+		(void)flock(sfd, LOCK_UN);
 	}
 
-	/* check if the loaded image was the dynamic linker/loader */
-	if (IMG_Name(img).compare(DYNLDLNK) == 0 ||
-			IMG_Type(img) == IMG_TYPE_STATIC)
-		/* set the corresponding flag accordingly */
-		dynldlnk_loaded = 1;
+	/* cleanup */
+	(void)close(sfd);
 }
-#else
+
 /*
- * ELF image loading callback
+ * forget the shared shadows in a tagmap segment range that is freed
  *
- * capture the loading of an image and setup the tagmap; we
- * allocate a tagmap segment and adjust the STAB accordingly 
+ * the segments that cross the range are trimmed (or split), and the
+ * process unregisters from the shadow objects that it does not map
+ * anymore
  *
- * @img:	image handle
- * @v:		callback value
+ * @start:	the starting address of the range
+ * @len:	the length of the range (page aligned)
  */
 static void
-elf_load(IMG img, VOID *v)
+share_trim(size_t start, size_t len)
 {
-	size_t	i, j;	/* STAB iterators		*/
-	void*	tseg;	/* tagmap segment		*/
-	size_t	slen;	/* segment length 		*/
+	/* iterator */
+	map<size_t, share_seg_t>::iterator it;
+	/* segment (start/end), and range end */
+	size_t	sstart, send, end = start + len;
+	/* the objects that lost a segment */
+	set<string> names;
+	set<string>::iterator nt;
+	/* shadow object */
+	string	name;
 
-	/* 
-	 * after the dynamic linker/loaded is mapped into
-	 * the address space of the process, the image loading
-	 * is handled via mmap(2). However, we cannot unregister
-	 * elf_load, so we rely on this ugly hack; optimized branch
-	 */ 
-	if (likely(dynldlnk_loaded == 1))
-		return;
+	/* the first segment that may overlap */
+	if ((it = share_segs.upper_bound(start)) != share_segs.begin())
+		it--;
+
+	/* traverse the segments that start before the end */
+	while (it != share_segs.end() && it->first < end) {
+		sstart	= it->first;
+		send	= sstart + it->second.len;
+
+		/* no overlap */
+		if (send <= start) {
+			it++;
+			continue;
+		}
+
+		/* drop it; keep the parts outside the range */
+		name = it->second.name;
+		share_segs.erase(it++);
+		if (sstart < start) {
+			share_segs[sstart].len	= start - sstart;
+			share_segs[sstart].name	= name;
+		}
+		if (send > end) {
+			share_segs[end].len	= send - end;
+			share_segs[end].name	= name;
+		}
+		if (!name.empty())
+			names.insert(name);
+	}
+
+	/* unregister from the objects that are not mapped anymore */
+	for (nt = names.begin(); nt != names.end(); nt++)
+		if (!share_mapped(*nt))
+			share_detach(*nt);
+}
+
+/*
+ * release the physical memory of a tagmap segment range
+ *
+ * the range must be page aligned and, after the invocation, it reads
+ * as clear; shared memory is released with MADV_REMOVE, since
+ * MADV_DONTNEED would only drop our view of the pages
+ *
+ * @addr:	the starting address of the range
+ * @len:	the length of the range
+ *
+ * returns:	0 on success, -1 on error
+ */
+static inline int
+seg_release(void *addr, size_t len)
+{
+	return madvise(addr, len, (arena_shared != 0 || seg_shared(addr)) ?
+			MADV_REMOVE : MADV_DONTNEED);
+}
+
+/*
+ * allocate a tagmap segment
+ *
+ * if the tagmap is not exported, the segment is a new mapping (flags);
+ * otherwise, the segment is carved out of the arena (first-fit). In both
+ * cases, the segment is page aligned and reads as clear
+ *
+ * @len:	the length of the segment
+ * @flags:	mmap(2) flags (private segments only)
+ *
+ * returns:	the address of the segment on success, NULL on error
+ */
+static void *
+seg_alloc(size_t len, int flags)
+{
+	/* iterator */
+	map<size_t, size_t>::iterator it;
+	/* segment address */
+	void	*tseg;
+	/* segment offset (arena) */
+	size_t	off;
+
+	/* private segment; optimized branch */
+	if (likely(arena_base == 0)) {
+		/* allocate the segment by invoking mmap(2) */
+		tseg = mmap(NULL, len,
+			/* RW- */
+			PROT_READ | PROT_WRITE | ~PROT_EXEC,
+			flags, -1, 0);
+
+		/* done */
+		return (tseg == MAP_FAILED) ? NULL : tseg;
+	}
+
+	/* page align the length */
+	len = PAGE_ALIGN(len + PAGE_SZ - 1);
+
+	/* find the first free extent that is large enough */
+	for (it = arena_free.begin();
+		it != arena_free.end() && it->second < len; it++);
+
+	/* the arena is exhausted */
+	if (unlikely(it == arena_free.end() || len == 0)) {
+		/* error message; the segments cannot be placed elsewhere */
+		if (len != 0)
+			LOG(string(__func__) + ": the exported tagmap is "
+				"exhausted (" + decstr(len) + " bytes requested, " +
+				decstr(arena_size >> 20) +
+				" MB arena); export a larger one\n");
+
+		errno = ENOMEM;
+		return NULL;
+	}
+
+	/* carve the segment out of the extent */
+	off = it->first;
+	if (it->second > len)
+		arena_free[off + len] = it->second - len;
+	arena_free.erase(it);
+
+	/* return the segment */
+	return (void *)(arena_base + off);
+}
+
+/*
+ * allocate a tagmap segment
+ *
+ * @len:	the length of the segment
+ *
+ * returns:	the address of the segment on success, NULL on error
+ */
+void *
+tagmap_seg_alloc(size_t len)
+{
+	return seg_alloc(len, MAP_PRIVATE | MAP_ANONYMOUS);
+}
+
+/*
+ * reserve a tagmap segment
+ *
+ * same as tagmap_seg_alloc(), but no swap space is reserved for the
+ * segment (MAP_NORESERVE); physical memory is committed page by page,
+ * as the segment is touched (e.g., the shadow of a thread stack)
+ *
+ * @len:	the length of the segment
+ *
+ * returns:	the address of the segment on success, NULL on error
+ */
+void *
+tagmap_seg_reserve(size_t len)
+{
+	return seg_alloc(len, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE);
+}
+
+/*
+ * deallocate (part of) a tagmap segment
+ *
+ * @addr:	the starting address of the range
+ * @len:	the length of the range
+ *
+ * returns:	0 on success, -1 on error
+ */
+int
+tagmap_seg_free(void *addr, size_t len)
+{
+	/* iterators */
+	map<size_t, size_t>::iterator it, prev;
+	/* range offset (arena; start/end) */
+	size_t	off, end;
+
+	/* page align the length */
+	len = PAGE_ALIGN(len + PAGE_SZ - 1);
+
+	/* private segment; optimized branch */
+	if (likely((size_t)addr - arena_base >= arena_size)) {
+		/* forget the shared shadows in the range */
+		if (unlikely(!share_segs.empty()))
+			share_trim((size_t)addr, len);
+
+		/* deallocate the segment by invoking munmap(2) */
+		return munmap(addr, len);
+	}
+
+	/* the range in the arena */
+	off = (size_t)addr - arena_base;
+	end = off + len;
+
+	/* invalid range */
+	if (unlikely(PAGE_OFFSET(off) != 0 || end > arena_size)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	/* release the pages of the range */
+	if (unlikely(len > 0 && seg_release(addr, len) == -1))
+		return -1;
 
-#ifdef DEBUG_MEMTRACK
-	/* verbose */
-	LOG(string(__func__) + ": " +
-		IMG_Name(img) + " " +
-		hexstr(IMG_LowAddress(img)) + "-" +
-		hexstr(IMG_HighAddress(img)) + "\n");
-#endif
-	
-	/* estimate the length of the tagmap segment */
-	slen	= PAGE_ALIGN(IMG_HighAddress(img)) -
-			PAGE_ALIGN(IMG_LowAddress(img)) + PAGE_SZ;
-	
 	/*
-	 * allocate space for a new tagmap
-	 * segment by invoking mmap(2)
+	 * return the range to the free extents; adjacent (or
+	 * overlapping) extents are coalesced with the range
 	 */
-	if (unlikely(((tseg = mmap(NULL, slen,
-		/* RW- */
-		PROT_READ | PROT_WRITE | ~PROT_EXEC,
-		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)) == MAP_FAILED))) {
-			
+	it = arena_free.upper_bound(off);
+	if (it != arena_free.begin()) {
+		prev = it;
+		prev--;
+		if (prev->first + prev->second >= off) {
+			off = prev->first;
+			if (prev->first + prev->second > end)
+				end = prev->first + prev->second;
+			arena_free.erase(prev);
+		}
+	}
+	while (it != arena_free.end() && it->first <= end) {
+		if (it->first + it->second > end)
+			end = it->first + it->second;
+		arena_free.erase(it++);
+	}
+	if (likely(end > off))
+		arena_free[off] = end - off;
+
+	/* return with success */
+	return 0;
+}
+
+/*
+ * resize a tagmap segment
+ *
+ * the contents of the segment are preserved (up to the minimum of the two
+ * lengths) and the new part of a grown segment reads as clear; the
+ * segment may be moved
+ *
+ * @addr:	the address of the segment
+ * @olen:	the old length of the segment
+ * @nlen:	the new length of the segment
+ *
+ * returns:	the address of the segment on success, NULL on error
+ */
+void *
+tagmap_seg_realloc(void *addr, size_t olen, size_t nlen)
+{
+	/* iterator */
+	map<size_t, size_t>::iterator it;
+	/* segment address */
+	void	*tseg;
+
+	/*
+	 * shared shadow; the shadow object may not cover the new
+	 * length, and the caller falls back to a private copy
+	 */
+	if (unlikely(seg_shared(addr))) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	/* private segment; optimized branch */
+	if (likely((size_t)addr - arena_base >= arena_size)) {
+		/* resize the segment by invoking mremap(2) */
+		tseg = mremap(addr, olen, nlen, MREMAP_MAYMOVE);
+
+		/* done */
+		return (tseg == MAP_FAILED) ? NULL : tseg;
+	}
+
+	/* page align the lengths */
+	olen = PAGE_ALIGN(olen + PAGE_SZ - 1);
+	nlen = PAGE_ALIGN(nlen + PAGE_SZ - 1);
+
+	/* shrink; release the tail */
+	if (nlen <= olen)
+		return (tagmap_seg_free((void *)((size_t)addr + nlen),
+					olen - nlen) == 0) ? addr : NULL;
+
+	/* grow in place; the next extent is free and large enough */
+	it = arena_free.find((size_t)addr - arena_base + olen);
+	if (it != arena_free.end() && it->second >= nlen - olen) {
+		if (it->second > nlen - olen)
+			arena_free[it->first + nlen - olen] =
+				it->second - (nlen - olen);
+		arena_free.erase(it);
+
+		/* done */
+		return addr;
+	}
+
+	/* move the segment */
+	if (unlikely((tseg = seg_alloc(nlen, 0)) == NULL))
+		return NULL;
+	(void)memcpy(tseg, addr, olen);
+	(void)tagmap_seg_free(addr, olen);
+
+	/* return the new segment */
+	return tseg;
+}
+
+/*
+ * register the child with the shadow objects that it inherited
+ *
+ * called in the child after fork
+ *
+ * @tid:	the thread id of the child
+ * @ctx:	CPU context
+ * @v:		callback value
+ */
+static void
+share_fork(THREADID tid, const CONTEXT *ctx, VOID *v)
+{
+	/* iterator */
+	map<size_t, share_seg_t>::iterator it;
+	/* the objects */
+	set<string> names;
+	set<string>::iterator nt;
+	/* shadow object descriptor */
+	int	sfd;
+
+	/* the objects that are mapped */
+	for (it = share_segs.begin(); it != share_segs.end(); it++)
+		if (!it->second.name.empty())
+			names.insert(it->second.name);
+
+	/* the parent maps them as well; they are not stale */
+	for (nt = names.begin(); nt != names.end(); nt++)
+		if ((sfd = shm_open(nt->c_str(), O_RDWR, 0)) != -1) {
+			(void)share_attach(sfd);
+			(void)close(sfd);
+		}
+}
+
+/*
+ * unregister from the shadow objects
+ *
+ * called when the process exits
+ *
+ * @code:	exit code of the application
+ * @v:		callback value
+ */
+static void
+share_fini(INT32 code, VOID *v)
+{
+	/* iterator */
+	map<size_t, share_seg_t>::iterator it;
+	/* the objects */
+	set<string> names;
+	set<string>::iterator nt;
+
+	/* the objects that are mapped */
+	for (it = share_segs.begin(); it != share_segs.end(); it++)
+		if (!it->second.name.empty())
+			names.insert(it->second.name);
+
+	/* unregister */
+	for (nt = names.begin(); nt != names.end(); nt++)
+		share_detach(*nt);
+}
+
+/*
+ * enable shared shadows
+ *
+ * the shadow of shared application memory (MAP_SHARED mappings, SysV
+ * shared memory) is itself shared, so that the tags propagate between
+ * the (instrumented) processes that map the same memory, at memory
+ * speed. The shadow objects are POSIX shared memory objects, named
+ * after the prefix and the key of the memory (see tagmap_seg_share());
+ * cooperating processes must use the same prefix. The shadow of a file
+ * is removed when the last process that maps it unmaps it (or exits)
+ *
+ * @pref:	the name prefix of the shadow objects (e.g., "/libdft-sh")
+ *
+ * returns:	0 on success, 1 on error
+ */
+int
+tagmap_share(const char *pref)
+{
+	/* invalid prefix */
+	if (unlikely(pref == NULL || pref[0] != TAGMAP_SHM_PREFIX ||
+		strchr(pref + 1, '/') != NULL ||
+		strlen(pref) >= NAME_MAX / 2)) {
 		/* error message */
-		LOG(string(__func__) +
-			": tagmap segment allocation failed (" +
-			string(strerror(errno)) + ")\n");
+		LOG(string(__func__) + ": invalid prefix\n");
 
-		/* die */
-		libdft_die();
+		/* failed */
+		return 1;
 	}
-		
-	/* STAB setup */	
-	for (i = VIRT2STAB(IMG_LowAddress(img)), j = 0;
-		i <= VIRT2STAB(IMG_HighAddress(img)); i++, j++)
-		STAB[i] = (uint32_t)tseg - STAB2VIRT(i) + (j * PAGE_SZ);
-#ifdef DEBUG_MEMTRACK
-		/* verbose */
-		LOG(string(__func__) + ": mapping sections " +
-			hexstr(IMG_LowAddress(img)) + "-" + 
-			hexstr(IMG_HighAddress(img)) + " [" +
-			hexstr(STAB[VIRT2STAB(IMG_LowAddress(img))] +
-			       IMG_LowAddress(img)) + "-" +
-			hexstr(STAB[VIRT2STAB(IMG_HighAddress(img))] + 
-					IMG_HighAddress(img)) + "]\n");
-#endif
-	/* setup the program break */
-	if (brk_end == 0) {
-		brk_start = brk_end =
-			PAGE_ALIGN(IMG_HighAddress(img)) + PAGE_SZ;
-#ifdef DEBUG_MEMTRACK
-		/* verbose */
-		LOG(string(__func__) + ": brk is set at " +
-				hexstr(brk_end) + "\n");
-#endif
+
+	/* enable */
+	(void)strcpy(share_pref, pref);
+
+	/* register the fork and exit callbacks */
+	PIN_AddForkFunction(FPOINT_AFTER_IN_CHILD, share_fork, NULL);
+	PIN_AddFiniFunction(share_fini, NULL);
+
+	/* success */
+	return 0;
+}
+
+/*
+ * allocate a shared tagmap segment
+ *
+ * the shadow of a file, or of a keyed object (e.g., a SysV shared memory
+ * segment), is the same range of a shadow object that is named after the
+ * file (device and inode) or the key; it is created on first use, and it
+ * is sparse and large enough for any offset (TAGMAP_SHARE_SZ), after a
+ * header (TAGMAP_SHARE_HDR). The shadow of a file is removed when none
+ * of the processes in its header maps it anymore, and the stale shadow
+ * of a crashed process is cleared when it is reused (see share_attach());
+ * the shadow of a keyed object is removed with the object. Otherwise
+ * (anonymous shared memory), the shadow is anonymous shared memory,
+ * which is inherited by the children of the process
+ *
+ * @fd:		the file (-1 if none)
+ * @key:	the key of the object (NULL if none)
+ * @off:	the offset of the range in the object (page aligned)
+ * @len:	the length of the range
+ * @created:	set to 1 if the shadow is new (clear), and to 0 if it
+ * 		was created by another process (unchanged on failure)
+ *
+ * returns:	the address of the segment, or NULL if shared shadows are
+ * 		disabled (or on error)
+ */
+void *
+tagmap_seg_share(int fd, const char *key, off64_t off, size_t len,
+		size_t *created)
+{
+	/* file key, and shadow object name */
+	char	fkey[NAME_MAX / 2], name[NAME_MAX];
+	/* shadow object descriptor */
+	int	sfd;
+	/* file, and shadow object, metadata */
+	struct stat64 st;
+	/* segment address */
+	void	*tseg;
+	/* new shadow (flag), and the object is mapped already (flag) */
+	size_t	fresh = 1, mapped = 0;
+	/* registration status (see share_attach(); 0 if not needed) */
+	int	reg;
+
+	/* disabled; fast path */
+	if (likely(share_pref[0] == '\0'))
+		return NULL;
+
+	/* the key of a file; optimized branch */
+	if (fd >= 0) {
+		if (unlikely(fstat64(fd, &st) == -1))
+			return NULL;
+		(void)snprintf(fkey, sizeof(fkey), "%llx.%llx",
+				(unsigned long long)st.st_dev,
+				(unsigned long long)st.st_ino);
+		key = fkey;
 	}
 
-	/* check if the loaded image was the dynamic linker/loader */
-	if (IMG_Name(img).compare(DYNLDLNK) == 0 ||
-			IMG_Type(img) == IMG_TYPE_STATIC)
-		/* set the corresponding flag accordingly */
-		dynldlnk_loaded = 1;
+	/* anonymous memory */
+	if (key == NULL)
+		tseg = mmap(NULL, len,
+			/* RW- */
+			PROT_READ | PROT_WRITE | ~PROT_EXEC,
+			MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	else {
+		/*
+		 * the process maps the object already (registered); the
+		 * shadows of keyed objects live as long as the objects
+		 * (see tagmap_seg_unshare()), and they are not registered
+		 */
+		(void)snprintf(name, sizeof(name), "%s.%s", share_pref, key);
+		mapped = (fd < 0) || share_mapped(name);
+
+		/* open (or create) the shadow object, and register */
+		do {
+			fresh	= 1;
+			reg	= 0;
+			if ((sfd = shm_open(name, O_RDWR | O_CREAT | O_EXCL,
+						S_IRUSR | S_IWUSR)) == -1 &&
+					errno == EEXIST) {
+				sfd	= shm_open(name, O_RDWR, 0);
+				fresh	= 0;
+			}
+
+			/* failed; optimized branch */
+			if (unlikely(sfd == -1)) {
+				/* error message */
+				LOG(string(__func__) + ": opening " +
+					string(name) + " failed (" +
+					string(strerror(errno)) + ")\n");
+
+				/* failed */
+				return NULL;
+			}
+
+			/* registered already, or now; otherwise, retry */
+			if ((mapped != 0 && (fd < 0 || fresh == 0)) ||
+					(reg = share_attach(sfd)) >= 0)
+				break;
+			(void)close(sfd);
+		} while (reg == -2);
+
+		/* failed; optimized branch */
+		if (unlikely(reg == -1)) {
+			/* error message */
+			LOG(string(__func__) + ": registering with " +
+				string(name) + " failed (" +
+				string(strerror(errno)) + ")\n");
+
+			/* failed */
+			return NULL;
+		}
+
+		/* stale; the tags were dropped */
+		if (reg == 1)
+			fresh = 1;
+
+		/* size it (once); it never shrinks */
+		if (unlikely(fstat64(sfd, &st) == -1 ||
+			(st.st_size < TAGMAP_SHARE_HDR + off + (off64_t)len &&
+			ftruncate64(sfd, TAGMAP_SHARE_HDR +
+				((off + (off64_t)len >
+					(off64_t)TAGMAP_SHARE_SZ) ?
+				off + (off64_t)len :
+				(off64_t)TAGMAP_SHARE_SZ)) == -1))) {
+			/* error message */
+			LOG(string(__func__) + ": sizing " + string(name) +
+				" failed (" + string(strerror(errno)) + ")\n");
+
+			/* cleanup */
+			(void)close(sfd);
+			if (mapped == 0)
+				share_detach(name);
+			return NULL;
+		}
+
+		/* map the range (after the header) */
+		tseg = mmap64(NULL, len,
+			/* RW- */
+			PROT_READ | PROT_WRITE | ~PROT_EXEC,
+			MAP_SHARED | MAP_NORESERVE, sfd,
+			TAGMAP_SHARE_HDR + off);
+
+		/* cleanup */
+		(void)close(sfd);
+
+		/* failed; unregister */
+		if (unlikely(tseg == MAP_FAILED) && mapped == 0)
+			share_detach(name);
+	}
+
+	/* failed; optimized branch */
+	if (unlikely(tseg == MAP_FAILED)) {
+		/* error message */
+		LOG(string(__func__) + ": mapping failed (" +
+				string(strerror(errno)) + ")\n");
+
+		/* failed */
+		return NULL;
+	}
+
+	/* keep track of the segment */
+	share_segs[(size_t)tseg].len	= PAGE_ALIGN(len + PAGE_SZ - 1);
+	share_segs[(size_t)tseg].name	= (fd >= 0) ? name : "";
+	*created = fresh;
+
+	/* return the segment */
+	return tseg;
+}
+
+/*
+ * remove a shadow object
+ *
+ * called when the keyed object is removed; the processes
+ * that map the shadow keep it
+ *
+ * @key:	the key of the object
+ */
+void
+tagmap_seg_unshare(const char *key)
+{
+	/* shadow object name */
+	char	name[NAME_MAX];
+
+	/* disabled; fast path */
+	if (likely(share_pref[0] == '\0'))
+		return;
+
+	/* unlink it */
+	(void)snprintf(name, sizeof(name), "%s.%s", share_pref, key);
+	(void)shm_unlink(name);
+}
+
+/*
+ * charge bytes to a region type
+ *
+ * @reg:	the region type
+ * @delta:	the bytes (negative to release them)
+ */
+static inline void
+acct_add(uint8_t reg, ssize_t delta)
+{
+	/* current value (after the update) and total */
+	size_t	cur, total;
+	/* iterator */
+	size_t	i;
+
+	/* nothing to charge (or not accounted); fast path */
+	if (delta == 0 || reg == TAGMAP_REG_NONE)
+		return;
+
+	/* update the type; the peaks are updated lazily (racy max) */
+	cur = __sync_add_and_fetch(&acct_cur[reg], (size_t)delta);
+	if (delta > 0 && cur > acct_peak[reg])
+		acct_peak[reg] = cur;
+
+	/* update the total peak */
+	if (delta > 0) {
+		for (i = 0, total = 0; i < TAGMAP_REG_NUM; i++)
+			total += acct_cur[i];
+		if (total > acct_total_peak)
+			acct_total_peak = total;
+	}
+}
+
+/*
+ * account a STAB range
+ *
+ * invoked after the STAB entries of a range are set up; the bytes of
+ * every entry are released from its previous region type and they are
+ * charged to the new one (TAGMAP_REG_NONE for zero_seg and null_seg)
+ *
+ * @first:	the first STAB entry
+ * @last:	the last STAB entry (inclusive)
+ * @reg:	the region type
+ */
+void
+tagmap_acct(size_t first, size_t last, uint8_t reg)
+{
+	/* per-type deltas */
+	ssize_t	delta[TAGMAP_REG_NUM];
+	/* iterator */
+	size_t	i;
+
+	/* not initialized yet; optimized branch */
+	if (unlikely(stab_reg == NULL))
+		return;
+
+	/* move the entries to the new type */
+	(void)memset(delta, 0, sizeof(delta));
+	for (i = first; i <= last && i < STAB_SIZE; i++) {
+		delta[stab_reg[i]]	-= PAGE_SZ;
+		delta[reg]		+= PAGE_SZ;
+		stab_reg[i]		= reg;
+
+		/* shared shadows may be tainted by other processes */
+		if (reg == TAGMAP_REG_SHM)
+			TSUM[TSUM_SLOT(i, 0)] = 1;
+	}
+
+	/* charge the types (releases first) */
+	for (i = 0; i < TAGMAP_REG_NUM; i++)
+		if (delta[i] < 0)
+			acct_add(i, delta[i]);
+	for (i = 0; i < TAGMAP_REG_NUM; i++)
+		if (delta[i] > 0)
+			acct_add(i, delta[i]);
+}
+
+/*
+ * get the region type of an address
+ *
+ * @addr:	the virtual address
+ *
+ * returns:	the region type (TAGMAP_REG_NONE if unknown)
+ */
+uint8_t
+tagmap_reg(size_t addr)
+{
+	return (likely(stab_reg != NULL)) ?
+		stab_reg[VIRT2STAB(addr)] : TAGMAP_REG_NONE;
+}
+
+/*
+ * count the tainted bytes of a shadow page
+ *
+ * @tpage:	the shadow page (page aligned)
+ *
+ * returns:	the number of non-zero tags
+ */
+static inline size_t
+page_tainted(const uint8_t *tpage)
+{
+	/* clear tags */
+	size_t	clr = 0;
+	/* iterator */
+	size_t	i;
+#ifdef __SSE2__
+	/* 16-byte tag vectors, and zero */
+	__m128i	v0, v1, v2, v3, zero = _mm_setzero_si128();
+
+	/* 64 bytes at a time; clear blocks are skipped at once */
+	for (i = 0; i < PAGE_SZ; i += 64) {
+		v0 = _mm_load_si128((const __m128i *)(tpage + i));
+		v1 = _mm_load_si128((const __m128i *)(tpage + i + 16));
+		v2 = _mm_load_si128((const __m128i *)(tpage + i + 32));
+		v3 = _mm_load_si128((const __m128i *)(tpage + i + 48));
+
+		/* clear block; fast path */
+		if (likely(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_or_si128(
+				_mm_or_si128(v0, v1), _mm_or_si128(v2, v3)),
+				zero)) == 0xFFFF)) {
+			clr += 64;
+			continue;
+		}
+
+		/* count the clear tags of every vector */
+		clr += __builtin_popcount(
+			_mm_movemask_epi8(_mm_cmpeq_epi8(v0, zero))) +
+			__builtin_popcount(
+			_mm_movemask_epi8(_mm_cmpeq_epi8(v1, zero))) +
+			__builtin_popcount(
+			_mm_movemask_epi8(_mm_cmpeq_epi8(v2, zero))) +
+			__builtin_popcount(
+			_mm_movemask_epi8(_mm_cmpeq_epi8(v3, zero)));
+	}
+#else
+	/* tag words */
+	uint32_t w;
+
+	/* 4 bytes at a time; clear words are skipped at once */
+	for (i = 0; i < PAGE_SZ; i += sizeof(uint32_t)) {
+		if (likely((w = *(const uint32_t *)(tpage + i)) == 0)) {
+			clr += sizeof(uint32_t);
+			continue;
+		}
+		clr += ((w & 0xFF) == 0) + ((w & 0xFF00) == 0) +
+			((w & 0xFF0000) == 0) + ((w & 0xFF000000) == 0);
+	}
+#endif
+	/* done */
+	return PAGE_SZ - clr;
+}
+
+/*
+ * check if a shadow page is clear
+ *
+ * @tpage:	the shadow page (page aligned)
+ *
+ * returns:	1 if all of its tags are clear, 0 otherwise
+ */
+static inline int
+page_clear(const uint8_t *tpage)
+{
+	/* iterator */
+	size_t	i;
+#ifdef __SSE2__
+	/* 16-byte tag vectors (OR-ed) */
+	__m128i	v;
+
+	/* 64 bytes at a time; stop at the first tainted block */
+	for (i = 0; i < PAGE_SZ; i += 64) {
+		v = _mm_or_si128(
+			_mm_or_si128(_mm_load_si128((const __m128i *)(tpage + i)),
+			_mm_load_si128((const __m128i *)(tpage + i + 16))),
+			_mm_or_si128(
+			_mm_load_si128((const __m128i *)(tpage + i + 32)),
+			_mm_load_si128((const __m128i *)(tpage + i + 48))));
+
+		/* tainted block; optimized branch */
+		if (unlikely(_mm_movemask_epi8(_mm_cmpeq_epi8(v,
+					_mm_setzero_si128())) != 0xFFFF))
+			return 0;
+	}
+#else
+	/* 4 bytes at a time; stop at the first tainted word */
+	for (i = 0; i < PAGE_SZ; i += sizeof(uint32_t))
+		if (unlikely(*(const uint32_t *)(tpage + i) != 0))
+			return 0;
+#endif
+	/* done */
+	return 1;
+}
+
+/*
+ * fold the cross-page mark of a page into the marks
+ * of the page and the next one in the taint summary
+ *
+ * @indx:	the STAB index of the page
+ */
+static inline void
+tsum_fold(size_t indx)
+{
+	/* not marked; optimized branch */
+	if (likely(TSUM[TSUM_SLOT(indx, 2)] == 0))
+		return;
+
+	/* mark both pages (the last page wraps to the first) */
+	TSUM[TSUM_SLOT(indx, 0)] = 1;
+	TSUM[TSUM_SLOT((indx + 1) & (STAB_SIZE - 1), 0)] = 1;
+	TSUM[TSUM_SLOT(indx, 2)] = 0;
+}
+
+/*
+ * unmark a clear page in the taint summary
+ *
+ * the cross-page marks that cover the page (i.e., its own and the one
+ * of the previous page) are folded first, so that the neighbouring
+ * pages stay marked
+ *
+ * @indx:	the STAB index of the page
+ */
+static inline void
+tsum_unmark(size_t indx)
+{
+	/* fold the cross-page marks */
+	tsum_fold((indx - 1) & (STAB_SIZE - 1));
+	tsum_fold(indx);
+
+	/* unmark */
+	TSUM[TSUM_SLOT(indx, 0)] = 0;
+}
+
+/*
+ * reclaim the clear shadow pages
+ *
+ * shadow pages stay resident after their tags are cleared (e.g., the
+ * buffers of a connection that is closed, or overwritten with clean
+ * data). The resident pages whose tags are all clear are released
+ * (seg_release()); they read as clear afterwards, and they are
+ * committed again on the next tag write. Shared shadows are skipped,
+ * since other processes may write to them.
+ *
+ * NOTE: a tag that is written between the check of a page and its
+ * release is lost; the caller must ensure that no tags are written
+ * while the scan runs (see libdft_scavenge())
+ *
+ * returns:	the number of reclaimed bytes
+ */
+size_t
+tagmap_scavenge(void)
+{
+	/* residency of a batch of shadow pages */
+	unsigned char	vec[TAGMAP_SCAN_PAGES];
+	/* iterators */
+	size_t		i, j, n;
+	/* shadow page (first of the batch) */
+	size_t		taddr;
+	/* run of clear pages (start and pages) */
+	size_t		rstart = 0, rlen;
+	/* reclaimed bytes */
+	size_t		reclaimed = 0;
+	/* region type */
+	uint8_t		reg;
+
+	/* not initialized yet; optimized branch */
+	if (unlikely(stab_reg == NULL))
+		return 0;
+
+	/* walk the STAB in batches of contiguous shadow pages */
+	for (i = 0; i < STAB_SIZE; i += n) {
+		/* unaccounted (zero_seg, null_seg), or shared; skip */
+		if ((reg = stab_reg[i]) == TAGMAP_REG_NONE ||
+				reg == TAGMAP_REG_SHM) {
+			n = 1;
+			continue;
+		}
+
+		/* extend the batch */
+		taddr = STAB2VIRT(i) + STAB[i];
+		for (n = 1; n < TAGMAP_SCAN_PAGES && i + n < STAB_SIZE &&
+			stab_reg[i + n] == reg &&
+			STAB2VIRT(i + n) + STAB[i + n] == taddr + n * PAGE_SZ;
+			n++);
+
+		/* unaligned shadow, or residency; optimized branch */
+		if (unlikely(PAGE_OFFSET(taddr) != 0) ||
+			unlikely(mincore((void *)taddr, n * PAGE_SZ, vec) == -1))
+			continue;
+
+		/*
+		 * release the runs of resident clear pages; the pages that
+		 * are not marked in the taint summary are clear by definition
+		 */
+		for (j = 0, rlen = 0; j <= n; j++) {
+			/* extend the run */
+			if (j < n && (vec[j] & 1) != 0 &&
+				(TSUM_PAGE(i + j) == 0 ||
+				page_clear((const uint8_t *)(taddr +
+							j * PAGE_SZ)))) {
+				tsum_unmark(i + j);
+				if (rlen++ == 0)
+					rstart = taddr + j * PAGE_SZ;
+				continue;
+			}
+
+			/* release the run */
+			if (rlen != 0 && likely(seg_release((void *)rstart,
+						rlen * PAGE_SZ) == 0))
+				reclaimed += rlen * PAGE_SZ;
+			rlen = 0;
+		}
+	}
+
+	/* update the statistics */
+	(void)__sync_add_and_fetch(&acct_reclaimed, reclaimed);
+
+	/* done */
+	return reclaimed;
+}
+
+/*
+ * get the shadow memory usage
+ *
+ * the reserved bytes (current and peak) are always reported; if scan
+ * is set, the shadow is also walked for the resident bytes (mincore(2))
+ * and the tainted bytes of every region type. Only resident pages are
+ * scanned for tags, and the scan must not race with the unmapping of
+ * application memory (e.g., invoke it at exit, or from a syscall hook
+ * of a single-threaded application)
+ *
+ * @usage:	the usage (output)
+ * @scan:	walk the shadow (flag)
+ */
+void
+tagmap_usage(tagmap_usage_t *usage, size_t scan)
+{
+	/* residency of a batch of shadow pages */
+	unsigned char	vec[TAGMAP_SCAN_PAGES];
+	/* iterators */
+	size_t		i, j, n;
+	/* shadow page (first of the batch) */
+	size_t		taddr;
+	/* region type */
+	uint8_t		reg;
+
+	/* the reserved bytes */
+	(void)memset(usage, 0, sizeof(*usage));
+	for (i = 0; i < TAGMAP_REG_NUM; i++) {
+		usage->cur[i]	= acct_cur[i];
+		usage->peak[i]	= acct_peak[i];
+		usage->total	+= acct_cur[i];
+	}
+	usage->total_peak = acct_total_peak;
+	usage->reclaimed = acct_reclaimed;
+
+	/* no scan; done */
+	if (scan == 0 || unlikely(stab_reg == NULL))
+		return;
+
+	/* STAB and the region types */
+	usage->rss[TAGMAP_REG_STAB] = acct_cur[TAGMAP_REG_STAB];
+
+	/* walk the STAB in batches of contiguous shadow pages */
+	for (i = 0; i < STAB_SIZE; i += n) {
+		/* unaccounted (zero_seg, null_seg); skip */
+		if ((reg = stab_reg[i]) == TAGMAP_REG_NONE) {
+			n = 1;
+			continue;
+		}
+
+		/* extend the batch */
+		taddr = STAB2VIRT(i) + STAB[i];
+		for (n = 1; n < TAGMAP_SCAN_PAGES && i + n < STAB_SIZE &&
+			stab_reg[i + n] == reg &&
+			STAB2VIRT(i + n) + STAB[i + n] == taddr + n * PAGE_SZ;
+			n++);
+
+		/* residency; optimized branch */
+		if (unlikely(mincore((void *)taddr, n * PAGE_SZ, vec) == -1))
+			continue;
+
+		/* resident pages; count their tags (clear ones are skipped) */
+		for (j = 0; j < n; j++)
+			if ((vec[j] & 1) != 0) {
+				usage->rss[reg]		+= PAGE_SZ;
+				if (TSUM_PAGE(i + j) != 0)
+					usage->tainted[reg] += page_tainted(
+						(const uint8_t *)(taddr +
+							j * PAGE_SZ));
+			}
+	}
+}
+
+/*
+ * log the shadow memory usage
+ *
+ * @usage:	the usage
+ * @scan:	the usage includes the scan (flag)
+ */
+static void
+usage_log(const tagmap_usage_t *usage, size_t scan)
+{
+	/* iterator */
+	size_t	i;
+	/* report */
+	string	rep = "tagmap: total " + decstr(usage->total >> 10) +
+			" KB (peak " + decstr(usage->total_peak >> 10) +
+			" KB);";
+
+	/* one entry per region type */
+	for (i = TAGMAP_REG_NONE + 1; i < TAGMAP_REG_NUM; i++) {
+		rep += " " + string(reg_name[i]) + " " +
+			decstr(usage->cur[i] >> 10) + "/" +
+			decstr(usage->peak[i] >> 10);
+		if (scan != 0)
+			rep += "/" + decstr(usage->rss[i] >> 10) + "/" +
+				decstr(usage->tainted[i]);
+	}
+
+	/* clear pages that were released by the scavenger */
+	if (usage->reclaimed != 0)
+		rep += "; reclaimed " + decstr(usage->reclaimed >> 10) + " KB";
+
+	/* done */
+	LOG(rep + (scan != 0 ? " (KB cur/peak/rss, tainted bytes)\n" :
+				" (KB cur/peak)\n"));
+}
+
+/*
+ * periodic usage dump (internal thread)
+ *
+ * @v:		the period (seconds)
+ */
+static void
+usage_thread(VOID *v)
+{
+	/* usage */
+	tagmap_usage_t usage;
+	/* period (ms) and elapsed time */
+	UINT32 period = (UINT32)(size_t)v * 1000, elapsed = 0;
+
+	/* dump the usage every period (counters only) */
+	while (!PIN_IsProcessExiting()) {
+		PIN_Sleep(TAGMAP_DUMP_MS);
+		if ((elapsed += TAGMAP_DUMP_MS) < period)
+			continue;
+		elapsed = 0;
+
+		tagmap_usage(&usage, 0);
+		usage_log(&usage, 0);
+	}
+}
+
+/*
+ * final usage dump (fini function)
+ *
+ * @code:	exit code of the application
+ * @v:		callback value
+ */
+static void
+usage_fini(INT32 code, VOID *v)
+{
+	/* usage */
+	tagmap_usage_t usage;
+
+	/* the scan is safe here; the application is exiting */
+	tagmap_usage(&usage, 1);
+	usage_log(&usage, 1);
+}
+
+/*
+ * enable the shadow memory usage dump
+ *
+ * the usage is logged at exit (including the resident and tainted
+ * bytes), and every period seconds while the application is running
+ *
+ * @period:	the period (seconds); 0 for the final dump only
+ *
+ * returns:	0 on success, 1 on error
+ */
+int
+tagmap_usage_dump(size_t period)
+{
+	/* spawn the internal thread; optimized branch */
+	if (period != 0 && unlikely(PIN_SpawnInternalThread(usage_thread,
+				(VOID *)period, 0, NULL) == INVALID_THREADID)) {
+		/* error message */
+		LOG(string(__func__) + ": internal thread spawn failed\n");
+
+		/* failed */
+		return 1;
+	}
+
+	/* dump the usage at exit */
+	PIN_AddFiniFunction(usage_fini, NULL);
+
+	/* success */
+	return 0;
+}
+
+/*
+ * unlink the exported tagmap
+ *
+ * the shared memory object is removed from the namespace when the
+ * process exits; readers that have it mapped keep their view
+ *
+ * @code:	exit code of the application
+ * @v:		callback value
+ */
+static void
+arena_fini(INT32 code, VOID *v)
+{
+	/* named shared memory object */
+	if (arena_shared != 0 && arena_name[0] == TAGMAP_SHM_PREFIX)
+		(void)shm_unlink(arena_name);
+}
+
+/*
+ * copy the resident, non-clear pages of an allocated arena range
+ *
+ * the pages that are not resident (e.g., the untouched part of the
+ * stack shadow) or clear are left to the zero-filled private arena,
+ * so that they are not committed in the child
+ *
+ * @arena:	the private arena
+ * @off:	the offset of the range (page-aligned)
+ * @len:	the length of the range (page-aligned)
+ */
+static inline void
+arena_copy(void *arena, size_t off, size_t len)
+{
+	/* residency of a batch of pages */
+	unsigned char	vec[TAGMAP_SCAN_PAGES];
+	/* iterators */
+	size_t		i, n;
+	/* shared page */
+	const uint8_t	*page;
+
+	/* traverse the range in batches */
+	for (; len > 0; off += n * PAGE_SZ, len -= n * PAGE_SZ) {
+		/* get the batch */
+		n = (len / PAGE_SZ < TAGMAP_SCAN_PAGES) ?
+			len / PAGE_SZ : TAGMAP_SCAN_PAGES;
+
+		/* residency; copy the whole batch on failure */
+		if (unlikely(mincore((void *)(arena_base + off),
+					n * PAGE_SZ, vec) == -1))
+			(void)memset(vec, 1, n);
+
+		/* copy the resident pages that are not clear */
+		for (i = 0; i < n; i++) {
+			page = (const uint8_t *)(arena_base + off + i * PAGE_SZ);
+			if ((vec[i] & 1) != 0 && !page_clear(page))
+				(void)memcpy((void *)((size_t)arena + off +
+						i * PAGE_SZ), page, PAGE_SZ);
+		}
+	}
+}
+
+/*
+ * privatize the exported tagmap in a child process
+ *
+ * after fork(2) the child shares the arena with its parent; we copy
+ * the allocated part of it to a private mapping, which is then moved
+ * on top of the arena, so that the two processes do not clobber
+ * each other's tags (the parent remains the exporter). Only the pages
+ * that are resident and not clear are copied (see arena_copy())
+ *
+ * @tid:	thread id
+ * @ctx:	CPU context
+ * @v:		callback value
+ */
+static void
+arena_fork(THREADID tid, const CONTEXT *ctx, VOID *v)
+{
+	/* iterator */
+	map<size_t, size_t>::iterator it;
+	/* private arena */
+	void	*arena;
+	/* allocated range (offset) */
+	size_t	off;
+
+	/* allocate the private arena */
+	if (unlikely((arena = mmap(NULL, arena_size,
+			/* RW- */
+			PROT_READ | PROT_WRITE | ~PROT_EXEC,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+			-1, 0)) == MAP_FAILED)) {
+		/* error message */
+		LOG(string(__func__) + ": tagmap arena allocation failed (" +
+				string(strerror(errno)) + ")\n");
+
+		/* die */
+		libdft_die();
+	}
+
+	/* copy the allocated ranges (i.e., the gaps between free extents) */
+	for (off = 0, it = arena_free.begin(); ; it++) {
+		/* the next free extent (or the end of the arena) */
+		size_t end = (it == arena_free.end()) ? arena_size : it->first;
+
+		/* copy the allocated range */
+		arena_copy(arena, off, end - off);
+
+		/* done */
+		if (it == arena_free.end())
+			break;
+		off = it->first + it->second;
+	}
+
+	/* replace the shared arena */
+	if (unlikely(mremap(arena, arena_size, arena_size,
+			MREMAP_MAYMOVE | MREMAP_FIXED,
+			(void *)arena_base) == MAP_FAILED)) {
+		/* error message */
+		LOG(string(__func__) + ": tagmap arena privatization failed (" +
+				string(strerror(errno)) + ")\n");
+
+		/* die */
+		libdft_die();
+	}
+
+	/* cleanup */
+	if (arena_fd != -1)
+		(void)close(arena_fd);
+	arena_fd	= -1;
+	arena_shared	= 0;
+	arena_name[0]	= '\0';
+}
+
+#ifdef TAGMAP_COLLAPSE
+/*
+ * ELF image loading callback
+ *
+ * capture the loading of an image and setup the tagmap accordingly;
+ * read-only sections are mapped to zero_seg, whereas for each writeable
+ * section we allocate a tagmap segment and adjust the STAB
+ *
+ * @img:	image handle
+ * @v:		callback value
+ */
+static void
+elf_load(IMG img, VOID *v)
+{
+	SEC	sec;	/* section iterator		*/
+	SEC	lread;	/* last read-only section	*/
+	size_t	i, j;	/* STAB iterators		*/
+	void*	tseg;	/* tagmap segment		*/
+	size_t	slen;	/* segment length 		*/
+
+	/* 
+	 * after the dynamic linker/loaded is mapped into
+	 * the address space of the process, the image loading
+	 * is handled via mmap(2). However, we cannot unregister
+	 * elf_load, so we rely on this ugly hack; optimized branch
+	 */ 
+	if (likely(dynldlnk_loaded == 1))
+		return;
+
+#ifdef DEBUG_MEMTRACK
+	/* verbose */
+	LOG(string(__func__) + ": " +
+		IMG_Name(img) + " " +
+		hexstr(IMG_LowAddress(img)) + "-" +
+		hexstr(IMG_HighAddress(img)) + "\n");
+
+	for (sec = IMG_SecHead(img); SEC_Valid(sec); sec = SEC_Next(sec)) {
+		LOG("\t" + SEC_Name(sec) + ": " +
+			hexstr(SEC_Address(sec)) + "-" +
+			hexstr(SEC_Address(sec) + SEC_Size(sec) - 1) + " ");
+		if (SEC_IsReadable(sec)) LOG("R"); else LOG("-");
+		if (SEC_IsWriteable(sec)) LOG("W"); else LOG("-");
+		if (SEC_IsExecutable(sec)) LOG("X"); else LOG("-");
+		if (!SEC_Mapped(sec)) LOG(" (not mapped)");
+		LOG("\n");
+	}
+#endif
+	
+	/* 
+	 * iterate the sections in the ELF image (forward pass)
+	 * until the first writeable section is encountered
+	 */
+	for (sec = IMG_SecHead(img), lread = SEC_Invalid();
+			SEC_Valid(sec) && !SEC_IsWriteable(sec);
+			sec = SEC_Next(sec)) {
+		/* ignore unmapped sections; optimized branch */
+		if (unlikely(!SEC_Mapped(sec)))
+			continue;
+
+		/* update the last read-only section */
+		lread = sec;
+	}
+	
+	/* read-only sections exist; optimized branch */
+	if (likely(SEC_Valid(lread))) {
+		/* get the last read-only section
+		 * (tagmap collapse optimization)
+		 * 
+		 * read-only sections are mapped to zero_seg for reducing
+		 * address space waste; reading from zero_seg always results
+		 * in clear tags
+		 */
+		
+		/* STAB setup */
+		for (i = VIRT2STAB(IMG_LowAddress(img));
+		i <= VIRT2STAB(SEC_Address(lread) + SEC_Size(lread) - 1); i++)
+			STAB[i] = (uint32_t)zero_seg - STAB2VIRT(i);
+		tagmap_acct(VIRT2STAB(IMG_LowAddress(img)),
+			VIRT2STAB(SEC_Address(lread) + SEC_Size(lread) - 1),
+			TAGMAP_REG_NONE);
+#ifdef DEBUG_MEMTRACK
+		/* verbose */
+		LOG(string(__func__) + ": mapping read sections " +
+			hexstr(IMG_LowAddress(img)) + "-" + 
+			hexstr(SEC_Address(lread) + SEC_Size(lread) - 1) +
+			" [" +
+			hexstr(STAB[VIRT2STAB(IMG_LowAddress(img))] + 
+					IMG_LowAddress(img)) + "-" +
+			hexstr(STAB[VIRT2STAB(SEC_Address(lread) +
+					SEC_Size(lread) - 1)] +
+			       SEC_Address(lread) + SEC_Size(lread) - 1) +
+			"]\n");	
+#endif
+	}
+	
+	/* writeable sections exist; optimized branch */
+	if (likely(SEC_IsWriteable(sec))) {
+		/* estimate the length of the tagmap segment */
+		slen	= PAGE_ALIGN(IMG_HighAddress(img)) -
+				PAGE_ALIGN(SEC_Address(sec)) + PAGE_SZ;
+	
+		/* allocate space for a new tagmap segment */
+		if (unlikely((tseg = tagmap_seg_alloc(slen)) == NULL)) {
+			
+			/* error message */
+			LOG(string(__func__) +
+				": tagmap segment allocation failed (" +
+				string(strerror(errno)) + ")\n");
+
+			/* die */
+			libdft_die();
+		}
+		
+		/* STAB setup */	
+		for (i = VIRT2STAB(SEC_Address(sec)), j = 0;
+			i <= VIRT2STAB(IMG_HighAddress(img)); i++, j++)
+			STAB[i] = (uint32_t)tseg - STAB2VIRT(i) + (j * PAGE_SZ);
+		tagmap_acct(VIRT2STAB(SEC_Address(sec)),
+			VIRT2STAB(IMG_HighAddress(img)), TAGMAP_REG_IMG);
+#ifdef DEBUG_MEMTRACK
+		/* verbose */
+		LOG(string(__func__) + ": mapping write sections " +
+			hexstr(SEC_Address(sec)) + "-" + 
+			hexstr(IMG_HighAddress(img)) + " [" +
+			hexstr(STAB[VIRT2STAB(SEC_Address(sec))] +
+			       SEC_Address(sec)) + "-" +
+			hexstr(STAB[VIRT2STAB(IMG_HighAddress(img))] + 
+					IMG_HighAddress(img)) + "]\n");
+#endif
+	}
+	
+	/* setup the program break */
+	if (brk_end == 0) {
+		brk_start = brk_end =
+			PAGE_ALIGN(IMG_HighAddress(img)) + PAGE_SZ;
+#ifdef DEBUG_MEMTRACK
+		/* verbose */
+		LOG(string(__func__) + ": brk is set at " +
+				hexstr(brk_end) + "\n");
+#endif
+	}
+
+	/* check if the loaded image was the dynamic linker/loader */
+	if (IMG_Name(img).compare(DYNLDLNK) == 0 ||
+			IMG_Type(img) == IMG_TYPE_STATIC)
+		/* set the corresponding flag accordingly */
+		dynldlnk_loaded = 1;
+}
+#else
+/*
+ * ELF image loading callback
+ *
+ * capture the loading of an image and setup the tagmap; we
+ * allocate a tagmap segment and adjust the STAB accordingly 
+ *
+ * @img:	image handle
+ * @v:		callback value
+ */
+static void
+elf_load(IMG img, VOID *v)
+{
+	size_t	i, j;	/* STAB iterators		*/
+	void*	tseg;	/* tagmap segment		*/
+	size_t	slen;	/* segment length 		*/
+
+	/* 
+	 * after the dynamic linker/loaded is mapped into
+	 * the address space of the process, the image loading
+	 * is handled via mmap(2). However, we cannot unregister
+	 * elf_load, so we rely on this ugly hack; optimized branch
+	 */ 
+	if (likely(dynldlnk_loaded == 1))
+		return;
+
+#ifdef DEBUG_MEMTRACK
+	/* verbose */
+	LOG(string(__func__) + ": " +
+		IMG_Name(img) + " " +
+		hexstr(IMG_LowAddress(img)) + "-" +
+		hexstr(IMG_HighAddress(img)) + "\n");
+#endif
+	
+	/* estimate the length of the tagmap segment */
+	slen	= PAGE_ALIGN(IMG_HighAddress(img)) -
+			PAGE_ALIGN(IMG_LowAddress(img)) + PAGE_SZ;
+	
+	/* allocate space for a new tagmap segment */
+	if (unlikely((tseg = tagmap_seg_alloc(slen)) == NULL)) {
+			
+		/* error message */
+		LOG(string(__func__) +
+			": tagmap segment allocation failed (" +
+			string(strerror(errno)) + ")\n");
+
+		/* die */
+		libdft_die();
+	}
+		
+	/* STAB setup */	
+	for (i = VIRT2STAB(IMG_LowAddress(img)), j = 0;
+		i <= VIRT2STAB(IMG_HighAddress(img)); i++, j++)
+		STAB[i] = (uint32_t)tseg - STAB2VIRT(i) + (j * PAGE_SZ);
+	tagmap_acct(VIRT2STAB(IMG_LowAddress(img)),
+		VIRT2STAB(IMG_HighAddress(img)), TAGMAP_REG_IMG);
+#ifdef DEBUG_MEMTRACK
+		/* verbose */
+		LOG(string(__func__) + ": mapping sections " +
+			hexstr(IMG_LowAddress(img)) + "-" + 
+			hexstr(IMG_HighAddress(img)) + " [" +
+			hexstr(STAB[VIRT2STAB(IMG_LowAddress(img))] +
+			       IMG_LowAddress(img)) + "-" +
+			hexstr(STAB[VIRT2STAB(IMG_HighAddress(img))] + 
+					IMG_HighAddress(img)) + "]\n");
+#endif
+	/* setup the program break */
+	if (brk_end == 0) {
+		brk_start = brk_end =
+			PAGE_ALIGN(IMG_HighAddress(img)) + PAGE_SZ;
+#ifdef DEBUG_MEMTRACK
+		/* verbose */
+		LOG(string(__func__) + ": brk is set at " +
+				hexstr(brk_end) + "\n");
+#endif
+	}
+
+	/* check if the loaded image was the dynamic linker/loader */
+	if (IMG_Name(img).compare(DYNLDLNK) == 0 ||
+			IMG_Type(img) == IMG_TYPE_STATIC)
+		/* set the corresponding flag accordingly */
+		dynldlnk_loaded = 1;
+}
+#endif
+
+/*
+ * find the installation of Pin in a /proc/self/maps snapshot
+ *
+ * Pin's own images (pinbin, and its runtime libraries) live
+ * under the directory above the one of pinbin (e.g., .../ia32/)
+ *
+ * @maps:	the snapshot
+ * @pref:	the directory, with a trailing slash (empty if not found)
+ */
+static void
+maps_pin(const char *maps, string *pref)
+{
+	/* the line of pinbin, and the end of its directory */
+	const char	*line, *end;
+	int		n = 0;
+	size_t		i;
+
+	/* not found */
+	pref->clear();
+	if ((end = strstr(maps, "/" PINBIN_STR "\n")) == NULL)
+		return;
+
+	/* the path of pinbin */
+	for (line = end; line > maps && line[-1] != '\n'; line--);
+	(void)sscanf(line, "%*x-%*x %*4s %*x %*s %*u %n", &n);
+	if (n == 0 || line + n >= end)
+		return;
+
+	/* its parent directory */
+	pref->assign(line + n, end - (line + n));
+	if ((i = pref->rfind('/')) == string::npos)
+		pref->clear();
+	else
+		pref->resize(i + 1);
+}
+
+/*
+ * set up the STAB for the regions that precede libdft
+ *
+ * the snapshot of /proc/self/maps is parsed in one pass. The vDSO and
+ * its data ([vvar]) are mapped to zero_seg. When Pin attaches to a
+ * running process (-pid), the images, the program break, and the
+ * mappings of the process are never reported via elf_load() or the
+ * mmap(2) hooks, and they get their tagmap segments here as well;
+ * inaccessible regions (reservations and guard pages) are mapped to
+ * zero_seg until they are made accessible (see post_mprotect_hook()),
+ * and Pin's own regions (pinbin, its runtime, and the tool) are left
+ * unmapped (anonymous regions of Pin cannot be told apart)
+ *
+ * @maps:	the snapshot (modified)
+ * @vdso:	the starting address of the vDSO (0 if unknown)
+ * @attach:	Pin attached to a running process (flag)
+ */
+static void
+maps_scan(char *maps, size_t vdso, size_t attach)
+{
+	/* current and next line */
+	char	*line, *next;
+	/* region (start-end perms offset dev inode path) */
+	size_t	start, end;
+	char	perms[5];
+	int	n;
+	/* STAB iterators */
+	size_t	i, j;
+	/* tagmap segment */
+	void	*tseg;
+	/* Pin's installation, and the image of the tool */
+	string	pinpref;
+	Dl_info	tool;
+
+	/* the program break; the first brk(2) maps it */
+	if (attach != 0) {
+		brk_start = brk_end = (size_t)syscall(__NR_brk, 0);
+		maps_pin(maps, &pinpref);
+		if (dladdr((void *)maps_scan, &tool) == 0 ||
+				tool.dli_fname == NULL)
+			tool.dli_fname = "";
+	}
+
+	/* traverse the regions */
+	for (line = maps; line != NULL && *line != '\0'; line = next) {
+		/* split the line */
+		if ((next = strchr(line, '\n')) != NULL)
+			*next++ = '\0';
+
+		/* parse the region; optimized branch */
+		n = 0;
+		if (unlikely(sscanf(line, "%zx-%zx %4s %*x %*s %*u %n",
+					&start, &end, perms, &n) < 3 || n == 0))
+			continue;
+
+		/* the vDSO and its data; clear tags */
+		if (start == vdso || strcmp(line + n, VDSO_STR) == 0 ||
+				strcmp(line + n, VVAR_STR) == 0) {
+			for (i = VIRT2STAB(start); i <= VIRT2STAB(end - 1); i++)
+				STAB[i] = (uint32_t)zero_seg - STAB2VIRT(i);
+			tagmap_acct(VIRT2STAB(start), VIRT2STAB(end - 1),
+					TAGMAP_REG_NONE);
+#ifdef DEBUG_MEMTRACK
+			/* verbose */
+			LOG(string(__func__) + ": mapping vDSO sections " +
+				hexstr(start) + "-" + hexstr(end - 1) + "\n");
+#endif
+			continue;
+		}
+
+		/*
+		 * Pin launched the process; the rest is set up by
+		 * elf_load() and the hooks. The stack and the kernel
+		 * space are already set up
+		 */
+		if (attach == 0 || start >= stack_start)
+			continue;
+		if (end > stack_start)
+			end = stack_start;
+
+		/* Pin and the tool; never accessed by the application */
+		if (line[n] == '/' && ((!pinpref.empty() &&
+			strncmp(line + n, pinpref.c_str(), pinpref.size()) == 0) ||
+				strcmp(line + n, tool.dli_fname) == 0))
+			continue;
+
+		/* inaccessible region; clear tags until it is accessible */
+		if (strcmp(perms, "---p") == 0) {
+			for (i = VIRT2STAB(start); i <= VIRT2STAB(end - 1); i++)
+				STAB[i] = (uint32_t)zero_seg - STAB2VIRT(i);
+			tagmap_acct(VIRT2STAB(start), VIRT2STAB(end - 1),
+					TAGMAP_REG_NONE);
+			continue;
+		}
+
+		/* the program break; see post_brk_hook() */
+		if (strcmp(line + n, HEAP_STR) == 0) {
+			brk_start	= start;
+			brk_end		= end - 1;
+		}
+#ifdef TAGMAP_COLLAPSE
+		/* read-only region; clear tags (collapse optimization) */
+		else if (perms[1] != 'w') {
+			for (i = VIRT2STAB(start); i <= VIRT2STAB(end - 1); i++)
+				STAB[i] = (uint32_t)zero_seg - STAB2VIRT(i);
+			tagmap_acct(VIRT2STAB(start), VIRT2STAB(end - 1),
+					TAGMAP_REG_NONE);
+			continue;
+		}
+#endif
+
+		/* allocate space for a new tagmap segment */
+		if (unlikely((tseg = tagmap_seg_alloc(end - start)) == NULL)) {
+			/* error message */
+			LOG(string(__func__) +
+				": tagmap segment allocation failed (" +
+				string(strerror(errno)) + ")\n");
+
+			/* die */
+			libdft_die();
+		}
+
+		/* STAB setup */
+		for (i = VIRT2STAB(start), j = 0; i <= VIRT2STAB(end - 1);
+				i++, j++)
+			STAB[i] = (uint32_t)tseg - STAB2VIRT(i) + (j * PAGE_SZ);
+		tagmap_acct(VIRT2STAB(start), VIRT2STAB(end - 1),
+			(strcmp(line + n, HEAP_STR) == 0) ?
+			TAGMAP_REG_BRK : TAGMAP_REG_MMAP);
+#ifdef DEBUG_MEMTRACK
+		/* verbose */
+		LOG(string(__func__) + ": mapping " + string(perms) + " " +
+			hexstr(start) + "-" + hexstr(end - 1) + " " +
+			string(line + n) + "\n");
+#endif
+	}
+
+	/* the images are already mapped; see elf_load() */
+	if (attach != 0)
+		dynldlnk_loaded = 1;
+}
+
+/*
+ * find the main stack
+ *
+ * the stack shadow spans from the top of the stack (i.e., [stack] in
+ * the /proc/self/maps snapshot, or the end of userland if it is not
+ * found) down to the maximum size of the stack (RLIMIT_STACK; at least
+ * STACK_SZ, and at most STACK_MAX_SZ for unlimited stacks), so that
+ * the stack never grows beyond its shadow
+ *
+ * @maps:	the snapshot (NULL if none)
+ *
+ * returns:	the lowest address that is shadowed (page aligned)
+ */
+static size_t
+stack_find(const char *maps)
+{
+	/* stack region (line, and top of the stack) */
+	const char	*line;
+	size_t		start, top = KERN_START;
+	/* stack size */
+	struct rlimit	rl;
+	size_t		sz = STACK_SZ;
+
+	/* the top of the stack; the line that ends with STACK_STR */
+	if (maps != NULL && (line = strstr(maps, STACK_STR "\n")) != NULL) {
+		while (line > maps && line[-1] != '\n')
+			line--;
+		if (sscanf(line, "%zx-%zx", &start, &top) != 2 ||
+				top > KERN_START)
+			top = KERN_START;
+	}
+
+	/* the maximum size of the stack */
+	if (likely(getrlimit(RLIMIT_STACK, &rl) == 0)) {
+		if (rl.rlim_cur == RLIM_INFINITY || rl.rlim_cur > STACK_MAX_SZ)
+			sz = STACK_MAX_SZ;
+		else if (rl.rlim_cur > STACK_SZ)
+			sz = PAGE_ALIGN((size_t)rl.rlim_cur + PAGE_SZ - 1);
+	}
+
+	/* done */
+	return PAGE_ALIGN(top) - sz;
+}
+
+/*
+ * initialize the STAB/tagmap
+ *
+ * allocate space for the STAB structure and the three ``hardcoded''
+ * tagmap segments: zero_seg (PAGE_SZ), null_seg (PAGE_SZ), and
+ * stack_seg (sized after RLIMIT_STACK; see stack_find()). stack_seg
+ * is only reserved (MAP_NORESERVE); its pages are committed as the
+ * stack grows into them
+ *
+ * returns:	0 on success, 1 on error 
+ */
+int
+tagmap_alloc(void)
+{
+	size_t	i, j;	/* iterators		*/
+			/* STAB size in bytes	*/
+	size_t 	len		= STAB_SIZE * sizeof(uint32_t);
+			/* /proc/self/maps snapshot */
+	char	*maps;
+	size_t	maps_len;
+			/* stack segment (and its size) */
+	void	*stack_seg	= NULL;
+	size_t	stack_sz;
+			/* arena header (exported tagmap) */
+	tagmap_shm_hdr_t *hdr;
+		
+	/*
+	 * snapshot the address space first, so that
+	 * it does not include the tagmap itself
+	 */
+	maps = proc_read("/proc/self/maps", &maps_len);
+
+	/* the stack shadow spans up to the end of userland */
+	stack_start	= stack_find(maps);
+	stack_sz	= KERN_START - stack_start;
+
+	/*
+	 * allocate space for STAB/zero_seg/null_seg/stack_seg by invoking
+	 * mmap(2); if HUGE_TLB is defined, then the mapping is done using
+	 * ``huge pages'' (STAB and stack_seg are carved out of the arena
+	 * if the tagmap is exported)
+	 */
+	if (unlikely(
+		/* STAB */
+		((STAB = (uint32_t *)seg_alloc(len, MAP_FLAGS)) == NULL)	||
+		/* stack_seg; zero_seg, null_seg; default segments */
+		((stack_seg = seg_alloc(stack_sz,
+				MAP_FLAGS | MAP_NORESERVE)) == NULL)	||
+		((zero_seg = mmap(NULL, PAGE_SZ,
+			/* R-- */
+			PROT_READ | ~PROT_WRITE | ~PROT_EXEC,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)) == MAP_FAILED)	||
+		((null_seg = mmap(NULL, PAGE_SZ,
+			/* --- */
+			PROT_NONE, 
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)) == MAP_FAILED)	||
+		/* region types (accounting); never exported */
+		((stab_reg = (uint8_t *)mmap(NULL, STAB_SIZE,
+			/* RW- */
+			PROT_READ | PROT_WRITE | ~PROT_EXEC,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+			-1, 0)) == MAP_FAILED)	||
+		/* taint summary; never exported */
+		((TSUM = (uint8_t *)mmap(NULL, TSUM_SIZE,
+			/* RW- */
+			PROT_READ | PROT_WRITE | ~PROT_EXEC,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+			-1, 0)) == MAP_FAILED))) {
+		/* error message */
+		LOG(string(__func__) +
+			": tagmap segment allocation failed (" +
+			string(strerror(errno)) + ")\n");
+	
+		/* failed */
+		goto err;
+	}
+	
+	/* setup the STAB */
+
+	/* 
+	 * the upper 1G of the address space is mapped to zero_seg;
+	 * this is how we handle vsyscall (i.e., reading from a
+	 * kernel address will result in always reading clear tags)
+	 */
+	for (i = VIRT2STAB(KERN_START); i <= VIRT2STAB(KERN_END); i++)
+		STAB[i] = (uint32_t)zero_seg - STAB2VIRT(i);
+
+	/* 
+	 * the lower 3G of the address space are considered unmapped, and
+	 * hence they translate to null_seg (i.e., reading/writing from an
+	 * unmapped address will fail)
+	 */
+	for (i = VIRT2STAB(USER_START); i <= VIRT2STAB(stack_start - 1); i++)
+		STAB[i] = (uint32_t)null_seg - STAB2VIRT(i);
+	
+	/* 
+	 * stack mapping
+	 */
+	for (i = VIRT2STAB(stack_start), j = 0;
+			i <= VIRT2STAB(USER_END); i++, j++)
+		STAB[i] = (uint32_t)stack_seg - STAB2VIRT(i) + (j * PAGE_SZ);
+
+	/*
+	 * shadow memory accounting; STAB, the region types,
+	 * the taint summary, and the stack
+	 */
+	acct_add(TAGMAP_REG_STAB, len + STAB_SIZE + TSUM_SIZE + 2 * PAGE_SZ);
+	tagmap_acct(VIRT2STAB(stack_start), VIRT2STAB(USER_END),
+			TAGMAP_REG_STACK);
+	
+	/* the regions that precede libdft */
+	if (likely(maps != NULL)) {
+		maps_scan(maps, get_vdso(), PIN_IsAttaching());
+		free(maps);
+	}
+	
+	/* exported tagmap; publish the layout */
+	if (arena_base != 0) {
+		hdr = (tagmap_shm_hdr_t *)arena_base;
+
+		hdr->stab	= (uint32_t)STAB - arena_base;
+		hdr->stab_sz	= STAB_SIZE;
+		hdr->zero_seg	= (uint32_t)zero_seg;
+		hdr->null_seg	= (uint32_t)null_seg;
+
+		/* the magic number goes last; readers check it first */
+		__sync_synchronize();
+		hdr->magic	= TAGMAP_SHM_MAGIC;
+	}
+
+	/* register the ELF image load callback */
+	IMG_AddInstrumentFunction(elf_load, NULL);
+	
+	/* return with success */
+	return 0;
+
+err:	/* error handling */
+	
+	/* cleanup */
+	if (STAB != NULL)
+		/* deallocate the STAB space */
+		(void)tagmap_seg_free(STAB, len);
+	if (zero_seg != NULL && zero_seg != MAP_FAILED)
+		/* deallocate the zero segment space */
+		(void)munmap(zero_seg, PAGE_SZ);
+	if (null_seg != NULL && null_seg != MAP_FAILED)
+		/* deallocate the null segment space */
+		(void)munmap(null_seg, PAGE_SZ);
+	if (stack_seg != NULL)
+		/* deallocate the stack segment space */
+		(void)tagmap_seg_free(stack_seg, stack_sz);
+	if (stab_reg != NULL && stab_reg != MAP_FAILED)
+		/* deallocate the region types */
+		(void)munmap(stab_reg, STAB_SIZE);
+	stab_reg = NULL;
+	if (TSUM != NULL && TSUM != MAP_FAILED)
+		/* deallocate the taint summary */
+		(void)munmap(TSUM, TSUM_SIZE);
+	TSUM = NULL;
+	/* the snapshot */
+	free(maps);
+
+	/* return with failure */
+	return 1;
+}
+
+/*
+ * export the tagmap
+ *
+ * back STAB and the tagmap segments with a shared memory object (i.e.,
+ * the arena), so that other processes can inspect the tag state of the
+ * instrumented process while it runs (see tagmap_reader.h). If the name
+ * starts with '/', a named object is created with shm_open(3); otherwise,
+ * an anonymous one is created with memfd_create(2) and it is reachable
+ * via /proc/<pid>/fd/<fd>. The arena is sparse; physical memory is only
+ * consumed for the parts of the tagmap that are touched
+ *
+ * NOTE: it must be called before libdft_init()
+ *
+ * @name:	the name of the shared memory object
+ * @size:	the size of the arena (bytes); 0 for half of the
+ * 		userland that is not in use
+ *
+ * returns:	0 on success, 1 on error
+ */
+int
+tagmap_export(const char *name, size_t size)
+{
+	/* arena address */
+	void	*arena;
+	/* arena header */
+	tagmap_shm_hdr_t *hdr;
+	/* /proc/self/maps snapshot (and the current line) */
+	char	*maps;
+	size_t	maps_len;
+	const char *line;
+	/* minimum arena size; mapped region, and userland in use */
+	size_t	min, start, end, used = 0;
+
+	/* already exported or invalid arguments */
+	if (unlikely(arena_base != 0 || STAB != NULL ||
+		name == NULL || *name == '\0' || strlen(name) >= NAME_MAX)) {
+		/* error message */
+		LOG(string(__func__) + ": invalid arguments\n");
+
+		/* failed */
+		return 1;
+	}
+
+	/*
+	 * the header, STAB, and the stack shadow are carved out of the
+	 * arena in tagmap_alloc(); the latter is sized after RLIMIT_STACK
+	 * (see stack_find()), hence it can be much larger than STACK_SZ
+	 */
+	maps	= proc_read("/proc/self/maps", &maps_len);
+	min	= TAGMAP_SHM_HDR_SZ +
+		PAGE_ALIGN(STAB_SIZE * sizeof(uint32_t) + PAGE_SZ - 1) +
+		(KERN_START - stack_find(maps));
+
+	/*
+	 * size the arena after the address space; the arena and the memory
+	 * that it shadows share the part of userland that is not in use yet,
+	 * hence half of it is the most that can ever be used
+	 */
+	if (size == 0) {
+		for (line = maps; line != NULL; line = strchr(line + 1, '\n'))
+			if (sscanf(line, "%zx-%zx", &start, &end) == 2 &&
+					start < KERN_START)
+				used += ((end < KERN_START) ?
+						end : KERN_START) - start;
+		size = (used < KERN_START) ? (KERN_START - used) / 2 : 0;
+		size = (size < min) ? min : PAGE_ALIGN(size);
+	}
+	free(maps);
+
+	/* the arena is too small; optimized branch */
+	if (unlikely(size < min)) {
+		/* error message */
+		LOG(string(__func__) + ": the arena must be at least " +
+				decstr(min) + " bytes\n");
+
+		/* failed */
+		return 1;
+	}
+
+	/* page align the size */
+	size = PAGE_ALIGN(size + PAGE_SZ - 1);
+
+	/* create the shared memory object */
+	if (name[0] == TAGMAP_SHM_PREFIX)
+		arena_fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL,
+				S_IRUSR | S_IWUSR);
+	else
+		arena_fd = syscall(__NR_memfd_create, name, 0);
+	
+	/* failed */
+	if (unlikely(arena_fd == -1)) {
+		/* error message */
+		LOG(string(__func__) + ": creating " + string(name) +
+				" failed (" + string(strerror(errno)) + ")\n");
+
+		/* failed */
+		return 1;
+	}
+
+	/* size it, and map it */
+	if (unlikely(ftruncate(arena_fd, size) == -1 ||
+		(arena = mmap(NULL, size,
+			/* RW- */
+			PROT_READ | PROT_WRITE | ~PROT_EXEC,
+			MAP_SHARED | MAP_NORESERVE, arena_fd, 0)) ==
+								MAP_FAILED)) {
+		/* error message */
+		LOG(string(__func__) + ": mapping " + string(name) +
+				" failed (" + string(strerror(errno)) + ")\n");
+
+		/* cleanup */
+		if (name[0] == TAGMAP_SHM_PREFIX)
+			(void)shm_unlink(name);
+		(void)close(arena_fd);
+		arena_fd = -1;
+
+		/* failed */
+		return 1;
+	}
+
+	/* the descriptor of a named object is not needed anymore */
+	if (name[0] == TAGMAP_SHM_PREFIX) {
+		(void)close(arena_fd);
+		arena_fd = -1;
+	}
+
+	/* initialize the arena */
+	arena_base	= (size_t)arena;
+	arena_size	= size;
+	arena_shared	= 1;
+	(void)strcpy(arena_name, name);
+	arena_free[TAGMAP_SHM_HDR_SZ] = size - TAGMAP_SHM_HDR_SZ;
+	
+	/* initialize the header; the rest is done in tagmap_alloc() */
+	hdr		= (tagmap_shm_hdr_t *)arena;
+	hdr->version	= TAGMAP_SHM_VERSION;
+	hdr->pid	= PIN_GetPid();
+	hdr->page_sz	= PAGE_SZ;
+	hdr->base	= (uint32_t)arena_base;
+	hdr->size	= (uint32_t)arena_size;
+
+	/* unlink the object at exit, and privatize it in child processes */
+	PIN_AddFiniFunction(arena_fini, NULL);
+	PIN_AddForkFunction(FPOINT_AFTER_IN_CHILD, arena_fork, NULL);
+
+	/* verbose */
+	if (name[0] == TAGMAP_SHM_PREFIX)
+		LOG(string(__func__) + ": tagmap exported at " +
+				string(name) + "\n");
+	else
+		LOG(string(__func__) + ": tagmap exported at /proc/" +
+				decstr(PIN_GetPid()) + "/fd/" +
+				decstr(arena_fd) + "\n");
+
+	/* return with success */
+	return 0;
+}
+
+/*
+ * mark the pages of a virtual address range in the taint summary
+ *
+ * @addr:	the virtual address
+ * @len:	the number of bytes (> 0)
+ */
+static inline void
+tsum_set(size_t addr, size_t len)
+{
+	/* iterator */
+	size_t i;
+
+	/* mark every page that the range touches */
+	for (i = VIRT2STAB(addr); i <= VIRT2STAB(addr + len - 1); i++)
+		TSUM[TSUM_SLOT(i, 0)] = 1;
+}
+
+/*
+ * unmark the pages of a clear virtual address range in the taint summary
+ *
+ * only the pages that lie wholly inside the range are unmarked, since
+ * the rest of a partially covered page may still be tainted; pages with
+ * shared shadows stay marked (see tagmap_acct())
+ *
+ * @addr:	the virtual address
+ * @len:	the number of bytes (> 0)
+ */
+static inline void
+tsum_clr(size_t addr, size_t len)
+{
+	/* iterators (pages that lie wholly inside the range) */
+	size_t i	= VIRT2STAB(addr) + (PAGE_OFFSET(addr) != 0);
+	size_t end	= VIRT2STAB(addr + len);
+
+	/* the range ends at the top of the address space */
+	if (unlikely(addr + len == 0))
+		end = STAB_SIZE;
+
+	/* unmark */
+	for (; i < end; i++)
+		if (likely(stab_reg[i] != TAGMAP_REG_SHM))
+			tsum_unmark(i);
+}
+
+/*
+ * check whether a virtual address range may be tainted
+ *
+ * @addr:	the virtual address
+ * @len:	the number of bytes (> 0)
+ *
+ * returns:	0 if all the pages of the range are clear, non-zero otherwise
+ */
+static inline size_t
+tsum_any(size_t addr, size_t len)
+{
+	/* iterator */
+	size_t i;
+
+	/* look for a marked page */
+	for (i = VIRT2STAB(addr); i <= VIRT2STAB(addr + len - 1); i++)
+		if (TSUM_PAGE(i) != 0)
+			return 1;
+
+	/* clear */
+	return 0;
+}
+
+/*
+ * get the length of the taint summary run that starts at a virtual address
+ *
+ * the run spans the consecutive pages that are all marked, or all
+ * unmarked, in the taint summary (see tagmap_run())
+ *
+ * @addr:	the virtual address
+ * @num:	the number of bytes that we are interested in
+ *
+ * returns:	the length of the run (at most num)
+ */
+static inline size_t
+tsum_run(size_t addr, size_t num)
+{
+	/* summary of the first page */
+	uint8_t sum	= TSUM_PAGE(VIRT2STAB(addr));
+	/* run length; bytes until the end of the first page */
+	size_t len	= PAGE_SZ - PAGE_OFFSET(addr);
+
+	/* extend the run while the summary is the same */
+	while (len < num && TSUM_PAGE(VIRT2STAB(addr + len)) == sum)
+		len += PAGE_SZ;
+
+	/* return the run length */
+	return (len < num) ? len : num;
+}
+
+/*
+ * tag a byte in the virtual address space
+ *
+ * @addr:	the virtual address
+ * @color:	the tag value
+ */
+void PIN_FAST_ANALYSIS_CALL
+tagmap_setb(size_t addr, uint8_t color)
+{
+	/* tag the byte that corresponds to the given address */
+	*(uint8_t *)(addr + STAB[VIRT2STAB(addr)]) = color;
+
+	/* taint summary */
+	TSUM_MARK(addr, sizeof(uint8_t), color);
+}
+
+/*
+ * untag a byte in the virtual address space
+ *
+ * @addr:	the virtual address
+ */
+void PIN_FAST_ANALYSIS_CALL
+tagmap_clrb(size_t addr)
+{
+	/* clear the byte that corresponds to the given address */
+	*(uint8_t *)(addr + STAB[VIRT2STAB(addr)]) = TAG_ZERO;
+}
+
+/*
+ * get the tag value of a byte from the tagmap
+ *
+ * @addr:	the virtual address
+ *
+ * returns:	the tag value (e.g., 0, 1,...)
+ */
+uint8_t
+tagmap_getb(size_t addr)
+{
+	/* get the byte that corresponds to the address */
+	return *(uint8_t *)(addr + STAB[VIRT2STAB(addr)]);
+}
+
+/*
+ * tag a word (i.e., 2 bytes) in the virtual address space
+ *
+ * @addr:	the virtual address
+ * @color:	the tag value
+ */
+void PIN_FAST_ANALYSIS_CALL
+tagmap_setw(size_t addr, uint16_t color)
+{
+	/* tag the bytes that correspond to the addresses of the word */
+	*(uint16_t *)(addr + STAB[VIRT2STAB(addr)]) = color;
+
+	/* taint summary */
+	TSUM_MARK(addr, sizeof(uint16_t), color);
+}
+
+/*
+ * untag a word (i.e., 2 bytes) in the virtual address space
+ *
+ * @addr:	the virtual address
+ */
+void PIN_FAST_ANALYSIS_CALL
+tagmap_clrw(size_t addr)
+{
+	/* clear the bytes that correspond to the addresses of the word */
+	*(uint16_t *)(addr + STAB[VIRT2STAB(addr)]) = TAG_ZERO;
+}
+
+/*
+ * get the tag value of a word (i.e., 2 bytes) from the tagmap
+ *
+ * @addr:	the virtual address
+ *
+ * returns:	the tag value (e.g., 0, 1,...)
+ */
+uint16_t
+tagmap_getw(size_t addr)
+{
+	/* get the bytes that correspond to the addresses of the word */
+	return *(uint16_t *)(addr + STAB[VIRT2STAB(addr)]);
+}
+
+/*
+ * tag a long word (i.e., 4 bytes) in the virtual address space
+ *
+ * @addr:	the virtual address
+ * @color:	the tag value
+ */
+void PIN_FAST_ANALYSIS_CALL
+tagmap_setl(size_t addr, uint32_t color)
+{
+	/* tag the bytes that correspond to the addresses of the long word */
+	*(uint32_t *)(addr + STAB[VIRT2STAB(addr)]) = color;
+
+	/* taint summary */
+	TSUM_MARK(addr, sizeof(uint32_t), color);
+}
+
+/*
+ * untag a long word (i.e., 4 bytes) in the virtual address space
+ *
+ * @addr:	the virtual address
+ */
+void PIN_FAST_ANALYSIS_CALL
+tagmap_clrl(size_t addr)
+{
+	/* clear the bytes that correspond to the addresses of the long word */
+	*(uint32_t *)(addr + STAB[VIRT2STAB(addr)]) = TAG_ZERO;
+}
+
+/*
+ * get the tag value of a long word (i.e., 4 bytes) from the tagmap
+ *
+ * @addr:	the virtual address
+ *
+ * returns:	the tag value (e.g., 0, 1,...)
+ */
+uint32_t PIN_FAST_ANALYSIS_CALL
+tagmap_getl(size_t addr)
+{
+	/* get the bytes that correspond to the addresses of the long word */
+	return *(uint32_t *)(addr + STAB[VIRT2STAB(addr)]);
+}
+
+/*
+ * get the length of the shadow run that starts at a virtual address
+ *
+ * consecutive pages that are backed by the same tagmap segment have
+ * equal STAB entries (i.e., the same offset), and therefore their
+ * shadow bytes are contiguous; we extend the run for as long as this
+ * holds and return its length, up to num bytes
+ *
+ * @addr:	the virtual address
+ * @num:	the number of bytes that we are interested in
+ *
+ * returns:	the length of the run (at most num)
+ */
+static inline size_t
+tagmap_run(size_t addr, size_t num)
+{
+	/* STAB offset of the first page */
+	uint32_t off	= STAB[VIRT2STAB(addr)];
+	/* run length; bytes until the end of the first page */
+	size_t len	= PAGE_SZ - PAGE_OFFSET(addr);
+
+	/* extend the run while the STAB offset is the same */
+	while (len < num && STAB[VIRT2STAB(addr + len)] == off)
+		len += PAGE_SZ;
+
+	/* return the run length */
+	return (len < num) ? len : num;
+}
+
+/*
+ * get the length of the shadow run that ends at a virtual address
+ *
+ * same as tagmap_run(), but the run is extended backwards
+ *
+ * @end:	the virtual address right after the last byte of the run
+ * @num:	the number of bytes that we are interested in
+ *
+ * returns:	the length of the run (at most num)
+ */
+static inline size_t
+tagmap_run_back(size_t end, size_t num)
+{
+	/* STAB offset of the last page */
+	uint32_t off	= STAB[VIRT2STAB(end - 1)];
+	/* run length; bytes since the beginning of the last page */
+	size_t len	= PAGE_OFFSET(end - 1) + 1;
+
+	/* extend the run while the STAB offset is the same */
+	while (len < num && STAB[VIRT2STAB(end - len - 1)] == off)
+		len += PAGE_SZ;
+
+	/* return the run length */
+	return (len < num) ? len : num;
+}
+
+/*
+ * tag an arbitrary number of bytes in the virtual address space
+ *
+ * the range may span multiple pages that are not backed
+ * by the same tagmap segment; hence, we tag it run by run
+ *
+ * @addr:	the virtual address
+ * @num:	the number of bytes to tag
+ * @color:	the tag value
+ */
+void
+tagmap_setn(size_t addr, size_t num, uint8_t color)
+{
+	/* run length */
+	size_t len;
+
+	/* taint summary */
+	if (likely(num > 0) && color != TAG_ZERO)
+		tsum_set(addr, num);
+
+	/* traverse the range run by run */
+	for (; num > 0; addr += len, num -= len) {
+		/* get the run */
+		len = tagmap_run(addr, num);
+
+		/* tag the bytes that correspond to the addresses of the run */
+		(void)memset((void *)(addr + STAB[VIRT2STAB(addr)]),
+				color, len);
+	}
+}
+
+/*
+ * rotate a tag pattern by a number of bytes
+ *
+ * @pat:	the tag pattern
+ * @n:		the number of bytes (0 - 3)
+ *
+ * returns:	the pattern that starts n bytes later
+ */
+static inline uint32_t
+tagmap_pat_rot(uint32_t pat, size_t n)
+{
+	/* no rotation; optimized branch */
+	if (likely(n == 0))
+		return pat;
+
+	return (pat >> (n << 3)) | (pat << (32 - (n << 3)));
+}
+
+/*
+ * fill a shadow range with a tag pattern
+ *
+ * the range is filled with aligned 16-byte (SSE2) or 4-byte
+ * stores; the unaligned head and the tail are done bytewise
+ *
+ * @taddr:	the shadow address
+ * @len:	the number of bytes
+ * @pat:	the tag pattern; its lowest byte goes to taddr
+ */
+static inline void
+tagmap_fill(uint8_t *taddr, size_t len, uint32_t pat)
+{
+#ifdef	__SSE2__
+	/* the tag pattern (vector) */
+	__m128i vpat;
+#endif
+
+	/* head; up to the first 16-byte aligned address */
+	for (; len > 0 && ((size_t)taddr & 0xF) != 0; taddr++, len--) {
+		*taddr	= (uint8_t)pat;
+		pat	= tagmap_pat_rot(pat, 1);
+	}
+
+#ifdef	__SSE2__
+	/* body; 16 bytes at a time */
+	for (vpat = _mm_set1_epi32(pat); len >= 16; taddr += 16, len -= 16)
+		_mm_store_si128((__m128i *)taddr, vpat);
+#else
+	/* body; 4 bytes at a time */
+	for (; len >= 4; taddr += 4, len -= 4)
+		*(uint32_t *)taddr = pat;
+#endif
+
+	/* tail */
+	for (; len > 0; taddr++, len--) {
+		*taddr	= (uint8_t)pat;
+		pat	= tagmap_pat_rot(pat, 1);
+	}
+}
+
+/*
+ * tag an arbitrary number of bytes in the virtual address space
+ * with a repeating tag pattern
+ *
+ * the pattern is the tag of a 1, 2, or 4-byte value, replicated
+ * to 4 bytes (e.g., the tag of AX for stosw), and the range is
+ * tagged run by run like in tagmap_setn(); patterns of a single
+ * tag value are left to tagmap_setn() and tagmap_clrn()
+ *
+ * @addr:	the virtual address
+ * @num:	the number of bytes to tag
+ * @pat:	the tag pattern; its lowest byte goes to addr
+ */
+void
+tagmap_filln(size_t addr, size_t num, uint32_t pat)
+{
+	/* run length */
+	size_t len;
+
+	/* single tag value; optimized branch */
+	if (likely(pat == (pat & TAG_ALL8) * 0x01010101U)) {
+		if (likely(pat == TAG_ZERO))
+			tagmap_clrn(addr, num);
+		else
+			tagmap_setn(addr, num, (uint8_t)pat);
+		return;
+	}
+
+	/* taint summary */
+	if (likely(num > 0))
+		tsum_set(addr, num);
+
+	/* traverse the range run by run */
+	for (; num > 0; addr += len, num -= len) {
+		/* get the run */
+		len = tagmap_run(addr, num);
+
+		/* tag the bytes that correspond to the addresses of the run */
+		tagmap_fill((uint8_t *)(addr + STAB[VIRT2STAB(addr)]), len, pat);
+
+		/* the pattern of the next run */
+		pat = tagmap_pat_rot(pat, len & 3);
+	}
+}
+
+/*
+ * untag an arbitrary number of bytes in the virtual address space
+ *
+ * the range may span multiple pages that are not backed by the same
+ * tagmap segment; hence, we clear it run by run. Runs that translate
+ * to zero_seg are clear by definition and they are skipped
+ *
+ * @addr:	the virtual address
+ * @num:	the number of bytes to untag
+ */
+void
+tagmap_clrn(size_t addr, size_t num)
+{
+	/* run length */
+	size_t len;
+
+	/* taint summary */
+	if (likely(num > 0))
+		tsum_clr(addr, num);
+
+	/* traverse the range run by run */
+	for (; num > 0; addr += len, num -= len) {
+		/* get the run */
+		len = tagmap_run(addr, num);
+
+		/* read-only shadow; nothing to do */
+		if (unlikely(PAGE_ALIGN(addr + STAB[VIRT2STAB(addr)]) ==
+					(size_t)zero_seg))
+			continue;
+
+		/* clear the bytes that correspond to the addresses of the run */
+		(void)memset((void *)(addr + STAB[VIRT2STAB(addr)]),
+				TAG_ZERO, len);
+	}
+}
+
+/*
+ * get the combined tag value of an arbitrary
+ * number of bytes in the virtual address space
+ *
+ * the pages that are not marked in the taint summary are clear,
+ * and they are skipped without touching their shadow
+ *
+ * @addr:	the virtual address
+ * @num:	the number of bytes
+ *
+ * returns:	the union (bitwise OR) of the tag values of the num bytes
+ */
+uint8_t
+tagmap_getn(size_t addr, size_t num)
+{
+	/* iterators */
+	size_t len, i;
+	/* shadow address */
+	uint8_t *taddr;
+	/* combined tag value; long word-sized for speed */
+	uint32_t tag = TAG_ZERO;
+
+	/* traverse the range run by run */
+	for (; num > 0; addr += len, num -= len) {
+		/* clear pages; nothing to do */
+		if (!TSUM_ISSET(addr)) {
+			len = tsum_run(addr, num);
+			continue;
+		}
+
+		/* get the run */
+		len	= tagmap_run(addr, tsum_run(addr, num));
+		taddr	= (uint8_t *)(addr + STAB[VIRT2STAB(addr)]);
+
+		/* long words first */
+		for (i = 0; i + sizeof(uint32_t) <= len; i += sizeof(uint32_t))
+			tag |= *(uint32_t *)(taddr + i);
+
+		/* remainder */
+		for (; i < len; i++)
+			tag |= taddr[i];
+	}
+
+	/* fold the long word into a byte */
+	tag |= (tag >> 16);
+	tag |= (tag >> 8);
+
+	/* return the combined tag */
+	return (uint8_t)tag;
 }
-#endif
 
 /*
- * initialize the STAB/tagmap
+ * check whether an arbitrary number of bytes
+ * in the virtual address space are tainted
  *
- * allocate space for the STAB structure and the three ``hardcoded''
- * tagmap segments: zero_seg (PAGE_SZ), null_seg (PAGE_SZ), and
- * stack_seg (STACK_SZ)
+ * same as tagmap_getn(), but the traversal stops at the first run
+ * of marked pages (see TSUM) that has a tagged byte
  *
- * returns:	0 on success, 1 on error 
+ * @addr:	the virtual address
+ * @num:	the number of bytes
+ *
+ * returns:	0 if clean, non-zero otherwise
  */
-int
-tagmap_alloc(void)
+size_t
+tagmap_issetn(size_t addr, size_t num)
 {
-	size_t	i, j;	/* iterators		*/
-			/* STAB size in bytes	*/
-	size_t 	len		= STAB_SIZE * sizeof(uint32_t);
-			/* vDSO handling */
-	size_t	vdso_start, vdso_end;
-			/* stack segment */
-	void	*stack_seg	= NULL;
-		
-	/*
-	 * allocate space for STAB/zero_seg/null_seg/stack_seg by invoking
-	 * mmap(2); if HUGE_TLB is defined, then the mapping is done using
-	 * ``huge pages''
-	 */
-	if (unlikely(
-		/* STAB */
-		((STAB = (uint32_t *)mmap(NULL, len,
-			/* RW- */
-			PROT_READ | PROT_WRITE | ~PROT_EXEC,
-			MAP_FLAGS, -1, 0)) == MAP_FAILED)		||
-		/* stack_seg; zero_seg, null_seg; default segments */
-		((stack_seg = mmap(NULL, STACK_SZ,
-			/* RW- */
-			PROT_READ | PROT_WRITE | ~PROT_EXEC,
-			MAP_FLAGS, -1, 0)) == MAP_FAILED)		||
-		((zero_seg = mmap(NULL, PAGE_SZ,
-			/* R-- */
-			PROT_READ | ~PROT_WRITE | ~PROT_EXEC,
-		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)) == MAP_FAILED)	||
-		((null_seg = mmap(NULL, PAGE_SZ,
-			/* --- */
-			PROT_NONE, 
-		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)) == MAP_FAILED))) {
-		/* error message */
-		LOG(string(__func__) +
-			": tagmap segment allocation failed (" +
-			string(strerror(errno)) + ")\n");
-	
-		/* failed */
-		goto err;
-	}
-	
-	/* setup the STAB */
+	/* run length */
+	size_t len;
 
-	/* 
-	 * the upper 1G of the address space is mapped to zero_seg;
-	 * this is how we handle vsyscall (i.e., reading from a
-	 * kernel address will result in always reading clear tags)
-	 */
-	for (i = VIRT2STAB(KERN_START); i <= VIRT2STAB(KERN_END); i++)
-		STAB[i] = (uint32_t)zero_seg - STAB2VIRT(i);
+	/* traverse the range run by run */
+	for (; num > 0; addr += len, num -= len) {
+		/* get the run of marked (or clear) pages */
+		len = tsum_run(addr, num);
 
-	/* 
-	 * the lower 3G of the address space are considered unmapped, and
-	 * hence they translate to null_seg (i.e., reading/writing from an
-	 * unmapped address will fail)
-	 */
-	for (i = VIRT2STAB(USER_START); i <= VIRT2STAB(STACK_SEG_ADDR - 1); i++)
-		STAB[i] = (uint32_t)null_seg - STAB2VIRT(i);
-	
-	/* 
-	 * stack mapping
-	 */
-	for (i = VIRT2STAB(STACK_SEG_ADDR), j = 0;
-			i <= VIRT2STAB(USER_END); i++, j++)
-		STAB[i] = (uint32_t)stack_seg - STAB2VIRT(i) + (j * PAGE_SZ);
-	
-	/* try to get the vDSO address */
-	get_vdso(&vdso_start, &vdso_end);
-		
-	/* check if we have the vDSO mapped */
-	if (likely(vdso_start != 0)) {
-		/* STAB setup */	
-		for (i = VIRT2STAB(vdso_start);
-				i <= VIRT2STAB(vdso_end - 1); i++)
-			STAB[i] = (uint32_t)zero_seg - STAB2VIRT(i);
-#ifdef DEBUG_MEMTRACK
-		/* verbose */
-		LOG(string(__func__) + ": mapping vDSO sections " +
-			hexstr(vdso_start) + "-" + 
-			hexstr(vdso_end - 1) + " [" +
-			hexstr(STAB[VIRT2STAB(vdso_start)] +
-			       vdso_start) + "-" +
-			hexstr(STAB[VIRT2STAB(vdso_end - 1)] + 
-					vdso_end - 1) + "]\n");
-#endif
+		/* tainted run; done */
+		if (TSUM_ISSET(addr) && tagmap_getn(addr, len) != TAG_ZERO)
+			return 1;
 	}
-	
-	/* register the ELF image load callback */
-	IMG_AddInstrumentFunction(elf_load, NULL);
-	
-	/* return with success */
+
+	/* clean */
 	return 0;
+}
 
-err:	/* error handling */
-	
-	/* cleanup */
-	if (STAB != NULL)
-		/* deallocate the STAB space */
-		(void)munmap(STAB, len);
-	if (zero_seg != NULL)
-		/* deallocate the zero segment space */
-		(void)munmap(zero_seg, PAGE_SZ);
-	if (null_seg != NULL)
-		/* deallocate the null segment space */
-		(void)munmap(null_seg, PAGE_SZ);
-	if (stack_seg != NULL)
-		/* deallocate the stack segment space */
-		(void)munmap(stack_seg, STACK_SZ);
+/*
+ * copy a shadow chunk
+ *
+ * large, non-overlapping chunks are copied with non-temporal
+ * (SSE2) stores, so that they do not evict the working set of
+ * the application from the cache; the rest use memmove(3)
+ *
+ * @tdst:	the destination shadow address
+ * @tsrc:	the source shadow address
+ * @len:	the number of bytes
+ */
+static inline void
+tagmap_copy(uint8_t *tdst, const uint8_t *tsrc, size_t len)
+{
+#ifdef	__SSE2__
+	/* large and non-overlapping; bypass the cache */
+	if (len >= TAGMAP_NT_SZ && (tdst + len <= tsrc || tsrc + len <= tdst)) {
+		/* head; up to the first 16-byte aligned address */
+		for (; ((size_t)tdst & 0xF) != 0; len--)
+			*tdst++ = *tsrc++;
 
-	/* return with failure */
-	return 1;
+		/* body; 16 bytes at a time */
+		for (; len >= 16; tdst += 16, tsrc += 16, len -= 16)
+			_mm_stream_si128((__m128i *)tdst,
+				_mm_loadu_si128((const __m128i *)tsrc));
+
+		/* order the non-temporal stores */
+		_mm_sfence();
+
+		/* tail */
+		for (; len > 0; len--)
+			*tdst++ = *tsrc++;
+
+		/* done */
+		return;
+	}
+#endif
+	/* copy the chunk */
+	(void)memmove(tdst, tsrc, len);
 }
 
 /*
- * tag a byte in the virtual address space
+ * carry the taint summary of a chunk over to its destination
  *
- * @addr:	the virtual address
- * @color:	the tag value
+ * the destination pages are marked if any source page is; otherwise
+ * the chunk is clear, and the destination pages that it covers wholly
+ * are unmarked
+ *
+ * @dst:	the destination virtual address
+ * @src:	the source virtual address
+ * @len:	the number of bytes (> 0)
  */
-void PIN_FAST_ANALYSIS_CALL
-tagmap_setb(size_t addr, uint8_t color)
+static inline void
+tsum_cpy(size_t dst, size_t src, size_t len)
 {
-	/* tag the byte that corresponds to the given address */
-	*(uint8_t *)(addr + STAB[VIRT2STAB(addr)]) = color;
+	if (tsum_any(src, len))
+		tsum_set(dst, len);
+	else
+		tsum_clr(dst, len);
 }
 
 /*
- * untag a byte in the virtual address space
+ * copy the tags of an arbitrary number of bytes in
+ * the virtual address space; t[dst] = t[src]
  *
- * @addr:	the virtual address
+ * the source and destination ranges may overlap (memmove(3) semantics)
+ * and they may span pages that are backed by different tagmap segments;
+ * the copy is performed in chunks that do not cross a run boundary in
+ * either range, and the direction is chosen based on the overlap
+ *
+ * @dst:	the destination virtual address
+ * @src:	the source virtual address
+ * @num:	the number of bytes
  */
-void PIN_FAST_ANALYSIS_CALL
-tagmap_clrb(size_t addr)
+void
+tagmap_cpyn(size_t dst, size_t src, size_t num)
 {
-	/* clear the byte that corresponds to the given address */
-	*(uint8_t *)(addr + STAB[VIRT2STAB(addr)]) = TAG_ZERO;
+	/* chunk length */
+	size_t len;
+
+	/* nothing to do; optimized branch */
+	if (unlikely(dst == src))
+		return;
+
+	/* forward copy (no overlap, or the destination is below the source) */
+	if (dst < src || dst >= src + num) {
+		for (; num > 0; dst += len, src += len, num -= len) {
+			/* get the chunk */
+			len = tagmap_run(dst, tagmap_run(src, num));
+
+			/* taint summary */
+			tsum_cpy(dst, src, len);
+
+			/* copy the tags of the chunk */
+			tagmap_copy((uint8_t *)(dst + STAB[VIRT2STAB(dst)]),
+				(uint8_t *)(src + STAB[VIRT2STAB(src)]), len);
+		}
+	}
+	/* backward copy (the destination overlaps the tail of the source) */
+	else {
+		for (dst += num, src += num; num > 0; num -= len) {
+			/* get the chunk */
+			len = tagmap_run_back(dst, tagmap_run_back(src, num));
+			dst -= len;
+			src -= len;
+
+			/* taint summary */
+			tsum_cpy(dst, src, len);
+
+			/* copy the tags of the chunk */
+			tagmap_copy((uint8_t *)(dst + STAB[VIRT2STAB(dst)]),
+				(uint8_t *)(src + STAB[VIRT2STAB(src)]), len);
+		}
+	}
 }
 
 /*
- * get the tag value of a byte from the tagmap
+ * copy the tags of a string move (i.e., rep movs); t[dst] = t[src]
  *
- * @addr:	the virtual address
+ * unlike tagmap_cpyn(), the copy goes in the direction of the string
+ * operation; a forward (EFLAGS.DF = 0) move onto the tail of its source,
+ * or a backward (EFLAGS.DF = 1) move onto the head of its source, reads
+ * what it has already written, hence it replicates the part of the
+ * source that lies outside the destination. We build the replicas with
+ * non-overlapping copies that double in size; the other moves behave
+ * like memmove(3). Elements that overlap their own source (i.e., the
+ * distance of the ranges is less than the element size) are treated as
+ * byte moves
  *
- * returns:	the tag value (e.g., 0, 1,...)
+ * @dst:	the lowest destination virtual address
+ * @src:	the lowest source virtual address
+ * @num:	the number of bytes
+ * @back:	flag; backward move (EFLAGS.DF = 1)
  */
-uint8_t
-tagmap_getb(size_t addr)
+void
+tagmap_movn(size_t dst, size_t src, size_t num, size_t back)
 {
-	/* get the byte that corresponds to the address */
-	return *(uint8_t *)(addr + STAB[VIRT2STAB(addr)]);
+	/* distance of the ranges, replicated bytes, and copy length */
+	size_t dist, done, len;
+
+	/* forward move onto the tail of the source */
+	if (back == 0 && src < dst && dst < src + num) {
+		/* replicate the head of the source upwards */
+		for (dist = dst - src, done = 0; done < num; done += len) {
+			len = (num - done < dist + done) ? num - done :
+				dist + done;
+			tagmap_cpyn(dst + done, src, len);
+		}
+	}
+	/* backward move onto the head of the source */
+	else if (back != 0 && dst < src && src < dst + num) {
+		/* replicate the tail of the source downwards */
+		for (dist = src - dst, done = 0; done < num; done += len) {
+			len = (num - done < dist + done) ? num - done :
+				dist + done;
+			tagmap_cpyn(dst + num - done - len,
+					src + num - len, len);
+		}
+	}
+	/* memmove(3) semantics */
+	else
+		tagmap_cpyn(dst, src, num);
 }
 
 /*
- * tag a word (i.e., 2 bytes) in the virtual address space
+ * tag the bytes of a vectored I/O operation
  *
- * @addr:	the virtual address
+ * the first num bytes that are scattered across an array of
+ * iovec structures are tagged in a single pass; each iovec is
+ * traversed run by run, as in tagmap_setn()
+ *
+ * @iov:	the iovec array
+ * @iovcnt:	the number of iovec structures
+ * @num:	the number of bytes to tag
  * @color:	the tag value
  */
-void PIN_FAST_ANALYSIS_CALL
-tagmap_setw(size_t addr, uint16_t color)
+void
+tagmap_setv(const struct iovec *iov, size_t iovcnt, size_t num, uint8_t color)
 {
-	/* tag the bytes that correspond to the addresses of the word */
-	*(uint16_t *)(addr + STAB[VIRT2STAB(addr)]) = color;
+	/* iovec address, bytes left in the iovec, and run length */
+	size_t addr, rem, len;
+
+	/* traverse the iovec array until num bytes are tagged */
+	for (; iovcnt > 0 && num > 0; iov++, iovcnt--) {
+		/* get the iovec */
+		addr	= (size_t)iov->iov_base;
+		rem	= ((size_t)iov->iov_len < num) ?
+				(size_t)iov->iov_len : num;
+		num	-= rem;
+
+		/* taint summary */
+		if (likely(rem > 0) && color != TAG_ZERO)
+			tsum_set(addr, rem);
+
+		/* traverse the iovec run by run */
+		for (; rem > 0; addr += len, rem -= len) {
+			/* get the run */
+			len = tagmap_run(addr, rem);
+
+			/* tag the bytes of the run */
+			(void)memset((void *)(addr + STAB[VIRT2STAB(addr)]),
+					color, len);
+		}
+	}
 }
 
 /*
- * untag a word (i.e., 2 bytes) in the virtual address space
+ * untag the bytes of a vectored I/O operation
  *
- * @addr:	the virtual address
+ * same as tagmap_setv(), but runs that translate
+ * to zero_seg are skipped (see tagmap_clrn())
+ *
+ * @iov:	the iovec array
+ * @iovcnt:	the number of iovec structures
+ * @num:	the number of bytes to untag
  */
-void PIN_FAST_ANALYSIS_CALL
-tagmap_clrw(size_t addr)
+void
+tagmap_clrv(const struct iovec *iov, size_t iovcnt, size_t num)
 {
-	/* clear the bytes that correspond to the addresses of the word */
-	*(uint16_t *)(addr + STAB[VIRT2STAB(addr)]) = TAG_ZERO;
+	/* iovec address, bytes left in the iovec, and run length */
+	size_t addr, rem, len;
+
+	/* traverse the iovec array until num bytes are cleared */
+	for (; iovcnt > 0 && num > 0; iov++, iovcnt--) {
+		/* get the iovec */
+		addr	= (size_t)iov->iov_base;
+		rem	= ((size_t)iov->iov_len < num) ?
+				(size_t)iov->iov_len : num;
+		num	-= rem;
+
+		/* taint summary */
+		if (likely(rem > 0))
+			tsum_clr(addr, rem);
+
+		/* traverse the iovec run by run */
+		for (; rem > 0; addr += len, rem -= len) {
+			/* get the run */
+			len = tagmap_run(addr, rem);
+
+			/* read-only shadow; nothing to do */
+			if (unlikely(PAGE_ALIGN(addr + STAB[VIRT2STAB(addr)]) ==
+						(size_t)zero_seg))
+				continue;
+
+			/* clear the bytes of the run */
+			(void)memset((void *)(addr + STAB[VIRT2STAB(addr)]),
+					TAG_ZERO, len);
+		}
+	}
 }
 
 /*
- * get the tag value of a word (i.e., 2 bytes) from the tagmap
+ * get the combined tag value of the bytes of a vectored I/O operation
  *
- * @addr:	the virtual address
+ * @iov:	the iovec array
+ * @iovcnt:	the number of iovec structures
+ * @num:	the number of bytes
  *
- * returns:	the tag value (e.g., 0, 1,...)
+ * returns:	the union (bitwise OR) of the tag values of the num bytes
  */
-uint16_t
-tagmap_getw(size_t addr)
+uint8_t
+tagmap_getv(const struct iovec *iov, size_t iovcnt, size_t num)
 {
-	/* get the bytes that correspond to the addresses of the word */
-	return *(uint16_t *)(addr + STAB[VIRT2STAB(addr)]);
+	/* bytes in the iovec */
+	size_t len;
+	/* combined tag value */
+	uint8_t tag = TAG_ZERO;
+
+	/* traverse the iovec array */
+	for (; iovcnt > 0 && num > 0; iov++, iovcnt--, num -= len) {
+		/* get the iovec */
+		len = ((size_t)iov->iov_len < num) ?
+			(size_t)iov->iov_len : num;
+
+		/* combine */
+		tag |= tagmap_getn((size_t)iov->iov_base, len);
+	}
+
+	/* return the combined tag */
+	return tag;
 }
 
 /*
- * tag a long word (i.e., 4 bytes) in the virtual address space
+ * write the tags of an arbitrary number of bytes
+ * in the virtual address space into a file
  *
+ * the tags are written run by run, straight from the tagmap
+ *
+ * @fd:		the file descriptor
  * @addr:	the virtual address
- * @color:	the tag value
+ * @num:	the number of bytes
+ * @off:	the file offset
+ *
+ * returns:	0 on success, 1 on error
  */
-void PIN_FAST_ANALYSIS_CALL
-tagmap_setl(size_t addr, uint32_t color)
+int
+tagmap_pwrite(int fd, size_t addr, size_t num, off64_t off)
 {
-	/* tag the bytes that correspond to the addresses of the long word */
-	*(uint32_t *)(addr + STAB[VIRT2STAB(addr)]) = color;
+	/* run length and bytes written */
+	size_t len;
+	ssize_t n;
+
+	/* traverse the range run by run */
+	for (; num > 0; addr += len, off += len, num -= len) {
+		/* get the run */
+		len = tagmap_run(addr, num);
+
+		/* write the tags of the run; short writes are retried */
+		if (unlikely((n = pwrite64(fd,
+				(void *)(addr + STAB[VIRT2STAB(addr)]),
+				len, off)) <= 0))
+			/* failed */
+			return 1;
+		len = (size_t)n;
+	}
+
+	/* success */
+	return 0;
 }
 
 /*
- * untag a long word (i.e., 4 bytes) in the virtual address space
+ * read the tags of an arbitrary number of bytes
+ * in the virtual address space from a file
  *
+ * the tags are read run by run, straight into the tagmap; runs that
+ * translate to zero_seg are skipped, and bytes beyond the end of the
+ * file are cleared
+ *
+ * @fd:		the file descriptor
  * @addr:	the virtual address
+ * @num:	the number of bytes
+ * @off:	the file offset
+ *
+ * returns:	0 on success, 1 on error
  */
-void PIN_FAST_ANALYSIS_CALL
-tagmap_clrl(size_t addr)
+int
+tagmap_pread(int fd, size_t addr, size_t num, off64_t off)
 {
-	/* clear the bytes that correspond to the addresses of the long word */
-	*(uint32_t *)(addr + STAB[VIRT2STAB(addr)]) = TAG_ZERO;
+	/* run length and bytes read */
+	size_t len;
+	ssize_t n;
+
+	/* taint summary; the tags that are read are not inspected */
+	if (likely(num > 0))
+		tsum_set(addr, num);
+
+	/* traverse the range run by run */
+	for (; num > 0; addr += len, off += len, num -= len) {
+		/* get the run */
+		len = tagmap_run(addr, num);
+
+		/* read-only shadow; nothing to do */
+		if (unlikely(PAGE_ALIGN(addr + STAB[VIRT2STAB(addr)]) ==
+					(size_t)zero_seg))
+			continue;
+
+		/* read the tags of the run; short reads are retried */
+		if (unlikely((n = pread64(fd,
+				(void *)(addr + STAB[VIRT2STAB(addr)]),
+				len, off)) < 0))
+			/* failed */
+			return 1;
+
+		/* end of file; the rest is clear */
+		if (n == 0) {
+			tagmap_clrn(addr, num);
+			break;
+		}
+		len = (size_t)n;
+	}
+
+	/* success */
+	return 0;
 }
 
 /*
- * get the tag value of a long word (i.e., 4 bytes) from the tagmap
- *
- * @addr:	the virtual address
+ * untag the whole virtual address space
  *
- * returns:	the tag value (e.g., 0, 1,...)
+ * we traverse the STAB run by run and clear every tagmap segment that is
+ * not hardcoded (i.e., zero_seg and null_seg); the page-aligned parts of
+ * a segment are released (seg_release()), so that the clear tagmap does
+ * not consume physical memory, and the rest is cleared with memset(3).
+ * The taint summary is cleared as well, except for the shared shadows
  */
-uint32_t PIN_FAST_ANALYSIS_CALL
-tagmap_getl(size_t addr)
+void
+tagmap_clrall(void)
 {
-	/* get the bytes that correspond to the addresses of the long word */
-	return *(uint32_t *)(addr + STAB[VIRT2STAB(addr)]);
+	/* iterators */
+	size_t i, j;
+	/* shadow run (start/end) */
+	size_t tstart, tend;
+	/* page-aligned part of the shadow run (start/end) */
+	size_t astart, aend;
+
+	/* taint summary; shared shadows stay marked */
+	for (i = 0; i < STAB_SIZE; i++) {
+		TSUM[TSUM_SLOT(i, 2)] = 0;
+		if (likely(stab_reg[i] != TAGMAP_REG_SHM))
+			TSUM[TSUM_SLOT(i, 0)] = 0;
+	}
+
+	/* traverse the STAB */
+	for (i = VIRT2STAB(USER_START); i <= VIRT2STAB(USER_END); i = j) {
+		/* get the run */
+		for (j = i + 1; j <= VIRT2STAB(USER_END) && STAB[j] == STAB[i];
+				j++);
+
+		/* shadow run */
+		tstart	= STAB2VIRT(i) + STAB[i];
+		tend	= STAB2VIRT(j) + STAB[i];
+
+		/* hardcoded segments; nothing to do */
+		if (tstart == (size_t)zero_seg || tstart == (size_t)null_seg)
+			continue;
+
+		/* page-aligned part of the shadow run */
+		astart	= PAGE_ALIGN(tstart + PAGE_SZ - 1);
+		aend	= PAGE_ALIGN(tend);
+
+		/* release the page-aligned part; optimized branch */
+		if (likely(astart < aend) && likely(seg_release((void *)astart,
+					aend - astart) == 0)) {
+			/* clear the unaligned head and tail */
+			(void)memset((void *)tstart, TAG_ZERO, astart - tstart);
+			(void)memset((void *)aend, TAG_ZERO, tend - aend);
+		}
+		else
+			/* clear the whole run */
+			(void)memset((void *)tstart, TAG_ZERO, tend - tstart);
+	}
 }
 
-/* tag an arbitrary number of bytes in the virtual address space
+/*
+ * check whether any byte of the virtual address space is tainted
  *
- * @addr:	the virtual address
- * @num:	the number of bytes to tag
- * @color:	the tag value
+ * we traverse the pages that are mapped (i.e., have a region type) and
+ * marked in the taint summary, and look for a tagged byte in their
+ * shadow; the rest are clear by definition
+ *
+ * returns:	0 if clean, non-zero otherwise
  */
-void
-tagmap_setn(size_t addr, size_t num, uint8_t color)
+size_t
+tagmap_issetall(void)
 {
-	/* tag the bytes that correspond to the addresses of the num bytes */
-	(void)memset((void *)(addr + STAB[VIRT2STAB(addr)]), color, num);
+	/* iterator */
+	size_t i;
+
+	/* not initialized; optimized branch */
+	if (unlikely(stab_reg == NULL))
+		return 0;
+
+	/* traverse the STAB */
+	for (i = 0; i < STAB_SIZE; i++)
+		if (stab_reg[i] != TAGMAP_REG_NONE && TSUM_PAGE(i) != 0 &&
+				tagmap_getn(STAB2VIRT(i), PAGE_SZ) != TAG_ZERO)
+			return 1;
+
+	/* clean */
+	return 0;
 }
 
 /*
- * untag an arbitrary number of bytes in the virtual address space
+ * move the taint summary of a remapped virtual address range
+ * (e.g., after mremap(2) has moved its tagmap segment)
  *
- * @addr:	the virtual address
- * @num:	the number of bytes to untag
+ * the summary of the source pages is left intact, which is
+ * conservative (i.e., it may only mark clear pages)
+ *
+ * @dst:	the new virtual address (page-aligned)
+ * @src:	the old virtual address (page-aligned)
+ * @num:	the number of bytes
  */
 void
-tagmap_clrn(size_t addr, size_t num)
+tagmap_tsum_move(size_t dst, size_t src, size_t num)
 {
-	/* clear the bytes that correspond to the addresses of the num bytes */
-	(void)memset((void *)(addr + STAB[VIRT2STAB(addr)]), TAG_ZERO, num);
+	/* nothing to do; optimized branch */
+	if (unlikely(dst == src || num == 0))
+		return;
+
+	/*
+	 * fold the cross-page marks at the edges of the source range, so
+	 * that the pages around it stay marked, and the marks of its first
+	 * page are moved as well
+	 */
+	tsum_fold((VIRT2STAB(src) - 1) & (STAB_SIZE - 1));
+	tsum_fold(VIRT2STAB(src + num - 1));
+
+	/* move the summary of the pages */
+	(void)memmove(&TSUM[TSUM_SLOT(VIRT2STAB(dst), 0)],
+			&TSUM[TSUM_SLOT(VIRT2STAB(src), 0)],
+			TSUM_SLOT(VIRT2STAB(num + PAGE_SZ - 1), 0));
 }
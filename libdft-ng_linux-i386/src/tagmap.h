@@ -33,26 +33,51 @@
 #ifndef __TAGMAP_H__
 #define __TAGMAP_H__
 
+#include <sys/types.h>
+#include <sys/uio.h>
+
 #include "pin.H"
+#include "tagmap_shm.h"
 
 #define PAGE_SHIFT	12		/* page alignment offset (bits) */
 #define PAGE_SZ		(1U << PAGE_SHIFT)	/* page size;
 					   4 KB in x86 (i386) Linux	*/
-#define STACK_SZ	(PAGE_SZ << 11)		/* stack size;
+#define STACK_SZ	(PAGE_SZ << 11)		/* minimum stack size;
 					   8 MB in x86 (i386) Linux	*/
+#define STACK_MAX_SZ	(PAGE_SZ << 16)		/* maximum stack size;
+					   256 MB (unlimited stacks)	*/
 #define STAB_SIZE	(1U << 20)	/* 1 M items; 4GB / PAGE_SZ	*/
+#define TSUM_SIZE	(STAB_SIZE << 2)	/* taint summary; 4 bytes
+					   per STAB entry		*/
 #define USER_START	0x00000000U	/* userland starting address	*/
 #define USER_END	0xBFFFFFFFU	/* userland ending address	*/
 #define KERN_START	0xC0000000U	/* kernel starting address	*/
 #define KERN_END	0xFFFFFFFFU	/* kernel ending address	*/
-#define STACK_SEG_ADDR	(KERN_START - STACK_SZ)	/* 0xBF800000		*/
 
-/* maximum size on an entry in /proc/<pid>/maps */
-#define MAPS_ENTRY_MAX	128
-/* vDSO string in /proc/<pid>/maps */
+/* tag copies of this size (or larger) bypass the cache	*/
+#define TAGMAP_NT_SZ	(PAGE_SZ << 8)	/* 1 MB				*/
+
+/* shadow pages per mincore(2) call (usage scan)		*/
+#define TAGMAP_SCAN_PAGES	64
+/* wakeup interval of the periodic usage dump (ms)		*/
+#define TAGMAP_DUMP_MS		1000
+
+/* initial size of the /proc/self/maps snapshot buffer */
+#define MAPS_BUF_SZ	(PAGE_SZ << 2)
+/* vDSO, vDSO data, program break, and stack strings in /proc/<pid>/maps */
 #define VDSO_STR	"[vdso]"
+#define VVAR_STR	"[vvar]"
+#define HEAP_STR	"[heap]"
+#define STACK_STR	"[stack]"
+/* the binary of Pin; its directory is next to Pin's runtime libraries */
+#define PINBIN_STR	"pinbin"
 /* dynamic linker/loader					*/
 #define	DYNLDLNK	"/lib/ld-linux.so.2"
+/* size of the shared shadow objects (sparse)			*/
+#define TAGMAP_SHARE_SZ	(1ULL << 32)
+/* header of the shared shadow objects; the pids that map them	*/
+#define TAGMAP_SHARE_HDR	PAGE_SZ
+#define TAGMAP_SHARE_PIDS	(TAGMAP_SHARE_HDR / sizeof(pid_t))
 
 /* get the offset on stlb given a virtual address		*/
 #define VIRT2STAB(vaddr)	((vaddr) >> PAGE_SHIFT)
@@ -60,6 +85,64 @@
 #define STAB2VIRT(indx)		((indx) << PAGE_SHIFT)
 /* page align a virtual address					*/
 #define PAGE_ALIGN(vaddr)	((vaddr) & 0xFFFFF000)
+/* get the offset of a virtual address inside its page		*/
+#define PAGE_OFFSET(vaddr)	((vaddr) & (PAGE_SZ - 1))
+
+/*
+ * taint summary (see TSUM in tagmap.c)
+ *
+ * every page has four slots; slot 0 is set when the page may be tainted,
+ * slot 2 when the page and the next one may be tainted (i.e., a tainted
+ * store crossed the page boundary), and slots 1 and 3 absorb the stores
+ * of clear tags. Hence, TSUM_MARK() is a single byte store without
+ * branches (i.e., it does not keep Pin from inlining the analysis
+ * routines), and it never writes 0 (i.e., racing stores on the same page
+ * cannot lose a mark)
+ */
+extern uint8_t	*TSUM;
+
+/* get the slot of a page (sel: 0, 1, 2, or 3; see above)		*/
+#define TSUM_SLOT(indx, sel)	(((indx) << 2) | (sel))
+/* check if a page may be tainted (the first page wraps to the last)	*/
+#define TSUM_PAGE(indx)							\
+	(TSUM[TSUM_SLOT(indx, 0)] | TSUM[TSUM_SLOT(indx, 2)] |		\
+	TSUM[TSUM_SLOT(((indx) - 1) & (STAB_SIZE - 1), 2)])
+/* check if the page of a virtual address may be tainted		*/
+#define TSUM_ISSET(vaddr)	(TSUM_PAGE(VIRT2STAB(vaddr)) != 0)
+/*
+ * mark the page(s) of a tag store of len (<= PAGE_SZ) bytes at vaddr;
+ * one slot per store, since at most two pages are touched
+ */
+#define TSUM_MARK(vaddr, len, tag)					\
+	(TSUM[TSUM_SLOT(VIRT2STAB(vaddr), ((tag) == 0) |		\
+		(((PAGE_OFFSET(vaddr) + (len) - 1) >> PAGE_SHIFT) << 1))] = 1)
+
+/*
+ * shadow region types (accounting); every STAB entry is charged to the
+ * type of the region it shadows (see tagmap_acct()), and zero_seg or
+ * null_seg are charged to none
+ */
+enum {
+/* #define */ TAGMAP_REG_NONE	= 0,	/* zero_seg, null_seg		*/
+/* #define */ TAGMAP_REG_STAB	= 1,	/* STAB and the hardcoded segs	*/
+/* #define */ TAGMAP_REG_STACK	= 2,	/* main stack			*/
+/* #define */ TAGMAP_REG_IMG	= 3,	/* ELF images (elf_load())	*/
+/* #define */ TAGMAP_REG_BRK	= 4,	/* program break		*/
+/* #define */ TAGMAP_REG_MMAP	= 5,	/* private mappings		*/
+/* #define */ TAGMAP_REG_SHM	= 6,	/* shared shadows		*/
+/* #define */ TAGMAP_REG_NUM	= 7
+};
+
+/* shadow memory usage (bytes) per region type; see tagmap_usage() */
+typedef struct {
+	size_t	cur[TAGMAP_REG_NUM];		/* reserved		*/
+	size_t	peak[TAGMAP_REG_NUM];		/* ...peak		*/
+	size_t	rss[TAGMAP_REG_NUM];		/* resident (scan)	*/
+	size_t	tainted[TAGMAP_REG_NUM];	/* tainted bytes (scan)	*/
+	size_t	total;				/* reserved; all types	*/
+	size_t	total_peak;			/* ...peak		*/
+	size_t	reclaimed;			/* released clear pages	*/
+} tagmap_usage_t;
 
 /* tag values */
 #define	TAG_ZERO	0x0U		/* clean		*/
@@ -68,6 +151,21 @@
 
 /* tagmap API */
 int					tagmap_alloc(void);
+int					tagmap_export(const char *, size_t);
+void					*tagmap_seg_alloc(size_t);
+void					*tagmap_seg_reserve(size_t);
+int					tagmap_seg_free(void *, size_t);
+void					*tagmap_seg_realloc(void *, size_t, size_t);
+int					tagmap_share(const char *);
+void					*tagmap_seg_share(int, const char *, off64_t,
+						size_t, size_t *);
+void					tagmap_seg_unshare(const char *);
+void					tagmap_acct(size_t, size_t, uint8_t);
+uint8_t					tagmap_reg(size_t);
+void					tagmap_usage(tagmap_usage_t *, size_t);
+int					tagmap_usage_dump(size_t);
+size_t					tagmap_scavenge(void);
+void					tagmap_tsum_move(size_t, size_t, size_t);
 void		PIN_FAST_ANALYSIS_CALL	tagmap_setb(size_t, uint8_t);
 void		PIN_FAST_ANALYSIS_CALL	tagmap_clrb(size_t);
 uint8_t					tagmap_getb(size_t);
@@ -79,5 +177,18 @@ void		PIN_FAST_ANALYSIS_CALL	tagmap_clrl(size_t);
 uint32_t	PIN_FAST_ANALYSIS_CALL	tagmap_getl(size_t);
 void					tagmap_setn(size_t, size_t, uint8_t);
 void					tagmap_clrn(size_t, size_t);
+void					tagmap_filln(size_t, size_t, uint32_t);
+uint8_t					tagmap_getn(size_t, size_t);
+size_t					tagmap_issetn(size_t, size_t);
+void					tagmap_cpyn(size_t, size_t, size_t);
+void					tagmap_movn(size_t, size_t, size_t, size_t);
+void					tagmap_setv(const struct iovec *, size_t, size_t,
+						uint8_t);
+void					tagmap_clrv(const struct iovec *, size_t, size_t);
+uint8_t					tagmap_getv(const struct iovec *, size_t, size_t);
+int					tagmap_pwrite(int, size_t, size_t, off64_t);
+int					tagmap_pread(int, size_t, size_t, off64_t);
+void					tagmap_clrall(void);
+size_t					tagmap_issetall(void);
 
 #endif /* __TAGMAP_H__ */
@@ -0,0 +1,319 @@
+/*-
+ * Copyright (c) 2011, 2012, 2013, Columbia University
+ * All rights reserved.
+ *
+ * This software was developed by Vasileios P. Kemerlis <vpk@cs.columbia.edu>
+ * at Columbia University, New York, NY, USA, in June 2011.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Columbia University nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "tagmap_reader.h"
+
+/* page size (exported tagmap) */
+#define READER_PAGE_SZ	(1U << TAGMAP_SHM_PAGE_SHIFT)
+
+/* the shadow of the pages that are clear by definition */
+static const uint8_t reader_clear[READER_PAGE_SZ];
+
+/*
+ * translate a virtual address of the instrumented
+ * process to its shadow byte in the arena
+ *
+ * @r:		the reader
+ * @vaddr:	the virtual address
+ *
+ * returns:	a pointer to the shadow byte (reader_clear if the
+ * 		address is clear by definition; i.e., zero_seg or
+ * 		null_seg), or NULL if the shadow is not in the arena
+ * 		(e.g., a shadow that is shared with other processes)
+ */
+static inline const uint8_t *
+reader_xlat(const tagmap_reader_t *r, uint32_t vaddr)
+{
+	/* shadow address (libdft) */
+	uint32_t taddr	= vaddr + r->stab[vaddr >> TAGMAP_SHM_PAGE_SHIFT];
+	/* shadow page (libdft) */
+	uint32_t tpage	= taddr & ~(READER_PAGE_SZ - 1);
+	/* offset in the arena */
+	uint32_t off	= taddr - r->hdr->base;
+
+	/* hardcoded segments */
+	if (tpage == r->hdr->zero_seg || tpage == r->hdr->null_seg)
+		return reader_clear + (taddr - tpage);
+
+	/* not exported */
+	if (off >= r->size)
+		return NULL;
+
+	/* return the shadow byte */
+	return r->arena + off;
+}
+
+/*
+ * attach a reader to an exported tagmap
+ *
+ * the descriptor is not needed after the invocation,
+ * and it is up to the caller to close it
+ *
+ * @r:		the reader
+ * @fd:		descriptor of the shared memory object
+ *
+ * returns:	0 on success, 1 on error (errno is set accordingly;
+ * 		EAGAIN means that libdft has not finished initializing
+ * 		the tagmap yet)
+ */
+int
+tagmap_reader_attach(tagmap_reader_t *r, int fd)
+{
+	/* object metadata */
+	struct stat st;
+	/* arena */
+	void *arena;
+	/* arena header */
+	const tagmap_shm_hdr_t *hdr;
+
+	/* cleanup */
+	(void)memset(r, 0, sizeof(tagmap_reader_t));
+
+	/* get the size of the object */
+	if (fstat(fd, &st) == -1)
+		return 1;
+
+	/* too small */
+	if ((size_t)st.st_size < TAGMAP_SHM_HDR_SZ) {
+		errno = EINVAL;
+		return 1;
+	}
+
+	/* map the object (read-only) */
+	if ((arena = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0)) ==
+								MAP_FAILED)
+		return 1;
+	hdr = (const tagmap_shm_hdr_t *)arena;
+
+	/* not initialized yet */
+	if (hdr->magic != TAGMAP_SHM_MAGIC) {
+		(void)munmap(arena, st.st_size);
+		errno = EAGAIN;
+		return 1;
+	}
+
+	/* invalid layout */
+	if (hdr->version != TAGMAP_SHM_VERSION		||
+		hdr->page_sz != READER_PAGE_SZ		||
+		hdr->size != (size_t)st.st_size		||
+		hdr->stab_sz != (1U << (32 - TAGMAP_SHM_PAGE_SHIFT)) ||
+		hdr->stab > hdr->size			||
+		hdr->size - hdr->stab < hdr->stab_sz * sizeof(uint32_t)) {
+		(void)munmap(arena, st.st_size);
+		errno = EINVAL;
+		return 1;
+	}
+
+	/* setup the reader */
+	r->hdr		= hdr;
+	r->arena	= (const uint8_t *)arena;
+	r->stab		= (const uint32_t *)(r->arena + hdr->stab);
+	r->size		= st.st_size;
+
+	/* return with success */
+	return 0;
+}
+
+/*
+ * open an exported tagmap by name
+ *
+ * @r:		the reader
+ * @name:	the name of the shared memory object
+ * 		(as passed to tagmap_export())
+ *
+ * returns:	0 on success, 1 on error (errno is set accordingly)
+ */
+int
+tagmap_reader_open(tagmap_reader_t *r, const char *name)
+{
+	/* object descriptor */
+	int fd;
+	/* return value; errno */
+	int ret, err;
+
+	/* open the object */
+	if ((fd = shm_open(name, O_RDONLY, 0)) == -1)
+		return 1;
+
+	/* attach */
+	ret = tagmap_reader_attach(r, fd);
+	err = errno;
+
+	/* cleanup */
+	(void)close(fd);
+	errno = err;
+
+	/* done */
+	return ret;
+}
+
+/*
+ * detach a reader from an exported tagmap
+ *
+ * @r:		the reader
+ */
+void
+tagmap_reader_close(tagmap_reader_t *r)
+{
+	/* unmap the arena */
+	if (r->arena != NULL)
+		(void)munmap((void *)r->arena, r->size);
+
+	/* cleanup */
+	(void)memset(r, 0, sizeof(tagmap_reader_t));
+}
+
+/*
+ * get the tag value of a byte
+ *
+ * @r:		the reader
+ * @vaddr:	the virtual address (instrumented process)
+ *
+ * returns:	the tag value, or -1 if its shadow is not exported
+ * 		(errno is set to ENODATA)
+ */
+int
+tagmap_reader_getb(const tagmap_reader_t *r, uint32_t vaddr)
+{
+	/* shadow byte */
+	const uint8_t *taddr = reader_xlat(r, vaddr);
+
+	/* not exported */
+	if (taddr == NULL) {
+		errno = ENODATA;
+		return -1;
+	}
+
+	/* return the tag */
+	return *taddr;
+}
+
+/*
+ * copy the tag values of an arbitrary number of bytes
+ *
+ * the range is translated page by page, since the
+ * shadow of adjacent pages need not be contiguous
+ *
+ * @r:		the reader
+ * @vaddr:	the virtual address (instrumented process)
+ * @num:	the number of bytes
+ * @buf:	the buffer to store the tags (num bytes)
+ *
+ * returns:	0 on success, 1 if the shadow of some bytes is not
+ * 		exported (their tags are cleared in buf, and errno
+ * 		is set to ENODATA)
+ */
+int
+tagmap_reader_read(const tagmap_reader_t *r, uint32_t vaddr, size_t num,
+								uint8_t *buf)
+{
+	/* chunk length */
+	size_t len;
+	/* shadow bytes */
+	const uint8_t *taddr;
+	/* return value */
+	int ret = 0;
+
+	/* traverse the range page by page */
+	for (; num > 0; vaddr += len, buf += len, num -= len) {
+		/* bytes until the end of the page */
+		len = READER_PAGE_SZ - (vaddr & (READER_PAGE_SZ - 1));
+		if (len > num)
+			len = num;
+
+		/* copy the tags (or clear them) */
+		if ((taddr = reader_xlat(r, vaddr)) == NULL) {
+			(void)memset(buf, 0, len);
+			ret = 1;
+		}
+		else
+			(void)memcpy(buf, taddr, len);
+	}
+
+	/* not exported */
+	if (ret != 0)
+		errno = ENODATA;
+
+	/* done */
+	return ret;
+}
+
+/*
+ * get the combined tag value of an arbitrary number of bytes
+ *
+ * @r:		the reader
+ * @vaddr:	the virtual address (instrumented process)
+ * @num:	the number of bytes
+ *
+ * returns:	the union (bitwise OR) of the tag values, or -1 if
+ * 		the shadow of some bytes is not exported (errno is
+ * 		set to ENODATA)
+ */
+int
+tagmap_reader_getn(const tagmap_reader_t *r, uint32_t vaddr, size_t num)
+{
+	/* iterator; chunk length */
+	size_t i, len;
+	/* shadow bytes */
+	const uint8_t *taddr;
+	/* combined tag value */
+	uint8_t tag = 0;
+
+	/* traverse the range page by page */
+	for (; num > 0; vaddr += len, num -= len) {
+		/* bytes until the end of the page */
+		len = READER_PAGE_SZ - (vaddr & (READER_PAGE_SZ - 1));
+		if (len > num)
+			len = num;
+
+		/* not exported */
+		if ((taddr = reader_xlat(r, vaddr)) == NULL) {
+			errno = ENODATA;
+			return -1;
+		}
+
+		/* combine the tags */
+		for (i = 0; i < len; i++)
+			tag |= taddr[i];
+	}
+
+	/* return the combined tag */
+	return tag;
+}
@@ -0,0 +1,68 @@
+/*-
+ * Copyright (c) 2011, 2012, 2013, Columbia University
+ * All rights reserved.
+ *
+ * This software was developed by Vasileios P. Kemerlis <vpk@cs.columbia.edu>
+ * at Columbia University, New York, NY, USA, in June 2011.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Columbia University nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __TAGMAP_READER_H__
+#define __TAGMAP_READER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "tagmap_shm.h"
+
+/*
+ * tagmap reader
+ *
+ * a read-only view of a tagmap that was exported by libdft (see
+ * tagmap_export()); the view is zero-copy, and therefore it always
+ * reflects the current tag state of the instrumented process. The
+ * reader does not depend on Pin, and it can be linked with any
+ * (32-bit or 64-bit) program. Shadows that are not in the arena
+ * (see tagmap_shm.h) cannot be read; the reader fails with ENODATA
+ */
+typedef struct {
+	const tagmap_shm_hdr_t	*hdr;	/* arena header		*/
+	const uint8_t		*arena;	/* arena		*/
+	const uint32_t		*stab;	/* STAB			*/
+	size_t			size;	/* arena size		*/
+} tagmap_reader_t;
+
+
+/* tagmap reader API */
+int	tagmap_reader_open(tagmap_reader_t *, const char *);
+int	tagmap_reader_attach(tagmap_reader_t *, int);
+void	tagmap_reader_close(tagmap_reader_t *);
+int	tagmap_reader_getb(const tagmap_reader_t *, uint32_t);
+int	tagmap_reader_getn(const tagmap_reader_t *, uint32_t, size_t);
+int	tagmap_reader_read(const tagmap_reader_t *, uint32_t, size_t,
+								uint8_t *);
+
+#endif /* __TAGMAP_READER_H__ */
@@ -0,0 +1,82 @@
+/*-
+ * Copyright (c) 2011, 2012, 2013, Columbia University
+ * All rights reserved.
+ *
+ * This software was developed by Vasileios P. Kemerlis <vpk@cs.columbia.edu>
+ * at Columbia University, New York, NY, USA, in June 2011.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Columbia University nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __TAGMAP_SHM_H__
+#define __TAGMAP_SHM_H__
+
+/*
+ * layout of an exported tagmap
+ *
+ * this header is shared between libdft and the (Pin-agnostic) tagmap
+ * reader library, and therefore it must not depend on pin.H
+ *
+ * when the tagmap is exported, STAB and every tagmap segment (except the
+ * ``hardcoded'' zero_seg and null_seg) are carved out of a single shared
+ * memory object (i.e., the arena). The arena starts with a header page
+ * that describes its layout, followed by STAB; the rest of it is used
+ * for tagmap segments. Since the tagmap is mapped at arbitrary addresses
+ * in the address space of libdft, a reader translates a virtual address
+ * of the instrumented process as follows:
+ *
+ * 	taddr = vaddr + STAB[vaddr >> lg(PAGE_SZ)]
+ * 	offset = taddr - base
+ *
+ * where base is the address of the arena in libdft. Addresses that
+ * translate to zero_seg, or null_seg, are clear by definition. Shadows
+ * that are shared with other processes (e.g., of shared memory, or of
+ * files in the file tag store) live in their own objects; they translate
+ * outside the arena, and their tags cannot be read
+ */
+
+#include <stdint.h>
+
+#define TAGMAP_SHM_MAGIC	0x54464444U	/* "DDFT"			*/
+#define TAGMAP_SHM_VERSION	1U		/* layout version		*/
+#define TAGMAP_SHM_PAGE_SHIFT	12		/* page alignment offset (bits)	*/
+#define TAGMAP_SHM_HDR_SZ	4096U		/* header size; 1 page		*/
+#define TAGMAP_SHM_PREFIX	'/'		/* shm_open(3) name prefix	*/
+
+/* arena header */
+typedef struct {
+	uint32_t magic;		/* TAGMAP_SHM_MAGIC			*/
+	uint32_t version;	/* TAGMAP_SHM_VERSION			*/
+	uint32_t pid;		/* PID of the instrumented process	*/
+	uint32_t page_sz;	/* page size				*/
+	uint32_t base;		/* address of the arena in libdft	*/
+	uint32_t size;		/* size of the arena			*/
+	uint32_t stab;		/* offset of STAB in the arena		*/
+	uint32_t stab_sz;	/* number of STAB entries		*/
+	uint32_t zero_seg;	/* address of zero_seg in libdft	*/
+	uint32_t null_seg;	/* address of null_seg in libdft	*/
+} tagmap_shm_hdr_t;
+
+#endif /* __TAGMAP_SHM_H__ */
@@ -0,0 +1,777 @@
+#!/bin/bash
+#
+# NSL DFT library (benchmark harness)
+#
+# Columbia University, Department of Computer Science
+# Network Security Lab
+#
+# runs a fixed local workload suite natively and under nullpin, libdft,
+# libdft-dta, and libdft-dta-d (i.e., libdft-dta with decoupled
+# propagation; -d 1, with the replay thread on a CPU of its own), and
+# writes one CSV line per (workload, tool) pair:
+#
+#	workload,tool,median_s,slowdown,rss_kb,shadow_kb,failed
+#
+# slowdown is relative to the native run; shadow_kb is the peak shadow
+# memory of libdft-dta (-a 0; the sum over the processes of the run), and
+# it is empty for the rest of the tools; failed is the number of runs
+# that exited with a non-zero status (e.g., crashed under a tool), which
+# are left out of the medians (all of them failed if the medians are
+# empty); the fields whose baseline is not measured are left empty
+#
+# the tools instrument i386 programs only; the generated programs are
+# built with cc -m32 (they are skipped if there is no 32-bit libc), and
+# the workloads whose programs are not 32-bit (e.g., the system commands
+# of an x86-64 host) are skipped
+#
+# environment (defaults in brackets):
+#
+#	PIN_HOME	Pin installation (required)
+#	BENCH_REPS	repetitions per (workload, tool) [5]
+#	BENCH_CPU	CPU list for taskset(1) [0]
+#	BENCH_RCPU	CPU of the replay thread of libdft-dta-d [1]
+#	BENCH_TOOLS	space-separated subset of the tools; native is
+#			the baseline, and it goes first [all]
+#	BENCH_JOBS	parallel jobs of the make workload [4]
+#	BENCH_OUT	CSV output [bench.csv]
+#	BENCH_DIR	scratch directory [/tmp/libdft-bench]
+#	BENCH_PORT	port of the HTTP workload [8089]
+#	BENCH_ONLY	space-separated subset of the workloads [all]
+#
+# workloads: gzip, http (python3 http.server + curl), sqlite (sqlite3),
+# json (jq), make (make -j on generated sources), sparse (a generated
+# program that taints 16 pages of a 256 MB mapping and writes the mapping
+# to a pipe, so that libdft-dta queries the tags of the whole range),
+# strings (a generated program that calls the summarized libc string
+# and memory routines on file data), syscalls (a generated program that
+# issues 7M short syscalls and 1M vDSO calls), spawn (a generated program
+# that starts 32 workers with fork and exec, with file data in their
+# arguments, as pre-fork servers do), attach (Pin attaches, with -pid, to
+# a generated program with 64 reservations and 64 guarded mappings; the
+# time until the program answers under the tool is measured, along with
+# its peak RSS; natively, only the handshake is, and ptrace(2) must be
+# allowed, e.g., kernel.yama.ptrace_scope = 0), remap (a generated
+# program that grows a tainted mapping from 1 MB to 256 MB with mremap),
+# memset (a generated program that fills 64 B to 64 MB with rep stos and
+# a tainted pattern), memmove (a generated program that copies 4 KB to
+# 16 MB of file data with rep movs, forward and, overlapping, backward),
+# hash (a generated program that computes CRC32 and a rotate-based hash
+# over file data); the ones whose commands are missing are skipped
+#
+
+# settings
+REPS=${BENCH_REPS:-5}
+CPU=${BENCH_CPU:-0}
+JOBS=${BENCH_JOBS:-4}
+OUT=${BENCH_OUT:-bench.csv}
+DIR=${BENCH_DIR:-/tmp/libdft-bench}
+PORT=${BENCH_PORT:-8089}
+WORKLOADS=${BENCH_ONLY:-"gzip http sqlite json make sparse strings syscalls \
+	spawn attach remap memset memmove hash"}
+RCPU=${BENCH_RCPU:-1}
+TOOLS=${BENCH_TOOLS:-"native nullpin libdft libdft-dta libdft-dta-d"}
+TOOLDIR=$(cd "$(dirname "$0")" && pwd)
+
+# die with an error message
+die() {
+	echo "bench: $*" >&2
+	exit 1
+}
+
+# sanity checks
+[ -n "$PIN_HOME" ] || die "PIN_HOME environment variable is not set"
+[ -x "$PIN_HOME/pin" ] || die "$PIN_HOME/pin not found"
+[ -x /usr/bin/time ] || die "GNU time (/usr/bin/time) is required"
+command -v taskset >/dev/null || die "taskset(1) is required"
+for t in nullpin libdft libdft-dta; do
+	[ -f "$TOOLDIR/$t.so" ] || die "$TOOLDIR/$t.so not found (make tools)"
+done
+
+# command prefix of a tool
+prefix() {
+	case $1 in
+	native)	echo "taskset -c $CPU" ;;
+	libdft-dta)
+		echo "taskset -c $CPU $PIN_HOME/pin -follow_execv" \
+			"-t $TOOLDIR/libdft-dta.so -a 0" \
+			"-logfile $DIR/pintool.log -unique_logfile --" ;;
+	libdft-dta-d)
+		echo "taskset -c $CPU,$RCPU $PIN_HOME/pin -follow_execv" \
+			"-t $TOOLDIR/libdft-dta.so -d 1 -p $RCPU -a 0" \
+			"-logfile $DIR/pintool.log -unique_logfile --" ;;
+	*)	echo "taskset -c $CPU $PIN_HOME/pin -follow_execv" \
+			"-t $TOOLDIR/$1.so --" ;;
+	esac
+}
+
+# compile a generated workload program for i386 (if there is a compiler
+# and a 32-bit libc; see setup()); the arguments after the name are
+# extra compiler flags
+build() {
+	local p=$1
+
+	shift
+	[ "$CC32" -eq 1 ] || return 0
+	cc -m32 -O2 "$@" -o "$DIR/$p" "$DIR/$p.c" ||
+		die "cannot build $DIR/$p.c"
+}
+
+# the program that a workload runs under the tools
+target() {
+	case $1 in
+	gzip|make)	command -v "$1" ;;
+	http)	command -v python3 ;;
+	sqlite)	command -v sqlite3 ;;
+	json)	command -v jq ;;
+	*)	echo "$DIR/$1" ;;
+	esac
+}
+
+# check if a program is a 32-bit ELF (i.e., EI_CLASS is ELFCLASS32)
+elf32() {
+	[ "$(od -An -tx1 -j4 -N1 "$1" 2>/dev/null | tr -d ' ')" = 01 ]
+}
+
+# generate the (deterministic) workload inputs
+setup() {
+	rm -rf "$DIR" && mkdir -p "$DIR/www" "$DIR/mk" || die "cannot use $DIR"
+
+	# the generated programs need a 32-bit libc (see build())
+	CC32=0
+	echo 'int main(void) { return 0; }' > "$DIR/cc32.c"
+	command -v cc >/dev/null &&
+		cc -m32 -o "$DIR/cc32" "$DIR/cc32.c" 2>/dev/null && CC32=1
+	[ "$CC32" -eq 1 ] ||
+		echo "bench: no cc -m32 (32-bit libc); no generated programs" >&2
+
+	# gzip: ~30 MB of text
+	seq 1 4000000 > "$DIR/data"
+
+	# http: a 256 KB page
+	head -c 262144 "$DIR/data" > "$DIR/www/index.html"
+
+	# sqlite: 50K inserts, an index, and a few aggregate queries
+	{
+		echo "CREATE TABLE t (k INTEGER, v TEXT);"
+		echo "BEGIN;"
+		seq 1 50000 | awk '{ printf "INSERT INTO t VALUES " \
+			"(%d, \"v%d\");\n", ($1 * 7919) % 50000, $1 }'
+		echo "COMMIT;"
+		echo "CREATE INDEX tk ON t (k);"
+		echo "SELECT COUNT(*), SUM(k) FROM t WHERE k % 3 = 0;"
+		echo "SELECT v FROM t ORDER BY k DESC LIMIT 10;"
+	} > "$DIR/sql"
+
+	# json: an array of 200K objects
+	seq 1 200000 | awk 'BEGIN { print "[" } { printf "%s{\"id\":%d,"  \
+		"\"name\":\"n%d\",\"tags\":[1,2,3]}\n", (NR > 1 ? "," : ""), \
+		$1, $1 } END { print "]" }' > "$DIR/json"
+
+	# make: 64 translation units
+	for i in $(seq 1 64); do
+		echo "int f$i(int x) { return x * $i + (x >> 3); }" \
+			> "$DIR/mk/f$i.c"
+	done
+	printf 'OBJS = %s\nall: $(OBJS)\n%%.o: %%.c\n\t$(CC) -O2 -c -o $@ $<\n' \
+		"$(cd "$DIR/mk" && ls *.c | sed 's/\.c$/.o/' | tr '\n' ' ')" \
+		> "$DIR/mk/Makefile"
+
+	# sparse: 256 MB, tainted with 4 KB reads every 16 MB, written to a
+	# pipe 4 times in chunks of up to 1 MB (and drained)
+	cat > "$DIR/sparse.c" <<-'EOF'
+	#define _GNU_SOURCE
+	#include <sys/mman.h>
+	#include <fcntl.h>
+	#include <string.h>
+	#include <unistd.h>
+
+	#define SZ	(256UL << 20)
+	#define CHUNK	(1UL << 20)
+
+	int
+	main(int argc, char **argv)
+	{
+		static char buf[CHUNK];
+		char *p;
+		size_t off, len;
+		ssize_t n;
+		int fd, pfd[2], i;
+
+		if (argc < 2 || (fd = open(argv[1], O_RDONLY)) < 0 ||
+			(p = mmap(NULL, SZ, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+			-1, 0)) == MAP_FAILED || pipe2(pfd, O_NONBLOCK) < 0)
+			return 1;
+		memset(p, 'x', SZ);
+
+		for (off = 0; off < SZ; off += SZ / 16)
+			if (pread(fd, p + off, 4096, 0) != 4096)
+				return 1;
+
+		for (i = 0; i < 4; i++)
+			for (off = 0; off < SZ; off += (size_t)n) {
+				len = (SZ - off < CHUNK) ? SZ - off : CHUNK;
+				if ((n = write(pfd[1], p + off, len)) <= 0 ||
+					read(pfd[0], buf, (size_t)n) != n)
+					return 1;
+			}
+		return 0;
+	}
+	EOF
+	build sparse
+
+	# strings: 20M rounds of strcpy, strncpy, strlen, strcmp, memcmp,
+	# memcpy, and memset on the lines of the gzip input (tainted);
+	# -fno-builtin keeps the calls to libc
+	cat > "$DIR/strings.c" <<-'EOF'
+	#include <stdio.h>
+	#include <string.h>
+
+	#define LINES	4096
+	#define ROUNDS	(20000000 / LINES)
+
+	int
+	main(int argc, char **argv)
+	{
+		static char lines[LINES][64], buf[256], pad[256];
+		FILE *fp;
+		size_t len, sum = 0;
+		int i, r;
+
+		if (argc < 2 || (fp = fopen(argv[1], "r")) == NULL)
+			return 1;
+		for (i = 0; i < LINES &&
+			fgets(lines[i], sizeof(lines[i]), fp) != NULL; i++);
+		if (i < LINES)
+			return 1;
+
+		for (r = 0; r < ROUNDS; r++)
+			for (i = 1; i < LINES; i++) {
+				strcpy(buf, lines[i]);
+				strncpy(pad, lines[i - 1], sizeof(pad));
+				len = strlen(buf);
+				sum += (strcmp(buf, pad) < 0) +
+					(memcmp(buf, lines[i - 1], len) == 0);
+				memcpy(pad, buf, len);
+				memset(buf, r, sizeof(buf));
+			}
+		return (sum == 0);
+	}
+	EOF
+	build strings -fno-builtin
+
+	# syscalls: 1M rounds of pread, write and read on a pipe, fstat,
+	# getppid, clock_gettime (vDSO), lseek, and an invalid close
+	cat > "$DIR/syscalls.c" <<-'EOF'
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <time.h>
+	#include <unistd.h>
+
+	#define ROUNDS	1000000
+
+	int
+	main(int argc, char **argv)
+	{
+		char buf[64];
+		struct stat st;
+		struct timespec ts;
+		int fd, pfd[2], i;
+
+		if (argc < 2 || (fd = open(argv[1], O_RDONLY)) < 0 ||
+			pipe(pfd) < 0)
+			return 1;
+
+		for (i = 0; i < ROUNDS; i++) {
+			if (pread(fd, buf, sizeof(buf), (i & 0xFFF) << 6) !=
+				sizeof(buf) ||
+				write(pfd[1], buf, sizeof(buf)) != sizeof(buf) ||
+				read(pfd[0], buf, sizeof(buf)) != sizeof(buf) ||
+				fstat(fd, &st) < 0)
+				return 1;
+			(void)getppid();
+			(void)clock_gettime(CLOCK_MONOTONIC, &ts);
+			(void)lseek(fd, 0, SEEK_SET);
+			(void)close(-1);
+		}
+		return 0;
+	}
+	EOF
+	build syscalls
+
+	# spawn: 32 workers, one at a time; each one is forked, and it
+	# execs the program again with a line of the gzip input (tainted)
+	# in its arguments
+	cat > "$DIR/spawn.c" <<-'EOF'
+	#include <sys/types.h>
+	#include <sys/wait.h>
+	#include <stdio.h>
+	#include <string.h>
+	#include <unistd.h>
+
+	#define WORKERS	32
+
+	int
+	main(int argc, char **argv)
+	{
+		char line[64], *args[4];
+		FILE *fp;
+		pid_t pid;
+		int i, st;
+
+		/* a worker */
+		if (argc > 2)
+			return (strlen(argv[2]) == 0);
+
+		if (argc < 2 || (fp = fopen(argv[1], "r")) == NULL ||
+			fgets(line, sizeof(line), fp) == NULL)
+			return 1;
+		args[0] = argv[0];
+		args[1] = argv[1];
+		args[2] = line;
+		args[3] = NULL;
+
+		for (i = 0; i < WORKERS; i++) {
+			if ((pid = fork()) < 0)
+				return 1;
+			if (pid == 0) {
+				execv(argv[0], args);
+				_exit(127);
+			}
+			if (waitpid(pid, &st, 0) != pid || !WIFEXITED(st) ||
+				WEXITSTATUS(st) != 0)
+				return 1;
+		}
+		return 0;
+	}
+	EOF
+	build spawn
+
+	# attach: 64 reservations of 8 MB (e.g., malloc arenas), and 64
+	# writable mappings of 1 MB with a guard page each; the program
+	# signals that it is ready, and it waits for a byte on a FIFO
+	cat > "$DIR/attach.c" <<-'EOF'
+	#include <sys/mman.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+
+	#define REGIONS	64
+
+	int
+	main(int argc, char **argv)
+	{
+		char *p, c;
+		int fd, i;
+
+		if (argc < 3)
+			return 1;
+
+		for (i = 0; i < REGIONS; i++) {
+			if (mmap(NULL, 8 << 20, PROT_NONE,
+				MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+				-1, 0) == MAP_FAILED ||
+				(p = mmap(NULL, 1 << 20, PROT_READ | PROT_WRITE,
+				MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)) ==
+				MAP_FAILED || mprotect(p, 4096, PROT_NONE) < 0)
+				return 1;
+			p[4096] = 1;
+		}
+
+		if ((fd = open(argv[1], O_WRONLY | O_CREAT, 0600)) < 0)
+			return 1;
+		(void)close(fd);
+		if ((fd = open(argv[2], O_RDONLY)) < 0 || read(fd, &c, 1) != 1)
+			return 1;
+		return 0;
+	}
+	EOF
+	build attach
+
+	# remap: 16 rounds of growing a mapping (4 KB of file data at its
+	# start) from 1 MB to 256 MB, doubling it with mremap and touching a
+	# page per MB of the new part, and shrinking it back in place
+	cat > "$DIR/remap.c" <<-'EOF'
+	#define _GNU_SOURCE
+	#include <sys/mman.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+
+	#define MIN	(1UL << 20)
+	#define MAX	(256UL << 20)
+	#define ROUNDS	16
+
+	int
+	main(int argc, char **argv)
+	{
+		char *p, *q;
+		size_t sz, off;
+		int fd, r;
+
+		if (argc < 2 || (fd = open(argv[1], O_RDONLY)) < 0 ||
+			(p = mmap(NULL, MIN, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)) == MAP_FAILED ||
+			pread(fd, p, 4096, 0) != 4096)
+			return 1;
+
+		for (r = 0; r < ROUNDS; r++) {
+			for (sz = MIN; sz < MAX; sz <<= 1) {
+				if ((q = mremap(p, sz, sz << 1,
+					MREMAP_MAYMOVE)) == MAP_FAILED)
+					return 1;
+				p = q;
+				for (off = sz; off < sz << 1; off += MIN)
+					p[off] = p[0];
+			}
+			if ((q = mremap(p, MAX, MIN, 0)) == MAP_FAILED)
+				return 1;
+			p = q;
+		}
+		return (p[0] == 0);
+	}
+	EOF
+	build remap
+
+	# memset: 256 MB filled per size, from 64 B to 64 MB (x4 steps),
+	# with rep stosl and rep stosb (alternately), and a pattern that
+	# is read from the gzip input (tainted)
+	cat > "$DIR/memset.c" <<-'EOF'
+	#define _GNU_SOURCE
+	#include <sys/mman.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+
+	#define MIN	64UL
+	#define MAX	(64UL << 20)
+	#define TOTAL	(256UL << 20)
+
+	int
+	main(int argc, char **argv)
+	{
+		unsigned char *p, *d;
+		unsigned int v;
+		size_t sz, i, n;
+		int fd;
+
+		if (argc < 2 || (fd = open(argv[1], O_RDONLY)) < 0 ||
+			read(fd, &v, sizeof(v)) != sizeof(v) ||
+			(p = mmap(NULL, MAX, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)) == MAP_FAILED)
+			return 1;
+
+		for (sz = MIN; sz <= MAX; sz <<= 2)
+			for (i = 0; i < TOTAL / sz; i++) {
+				d = p;
+				if (i & 1) {
+					n = sz;
+					__asm__ __volatile__("rep stosb"
+						: "+D" (d), "+c" (n)
+						: "a" (v) : "memory");
+				} else {
+					n = sz / 4;
+					__asm__ __volatile__("rep stosl"
+						: "+D" (d), "+c" (n)
+						: "a" (v) : "memory");
+				}
+			}
+		return (p[MAX - 1] != (unsigned char)v);
+	}
+	EOF
+	build memset
+
+	# memmove: 256 MB copied per size and direction, from 4 KB to
+	# 16 MB (x4 steps), with rep movsl; forward to a disjoint buffer,
+	# and backward (DF = 1) to an overlapping one, 64 bytes higher, as
+	# memmove(3) does; the source is the gzip input (tainted)
+	cat > "$DIR/memmove.c" <<-'EOF'
+	#define _GNU_SOURCE
+	#include <sys/mman.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+
+	#define MIN	(4UL << 10)
+	#define MAX	(16UL << 20)
+	#define TOTAL	(256UL << 20)
+	#define SHIFT	64
+
+	int
+	main(int argc, char **argv)
+	{
+		unsigned char *p, *s, *d;
+		size_t sz, i, n, off;
+		ssize_t ret;
+		int fd;
+
+		if (argc < 2 || (fd = open(argv[1], O_RDONLY)) < 0 ||
+			(p = mmap(NULL, 2 * MAX + SHIFT, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)) == MAP_FAILED)
+			return 1;
+		for (off = 0; off < MAX; off += ret)
+			if ((ret = read(fd, p + off, MAX - off)) <= 0)
+				return 1;
+
+		for (sz = MIN; sz <= MAX; sz <<= 2)
+			for (i = 0; i < TOTAL / sz; i++) {
+				s = p;
+				d = p + MAX + SHIFT;
+				n = sz / 4;
+				__asm__ __volatile__("rep movsl"
+					: "+S" (s), "+D" (d), "+c" (n)
+					: : "memory");
+				s = p + sz - 4;
+				d = p + SHIFT + sz - 4;
+				n = sz / 4;
+				__asm__ __volatile__("std\n\trep movsl\n\tcld"
+					: "+S" (s), "+D" (d), "+c" (n)
+					: : "memory");
+			}
+		return (p[MAX + SHIFT] != p[SHIFT]);
+	}
+	EOF
+	build memmove
+
+	# hash: 8 rounds of a table-driven CRC32 and of MurmurHash3's
+	# (32-bit) mixing over 16 MB of the gzip input (tainted); both are
+	# shift and rotate bound
+	cat > "$DIR/hash.c" <<-'EOF'
+	#include <fcntl.h>
+	#include <stdint.h>
+	#include <stdlib.h>
+	#include <unistd.h>
+
+	#define LEN	(16UL << 20)
+	#define ROUNDS	8
+
+	#define ROL(x, n)	(((x) << (n)) | ((x) >> (32 - (n))))
+
+	static uint32_t crc_tbl[256];
+
+	static uint32_t
+	crc32(const unsigned char *p, size_t len)
+	{
+		uint32_t crc = 0xffffffff;
+
+		while (len--)
+			crc = crc_tbl[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+		return ~crc;
+	}
+
+	static uint32_t
+	murmur(const uint32_t *p, size_t len)
+	{
+		uint32_t h = 0, k;
+
+		for (len /= 4; len--; p++) {
+			k = *p * 0xcc9e2d51;
+			k = ROL(k, 15) * 0x1b873593;
+			h ^= k;
+			h = ROL(h, 13) * 5 + 0xe6546b64;
+		}
+		h ^= h >> 16;
+		h *= 0x85ebca6b;
+		h ^= h >> 13;
+		return h;
+	}
+
+	int
+	main(int argc, char **argv)
+	{
+		unsigned char *buf;
+		uint32_t c, h = 0;
+		size_t off;
+		ssize_t ret;
+		int fd, i, j;
+
+		if (argc < 2 || (fd = open(argv[1], O_RDONLY)) < 0 ||
+			(buf = malloc(LEN)) == NULL)
+			return 1;
+		for (off = 0; off < LEN; off += ret)
+			if ((ret = read(fd, buf + off, LEN - off)) <= 0)
+				return 1;
+
+		for (i = 0; i < 256; i++) {
+			for (c = i, j = 0; j < 8; j++)
+				c = (c & 1) ? (c >> 1) ^ 0xedb88320 : c >> 1;
+			crc_tbl[i] = c;
+		}
+		for (i = 0; i < ROUNDS; i++) {
+			buf[i] ^= crc32(buf, LEN);
+			h ^= murmur((const uint32_t *)buf, LEN);
+		}
+		return (h == 0);
+	}
+	EOF
+	build hash
+}
+
+# required commands of a workload
+needs() {
+	case $1 in
+	gzip)	echo gzip ;;
+	http)	echo python3 curl ;;
+	sqlite)	echo sqlite3 ;;
+	json)	echo jq ;;
+	make)	echo make cc ;;
+	sparse|strings|syscalls|spawn|remap|memset|memmove|hash)
+		echo cc ;;
+	attach)	echo cc mkfifo ;;
+	esac
+}
+
+# run a workload once; prints "seconds,rss_kb", or fails
+run() {
+	local w=$1 pre=$2 t0 t1 pid i st=0
+
+	case $w in
+	gzip)
+		/usr/bin/time -f "%e,%M" -o "$DIR/time" \
+			$pre gzip -6 -c "$DIR/data" > /dev/null || st=$?
+		;;
+	sqlite)
+		rm -f "$DIR/db"
+		/usr/bin/time -f "%e,%M" -o "$DIR/time" \
+			$pre sqlite3 "$DIR/db" < "$DIR/sql" > /dev/null || st=$?
+		;;
+	json)
+		/usr/bin/time -f "%e,%M" -o "$DIR/time" \
+			$pre jq length "$DIR/json" > /dev/null || st=$?
+		;;
+	sparse|strings|syscalls|spawn|remap|memset|memmove|hash)
+		/usr/bin/time -f "%e,%M" -o "$DIR/time" \
+			$pre "$DIR/$w" "$DIR/data" || st=$?
+		;;
+	make)
+		rm -f "$DIR"/mk/*.o
+		/usr/bin/time -f "%e,%M" -o "$DIR/time" \
+			$pre make -s -j"$JOBS" -C "$DIR/mk" > /dev/null || st=$?
+		;;
+	http)
+		# the server is measured for RSS, the load for time
+		/usr/bin/time -f "%e,%M" -o "$DIR/time" \
+			$pre python3 -m http.server --bind 127.0.0.1 \
+			--directory "$DIR/www" "$PORT" > /dev/null 2>&1 &
+		pid=$!
+		for i in $(seq 1 600); do
+			curl -s -o /dev/null "http://127.0.0.1:$PORT/" && break
+			sleep 0.1
+		done
+		t0=$(date +%s.%N)
+		for i in $(seq 1 500); do
+			curl -sf -o /dev/null "http://127.0.0.1:$PORT/" ||
+				st=$?
+		done
+		t1=$(date +%s.%N)
+		# SIGINT is ignored by asynchronous commands; time(1) prefixes
+		# the report with a line about the terminating signal
+		pkill -TERM -P "$pid"
+		wait "$pid"
+		[ "$st" -eq 0 ] || { echo "bench: $w: curl failed ($st)" >&2; \
+			return 1; }
+		echo "$(awk "BEGIN { print $t1 - $t0 }"),$(tail -n 1 "$DIR/time" |
+			cut -d, -f2)"
+		return
+		;;
+	attach)
+		# the program is started natively, and Pin attaches to it
+		rm -f "$DIR/ready" "$DIR/fifo"
+		mkfifo "$DIR/fifo" || return 1
+		taskset -c "$CPU" "$DIR/attach" "$DIR/ready" "$DIR/fifo" &
+		pid=$!
+		while [ ! -e "$DIR/ready" ] && kill -0 "$pid" 2>/dev/null; do
+			sleep 0.05
+		done
+		case $pre in
+		*/pin\ *)
+			pre=$(echo "$pre" | sed "s| -follow_execv | -pid $pid |;
+				s| --\$||") ;;
+		*)	pre=true ;;
+		esac
+		t0=$(date +%s.%N)
+		[ -e "$DIR/ready" ] && $pre || st=$?
+		# the program answers once it runs under the tool
+		rss=$(awk '/^VmHWM:/ { print $2 }' "/proc/$pid/status" \
+			2>/dev/null)
+		echo > "$DIR/fifo"
+		wait "$pid" || st=$?
+		t1=$(date +%s.%N)
+		[ "$st" -eq 0 ] || { echo "bench: $w: failed ($st)" >&2; \
+			return 1; }
+		echo "$(awk "BEGIN { print $t1 - $t0 }"),${rss:-0}"
+		return
+		;;
+	esac
+
+	# time(1) reports a non-zero status on a line of its own
+	[ "$st" -eq 0 ] || { echo "bench: $w: exited with status $st" >&2; \
+		return 1; }
+	tail -n 1 "$DIR/time"
+}
+
+# median of the numbers on stdin (nothing if there are none)
+median() {
+	sort -n | awk '{ v[NR] = $1 } END { if (NR > 0) print (NR % 2) ? \
+		v[(NR + 1) / 2] : (v[NR / 2] + v[NR / 2 + 1]) / 2 }'
+}
+
+# peak shadow memory of a run (KB); the sum over the final usage dumps
+# of its processes (see prefix()), or nothing if there are none
+shadow() {
+	cat "$DIR"/pintool.log* 2>/dev/null | sed -n \
+		's/^.*tagmap: total [0-9]* KB (peak \([0-9]*\) KB).*$/\1/p' |
+		awk '{ s += $1 } END { if (NR > 0) print s }'
+}
+
+# prepare the inputs
+setup
+echo "workload,tool,median_s,slowdown,rss_kb,shadow_kb,failed" > "$OUT"
+
+# run the suite
+for w in $WORKLOADS; do
+	# skip workloads with missing commands
+	for c in $(needs "$w"); do
+		command -v "$c" >/dev/null || { echo "bench: $w: no $c" >&2; \
+			continue 2; }
+	done
+
+	# the tools instrument i386 programs only
+	elf32 "$(target "$w")" || { echo "bench: $w: $(target "$w")" \
+		"is not an i386 program" >&2; continue; }
+
+	# no baseline yet
+	base_s=
+
+	for t in $TOOLS; do
+		: > "$DIR/runs"
+		failed=0
+		for r in $(seq 1 "$REPS"); do
+			echo "bench: $w/$t ($r/$REPS)" >&2
+			rm -f "$DIR"/pintool.log*
+			if res=$(run "$w" "$(prefix "$t")"); then
+				echo "$res,$(shadow)" >> "$DIR/runs"
+			else
+				failed=$((failed + 1))
+			fi
+		done
+
+		# every run failed; no medians
+		if [ "$failed" -eq "$REPS" ]; then
+			echo "$w,$t,,,,,$failed" >> "$OUT"
+			continue
+		fi
+		secs=$(cut -d, -f1 "$DIR/runs" | median)
+		rss=$(cut -d, -f2 "$DIR/runs" | median)
+		sh=$(cut -d, -f3 "$DIR/runs" | grep -v '^$' | median)
+
+		# baseline (native time)
+		[ "$t" = native ] && base_s=$secs
+
+		awk -v w="$w" -v t="$t" -v s="$secs" -v b="$base_s" \
+			-v r="$rss" -v sh="$sh" -v f="$failed" 'BEGIN { \
+			printf "%s,%s,%.2f,%s,%d,%s,%d\n", w, t, s, \
+			(b > 0) ? sprintf("%.2f", s / b) : "", r, \
+			(sh != "") ? sprintf("%d", sh) : "", f }' >> "$OUT"
+	done
+done
+
+# cleanup
+rm -rf "$DIR"
+echo "bench: results in $OUT" >&2
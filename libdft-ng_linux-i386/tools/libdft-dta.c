@@ -34,25 +34,31 @@
  * TODO:
  * 	- add support for file descriptor duplication via fcntl(2)
  * 	- add support for non PF_INET* sockets
- * 	- add support for recvmmsg(2)
  */
 
 #include <errno.h>
 #include <sys/socket.h>
+#include <asm/fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include <map>
 #include <set>
 
 #include "branch_pred.h"
+#include "exectag.h"
+#include "filetag.h"
 #include "libdft_api.h"
 #include "libdft_core.h"
+#include "libdft_ctl.h"
+#include "libdft_replay.h"
+#include "libdft_stats.h"
+#include "summary.h"
 #include "syscall_desc.h"
 #include "tagmap.h"
 
 #define WORD_LEN	4	/* size in bytes of a word value */
-#define SYS_SOCKET	1	/* socket(2) demux index for socketcall */
 
 /* default path for the log file (audit) */
 #define LOGFILE_DFL	"/tmp/libdft-dta.log"
@@ -61,6 +67,10 @@
 #define DLIB_SUFF	".so"
 #define DLIB_SUFF_ALT	".so."
 
+/* 64-bit file offset that is passed in two arguments (low word first) */
+#define OFF64_ARG(ctx, i)	((off64_t)(ctx)->arg[(i)] |		\
+				((off64_t)(ctx)->arg[(i) + 1] << 32))
+
 
 /* thread context */
 extern REG thread_ctx_ptr;
@@ -74,6 +84,13 @@ extern syscall_desc_t syscall_desc[SYSCALL_MAX];
 /* set of interesting descriptors (sockets) */
 static set<int> fdset;
 
+/*
+ * pipes (write end -> read end), and the reverse
+ * index (read end -> write ends); see pipe_taint()
+ */
+static map<int, int> pipes;
+static multimap<int, int> pipes_rd;
+
 /* log file path (auditing) */
 static KNOB<string> logpath(KNOB_MODE_WRITEONCE, "pintool", "l",
 		LOGFILE_DFL, "");
@@ -94,6 +111,46 @@ static KNOB<size_t> fs(KNOB_MODE_WRITEONCE, "pintool", "f", "1", "");
 /* track net (enabled by default) */
 static KNOB<size_t> net(KNOB_MODE_WRITEONCE, "pintool", "n", "1", "");
 
+/* summarize libc string/memory routines (enabled by default) */
+static KNOB<size_t> summ(KNOB_MODE_WRITEONCE, "pintool", "u", "1", "");
+
+/* sampling rate; out of SAMPLE_SCALE (sampling disabled by default) */
+static KNOB<size_t> srate(KNOB_MODE_WRITEONCE, "pintool", "r",
+		decstr(SAMPLE_SCALE), "");
+
+/* sampling granularity; 0: connections, 1: reads */
+static KNOB<size_t> sgran(KNOB_MODE_WRITEONCE, "pintool", "g", "0", "");
+
+/* control socket path (control channel disabled by default) */
+static KNOB<string> ctlpath(KNOB_MODE_WRITEONCE, "pintool", "c", "", "");
+
+/* tagmap export name (tagmap export disabled by default) */
+static KNOB<string> shmname(KNOB_MODE_WRITEONCE, "pintool", "e", "", "");
+
+/* tagmap export size (MB); 0 for half of the free address space */
+static KNOB<size_t> shmsize(KNOB_MODE_WRITEONCE, "pintool", "m", "0", "");
+
+/* decoupled propagation (disabled by default) */
+static KNOB<size_t> decoupled(KNOB_MODE_WRITEONCE, "pintool", "d", "0", "");
+
+/* CPU of the replay thread (decoupled propagation); -1 for any */
+static KNOB<int> rcpu(KNOB_MODE_WRITEONCE, "pintool", "p", "-1", "");
+
+/* directory of the file tag store; empty for none (disabled) */
+static KNOB<string> ftdir(KNOB_MODE_WRITEONCE, "pintool", "w", "", "");
+
+/* name prefix of the shared shadows; empty for none (disabled) */
+static KNOB<string> sharepref(KNOB_MODE_WRITEONCE, "pintool", "x", "", "");
+
+/* instrumentation statistics report path; empty for none (disabled) */
+static KNOB<string> statpath(KNOB_MODE_WRITEONCE, "pintool", "t", "", "");
+
+/* shadow memory usage dump period (s); 0 for at exit only, -1 for none */
+static KNOB<int> memdump(KNOB_MODE_WRITEONCE, "pintool", "a", "-1", "");
+
+/* shadow scavenger period (s); 0 for none (disabled) */
+static KNOB<size_t> scavenge(KNOB_MODE_WRITEONCE, "pintool", "z", "0", "");
+
 /* 
  * DTA/DFT alert
  *
@@ -237,7 +294,7 @@ dta_instrument_jmp_call(INS ins)
 				 * instrument assert_reg32() before branch;
 				 * conditional instrumentation -- if
 				 */
-				INS_InsertIfCall(ins,
+				DFT_SINK_IFCALL(ins,
 					IPOINT_BEFORE,
 					(AFUNPTR)assert_reg32,
 					IARG_FAST_ANALYSIS_CALL,
@@ -251,7 +308,7 @@ dta_instrument_jmp_call(INS ins)
 				 * instrument assert_reg16() before branch;
 				 * conditional instrumentation -- if
 				 */
-				INS_InsertIfCall(ins,
+				DFT_SINK_IFCALL(ins,
 					IPOINT_BEFORE,
 					(AFUNPTR)assert_reg16,
 					IARG_FAST_ANALYSIS_CALL,
@@ -270,7 +327,7 @@ dta_instrument_jmp_call(INS ins)
 				 * instrument assert_mem32() before branch;
 				 * conditional instrumentation -- if
 				 */
-				INS_InsertIfCall(ins,
+				DFT_SINK_IFCALL(ins,
 					IPOINT_BEFORE,
 					(AFUNPTR)assert_mem32,
 					IARG_FAST_ANALYSIS_CALL,
@@ -283,7 +340,7 @@ dta_instrument_jmp_call(INS ins)
 				 * instrument assert_mem16() before branch;
 				 * conditional instrumentation -- if
 				 */
-				INS_InsertIfCall(ins,
+				DFT_SINK_IFCALL(ins,
 					IPOINT_BEFORE,
 					(AFUNPTR)assert_mem16,
 					IARG_FAST_ANALYSIS_CALL,
@@ -295,7 +352,7 @@ dta_instrument_jmp_call(INS ins)
 		 * instrument alert() before branch;
 		 * conditional instrumentation -- then
 		 */
-		INS_InsertThenCall(ins,
+		DFT_SINK_THENCALL(ins,
 			IPOINT_BEFORE,
 			(AFUNPTR)alert,
 			IARG_FAST_ANALYSIS_CALL,
@@ -323,7 +380,7 @@ dta_instrument_ret(INS ins)
 		 * instrument assert_mem32() before ret;
 		 * conditional instrumentation -- if
 		 */
-		INS_InsertIfCall(ins,
+		DFT_SINK_IFCALL(ins,
 			IPOINT_BEFORE,
 			(AFUNPTR)assert_mem32,
 			IARG_FAST_ANALYSIS_CALL,
@@ -336,7 +393,7 @@ dta_instrument_ret(INS ins)
 		 * instrument assert_mem16() before ret;
 		 * conditional instrumentation -- if
 		 */
-		INS_InsertIfCall(ins,
+		DFT_SINK_IFCALL(ins,
 			IPOINT_BEFORE,
 			(AFUNPTR)assert_mem16,
 			IARG_FAST_ANALYSIS_CALL,
@@ -348,7 +405,7 @@ dta_instrument_ret(INS ins)
 	 * instrument alert() before ret;
 	 * conditional instrumentation -- then
 	 */
-	INS_InsertThenCall(ins,
+	DFT_SINK_THENCALL(ins,
 		IPOINT_BEFORE,
 		(AFUNPTR)alert,
 		IARG_FAST_ANALYSIS_CALL,
@@ -358,103 +415,346 @@ dta_instrument_ret(INS ins)
 }
 
 /*
- * read(2) handler (taint-source)
+ * auxiliary (helper) function
+ *
+ * check if the data that are read from a descriptor must be tagged
+ *
+ * @fd:		the descriptor
+ * @len:	the number of bytes read
+ *
+ * returns:	1 if the descriptor is interesting and sampled, 0 otherwise
+ */
+static inline size_t
+fd_src(int fd, size_t len)
+{
+	return fdset.find(fd) != fdset.end() && sample_src(fd, len);
+}
+
+/*
+ * auxiliary (helper) function
+ *
+ * get a socket address (or option) length that the kernel has stored in
+ * the address space of the process; the length is fetched with
+ * PIN_SafeCopy(), since the pointer comes from the application
+ *
+ * @addr:	the address of the length (socklen_t)
+ * @len:	the length (output)
+ *
+ * returns:	1 on success, 0 if the length is not readable
+ */
+static inline int
+sock_len(ADDRINT addr, size_t *len)
+{
+	/* the length */
+	socklen_t slen;
+
+	/* fetch the length; optimized branch */
+	if (unlikely(PIN_SafeCopy(&slen, (const VOID *)addr, sizeof(slen)) !=
+				sizeof(slen)))
+		return 0;
+
+	/* done */
+	*len = slen;
+	return 1;
+}
+
+/*
+ * auxiliary (helper) function
+ *
+ * get the read end of a pipe
+ *
+ * @fd:		the write end of the pipe
+ *
+ * returns:	the read end, or -1 if fd is not the write end of a pipe
+ */
+static inline int
+pipe_peer(int fd)
+{
+	/* iterator */
+	map<int, int>::iterator it;
+
+	/* no pipes; optimized branch */
+	if (likely(pipes.empty()))
+		return -1;
+
+	/* lookup */
+	return ((it = pipes.find(fd)) != pipes.end()) ? it->second : -1;
+}
+
+/*
+ * auxiliary (helper) function
+ *
+ * forget the pipes that a descriptor is an end of
+ *
+ * @fd:		the descriptor
+ */
+static void
+pipe_del(int fd)
+{
+	/* iterators */
+	map<int, int>::iterator it;
+	multimap<int, int>::iterator rit, rend;
+
+	/* no pipes; optimized branch */
+	if (likely(pipes.empty()))
+		return;
+
+	/* write end; drop it from the reverse index of its read end */
+	if ((it = pipes.find(fd)) != pipes.end()) {
+		for (rit = pipes_rd.lower_bound(it->second),
+				rend = pipes_rd.upper_bound(it->second);
+				rit != rend; rit++)
+			if (rit->second == fd) {
+				pipes_rd.erase(rit);
+				break;
+			}
+		pipes.erase(it);
+	}
+
+	/* read end; drop its write ends */
+	for (rit = pipes_rd.lower_bound(fd), rend = pipes_rd.upper_bound(fd);
+			rit != rend; rit++)
+		pipes.erase(rit->second);
+	pipes_rd.erase(fd);
+}
+
+/*
+ * auxiliary (helper) function
+ *
+ * add a pipe (or a duplicate of the write end of one)
+ *
+ * @wr:		the write end
+ * @rd:		the read end
+ */
+static void
+pipe_add(int wr, int rd)
+{
+	/* the write end was reused */
+	pipe_del(wr);
+
+	/* add the pipe */
+	pipes[wr] = rd;
+	pipes_rd.insert(make_pair(rd, wr));
+}
+
+/*
+ * auxiliary (helper) function
+ *
+ * pipes are not shadowed, and the data that are written into a pipe
+ * lose their tags; whenever tainted data are written into a pipe, we
+ * add its read end to the monitored set instead, so that the data are
+ * tagged again when they are read
+ *
+ * @fd:		the read end of the pipe
+ * @src:	the descriptor that the data come from, or -1 if
+ * 		they are written from memory
+ */
+static void
+pipe_taint(int fd, int src)
+{
+	/* already interesting */
+	if (!fdset.insert(fd).second)
+		return;
+
+	/* sampling */
+	if (src >= 0)
+		sample_dup(src, fd);
+	else
+		(void)sample_open(fd);
+}
+
+/*
+ * read(2)/pread64(2) handler (taint-source)
+ *
+ * data that were written into the file before get their recorded tags
  */
 static void
 post_read_hook(syscall_ctx_t *ctx)
 {
+	/* the tag value of the data */
+	uint8_t color;
+
         /* read() was not successful; optimized branch */
         if (unlikely((long)ctx->ret <= 0))
                 return;
-	
+
 	/* taint-source */
-	if (fdset.find(ctx->arg[SYSCALL_ARG0]) != fdset.end())
+	color = fd_src((int)ctx->arg[SYSCALL_ARG0], (size_t)ctx->ret) ?
+		TAG_ALL8 : TAG_ZERO;
+
+	/* file data with recorded tags */
+	if (filetag_load((int)ctx->arg[SYSCALL_ARG0], ctx->arg[SYSCALL_ARG1],
+			(size_t)ctx->ret, (ctx->nr == __NR_pread64) ?
+			OFF64_ARG(ctx, SYSCALL_ARG3) : -1, color))
+		return;
+
+	/* taint-source */
+	if (color != TAG_ZERO)
         	/* set the tag markings */
-	        tagmap_setn(ctx->arg[SYSCALL_ARG1], (size_t)ctx->ret, TAG_ALL8);
+	        tagmap_setn(ctx->arg[SYSCALL_ARG1], (size_t)ctx->ret, color);
 	else
         	/* clear the tag markings */
 	        tagmap_clrn(ctx->arg[SYSCALL_ARG1], (size_t)ctx->ret);
 }
 
 /*
- * readv(2) handler (taint-source)
+ * readv(2)/preadv(2)/preadv2(2) handler (taint-source)
+ *
+ * the iovec structures are tagged in one pass; data that were
+ * written into the file before get their recorded tags
  */
 static void
 post_readv_hook(syscall_ctx_t *ctx)
 {
-	/* iterators */
-	int i;
-	struct iovec *iov;
-	set<int>::iterator it;
+	/* the tag value of the data */
+	uint8_t color;
+
+	/* (p)readv() was not successful; optimized branch */
+	if (unlikely((long)ctx->ret <= 0))
+		return;
 
-	/* bytes copied in a iovec structure */
-	size_t iov_tot;
+	/* taint-source */
+	color = fd_src((int)ctx->arg[SYSCALL_ARG0], (size_t)ctx->ret) ?
+		TAG_ALL8 : TAG_ZERO;
+
+	/* file data with recorded tags */
+	if (filetag_loadv((int)ctx->arg[SYSCALL_ARG0],
+			(struct iovec *)ctx->arg[SYSCALL_ARG1],
+			(size_t)ctx->arg[SYSCALL_ARG2], (size_t)ctx->ret,
+			(ctx->nr == __NR_readv) ?
+			-1 : OFF64_ARG(ctx, SYSCALL_ARG3), color))
+		return;
+
+	/* taint interesting data and zero everything else */
+	if (color != TAG_ZERO)
+		/* set the tag markings */
+		tagmap_setv((struct iovec *)ctx->arg[SYSCALL_ARG1],
+				(size_t)ctx->arg[SYSCALL_ARG2],
+				(size_t)ctx->ret, color);
+	else
+		/* clear the tag markings */
+		tagmap_clrv((struct iovec *)ctx->arg[SYSCALL_ARG1],
+				(size_t)ctx->arg[SYSCALL_ARG2],
+				(size_t)ctx->ret);
+}
+
+/*
+ * auxiliary (helper) function
+ *
+ * tag a received message; recvmsg(2), recvmmsg(2)
+ *
+ * @msg:	the message header
+ * @tot:	the number of bytes received
+ * @src:	1 if the message must be tagged, 0 otherwise
+ */
+static void
+recvmsg_src(struct msghdr *msg, size_t tot, size_t src)
+{
+	/* source address specified */
+	if (msg->msg_name != NULL) {
+		/* clear the tag bits */
+		tagmap_clrn((size_t)msg->msg_name, msg->msg_namelen);
+
+		/* clear the tag bits */
+		tagmap_clrn((size_t)&msg->msg_namelen, sizeof(int));
+	}
+
+	/* ancillary data specified */
+	if (msg->msg_control != NULL) {
+		/* taint-source */
+		if (src)
+			/* set the tag markings */
+			tagmap_setn((size_t)msg->msg_control,
+					msg->msg_controllen, TAG_ALL8);
+		else
+			/* clear the tag markings */
+			tagmap_clrn((size_t)msg->msg_control,
+					msg->msg_controllen);
+
+		/* clear the tag bits */
+		tagmap_clrn((size_t)&msg->msg_controllen, sizeof(int));
+	}
+
+	/* flags; clear the tag bits */
+	tagmap_clrn((size_t)&msg->msg_flags, sizeof(int));
+
+	/* taint-source */
+	if (src)
+		/* set the tag markings */
+		tagmap_setv(msg->msg_iov, msg->msg_iovlen, tot, TAG_ALL8);
+	else
+		/* clear the tag markings */
+		tagmap_clrv(msg->msg_iov, msg->msg_iovlen, tot);
+}
+
+/*
+ * auxiliary (helper) function
+ *
+ * tag the messages of recvmmsg(2); every
+ * message is considered a separate read
+ *
+ * @ctx:	the syscall context
+ * @args:	the recvmmsg(2) arguments
+ */
+static void
+recvmmsg_src(syscall_ctx_t *ctx, unsigned long *args)
+{
+	/* message headers */
+	struct mmsghdr *msg = (struct mmsghdr *)args[SYSCALL_ARG1];
+
+	/* iterator */
+	size_t i;
 
-	/* total bytes copied */
-	size_t tot = (size_t)ctx->ret;
+	/* the descriptor */
+	int fd = (int)args[SYSCALL_ARG0];
 
-	/* readv() was not successful; optimized branch */
+	/* not successful; optimized branch */
 	if (unlikely((long)ctx->ret <= 0))
 		return;
-	
-	/* get the descriptor */
-	it = fdset.find((int)ctx->arg[SYSCALL_ARG0]);
 
-	/* iterate the iovec structures */
-	for (i = 0; i < (int)ctx->arg[SYSCALL_ARG2] && tot > 0; i++) {
-		/* get an iovec  */
-		iov = ((struct iovec *)ctx->arg[SYSCALL_ARG1]) + i;
-		
-		/* get the length of the iovec */
-		iov_tot = (tot >= (size_t)iov->iov_len) ?
-			(size_t)iov->iov_len : tot;
-	
-		/* taint interesting data and zero everything else */	
-		if (it != fdset.end())
-                	/* set the tag markings */
-                	tagmap_setn((size_t)iov->iov_base, iov_tot, TAG_ALL8);
-		else
-                	/* clear the tag markings */
-                	tagmap_clrn((size_t)iov->iov_base, iov_tot);
+	/* iterate the mmsghdr structures */
+	for (i = 0; i < (size_t)ctx->ret; i++, msg++) {
+		/* taint-source */
+		recvmsg_src(&msg->msg_hdr, (size_t)msg->msg_len,
+				fd_src(fd, (size_t)msg->msg_len));
 
-                /* housekeeping */
-                tot -= iov_tot;
-        }
+		/* bytes received; clear the tag bits */
+		tagmap_clrn((size_t)&msg->msg_len, sizeof(unsigned));
+	}
+
+	/* timespec structure specified */
+	if ((void *)args[SYSCALL_ARG4] != NULL)
+		/* clear the tag bits */
+		tagmap_clrn(args[SYSCALL_ARG4],
+#ifdef __NR_recvmmsg_time64
+			(ctx->nr == __NR_recvmmsg_time64) ? TIMESPEC64_SZ :
+#endif
+			sizeof(struct timespec));
 }
 
 /*
- * socketcall(2) handler
+ * socket calls handler
  *
  * attach taint-sources in the following
- * syscalls:
+ * calls:
  * 	socket(2), accept(2), recv(2),
- * 	recvfrom(2), recvmsg(2)
+ * 	recvfrom(2), recvmsg(2), recvmmsg(2)
  *
  * everything else is left intact in order
  * to avoid taint-leaks
+ *
+ * @ctx:	the syscall context
+ * @call:	the socket call (SYS_*)
+ * @args:	the socket call arguments
  */
 static void
-post_socketcall_hook(syscall_ctx_t *ctx)
+post_sock_hook(syscall_ctx_t *ctx, int call, unsigned long *args)
 {
-	/* message header; recvmsg(2) */
-	struct msghdr *msg;
+	/* address (or option) length */
+	size_t len;
 
-	/* iov bytes copied; recvmsg(2) */
-	size_t iov_tot;
-
-	/* iterators */
-	size_t i;
-	struct iovec *iov;
-	set<int>::iterator it;
-	
-	/* total bytes received */
-	size_t tot;
-	
-	/* socket call arguments */
-	unsigned long *args = (unsigned long *)ctx->arg[SYSCALL_ARG1];
-
-	/* demultiplex the socketcall */
-	switch ((int)ctx->arg[SYSCALL_ARG0]) {
+	/* demultiplex the socket call */
+	switch (call) {
 		case SYS_SOCKET:
 			/* not successful; optimized branch */
 			if (unlikely((long)ctx->ret < 0))
@@ -465,9 +765,11 @@ post_socketcall_hook(syscall_ctx_t *ctx)
 			 * considered interesting
 			 */
 			if (likely(args[SYSCALL_ARG0] == PF_INET ||
-				args[SYSCALL_ARG0] == PF_INET6))
+				args[SYSCALL_ARG0] == PF_INET6)) {
 				/* add the descriptor to the monitored set */
 				fdset.insert((int)ctx->ret);
+				(void)sample_open((int)ctx->ret);
+			}
 
 			/* done */
 			break;
@@ -482,21 +784,23 @@ post_socketcall_hook(syscall_ctx_t *ctx)
 			 * interesting
 			 */
 			if (likely(fdset.find(args[SYSCALL_ARG0]) !=
-						fdset.end()))
+						fdset.end())) {
 				/* add the descriptor to the monitored set */
 				fdset.insert((int)ctx->ret);
+				(void)sample_open((int)ctx->ret);
+			}
 		case SYS_GETSOCKNAME:
 		case SYS_GETPEERNAME:
 			/* not successful; optimized branch */
 			if (unlikely((long)ctx->ret < 0))
 				return;
 
-			/* addr argument is provided */
-			if ((void *)args[SYSCALL_ARG1] != NULL) {
+			/* addr argument is provided, and its length readable */
+			if ((void *)args[SYSCALL_ARG1] != NULL &&
+				sock_len(args[SYSCALL_ARG2], &len)) {
 				/* clear the tag bits */
-				tagmap_clrn(args[SYSCALL_ARG1],
-					*((int *)args[SYSCALL_ARG2]));
-				
+				tagmap_clrn(args[SYSCALL_ARG1], len);
+
 				/* clear the tag bits */
 				tagmap_clrn(args[SYSCALL_ARG2], sizeof(int));
 			}
@@ -505,7 +809,7 @@ post_socketcall_hook(syscall_ctx_t *ctx)
 			/* not successful; optimized branch */
 			if (unlikely((long)ctx->ret < 0))
 				return;
-	
+
 			/* clear the tag bits */
 			tagmap_clrn(args[SYSCALL_ARG3], (sizeof(int) * 2));
 			break;
@@ -513,9 +817,9 @@ post_socketcall_hook(syscall_ctx_t *ctx)
 			/* not successful; optimized branch */
 			if (unlikely((long)ctx->ret <= 0))
 				return;
-			
-			/* taint-source */	
-			if (fdset.find((int)args[SYSCALL_ARG0]) != fdset.end())
+
+			/* taint-source */
+			if (fd_src((int)args[SYSCALL_ARG0], (size_t)ctx->ret))
 				/* set the tag markings */
 				tagmap_setn(args[SYSCALL_ARG1],
 						(size_t)ctx->ret, TAG_ALL8);
@@ -528,9 +832,9 @@ post_socketcall_hook(syscall_ctx_t *ctx)
 			/* not successful; optimized branch */
 			if (unlikely((long)ctx->ret <= 0))
 				return;
-	
-			/* taint-source */	
-			if (fdset.find((int)args[SYSCALL_ARG0]) != fdset.end())
+
+			/* taint-source */
+			if (fd_src((int)args[SYSCALL_ARG0], (size_t)ctx->ret))
 				/* set the tag markings */
 				tagmap_setn(args[SYSCALL_ARG1],
 						(size_t)ctx->ret, TAG_ALL8);
@@ -539,12 +843,12 @@ post_socketcall_hook(syscall_ctx_t *ctx)
 				tagmap_clrn(args[SYSCALL_ARG1],
 						(size_t)ctx->ret);
 
-			/* sockaddr argument is specified */
-			if ((void *)args[SYSCALL_ARG4] != NULL) {
+			/* sockaddr argument is specified, and its length readable */
+			if ((void *)args[SYSCALL_ARG4] != NULL &&
+				sock_len(args[SYSCALL_ARG5], &len)) {
 				/* clear the tag bits */
-				tagmap_clrn(args[SYSCALL_ARG4],
-					*((int *)args[SYSCALL_ARG5]));
-				
+				tagmap_clrn(args[SYSCALL_ARG4], len);
+
 				/* clear the tag bits */
 				tagmap_clrn(args[SYSCALL_ARG5], sizeof(int));
 			}
@@ -553,11 +857,14 @@ post_socketcall_hook(syscall_ctx_t *ctx)
 			/* not successful; optimized branch */
 			if (unlikely((long)ctx->ret < 0))
 				return;
-	
+
+			/* the option length is not readable; optimized branch */
+			if (unlikely(!sock_len(args[SYSCALL_ARG4], &len)))
+				return;
+
 			/* clear the tag bits */
-			tagmap_clrn(args[SYSCALL_ARG3],
-					*((int *)args[SYSCALL_ARG4]));
-			
+			tagmap_clrn(args[SYSCALL_ARG3], len);
+
 			/* clear the tag bits */
 			tagmap_clrn(args[SYSCALL_ARG4], sizeof(int));
 			break;
@@ -565,73 +872,18 @@ post_socketcall_hook(syscall_ctx_t *ctx)
 			/* not successful; optimized branch */
 			if (unlikely((long)ctx->ret <= 0))
 				return;
-			
-			/* get the descriptor */
-			it = fdset.find((int)ctx->arg[SYSCALL_ARG0]);
-
-			/* extract the message header */
-			msg = (struct msghdr *)args[SYSCALL_ARG1];
 
-			/* source address specified */
-			if (msg->msg_name != NULL) {
-				/* clear the tag bits */
-				tagmap_clrn((size_t)msg->msg_name,
-					msg->msg_namelen);
-				
-				/* clear the tag bits */
-				tagmap_clrn((size_t)&msg->msg_namelen,
-						sizeof(int));
-			}
-			
-			/* ancillary data specified */
-			if (msg->msg_control != NULL) {
-				/* taint-source */
-				if (it != fdset.end())
-					/* set the tag markings */
-					tagmap_setn((size_t)msg->msg_control,
-						msg->msg_controllen, TAG_ALL8);
-					
-				else
-					/* clear the tag markings */
-					tagmap_clrn((size_t)msg->msg_control,
-						msg->msg_controllen);
-					
-				/* clear the tag bits */
-				tagmap_clrn((size_t)&msg->msg_controllen,
-						sizeof(int));
-			}
-			
-			/* flags; clear the tag bits */
-			tagmap_clrn((size_t)&msg->msg_flags, sizeof(int));	
-			
-			/* total bytes received */	
-			tot = (size_t)ctx->ret;
-
-			/* iterate the iovec structures */
-			for (i = 0; i < msg->msg_iovlen && tot > 0; i++) {
-				/* get the next I/O vector */
-				iov = &msg->msg_iov[i];
-
-				/* get the length of the iovec */
-				iov_tot = (tot > (size_t)iov->iov_len) ?
-						(size_t)iov->iov_len : tot;
-				
-				/* taint-source */	
-				if (it != fdset.end())
-					/* set the tag markings */
-					tagmap_setn((size_t)iov->iov_base,
-							iov_tot, TAG_ALL8);
-				else
-					/* clear the tag markings */
-					tagmap_clrn((size_t)iov->iov_base,
-								iov_tot);
-		
-				/* housekeeping */
-				tot -= iov_tot;
-			}
+			/* taint-source */
+			recvmsg_src((struct msghdr *)args[SYSCALL_ARG1],
+				(size_t)ctx->ret,
+				fd_src((int)args[SYSCALL_ARG0],
+					(size_t)ctx->ret));
 			break;
-#if LINUX_KERNEL >= 2633
+#ifdef SYS_RECVMMSG
 		case SYS_RECVMMSG:
+			/* taint-source */
+			recvmmsg_src(ctx, args);
+			break;
 #endif
 		default:
 			/* nothing to do */
@@ -639,6 +891,207 @@ post_socketcall_hook(syscall_ctx_t *ctx)
 	}
 }
 
+/*
+ * socketcall(2) handler
+ *
+ * the socket call and its arguments are passed in memory; the
+ * arguments are fetched with PIN_SafeCopy(), since the pointer
+ * comes from the application
+ */
+static void
+post_socketcall_hook(syscall_ctx_t *ctx)
+{
+	/* the socket call arguments */
+	unsigned long args[SYSCALL_ARG_NUM];
+
+	/* fetch the arguments; optimized branch */
+	(void)memset(args, 0, sizeof(args));
+	if (unlikely(PIN_SafeCopy(args, (const VOID *)ctx->arg[SYSCALL_ARG1],
+				sizeof(args)) == 0))
+		return;
+
+	post_sock_hook(ctx, (int)ctx->arg[SYSCALL_ARG0], args);
+}
+
+/*
+ * direct socket syscalls handler
+ *
+ * socket(2), accept(2), recvfrom(2), etc. are separate
+ * syscalls since Linux 4.3 (i386); see syscall_sockcall()
+ */
+static void
+post_socket_hook(syscall_ctx_t *ctx)
+{
+	/* the socket call */
+	int call = syscall_sockcall(ctx->nr);
+
+	/* the arguments are in the syscall context */
+	if (likely(call >= 0))
+		post_sock_hook(ctx, call, (unsigned long *)ctx->arg);
+}
+
+/*
+ * auxiliary (helper) function
+ *
+ * pipe(2)/pipe2(2) handler; the two ends of
+ * every pipe are recorded for pipe_taint()
+ */
+static void
+post_pipe_hook(syscall_ctx_t *ctx)
+{
+	/* the pipe descriptors */
+	int *fds = (int *)ctx->arg[SYSCALL_ARG0];
+
+	/* not successful; optimized branch */
+	if (unlikely((long)ctx->ret < 0))
+		return;
+
+	/* write end -> read end */
+	pipe_add(fds[1], fds[0]);
+
+	/* clear the tag bits */
+	tagmap_clrn(ctx->arg[SYSCALL_ARG0], (sizeof(int) * 2));
+}
+
+/*
+ * write(2)/pwrite64(2) handler (propagation)
+ *
+ * the tags of the data that are written into a file are recorded
+ * (file tag store), and tainted data that are written into a pipe
+ * taint its read end
+ */
+static void
+post_write_hook(syscall_ctx_t *ctx)
+{
+	/* the read end of the pipe */
+	int fd;
+
+	/* not successful; optimized branch */
+	if (unlikely((long)ctx->ret <= 0))
+		return;
+
+	/* file data */
+	filetag_store((int)ctx->arg[SYSCALL_ARG0], ctx->arg[SYSCALL_ARG1],
+			(size_t)ctx->ret, (ctx->nr == __NR_pwrite64) ?
+			OFF64_ARG(ctx, SYSCALL_ARG3) : -1);
+
+	/* not a pipe; optimized branch */
+	if (likely((fd = pipe_peer((int)ctx->arg[SYSCALL_ARG0])) < 0))
+		return;
+
+	/* tainted data */
+	if (tagmap_issetn(ctx->arg[SYSCALL_ARG1], (size_t)ctx->ret))
+		pipe_taint(fd, -1);
+}
+
+/*
+ * writev(2)/pwritev(2)/pwritev2(2)/vmsplice(2) handler (propagation)
+ *
+ * same as post_write_hook(), but with iovec structures
+ */
+static void
+post_writev_hook(syscall_ctx_t *ctx)
+{
+	/* the read end of the pipe */
+	int fd;
+
+	/* not successful; optimized branch */
+	if (unlikely((long)ctx->ret <= 0))
+		return;
+
+	/* file data; vmsplice(2) works only on pipes */
+	if (ctx->nr != __NR_vmsplice)
+		filetag_storev((int)ctx->arg[SYSCALL_ARG0],
+			(struct iovec *)ctx->arg[SYSCALL_ARG1],
+			(size_t)ctx->arg[SYSCALL_ARG2], (size_t)ctx->ret,
+			(ctx->nr == __NR_writev) ?
+			-1 : OFF64_ARG(ctx, SYSCALL_ARG3));
+
+	/* not a pipe; optimized branch */
+	if (likely((fd = pipe_peer((int)ctx->arg[SYSCALL_ARG0])) < 0))
+		return;
+
+	/* tainted data */
+	if (tagmap_getv((struct iovec *)ctx->arg[SYSCALL_ARG1],
+				(size_t)ctx->arg[SYSCALL_ARG2],
+				(size_t)ctx->ret) != TAG_ZERO)
+		pipe_taint(fd, -1);
+}
+
+/*
+ * splice(2)/tee(2)/sendfile(2)/sendfile64(2) handler (propagation)
+ *
+ * the data are moved between descriptors without going through
+ * memory; data that come from an interesting descriptor taint
+ * the destination pipe (if any), and the offset arguments are
+ * cleared (the default handling of the syscalls)
+ */
+static void
+post_splice_hook(syscall_ctx_t *ctx)
+{
+	/* source and destination descriptors */
+	int in, out;
+
+	/* demultiplex the syscall */
+	switch (ctx->nr) {
+#ifdef __NR_splice
+		case __NR_splice:
+			/* not successful; optimized branch */
+			if (unlikely((long)ctx->ret < 0))
+				return;
+
+			/* offsets; clear the tag bits */
+			if ((void *)ctx->arg[SYSCALL_ARG1] != NULL)
+				tagmap_clrn(ctx->arg[SYSCALL_ARG1],
+						sizeof(loff_t));
+			if ((void *)ctx->arg[SYSCALL_ARG3] != NULL)
+				tagmap_clrn(ctx->arg[SYSCALL_ARG3],
+						sizeof(loff_t));
+
+			/* descriptors */
+			in	= (int)ctx->arg[SYSCALL_ARG0];
+			out	= (int)ctx->arg[SYSCALL_ARG2];
+			break;
+#endif
+#ifdef __NR_tee
+		case __NR_tee:
+			/* descriptors */
+			in	= (int)ctx->arg[SYSCALL_ARG0];
+			out	= (int)ctx->arg[SYSCALL_ARG1];
+			break;
+#endif
+		case __NR_sendfile:
+#ifdef __NR_sendfile64
+		case __NR_sendfile64:
+#endif
+			/* not successful; optimized branch */
+			if (unlikely((long)ctx->ret < 0))
+				return;
+
+			/* offset; clear the tag bits */
+			if ((void *)ctx->arg[SYSCALL_ARG2] != NULL)
+				tagmap_clrn(ctx->arg[SYSCALL_ARG2],
+					(ctx->nr == __NR_sendfile) ?
+					sizeof(off_t) : sizeof(loff_t));
+
+			/* descriptors */
+			in	= (int)ctx->arg[SYSCALL_ARG1];
+			out	= (int)ctx->arg[SYSCALL_ARG0];
+			break;
+		default:
+			/* nothing to do */
+			return;
+	}
+
+	/* not successful, or not a pipe; optimized branch */
+	if (unlikely((long)ctx->ret <= 0) || likely((out = pipe_peer(out)) < 0))
+		return;
+
+	/* interesting data */
+	if (fd_src(in, (size_t)ctx->ret))
+		pipe_taint(out, in);
+}
+
 /*
  * auxiliary (helper) function
  *
@@ -648,17 +1101,29 @@ post_socketcall_hook(syscall_ctx_t *ctx)
 static void
 post_dup_hook(syscall_ctx_t *ctx)
 {
+	/* the read end of the pipe */
+	int fd;
+
 	/* not successful; optimized branch */
 	if (unlikely((long)ctx->ret < 0))
 		return;
-	
+
 	/*
 	 * if the old descriptor argument is
 	 * interesting, the returned handle is
 	 * also interesting
 	 */
-	if (likely(fdset.find((int)ctx->arg[SYSCALL_ARG0]) != fdset.end()))
+	if (likely(fdset.find((int)ctx->arg[SYSCALL_ARG0]) != fdset.end())) {
 		fdset.insert((int)ctx->ret);
+		sample_dup((int)ctx->arg[SYSCALL_ARG0], (int)ctx->ret);
+	}
+
+	/* the write end of a pipe is duplicated */
+	if ((fd = pipe_peer((int)ctx->arg[SYSCALL_ARG0])) >= 0)
+		pipe_add((int)ctx->ret, fd);
+
+	/* file tag store */
+	filetag_dup((int)ctx->arg[SYSCALL_ARG0], (int)ctx->ret);
 }
 
 /*
@@ -674,26 +1139,38 @@ post_close_hook(syscall_ctx_t *ctx)
 	/* iterator */
 	set<int>::iterator it;
 
+	/* the descriptor */
+	int fd = (int)ctx->arg[SYSCALL_ARG0];
+
 	/* not successful; optimized branch */
 	if (unlikely((long)ctx->ret < 0))
 		return;
-	
+
 	/*
 	 * if the descriptor (argument) is
 	 * interesting, remove it from the
 	 * monitored set
 	 */
-	it = fdset.find((int)ctx->arg[SYSCALL_ARG0]);
-	if (likely(it != fdset.end()))
+	it = fdset.find(fd);
+	if (likely(it != fdset.end())) {
 		fdset.erase(it);
+		sample_close(fd);
+	}
+
+	/* file tag store */
+	filetag_close(fd);
+
+	/* forget the pipes that the descriptor was an end of */
+	pipe_del(fd);
 }
 
 /*
  * auxiliary (helper) function
  *
- * whenever open(2)/creat(2) is invoked,
- * add the descriptor inside the monitored
- * set of descriptors
+ * whenever open(2)/creat(2)/openat(2) is invoked,
+ * add the descriptor inside the monitored set of
+ * descriptors (if files are taint-sources), and
+ * drop the recorded tags of truncated files
  *
  * NOTE: it does not track dynamic shared
  * libraries
@@ -701,14 +1178,60 @@ post_close_hook(syscall_ctx_t *ctx)
 static void
 post_open_hook(syscall_ctx_t *ctx)
 {
+	/* path and flags */
+	char *path;
+	int flags;
+
 	/* not successful; optimized branch */
 	if (unlikely((long)ctx->ret < 0))
 		return;
+
+	/* demultiplex the syscall */
+	if (ctx->nr == __NR_openat) {
+		path	= (char *)ctx->arg[SYSCALL_ARG1];
+		flags	= (int)ctx->arg[SYSCALL_ARG2];
+	}
+	else {
+		path	= (char *)ctx->arg[SYSCALL_ARG0];
+		flags	= (ctx->nr == __NR_creat) ?
+			O_CREAT | O_WRONLY | O_TRUNC :
+			(int)ctx->arg[SYSCALL_ARG1];
+	}
+
+	/* the file is truncated */
+	if ((flags & O_TRUNC) != 0)
+		filetag_trunc((int)ctx->ret, 0);
+
+	/* files are not taint-sources */
+	if (fs.Value() == 0)
+		return;
 	
 	/* ignore dynamic shared libraries */
-	if (strstr((char *)ctx->arg[SYSCALL_ARG0], DLIB_SUFF) == NULL &&
-		strstr((char *)ctx->arg[SYSCALL_ARG0], DLIB_SUFF_ALT) == NULL)
+	if (strstr(path, DLIB_SUFF) == NULL &&
+		strstr(path, DLIB_SUFF_ALT) == NULL) {
 		fdset.insert((int)ctx->ret);
+		(void)sample_open((int)ctx->ret);
+	}
+}
+
+/*
+ * ftruncate(2)/ftruncate64(2) handler
+ *
+ * the recorded tags beyond the end
+ * of the file are dropped
+ */
+static void
+post_ftruncate_hook(syscall_ctx_t *ctx)
+{
+	/* not successful; optimized branch */
+	if (unlikely((long)ctx->ret < 0))
+		return;
+
+	/* file tag store */
+	filetag_trunc((int)ctx->arg[SYSCALL_ARG0],
+		(ctx->nr == __NR_ftruncate) ?
+		(off64_t)(long)ctx->arg[SYSCALL_ARG1] :
+		OFF64_ARG(ctx, SYSCALL_ARG1));
 }
 
 /* 
@@ -721,6 +1244,9 @@ post_open_hook(syscall_ctx_t *ctx)
 int
 main(int argc, char **argv)
 {
+	/* iterator */
+	int i;
+
 	/* initialize symbol processing */
 	PIN_InitSymbols();
 	
@@ -729,10 +1255,70 @@ main(int argc, char **argv)
 		/* Pin initialization failed */
 		goto err;
 
+	/* export the tagmap; before libdft_init() */
+	if (!shmname.Value().empty() &&
+		unlikely(tagmap_export(shmname.Value().c_str(),
+					shmsize.Value() << 20) != 0))
+		/* failed */
+		goto err;
+
 	/* initialize the core tagging engine */
 	if (unlikely(libdft_init() != 0))
 		/* failed */
 		goto err;
+
+	/* initialize the function summaries */
+	if (summ.Value() != 0 && unlikely(summary_init() != 0))
+		/* failed */
+		goto err;
+
+	/* enable sampling */
+	if (srate.Value() < SAMPLE_SCALE &&
+			unlikely(sample_init(srate.Value(), sgran.Value()) != 0))
+		/* failed */
+		goto err;
+
+	/* enable the shared shadows */
+	if (!sharepref.Value().empty() &&
+			unlikely(tagmap_share(sharepref.Value().c_str()) != 0))
+		/* failed */
+		goto err;
+
+	/* enable the file tag store */
+	if (!ftdir.Value().empty() &&
+			unlikely(filetag_init(ftdir.Value().c_str()) != 0))
+		/* failed */
+		goto err;
+
+	/* enable the control channel */
+	if (!ctlpath.Value().empty() &&
+			unlikely(ctl_init(ctlpath.Value().c_str()) != 0))
+		/* failed */
+		goto err;
+
+	/* enable the shadow memory usage dump */
+	if (memdump.Value() >= 0 &&
+			unlikely(tagmap_usage_dump(memdump.Value()) != 0))
+		/* failed */
+		goto err;
+
+	/* enable the shadow scavenger */
+	if (scavenge.Value() != 0 &&
+			unlikely(libdft_scavenge(scavenge.Value()) != 0))
+		/* failed */
+		goto err;
+
+	/* enable the instrumentation statistics */
+	if (!statpath.Value().empty() &&
+			unlikely(stats_init(statpath.Value().c_str()) != 0))
+		/* failed */
+		goto err;
+
+	/* enable decoupled propagation */
+	if (decoupled.Value() != 0 &&
+			unlikely(replay_init(rcpu.Value()) != 0))
+		/* failed */
+		goto err;
 	
 	/* 
 	 * handle control transfer instructions
@@ -769,35 +1355,94 @@ main(int argc, char **argv)
 	 * syscall_set_post() are successful
 	 */
 
-	/* read(2) */
+	/* read(2), pread64(2) */
 	(void)syscall_set_post(&syscall_desc[__NR_read], post_read_hook);
+	(void)syscall_set_post(&syscall_desc[__NR_pread64], post_read_hook);
 
-	/* readv(2) */
+	/* readv(2), preadv(2), preadv2(2) */
 	(void)syscall_set_post(&syscall_desc[__NR_readv], post_readv_hook);
+#ifdef __NR_preadv
+	(void)syscall_set_post(&syscall_desc[__NR_preadv], post_readv_hook);
+#endif
+#ifdef __NR_preadv2
+	(void)syscall_set_post(&syscall_desc[__NR_preadv2], post_readv_hook);
+#endif
 
-	/* socket(2), accept(2), recv(2), recvfrom(2), recvmsg(2) */
-	if (net.Value() != 0)
+	/*
+	 * socket(2), accept(2), recv(2), recvfrom(2), recvmsg(2),
+	 * recvmmsg(2); both via socketcall(2) and as direct syscalls
+	 */
+	if (net.Value() != 0) {
 		(void)syscall_set_post(&syscall_desc[__NR_socketcall],
 			post_socketcall_hook);
+		for (i = 0; i < SYSCALL_MAX; i++)
+			if (syscall_sockcall(i) >= 0)
+				(void)syscall_set_post(&syscall_desc[i],
+					post_socket_hook);
+	}
+
+	/*
+	 * pipe(2), pipe2(2), write(2), writev(2), vmsplice(2), splice(2),
+	 * tee(2), sendfile(2), sendfile64(2); taint propagation via pipes
+	 */
+	(void)syscall_set_post(&syscall_desc[__NR_pipe], post_pipe_hook);
+#ifdef __NR_pipe2
+	(void)syscall_set_post(&syscall_desc[__NR_pipe2], post_pipe_hook);
+#endif
+	(void)syscall_set_post(&syscall_desc[__NR_write], post_write_hook);
+	(void)syscall_set_post(&syscall_desc[__NR_writev], post_writev_hook);
+	(void)syscall_set_post(&syscall_desc[__NR_vmsplice], post_writev_hook);
+
+	/*
+	 * pwrite64(2), pwritev(2), pwritev2(2), ftruncate(2), ftruncate64(2);
+	 * file tag store (write(2), writev(2), and the reads are above)
+	 */
+	(void)syscall_set_post(&syscall_desc[__NR_pwrite64], post_write_hook);
+#ifdef __NR_pwritev
+	(void)syscall_set_post(&syscall_desc[__NR_pwritev], post_writev_hook);
+#endif
+#ifdef __NR_pwritev2
+	(void)syscall_set_post(&syscall_desc[__NR_pwritev2], post_writev_hook);
+#endif
+	(void)syscall_set_post(&syscall_desc[__NR_ftruncate],
+			post_ftruncate_hook);
+	(void)syscall_set_post(&syscall_desc[__NR_ftruncate64],
+			post_ftruncate_hook);
+#ifdef __NR_splice
+	(void)syscall_set_post(&syscall_desc[__NR_splice], post_splice_hook);
+#endif
+#ifdef __NR_tee
+	(void)syscall_set_post(&syscall_desc[__NR_tee], post_splice_hook);
+#endif
+	(void)syscall_set_post(&syscall_desc[__NR_sendfile], post_splice_hook);
+#ifdef __NR_sendfile64
+	(void)syscall_set_post(&syscall_desc[__NR_sendfile64],
+			post_splice_hook);
+#endif
 
-	/* dup(2), dup2(2) */
+	/* dup(2), dup2(2), dup3(2) */
 	(void)syscall_set_post(&syscall_desc[__NR_dup], post_dup_hook);
 	(void)syscall_set_post(&syscall_desc[__NR_dup2], post_dup_hook);
+#ifdef __NR_dup3
+	(void)syscall_set_post(&syscall_desc[__NR_dup3], post_dup_hook);
+#endif
 
 	/* close(2) */
 	(void)syscall_set_post(&syscall_desc[__NR_close], post_close_hook);
 	
-	/* open(2), creat(2) */
-	if (fs.Value() != 0) {
-		(void)syscall_set_post(&syscall_desc[__NR_open],
-				post_open_hook);
-		(void)syscall_set_post(&syscall_desc[__NR_creat],
-				post_open_hook);
-	}
+	/* open(2), creat(2), openat(2) */
+	(void)syscall_set_post(&syscall_desc[__NR_open], post_open_hook);
+	(void)syscall_set_post(&syscall_desc[__NR_creat], post_open_hook);
+	(void)syscall_set_post(&syscall_desc[__NR_openat], post_open_hook);
 	
 	/* add stdin to the interesting descriptors set */
-	if (sin.Value() != 0)
+	if (sin.Value() != 0) {
 		fdset.insert(STDIN_FILENO);
+		(void)sample_open(STDIN_FILENO);
+	}
+
+	/* carry the interesting descriptors across exec */
+	exectag_fds(&fdset);
 
 	/* start Pin */
 	PIN_StartProgram();